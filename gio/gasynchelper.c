@@ -24,6 +24,11 @@
 
 #include "gasynchelper.h"
 
+#ifdef G_OS_UNIX
+#include <limits.h>
+#include <sys/uio.h>
+#endif
+
 
 /*< private >
  * SECTION:gasynchelper
@@ -168,3 +173,83 @@ _g_fd_source_new (int           fd,
 
   return source;
 }
+
+#ifdef G_OS_UNIX
+
+/*************************************************************************
+ *             vectored fd I/O                                           *
+ ************************************************************************/
+
+/* POSIX guarantees at least _XOPEN_IOV_MAX */
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+/* Like writev(), but taking #GOutputVectors. No more than IOV_MAX
+ * vectors are passed to the kernel, so callers must be prepared for
+ * a short write. Returns -1 with errno set on failure.
+ */
+gssize
+_g_fd_writev (int                  fd,
+	      const GOutputVector *vectors,
+	      gsize                n_vectors)
+{
+  struct iovec *iov;
+  gsize i;
+
+  if (n_vectors > IOV_MAX)
+    n_vectors = IOV_MAX;
+
+  /* this entire expression will be evaluated at compile time */
+  if (sizeof (struct iovec) == sizeof (GOutputVector) &&
+      G_STRUCT_OFFSET (struct iovec, iov_base) ==
+      G_STRUCT_OFFSET (GOutputVector, buffer) &&
+      G_STRUCT_OFFSET (struct iovec, iov_len) ==
+      G_STRUCT_OFFSET (GOutputVector, size))
+    /* ABI is compatible */
+    return writev (fd, (const struct iovec *) vectors, n_vectors);
+
+  /* ABI is incompatible */
+  iov = g_newa (struct iovec, n_vectors);
+  for (i = 0; i < n_vectors; i++)
+    {
+      iov[i].iov_base = (void *) vectors[i].buffer;
+      iov[i].iov_len = vectors[i].size;
+    }
+
+  return writev (fd, iov, n_vectors);
+}
+
+/* Like readv(), but taking #GInputVectors; see _g_fd_writev(). */
+gssize
+_g_fd_readv (int           fd,
+	     GInputVector *vectors,
+	     gsize         n_vectors)
+{
+  struct iovec *iov;
+  gsize i;
+
+  if (n_vectors > IOV_MAX)
+    n_vectors = IOV_MAX;
+
+  /* this entire expression will be evaluated at compile time */
+  if (sizeof (struct iovec) == sizeof (GInputVector) &&
+      G_STRUCT_OFFSET (struct iovec, iov_base) ==
+      G_STRUCT_OFFSET (GInputVector, buffer) &&
+      G_STRUCT_OFFSET (struct iovec, iov_len) ==
+      G_STRUCT_OFFSET (GInputVector, size))
+    /* ABI is compatible */
+    return readv (fd, (struct iovec *) vectors, n_vectors);
+
+  /* ABI is incompatible */
+  iov = g_newa (struct iovec, n_vectors);
+  for (i = 0; i < n_vectors; i++)
+    {
+      iov[i].iov_base = vectors[i].buffer;
+      iov[i].iov_len = vectors[i].size;
+    }
+
+  return readv (fd, iov, n_vectors);
+}
+
+#endif /* G_OS_UNIX */
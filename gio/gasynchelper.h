@@ -35,6 +35,26 @@ GSource *_g_fd_source_new      (int              fd,
 				gushort          events,
 				GCancellable    *cancellable);
 
+void     _g_io_scheduler_invoke_in_context         (GMainContext           *context,
+                                                    GSourceFunc             func,
+                                                    gpointer                user_data,
+                                                    GDestroyNotify          notify);
+
+void     _g_simple_async_result_run_in_thread_pool (GSimpleAsyncResult     *simple,
+                                                    GIOSchedulerPool        pool,
+                                                    GSimpleAsyncThreadFunc  func,
+                                                    int                     io_priority,
+                                                    GCancellable           *cancellable);
+
+#ifdef G_OS_UNIX
+gssize   _g_fd_writev                              (int                     fd,
+                                                    const GOutputVector    *vectors,
+                                                    gsize                   n_vectors);
+gssize   _g_fd_readv                               (int                     fd,
+                                                    GInputVector           *vectors,
+                                                    gsize                   n_vectors);
+#endif
+
 G_END_DECLS
 
 #endif /* __G_ASYNC_HELPER_H__ */
@@ -58,11 +58,23 @@
 
 #define DEFAULT_BUFFER_SIZE 4096
 
+/* The buffer is used as a ring, so that neither reads nor fills ever
+ * move buffered data around. The available bytes run from pos to end,
+ * with 0 <= pos < len and pos <= end <= pos + len; offsets of len and
+ * beyond wrap around to the start of the buffer.
+ * g_buffered_input_stream_peek_buffer() straightens the ring out
+ * when the data wraps.
+ *
+ * Bytes that were read stay in the buffer behind pos until a fill
+ * overwrites them; history counts how many of them are left, so that
+ * short backwards seeks can be served from the buffer.
+ */
 struct _GBufferedInputStreamPrivate {
   guint8 *buffer;
   gsize   len;
   gsize   pos;
   gsize   end;
+  gsize   history;
   GAsyncReadyCallback outstanding_callback;
 };
 
@@ -131,7 +143,11 @@ static gboolean g_buffered_input_stream_truncate            (GSeekable       *se
 
 static void     g_buffered_input_stream_finalize            (GObject         *object);
 
-static void compact_buffer (GBufferedInputStream *stream);
+static void     buffer_reset   (GBufferedInputStreamPrivate *priv);
+static void     buffer_copy    (GBufferedInputStreamPrivate *priv,
+                                void                        *dest,
+                                gsize                        offset,
+                                gsize                        count);
 
 G_DEFINE_TYPE_WITH_CODE (GBufferedInputStream,
 			 g_buffered_input_stream,
@@ -226,18 +242,18 @@ g_buffered_input_stream_set_buffer_size (GBufferedInputStream *stream,
       size = MAX (size, in_buffer);
 
       buffer = g_malloc (size);
-      memcpy (buffer, priv->buffer + priv->pos, in_buffer);
+      buffer_copy (priv, buffer, 0, in_buffer);
       priv->len = size;
       priv->pos = 0;
       priv->end = in_buffer;
+      priv->history = 0;
       g_free (priv->buffer);
       priv->buffer = buffer;
     }
   else
     {
       priv->len = size;
-      priv->pos = 0;
-      priv->end = 0;
+      buffer_reset (priv);
       priv->buffer = g_malloc (size);
     }
 
@@ -612,7 +628,7 @@ g_buffered_input_stream_peek (GBufferedInputStream *stream,
   end = MIN (offset + count, available);
   count = end - offset;
 
-  memcpy (buffer, stream->priv->buffer + stream->priv->pos + offset, count);
+  buffer_copy (stream->priv, buffer, offset, count);
   return count;
 }
 
@@ -633,11 +649,27 @@ g_buffered_input_stream_peek_buffer (GBufferedInputStream *stream,
                                      gsize                *count)
 {
   GBufferedInputStreamPrivate *priv;
+  guint8 *head;
+  gsize head_len;
 
   g_return_val_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream), NULL);
 
   priv = stream->priv;
 
+  if (priv->end > priv->len)
+    {
+      /* The data wraps around; move it to the start of the buffer */
+      head_len = priv->end - priv->len;
+      head = g_memdup (priv->buffer, head_len);
+      g_memmove (priv->buffer, priv->buffer + priv->pos, priv->len - priv->pos);
+      memcpy (priv->buffer + priv->len - priv->pos, head, head_len);
+      g_free (head);
+
+      priv->end -= priv->pos;
+      priv->pos = 0;
+      priv->history = 0;
+    }
+
   if (count)
     *count = priv->end - priv->pos;
 
@@ -645,19 +677,94 @@ g_buffered_input_stream_peek_buffer (GBufferedInputStream *stream,
 }
 
 static void
-compact_buffer (GBufferedInputStream *stream)
+buffer_reset (GBufferedInputStreamPrivate *priv)
 {
-  GBufferedInputStreamPrivate *priv;
-  gsize current_size;
+  priv->pos = 0;
+  priv->end = 0;
+  priv->history = 0;
+}
 
-  priv = stream->priv;
+/* Marks @count available bytes as read */
+static void
+buffer_consume (GBufferedInputStreamPrivate *priv,
+                gsize                        count)
+{
+  priv->pos += count;
+  priv->history += count;
+
+  if (priv->pos >= priv->len)
+    {
+      priv->pos -= priv->len;
+      priv->end -= priv->len;
+    }
+}
 
-  current_size = priv->end - priv->pos;
+/* Copies @count available bytes, starting @offset bytes after pos */
+static void
+buffer_copy (GBufferedInputStreamPrivate *priv,
+             void                        *dest,
+             gsize                        offset,
+             gsize                        count)
+{
+  gsize start, n;
 
-  g_memmove (priv->buffer, priv->buffer + priv->pos, current_size);
+  start = priv->pos + offset;
+  if (start >= priv->len)
+    start -= priv->len;
 
-  priv->pos = 0;
-  priv->end = current_size;
+  n = MIN (count, priv->len - start);
+  memcpy (dest, priv->buffer + start, n);
+  memcpy ((guint8 *)dest + n, priv->buffer, count - n);
+}
+
+/* Returns where to store up to @count more bytes, and in @count how
+ * many of them fit there */
+static guint8 *
+buffer_prepare_fill (GBufferedInputStreamPrivate *priv,
+                     gssize                      *count)
+{
+  gsize room;
+
+  if (*count == -1)
+    *count = priv->len;
+
+  /* Never fill more than can fit in the buffer */
+  *count = MIN (*count, priv->len - (priv->end - priv->pos));
+
+  if (priv->end < priv->len)
+    {
+      room = priv->len - priv->end;
+      if (room < *count && priv->end == priv->pos)
+        {
+          /* Empty; start over to read it all in one go */
+          buffer_reset (priv);
+          room = priv->len;
+        }
+      *count = MIN (*count, room);
+      return priv->buffer + priv->end;
+    }
+  else
+    return priv->buffer + priv->end - priv->len;
+}
+
+static int
+buffer_read_byte (GBufferedInputStreamPrivate *priv)
+{
+  int c;
+
+  c = priv->buffer[priv->pos];
+  buffer_consume (priv, 1);
+
+  return c;
+}
+
+/* Adds @count bytes stored at the place buffer_prepare_fill() chose */
+static void
+buffer_commit_fill (GBufferedInputStreamPrivate *priv,
+                    gsize                        count)
+{
+  priv->end += count;
+  priv->history = MIN (priv->history, priv->len - (priv->end - priv->pos));
 }
 
 static gssize
@@ -669,31 +776,21 @@ g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
   GBufferedInputStreamPrivate *priv;
   GInputStream *base_stream;
   gssize nread;
-  gsize in_buffer;
+  guint8 *dest;
 
   priv = stream->priv;
 
-  if (count == -1)
-    count = priv->len;
-
-  in_buffer = priv->end - priv->pos;
-
-  /* Never fill more than can fit in the buffer */
-  count = MIN (count, priv->len - in_buffer);
-
-  /* If requested length does not fit at end, compact */
-  if (priv->len - priv->end < count)
-    compact_buffer (stream);
+  dest = buffer_prepare_fill (priv, &count);
 
   base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
   nread = g_input_stream_read (base_stream,
-                               priv->buffer + priv->end,
+                               dest,
                                count,
                                cancellable,
                                error);
 
   if (nread > 0)
-    priv->end += nread;
+    buffer_commit_fill (priv, nread);
 
   return nread;
 }
@@ -718,7 +815,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
 
   if (count <= available)
     {
-      priv->pos += count;
+      buffer_consume (priv, count);
       return count;
     }
 
@@ -726,8 +823,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
    * request refill for more
    */
 
-  priv->pos = 0;
-  priv->end = 0;
+  buffer_reset (priv);
   bytes_skipped = available;
   count -= available;
 
@@ -769,7 +865,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
   count = MIN (count, available);
 
   bytes_skipped += count;
-  priv->pos += count;
+  buffer_consume (priv, count);
 
   return bytes_skipped;
 }
@@ -795,8 +891,8 @@ g_buffered_input_stream_read (GInputStream *stream,
 
   if (count <= available)
     {
-      memcpy (buffer, priv->buffer + priv->pos, count);
-      priv->pos += count;
+      buffer_copy (priv, buffer, 0, count);
+      buffer_consume (priv, count);
       return count;
     }
 
@@ -804,9 +900,8 @@ g_buffered_input_stream_read (GInputStream *stream,
    * request refill for more
    */
 
-  memcpy (buffer, priv->buffer + priv->pos, available);
-  priv->pos = 0;
-  priv->end = 0;
+  buffer_copy (priv, buffer, 0, available);
+  buffer_reset (priv);
   bytes_read = available;
   count -= available;
 
@@ -847,9 +942,9 @@ g_buffered_input_stream_read (GInputStream *stream,
   available = priv->end - priv->pos;
   count = MIN (count, available);
 
-  memcpy ((char *)buffer + bytes_read, (char *)priv->buffer + priv->pos, count);
+  buffer_copy (priv, (char *)buffer + bytes_read, 0, count);
   bytes_read += count;
-  priv->pos += count;
+  buffer_consume (priv, count);
 
   return bytes_read;
 }
@@ -914,9 +1009,24 @@ g_buffered_input_stream_seek (GSeekable     *seekable,
   
   if (type == G_SEEK_CUR)
     {
-      if (offset <= priv->end - priv->pos && offset >= -priv->pos)
+      gsize history;
+
+      history = MIN (priv->history, priv->len - (priv->end - priv->pos));
+
+      if (offset >= 0 && offset <= priv->end - priv->pos)
+	{
+	  buffer_consume (priv, offset);
+	  return TRUE;
+	}
+      else if (offset < 0 && -offset <= history)
 	{
+	  if (priv->pos < -offset)
+	    {
+	      priv->pos += priv->len;
+	      priv->end += priv->len;
+	    }
 	  priv->pos += offset;
+	  priv->history += offset;
 	  return TRUE;
 	}
       else
@@ -927,8 +1037,7 @@ g_buffered_input_stream_seek (GSeekable     *seekable,
 
   if (g_seekable_seek (base_stream_seekable, offset, type, cancellable, error))
     {
-      priv->pos = 0;
-      priv->end = 0;
+      buffer_reset (priv);
       return TRUE;
     }
   else
@@ -1009,7 +1118,7 @@ g_buffered_input_stream_read_byte (GBufferedInputStream  *stream,
   if (available != 0)
     {
       g_input_stream_clear_pending (input_stream);
-      return priv->buffer[priv->pos++];
+      return buffer_read_byte (priv);
     }
 
   /* Byte not available, request refill for more */
@@ -1017,8 +1126,7 @@ g_buffered_input_stream_read_byte (GBufferedInputStream  *stream,
   if (cancellable)
     g_cancellable_push_current (cancellable);
 
-  priv->pos = 0;
-  priv->end = 0;
+  buffer_reset (priv);
 
   class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
   nread = class->fill (stream, priv->len, cancellable, error);
@@ -1031,7 +1139,7 @@ g_buffered_input_stream_read_byte (GBufferedInputStream  *stream,
   if (nread <= 0)
     return -1; /* error or end of stream */
 
-  return priv->buffer[priv->pos++];
+  return buffer_read_byte (priv);
 }
 
 /* ************************** */
@@ -1066,8 +1174,7 @@ fill_async_callback (GObject      *source_object,
       object = g_async_result_get_source_object (G_ASYNC_RESULT (simple));
       priv = G_BUFFERED_INPUT_STREAM (object)->priv;
 
-      g_assert_cmpint (priv->end + res, <=, priv->len);
-      priv->end += res;
+      buffer_commit_fill (priv, res);
 
       g_object_unref (object);
     }
@@ -1090,21 +1197,11 @@ g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
   GBufferedInputStreamPrivate *priv;
   GInputStream *base_stream;
   GSimpleAsyncResult *simple;
-  gsize in_buffer;
+  guint8 *dest;
 
   priv = stream->priv;
 
-  if (count == -1)
-    count = priv->len;
-
-  in_buffer = priv->end - priv->pos;
-
-  /* Never fill more than can fit in the buffer */
-  count = MIN (count, priv->len - in_buffer);
-
-  /* If requested length does not fit at end, compact */
-  if (priv->len - priv->end < count)
-    compact_buffer (stream);
+  dest = buffer_prepare_fill (priv, &count);
 
   simple = g_simple_async_result_new (G_OBJECT (stream),
                                       callback, user_data,
@@ -1112,7 +1209,7 @@ g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
 
   base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
   g_input_stream_read_async (base_stream,
-                             priv->buffer + priv->end,
+                             dest,
                              count,
                              io_priority,
                              cancellable,
@@ -1213,7 +1310,7 @@ skip_fill_buffer_callback (GObject      *source_object,
       data->count = MIN (data->count, available);
 
       data->bytes_skipped += data->count;
-      priv->pos += data->count;
+      buffer_consume (priv, data->count);
     }
 
   /* Complete immediately, not in idle, since we're already
@@ -1253,7 +1350,7 @@ g_buffered_input_stream_skip_async (GInputStream        *stream,
 
   if (count <= available)
     {
-      priv->pos += count;
+      buffer_consume (priv, count);
       data->bytes_skipped = count;
 
       g_simple_async_result_complete_in_idle (simple);
@@ -1265,8 +1362,7 @@ g_buffered_input_stream_skip_async (GInputStream        *stream,
    * and request refill for more
    */
 
-  priv->pos = 0;
-  priv->end = 0;
+  buffer_reset (priv);
 
   count -= available;
 
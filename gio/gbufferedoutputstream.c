@@ -25,6 +25,7 @@
 #include "goutputstream.h"
 #include "gseekable.h"
 #include "gsimpleasyncresult.h"
+#include "gasynchelper.h"
 #include "string.h"
 #include "gioerror.h"
 #include "glibintl.h"
@@ -713,10 +714,11 @@ g_buffered_output_stream_flush_async (GOutputStream        *stream,
 
   g_simple_async_result_set_op_res_gpointer (res, fdata, free_flush_data);
 
-  g_simple_async_result_run_in_thread (res, 
-                                       flush_buffer_thread, 
-                                       io_priority,
-                                       cancellable);
+  _g_simple_async_result_run_in_thread_pool (res,
+                                             G_IO_SCHEDULER_POOL_DATA,
+                                             flush_buffer_thread,
+                                             io_priority,
+                                             cancellable);
   g_object_unref (res);
 }
 
@@ -755,10 +757,11 @@ g_buffered_output_stream_close_async (GOutputStream        *stream,
 
   g_simple_async_result_set_op_res_gpointer (res, fdata, free_flush_data);
 
-  g_simple_async_result_run_in_thread (res, 
-                                       flush_buffer_thread, 
-                                       io_priority,
-                                       cancellable);
+  _g_simple_async_result_run_in_thread_pool (res,
+                                             G_IO_SCHEDULER_POOL_DATA,
+                                             flush_buffer_thread,
+                                             io_priority,
+                                             cancellable);
   g_object_unref (res);
 }
 
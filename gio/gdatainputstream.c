@@ -636,96 +636,148 @@ scan_for_newline (GDataInputStream *stream,
 {
   GBufferedInputStream *bstream;
   GDataInputStreamPrivate *priv;
-  const char *buffer;
-  gsize start, end, peeked;
-  int i;
-  gssize found_pos;
-  int newline_len;
-  gsize available, checked;
+  const char *buffer, *lf, *cr;
+  gsize start, peeked;
+  gsize available, i;
   gboolean last_saw_cr;
 
   priv = stream->priv;
   
   bstream = G_BUFFERED_INPUT_STREAM (stream);
 
-  checked = *checked_out;
+  start = *checked_out;
   last_saw_cr = *last_saw_cr_out;
-  found_pos = -1;
-  newline_len = 0;
   
-  start = checked;
   buffer = (const char*)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  peeked = available - start;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  if (peeked == 0)
+    return -1;
+
+  /* Lines can be long, so let memchr() do the scanning */
+  switch (priv->newline_type)
     {
-      switch (priv->newline_type)
+    case G_DATA_STREAM_NEWLINE_TYPE_LF:
+      lf = memchr (buffer, 10, peeked);
+      if (lf)
 	{
-	case G_DATA_STREAM_NEWLINE_TYPE_LF:
-	  if (buffer[i] == 10)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR:
-	  if (buffer[i] == 13)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
-	  if (last_saw_cr && buffer[i] == 10)
-	    {
-	      found_pos = start + i - 1;
-	      newline_len = 2;
-	    }
-	  break;
-	default:
-	case G_DATA_STREAM_NEWLINE_TYPE_ANY:
-	  if (buffer[i] == 10) /* LF */
+	  *newline_len_out = 1;
+	  return start + (lf - buffer);
+	}
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR:
+      cr = memchr (buffer, 13, peeked);
+      if (cr)
+	{
+	  *newline_len_out = 1;
+	  return start + (cr - buffer);
+	}
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
+      if (last_saw_cr && buffer[0] == 10)
+	{
+	  *newline_len_out = 2;
+	  return start - 1;
+	}
+
+      for (lf = buffer; (lf = memchr (lf, 10, peeked - (lf - buffer))) != NULL; lf++)
+	{
+	  i = lf - buffer;
+	  if (i > 0 && buffer[i - 1] == 13)
 	    {
-	      if (last_saw_cr)
-		{
-		  /* CR LF */
-		  found_pos = start + i - 1;
-		  newline_len = 2;
-		}
-	      else
-		{
-		  /* LF */
-		  found_pos = start + i;
-		  newline_len = 1;
-		}
+	      *newline_len_out = 2;
+	      return start + i - 1;
 	    }
-	  else if (last_saw_cr)
+	}
+      break;
+
+    default:
+    case G_DATA_STREAM_NEWLINE_TYPE_ANY:
+      /* A CR at the end of the last chunk ends the line, together
+       * with a following LF if there is one */
+      if (last_saw_cr)
+	{
+	  *newline_len_out = buffer[0] == 10 ? 2 : 1;
+	  return start - 1;
+	}
+
+      lf = memchr (buffer, 10, peeked);
+      cr = memchr (buffer, 13, lf ? (gsize) (lf - buffer) : peeked);
+
+      if (cr == NULL && lf != NULL)
+	{
+	  *newline_len_out = 1;
+	  return start + (lf - buffer);
+	}
+      else if (cr != NULL)
+	{
+	  i = cr - buffer;
+	  if (i + 1 < peeked)
 	    {
-	      /* Last was cr, this is not LF, end is CR */
-	      found_pos = start + i - 1;
-	      newline_len = 1;
+	      *newline_len_out = buffer[i + 1] == 10 ? 2 : 1;
+	      return start + i;
 	    }
-	  /* Don't check for CR here, instead look at last_saw_cr on next byte */
-	  break;
+	  /* Whether it is CR or CR LF depends on the next chunk */
 	}
-	
-      last_saw_cr = (buffer[i] == 13);
+      break;
+    }
+
+  *checked_out = available;
+  *last_saw_cr_out = buffer[peeked - 1] == 13;
+  return -1;
+}
+
+/* Fills the buffer until it holds a whole line, and returns its
+ * length and that of its newline, or -1 at the end of the stream or
+ * on error. */
+static gssize
+fill_line (GDataInputStream  *stream,
+	   int               *newline_len_out,
+	   GCancellable      *cancellable,
+	   GError           **error)
+{
+  GBufferedInputStream *bstream;
+  gsize checked;
+  gboolean last_saw_cr;
+  gssize found_pos;
+  gssize res;
+  int newline_len;
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
 
-      if (found_pos != -1)
+  newline_len = 0;
+  checked = 0;
+  last_saw_cr = FALSE;
+
+  while ((found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len)) == -1)
+    {
+      if (g_buffered_input_stream_get_available (bstream) ==
+	  g_buffered_input_stream_get_buffer_size (bstream))
+	g_buffered_input_stream_set_buffer_size (bstream,
+						 2 * g_buffered_input_stream_get_buffer_size (bstream));
+
+      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
+      if (res < 0)
+	return -1;
+      if (res == 0)
 	{
-	  *newline_len_out = newline_len;
-	  return found_pos;
+	  /* End of stream */
+	  if (g_buffered_input_stream_get_available (bstream) == 0)
+	    return -1;
+	  else
+	    {
+	      found_pos = checked;
+	      newline_len = 0;
+	      break;
+	    }
 	}
     }
 
-  checked = end;
-
-  *checked_out = checked;
-  *last_saw_cr_out = last_saw_cr;
-  return -1;
+  *newline_len_out = newline_len;
+  return found_pos;
 }
-		  
 
 /**
  * g_data_input_stream_read_line:
@@ -755,9 +807,6 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
 			       GCancellable      *cancellable,
 			       GError           **error)
 {
-  GBufferedInputStream *bstream;
-  gsize checked;
-  gboolean last_saw_cr;
   gssize found_pos;
   gssize res;
   int newline_len;
@@ -765,38 +814,12 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   
   g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);  
 
-  bstream = G_BUFFERED_INPUT_STREAM (stream);
-
-  newline_len = 0;
-  checked = 0;
-  last_saw_cr = FALSE;
-
-  while ((found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len)) == -1)
+  found_pos = fill_line (stream, &newline_len, cancellable, error);
+  if (found_pos < 0)
     {
-      if (g_buffered_input_stream_get_available (bstream) ==
-	  g_buffered_input_stream_get_buffer_size (bstream))
-	g_buffered_input_stream_set_buffer_size (bstream,
-						 2 * g_buffered_input_stream_get_buffer_size (bstream));
-
-      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
-      if (res < 0)
-	return NULL;
-      if (res == 0)
-	{
-	  /* End of stream */
-	  if (g_buffered_input_stream_get_available (bstream) == 0)
-	    {
-	      if (length)
-		*length = 0;
-	      return NULL;
-	    }
-	  else
-	    {
-	      found_pos = checked;
-	      newline_len = 0;
-	      break;
-	    }
-	}
+      if (length)
+	*length = 0;
+      return NULL;
     }
 
   line = g_malloc (found_pos + newline_len + 1);
@@ -813,6 +836,59 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   return line;
 }
 
+/**
+ * g_data_input_stream_read_line_in_place:
+ * @stream: a given #GDataInputStream.
+ * @length: (out): a #gsize to get the length of the line read in.
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore.
+ * @error: #GError for error reporting.
+ *
+ * Reads a line from the data input stream like
+ * g_data_input_stream_read_line(), but instead of copying it, returns
+ * a pointer to the line in the buffer of @stream.  The line is not
+ * NUL terminated, and is only valid until the next operation on
+ * @stream.
+ *
+ * Returns: (transfer none) (array length=length) (element-type guint8):
+ *  the line that was read in (without the newlines), or %NULL on
+ *  error or if there's no content to read, in which case @error is
+ *  only set for the former.
+ *
+ * Since: 2.34
+ **/
+const char *
+g_data_input_stream_read_line_in_place (GDataInputStream  *stream,
+					gsize             *length,
+					GCancellable      *cancellable,
+					GError           **error)
+{
+  gssize found_pos;
+  gssize res;
+  int newline_len;
+  const char *line;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  found_pos = fill_line (stream, &newline_len, cancellable, error);
+  if (found_pos < 0)
+    {
+      *length = 0;
+      return NULL;
+    }
+
+  line = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (stream), NULL);
+
+  /* Skipping buffered data just moves past it */
+  res = g_input_stream_skip (G_INPUT_STREAM (stream),
+			     found_pos + newline_len,
+			     NULL, NULL);
+  g_warn_if_fail (res == found_pos + newline_len);
+  *length = (gsize)found_pos;
+
+  return line;
+}
+
 /**
  * g_data_input_stream_read_line_utf8:
  * @stream: a given #GDataInputStream.
@@ -865,35 +941,38 @@ scan_for_chars (GDataInputStream *stream,
                 gssize            stop_chars_len)
 {
   GBufferedInputStream *bstream;
-  const char *buffer;
-  gsize start, end, peeked;
-  int i;
-  gsize available, checked;
-  const char *stop_char;
-  const char *stop_end;
+  const guchar *buffer, *p;
+  gsize start, peeked;
+  gsize available;
+  gboolean is_stop_char[256];
+  gssize i;
 
   bstream = G_BUFFERED_INPUT_STREAM (stream);
-  stop_end = stop_chars + stop_chars_len;
-
-  checked = *checked_out;
 
-  start = checked;
-  buffer = (const char *)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  start = *checked_out;
+  buffer = (const guchar *)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
+  peeked = available - start;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  if (stop_chars_len == 1)
     {
-      for (stop_char = stop_chars; stop_char != stop_end; stop_char++)
+      p = memchr (buffer, stop_chars[0], peeked);
+      if (p)
+	return start + (p - buffer);
+    }
+  else if (peeked > 0)
+    {
+      memset (is_stop_char, 0, sizeof (is_stop_char));
+      for (i = 0; i < stop_chars_len; i++)
+	is_stop_char[(guchar) stop_chars[i]] = TRUE;
+
+      for (p = buffer; p < buffer + peeked; p++)
 	{
-	  if (buffer[i] == *stop_char)
-	    return (start + i);
+	  if (is_stop_char[*p])
+	    return start + (p - buffer);
 	}
     }
 
-  checked = end;
-
-  *checked_out = checked;
+  *checked_out = available;
   return -1;
 }
 
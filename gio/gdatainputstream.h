@@ -106,6 +106,11 @@ char *                 g_data_input_stream_read_line_utf8       (GDataInputStrea
 								 gsize                   *length,
 								 GCancellable            *cancellable,
 								 GError                 **error);
+GLIB_AVAILABLE_IN_2_34
+const char *           g_data_input_stream_read_line_in_place   (GDataInputStream        *stream,
+                                                                 gsize                   *length,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
 void                   g_data_input_stream_read_line_async      (GDataInputStream        *stream,
                                                                  gint                     io_priority,
                                                                  GCancellable            *cancellable,
@@ -37,6 +37,7 @@
 #include "gfile.h"
 #include "gvfs.h"
 #include "gioscheduler.h"
+#include "gasynchelper.h"
 #include "gsimpleasyncresult.h"
 #include "gfileattribute-priv.h"
 #include "gfiledescriptorbased.h"
@@ -5836,7 +5837,9 @@ g_file_real_copy_async (GFile                  *source,
   res = g_simple_async_result_new (G_OBJECT (source), callback, user_data, g_file_real_copy_async);
   g_simple_async_result_set_op_res_gpointer (res, data, (GDestroyNotify)copy_async_data_free);
 
-  g_io_scheduler_push_job (copy_async_thread, res, g_object_unref, io_priority, cancellable);
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA,
+                                   copy_async_thread, res, g_object_unref,
+                                   io_priority, cancellable);
 }
 
 static gboolean
@@ -7252,3 +7255,624 @@ g_file_supports_thread_contexts (GFile *file)
  iface = G_FILE_GET_IFACE (file);
  return iface->supports_thread_contexts;
 }
+
+/* Recursive walks
+ *
+ * Directories are enumerated by jobs in the metadata pool of the I/O
+ * scheduler, at most max_workers of them at a time per walk. Each job
+ * takes directories from the pending queue until it is empty and
+ * queues the children it finds in batches. The consumer (the thread
+ * calling g_file_walk(), or the main context of g_file_walk_async())
+ * hands the batches to the caller and queues the subdirectories that
+ * pass the filter and have not been seen before.
+ */
+
+#define WALK_BATCH_SIZE 256
+#define WALK_MAX_QUEUED_BATCHES 64
+#define WALK_DEFAULT_MAX_THREADS 4
+
+typedef struct {
+  GFile *directory;
+  GList *infos;
+} WalkBatch;
+
+typedef struct {
+  volatile gint ref_count;
+
+  GFile *root;
+  char *attributes;
+  GFileQueryInfoFlags flags;
+  int io_priority;
+  GCancellable *cancellable;
+  GFileWalkFilterFunc filter_func;
+  GFileWalkFunc walk_func;
+  gpointer walk_data;
+
+  /* Only used by the consumer */
+  GHashTable *visited;
+  GMainContext *context;
+  GSimpleAsyncResult *simple;
+  gboolean completed;
+
+  GMutex lock;
+  GCond cond;
+  GQueue pending;
+  GQueue batches;
+  guint n_workers;
+  guint max_workers;
+  gboolean stopped;
+  gboolean wakeup_pending;
+  char *root_id;
+  GError *error;
+} Walker;
+
+static void
+walk_batch_free (WalkBatch *batch)
+{
+  g_object_unref (batch->directory);
+  g_list_free_full (batch->infos, g_object_unref);
+  g_slice_free (WalkBatch, batch);
+}
+
+static Walker *
+walker_new (GFile               *file,
+            const char          *attributes,
+            GFileQueryInfoFlags  flags,
+            guint                max_threads,
+            int                  io_priority,
+            GCancellable        *cancellable,
+            GFileWalkFilterFunc  filter_func,
+            GFileWalkFunc        walk_func,
+            gpointer             walk_data)
+{
+  Walker *walker;
+
+  walker = g_slice_new0 (Walker);
+  walker->ref_count = 1;
+  walker->root = g_object_ref (file);
+  /* The walk itself needs names, types and file ids */
+  walker->attributes = g_strconcat (attributes, ","
+                                    G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                    G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                    G_FILE_ATTRIBUTE_ID_FILE, NULL);
+  walker->flags = flags;
+  walker->io_priority = io_priority;
+  if (cancellable)
+    walker->cancellable = g_object_ref (cancellable);
+  walker->filter_func = filter_func;
+  walker->walk_func = walk_func;
+  walker->walk_data = walk_data;
+  walker->max_workers = max_threads > 0 ? max_threads : WALK_DEFAULT_MAX_THREADS;
+  walker->visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_mutex_init (&walker->lock);
+  g_cond_init (&walker->cond);
+  g_queue_init (&walker->pending);
+  g_queue_init (&walker->batches);
+  g_queue_push_tail (&walker->pending, g_object_ref (file));
+
+  return walker;
+}
+
+static Walker *
+walker_ref (Walker *walker)
+{
+  g_atomic_int_inc (&walker->ref_count);
+  return walker;
+}
+
+static void
+walker_unref (gpointer data)
+{
+  Walker *walker = data;
+
+  if (!g_atomic_int_dec_and_test (&walker->ref_count))
+    return;
+
+  g_object_unref (walker->root);
+  g_free (walker->attributes);
+  if (walker->cancellable)
+    g_object_unref (walker->cancellable);
+  g_hash_table_unref (walker->visited);
+  if (walker->context)
+    g_main_context_unref (walker->context);
+  if (walker->simple)
+    g_object_unref (walker->simple);
+  g_mutex_clear (&walker->lock);
+  g_cond_clear (&walker->cond);
+  g_queue_foreach (&walker->pending, (GFunc) g_object_unref, NULL);
+  g_queue_clear (&walker->pending);
+  g_queue_foreach (&walker->batches, (GFunc) walk_batch_free, NULL);
+  g_queue_clear (&walker->batches);
+  g_free (walker->root_id);
+  if (walker->error)
+    g_error_free (walker->error);
+  g_slice_free (Walker, walker);
+}
+
+static gboolean walk_dispatch_cb (gpointer user_data);
+
+/* Tells the consumer that something changed */
+static void
+walker_wakeup (Walker *walker)
+{
+  gboolean wakeup;
+
+  g_mutex_lock (&walker->lock);
+  g_cond_broadcast (&walker->cond);
+  wakeup = walker->context != NULL && !walker->wakeup_pending;
+  walker->wakeup_pending = TRUE;
+  g_mutex_unlock (&walker->lock);
+
+  if (wakeup)
+    _g_io_scheduler_invoke_in_context (walker->context, walk_dispatch_cb,
+                                       walker_ref (walker), walker_unref);
+}
+
+/* Called with the lock held */
+static void
+walker_stop (Walker *walker,
+             GError *error)
+{
+  GFile *directory;
+
+  if (error)
+    {
+      if (walker->error == NULL && !walker->stopped)
+        walker->error = error;
+      else
+        g_error_free (error);
+    }
+
+  walker->stopped = TRUE;
+  while ((directory = g_queue_pop_head (&walker->pending)) != NULL)
+    g_object_unref (directory);
+  g_cond_broadcast (&walker->cond);
+}
+
+/* Hands a batch to the consumer, waiting for it to catch up if it
+ * has fallen too far behind. Returns %FALSE if the walk was stopped. */
+static gboolean
+walk_push_batch (Walker *walker,
+                 GFile  *directory,
+                 GList  *infos)
+{
+  WalkBatch *batch;
+
+  batch = g_slice_new (WalkBatch);
+  batch->directory = g_object_ref (directory);
+  batch->infos = infos;
+
+  g_mutex_lock (&walker->lock);
+  while (!walker->stopped &&
+         walker->batches.length >= WALK_MAX_QUEUED_BATCHES)
+    g_cond_wait (&walker->cond, &walker->lock);
+
+  if (walker->stopped)
+    {
+      g_mutex_unlock (&walker->lock);
+      walk_batch_free (batch);
+      return FALSE;
+    }
+
+  g_queue_push_tail (&walker->batches, batch);
+  g_mutex_unlock (&walker->lock);
+
+  walker_wakeup (walker);
+
+  return TRUE;
+}
+
+static void
+walk_directory (Walker *walker,
+                GFile  *directory)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GList *infos;
+  guint n_infos;
+  GError *error = NULL;
+
+  if (directory == walker->root)
+    {
+      /* So that a link back to the root is not walked again */
+      info = g_file_query_info (directory, G_FILE_ATTRIBUTE_ID_FILE,
+                                walker->flags, walker->cancellable, NULL);
+      if (info)
+        {
+          g_mutex_lock (&walker->lock);
+          walker->root_id = g_strdup (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILE));
+          g_mutex_unlock (&walker->lock);
+          g_object_unref (info);
+        }
+    }
+
+  enumerator = g_file_enumerate_children (directory, walker->attributes,
+                                          walker->flags, walker->cancellable,
+                                          &error);
+  if (enumerator == NULL)
+    goto out;
+
+  infos = NULL;
+  n_infos = 0;
+  while ((info = g_file_enumerator_next_file (enumerator, walker->cancellable, &error)) != NULL)
+    {
+      infos = g_list_prepend (infos, info);
+
+      if (++n_infos == WALK_BATCH_SIZE)
+        {
+          if (!walk_push_batch (walker, directory, g_list_reverse (infos)))
+            break;
+          infos = NULL;
+          n_infos = 0;
+        }
+    }
+
+  if (info == NULL && infos != NULL)
+    walk_push_batch (walker, directory, g_list_reverse (infos));
+
+  g_file_enumerator_close (enumerator, NULL, NULL);
+  g_object_unref (enumerator);
+
+ out:
+  if (error)
+    {
+      /* Unreadable subdirectories are skipped; failing to read the
+       * root or being cancelled ends the walk. */
+      if (directory == walker->root ||
+          g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_mutex_lock (&walker->lock);
+          walker_stop (walker, error);
+          g_mutex_unlock (&walker->lock);
+        }
+      else
+        g_error_free (error);
+    }
+}
+
+static gboolean
+walk_job (GIOSchedulerJob *job,
+          GCancellable    *cancellable,
+          gpointer         user_data)
+{
+  Walker *walker = user_data;
+  GFile *directory;
+
+  g_mutex_lock (&walker->lock);
+  while (!walker->stopped &&
+         (directory = g_queue_pop_head (&walker->pending)) != NULL)
+    {
+      g_mutex_unlock (&walker->lock);
+      walk_directory (walker, directory);
+      g_object_unref (directory);
+      g_mutex_lock (&walker->lock);
+    }
+  walker->n_workers--;
+  g_mutex_unlock (&walker->lock);
+
+  walker_wakeup (walker);
+
+  return FALSE;
+}
+
+/* Called with the lock held */
+static void
+walker_schedule (Walker *walker)
+{
+  guint n_new;
+
+  if (walker->stopped)
+    return;
+
+  n_new = MIN (walker->max_workers - walker->n_workers,
+               walker->pending.length);
+  while (n_new-- > 0)
+    {
+      walker->n_workers++;
+      g_io_scheduler_push_job (walk_job, walker_ref (walker), walker_unref,
+                               walker->io_priority, walker->cancellable);
+    }
+}
+
+static void
+walk_batch (Walker    *walker,
+            WalkBatch *batch)
+{
+  GFileInfo *info;
+  GQueue children = G_QUEUE_INIT;
+  const char *id;
+  GList *l;
+
+  if (!walker->walk_func (batch->directory, batch->infos, walker->walk_data))
+    {
+      g_mutex_lock (&walker->lock);
+      walker_stop (walker, NULL);
+      g_mutex_unlock (&walker->lock);
+      return;
+    }
+
+  for (l = batch->infos; l != NULL; l = l->next)
+    {
+      info = l->data;
+
+      if (g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
+        continue;
+
+      if (walker->filter_func &&
+          !walker->filter_func (batch->directory, info, walker->walk_data))
+        continue;
+
+      id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILE);
+      if (id)
+        {
+          if (g_hash_table_contains (walker->visited, id))
+            continue;
+          g_hash_table_add (walker->visited, g_strdup (id));
+        }
+
+      g_queue_push_tail (&children,
+                         g_file_get_child (batch->directory,
+                                           g_file_info_get_name (info)));
+    }
+
+  g_mutex_lock (&walker->lock);
+  if (walker->stopped)
+    g_queue_foreach (&children, (GFunc) g_object_unref, NULL);
+  else
+    {
+      while (children.length > 0)
+        g_queue_push_tail (&walker->pending, g_queue_pop_head (&children));
+      walker_schedule (walker);
+    }
+  g_mutex_unlock (&walker->lock);
+  g_queue_clear (&children);
+}
+
+/* Hands all queued batches to the caller. Returns %TRUE, once, when
+ * the walk is over. */
+static gboolean
+walk_process (Walker *walker)
+{
+  WalkBatch *batch;
+  gboolean done;
+
+  g_mutex_lock (&walker->lock);
+  walker->wakeup_pending = FALSE;
+
+  while (TRUE)
+    {
+      if (walker->root_id)
+        {
+          g_hash_table_add (walker->visited, walker->root_id);
+          walker->root_id = NULL;
+        }
+
+      if (walker->stopped)
+        break;
+
+      batch = g_queue_pop_head (&walker->batches);
+      if (batch == NULL)
+        break;
+
+      g_cond_broadcast (&walker->cond);
+      g_mutex_unlock (&walker->lock);
+
+      walk_batch (walker, batch);
+      walk_batch_free (batch);
+
+      g_mutex_lock (&walker->lock);
+    }
+
+  done = !walker->completed && walker->n_workers == 0;
+  if (done)
+    walker->completed = TRUE;
+  g_mutex_unlock (&walker->lock);
+
+  return done;
+}
+
+/**
+ * g_file_walk:
+ * @file: input #GFile, a directory
+ * @attributes: an attribute query string
+ * @flags: a set of #GFileQueryInfoFlags
+ * @max_threads: the maximum number of directories to read at the
+ *     same time, or 0 for a default
+ * @cancellable: (allow-none): optional #GCancellable object,
+ *     %NULL to ignore
+ * @filter_func: (allow-none) (scope call): a #GFileWalkFilterFunc to
+ *     prune the walk, or %NULL to walk all subdirectories
+ * @walk_func: (scope call): a #GFileWalkFunc to call for each batch
+ *     of children
+ * @walk_data: (closure): user data for @filter_func and @walk_func
+ * @error: a #GError, or %NULL
+ *
+ * Walks the directory hierarchy below @file, reading up to
+ * @max_threads directories at a time in I/O threads, and calls
+ * @walk_func with the #GFileInfo<!-- -->s of their children in batches.
+ * The infos contain the attributes matching @attributes (see
+ * g_file_enumerate_children()), and always the name, type and file id.
+ *
+ * Batches of different directories arrive in no particular order, but
+ * a directory is always reported after its parent. The walk descends
+ * into every subdirectory for which @filter_func returns %TRUE, and
+ * into each directory only once, as identified by its
+ * %G_FILE_ATTRIBUTE_ID_FILE; this keeps symbolic link loops from being
+ * followed when @flags does not contain
+ * %G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS.
+ *
+ * @filter_func and @walk_func are called in the thread calling this
+ * function. The walk stops when @walk_func returns %FALSE.
+ * Subdirectories that cannot be read are skipped.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by
+ * triggering the cancellable object from another thread. If the operation
+ * was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * Returns: %TRUE if the walk finished or was stopped by @walk_func,
+ *     %FALSE if @file could not be read or the walk was cancelled.
+ *
+ * Since: 2.34
+ **/
+gboolean
+g_file_walk (GFile                *file,
+             const char           *attributes,
+             GFileQueryInfoFlags   flags,
+             guint                 max_threads,
+             GCancellable         *cancellable,
+             GFileWalkFilterFunc   filter_func,
+             GFileWalkFunc         walk_func,
+             gpointer              walk_data,
+             GError              **error)
+{
+  Walker *walker;
+  gboolean res;
+
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (attributes != NULL, FALSE);
+  g_return_val_if_fail (walk_func != NULL, FALSE);
+
+  walker = walker_new (file, attributes, flags, max_threads,
+                       G_PRIORITY_DEFAULT, cancellable,
+                       filter_func, walk_func, walk_data);
+
+  g_mutex_lock (&walker->lock);
+  walker_schedule (walker);
+  g_mutex_unlock (&walker->lock);
+
+  while (!walk_process (walker))
+    {
+      g_mutex_lock (&walker->lock);
+      while ((walker->stopped || walker->batches.length == 0) &&
+             walker->n_workers > 0)
+        g_cond_wait (&walker->cond, &walker->lock);
+      g_mutex_unlock (&walker->lock);
+    }
+
+  res = walker->error == NULL;
+  if (walker->error)
+    {
+      g_propagate_error (error, walker->error);
+      walker->error = NULL;
+    }
+
+  walker_unref (walker);
+
+  return res;
+}
+
+static gboolean
+walk_dispatch_cb (gpointer user_data)
+{
+  Walker *walker = user_data;
+
+  if (walk_process (walker))
+    {
+      if (walker->error)
+        {
+          g_simple_async_result_take_error (walker->simple, walker->error);
+          walker->error = NULL;
+        }
+      else
+        g_simple_async_result_set_op_res_gboolean (walker->simple, TRUE);
+
+      g_simple_async_result_complete (walker->simple);
+      g_object_unref (walker->simple);
+      walker->simple = NULL;
+    }
+
+  return FALSE;
+}
+
+/**
+ * g_file_walk_async:
+ * @file: input #GFile, a directory
+ * @attributes: an attribute query string
+ * @flags: a set of #GFileQueryInfoFlags
+ * @max_threads: the maximum number of directories to read at the
+ *     same time, or 0 for a default
+ * @io_priority: the <link linkend="io-priority">I/O priority</link>
+ *     of the request
+ * @cancellable: (allow-none): optional #GCancellable object,
+ *     %NULL to ignore
+ * @filter_func: (allow-none) (scope notified): a #GFileWalkFilterFunc
+ *     to prune the walk, or %NULL to walk all subdirectories
+ * @walk_func: (scope notified): a #GFileWalkFunc to call for each
+ *     batch of children
+ * @walk_data: (closure): user data for @filter_func and @walk_func
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *     walk is over
+ * @user_data: (closure): the data to pass to @callback
+ *
+ * Asynchronously walks the directory hierarchy below @file. See
+ * g_file_walk() for details.
+ *
+ * @filter_func and @walk_func are called from the <link
+ * linkend="g-main-context-push-thread-default">thread-default main
+ * context</link> of the calling thread. When the walk is over,
+ * @callback will be called; call g_file_walk_finish() to get the
+ * result of the operation.
+ *
+ * Since: 2.34
+ **/
+void
+g_file_walk_async (GFile                *file,
+                   const char           *attributes,
+                   GFileQueryInfoFlags   flags,
+                   guint                 max_threads,
+                   int                   io_priority,
+                   GCancellable         *cancellable,
+                   GFileWalkFilterFunc   filter_func,
+                   GFileWalkFunc         walk_func,
+                   gpointer              walk_data,
+                   GAsyncReadyCallback   callback,
+                   gpointer              user_data)
+{
+  Walker *walker;
+
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (attributes != NULL);
+  g_return_if_fail (walk_func != NULL);
+
+  walker = walker_new (file, attributes, flags, max_threads,
+                       io_priority, cancellable,
+                       filter_func, walk_func, walk_data);
+  walker->context = g_main_context_ref_thread_default ();
+  walker->simple = g_simple_async_result_new (G_OBJECT (file),
+                                              callback, user_data,
+                                              g_file_walk_async);
+
+  g_mutex_lock (&walker->lock);
+  walker_schedule (walker);
+  g_mutex_unlock (&walker->lock);
+
+  walker_unref (walker);
+}
+
+/**
+ * g_file_walk_finish:
+ * @file: input #GFile
+ * @res: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes a walk started with g_file_walk_async().
+ *
+ * Returns: %TRUE if the walk finished or was stopped by the
+ *     #GFileWalkFunc, %FALSE on error.
+ *
+ * Since: 2.34
+ **/
+gboolean
+g_file_walk_finish (GFile         *file,
+                    GAsyncResult  *res,
+                    GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (g_simple_async_result_is_valid (res, G_OBJECT (file), g_file_walk_async), FALSE);
+
+  if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+    return FALSE;
+
+  return g_simple_async_result_get_op_res_gboolean (G_SIMPLE_ASYNC_RESULT (res));
+}
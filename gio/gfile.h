@@ -1017,6 +1017,33 @@ gboolean g_file_replace_contents_finish      (GFile                  *file,
 
 gboolean g_file_supports_thread_contexts     (GFile                  *file);
 
+GLIB_AVAILABLE_IN_2_34
+gboolean g_file_walk                         (GFile                  *file,
+					      const char             *attributes,
+					      GFileQueryInfoFlags     flags,
+					      guint                   max_threads,
+					      GCancellable           *cancellable,
+					      GFileWalkFilterFunc     filter_func,
+					      GFileWalkFunc           walk_func,
+					      gpointer                walk_data,
+					      GError                **error);
+GLIB_AVAILABLE_IN_2_34
+void     g_file_walk_async                   (GFile                  *file,
+					      const char             *attributes,
+					      GFileQueryInfoFlags     flags,
+					      guint                   max_threads,
+					      int                     io_priority,
+					      GCancellable           *cancellable,
+					      GFileWalkFilterFunc     filter_func,
+					      GFileWalkFunc           walk_func,
+					      gpointer                walk_data,
+					      GAsyncReadyCallback     callback,
+					      gpointer                user_data);
+GLIB_AVAILABLE_IN_2_34
+gboolean g_file_walk_finish                  (GFile                  *file,
+					      GAsyncResult           *res,
+					      GError                **error);
+
 G_END_DECLS
 
 #endif /* __G_FILE_H__ */
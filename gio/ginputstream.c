@@ -31,6 +31,7 @@
 #include "gsimpleasyncresult.h"
 #include "gioerror.h"
 #include "gpollableinputstream.h"
+#include "gasynchelper.h"
 
 /**
  * SECTION:ginputstream
@@ -41,6 +42,8 @@
  * to close a stream (g_input_stream_close()) and to skip some content
  * (g_input_stream_skip()). 
  *
+ * To read into several buffers at once, use g_input_stream_readv().
+ *
  * To copy the content of an input stream to an output stream without 
  * manually handling the reads and writes, use g_output_stream_splice(). 
  *
@@ -59,6 +62,21 @@ static gssize   g_input_stream_real_skip         (GInputStream         *stream,
 						  gsize                 count,
 						  GCancellable         *cancellable,
 						  GError              **error);
+static gssize   g_input_stream_real_readv        (GInputStream         *stream,
+						  GInputVector         *vectors,
+						  gsize                 n_vectors,
+						  GCancellable         *cancellable,
+						  GError              **error);
+static void     g_input_stream_real_readv_async  (GInputStream         *stream,
+						  GInputVector         *vectors,
+						  gsize                 n_vectors,
+						  int                   io_priority,
+						  GCancellable         *cancellable,
+						  GAsyncReadyCallback   callback,
+						  gpointer              user_data);
+static gssize   g_input_stream_real_readv_finish (GInputStream         *stream,
+						  GAsyncResult         *result,
+						  GError              **error);
 static void     g_input_stream_real_read_async   (GInputStream         *stream,
 						  void                 *buffer,
 						  gsize                 count,
@@ -120,6 +138,9 @@ g_input_stream_class_init (GInputStreamClass *klass)
   klass->skip = g_input_stream_real_skip;
   klass->read_async = g_input_stream_real_read_async;
   klass->read_finish = g_input_stream_real_read_finish;
+  klass->readv_fn = g_input_stream_real_readv;
+  klass->readv_async = g_input_stream_real_readv_async;
+  klass->readv_finish = g_input_stream_real_readv_finish;
   klass->skip_async = g_input_stream_real_skip_async;
   klass->skip_finish = g_input_stream_real_skip_finish;
   klass->close_async = g_input_stream_real_close_async;
@@ -273,6 +294,108 @@ g_input_stream_read_all (GInputStream  *stream,
   return TRUE;
 }
 
+static gboolean
+check_vectors_size (const GInputVector  *vectors,
+		    gsize                n_vectors,
+		    gsize               *total,
+		    GError             **error)
+{
+  gsize i;
+
+  *total = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      *total += vectors[i].size;
+      if (((gssize) *total) < 0 || *total < vectors[i].size)
+	{
+	  g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		       _("Too large count value passed to %s"), G_STRFUNC);
+	  return FALSE;
+	}
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_input_stream_readv:
+ * @stream: a #GInputStream.
+ * @vectors: (array length=n_vectors): the buffers to read data into
+ * @n_vectors: the number of elements in @vectors
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore.
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Tries to read data from the stream into the buffers in @vectors,
+ * filling each one completely before moving on to the next, as if
+ * they formed a single buffer passed to g_input_stream_read(). Will
+ * block during this read.
+ *
+ * Streams that can read into several buffers at once (such as file
+ * descriptor based streams) do so with a single system call; others
+ * fall back to reading one buffer at a time.
+ *
+ * If the total size of @vectors is zero returns zero and does nothing.
+ * A total size larger than %G_MAXSSIZE will cause a
+ * %G_IO_ERROR_INVALID_ARGUMENT error.
+ *
+ * On success, the number of bytes read is returned. As with
+ * g_input_stream_read(), this may be less than the total size of
+ * @vectors, and zero is returned on end of file.
+ *
+ * On error -1 is returned and @error is set accordingly.
+ *
+ * Virtual: readv_fn
+ *
+ * Return value: Number of bytes read, or -1 on error, or 0 on end of file.
+ *
+ * Since: 2.34
+ **/
+gssize
+g_input_stream_readv (GInputStream  *stream,
+		      GInputVector  *vectors,
+		      gsize          n_vectors,
+		      GCancellable  *cancellable,
+		      GError       **error)
+{
+  GInputStreamClass *class;
+  gsize total;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+
+  if (!check_vectors_size (vectors, n_vectors, &total, error))
+    return -1;
+
+  if (total == 0)
+    return 0;
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+
+  if (class->readv_fn == g_input_stream_real_readv &&
+      class->read_fn == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Input stream doesn't implement read"));
+      return -1;
+    }
+
+  if (!g_input_stream_set_pending (stream, error))
+    return -1;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = class->readv_fn (stream, vectors, n_vectors, cancellable, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  g_input_stream_clear_pending (stream);
+
+  return res;
+}
+
 /**
  * g_input_stream_skip:
  * @stream: a #GInputStream.
@@ -611,6 +734,121 @@ g_input_stream_read_finish (GInputStream  *stream,
   return class->read_finish (stream, result, error);
 }
 
+/**
+ * g_input_stream_readv_async:
+ * @stream: A #GInputStream.
+ * @vectors: (array length=n_vectors): the buffers to read data into
+ * @n_vectors: the number of elements in @vectors
+ * @io_priority: the <link linkend="io-priority">I/O priority</link>
+ * of the request.
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore.
+ * @callback: (scope async): callback to call when the request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Request an asynchronous read into the buffers in @vectors. When
+ * the operation is finished @callback will be called. You can then
+ * call g_input_stream_readv_finish() to get the result of the
+ * operation.
+ *
+ * This is the asynchronous version of g_input_stream_readv(), and
+ * behaves like g_input_stream_read_async() otherwise. The @vectors
+ * array itself is copied, but the buffers it points to must stay
+ * valid until the operation has finished.
+ *
+ * Since: 2.34
+ **/
+void
+g_input_stream_readv_async (GInputStream        *stream,
+			    GInputVector        *vectors,
+			    gsize                n_vectors,
+			    int                  io_priority,
+			    GCancellable        *cancellable,
+			    GAsyncReadyCallback  callback,
+			    gpointer             user_data)
+{
+  GInputStreamClass *class;
+  GSimpleAsyncResult *simple;
+  GError *error = NULL;
+  gsize total;
+
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (vectors != NULL || n_vectors == 0);
+
+  if (!check_vectors_size (vectors, n_vectors, &total, &error))
+    {
+      g_simple_async_report_take_gerror_in_idle (G_OBJECT (stream),
+						 callback,
+						 user_data,
+						 error);
+      return;
+    }
+
+  if (total == 0)
+    {
+      simple = g_simple_async_result_new (G_OBJECT (stream),
+					  callback,
+					  user_data,
+					  g_input_stream_readv_async);
+      g_simple_async_result_complete_in_idle (simple);
+      g_object_unref (simple);
+      return;
+    }
+
+  if (!g_input_stream_set_pending (stream, &error))
+    {
+      g_simple_async_report_take_gerror_in_idle (G_OBJECT (stream),
+						 callback,
+						 user_data,
+						 error);
+      return;
+    }
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+  stream->priv->outstanding_callback = callback;
+  g_object_ref (stream);
+  class->readv_async (stream, vectors, n_vectors, io_priority, cancellable,
+		      async_ready_callback_wrapper, user_data);
+}
+
+/**
+ * g_input_stream_readv_finish:
+ * @stream: a #GInputStream.
+ * @result: a #GAsyncResult.
+ * @error: a #GError location to store the error occurring, or %NULL to
+ * ignore.
+ *
+ * Finishes an asynchronous stream readv operation.
+ *
+ * Returns: number of bytes read in, or -1 on error, or 0 on end of file.
+ *
+ * Since: 2.34
+ **/
+gssize
+g_input_stream_readv_finish (GInputStream  *stream,
+			     GAsyncResult  *result,
+			     GError       **error)
+{
+  GSimpleAsyncResult *simple;
+  GInputStreamClass *class;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), -1);
+  g_return_val_if_fail (G_IS_ASYNC_RESULT (result), -1);
+
+  if (G_IS_SIMPLE_ASYNC_RESULT (result))
+    {
+      simple = G_SIMPLE_ASYNC_RESULT (result);
+      if (g_simple_async_result_propagate_error (simple, error))
+	return -1;
+
+      /* Special case read of 0 bytes */
+      if (g_simple_async_result_get_source_tag (simple) == g_input_stream_readv_async)
+	return 0;
+    }
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+  return class->readv_finish (stream, result, error);
+}
+
 /**
  * g_input_stream_skip_async:
  * @stream: A #GInputStream.
@@ -1030,7 +1268,9 @@ g_input_stream_real_read_async (GInputStream        *stream,
       g_pollable_input_stream_can_poll (G_POLLABLE_INPUT_STREAM (stream)))
     read_async_pollable (G_POLLABLE_INPUT_STREAM (stream), res);
   else
-    g_simple_async_result_run_in_thread (res, read_async_thread, io_priority, cancellable);
+    _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                               read_async_thread, io_priority,
+                                               cancellable);
   g_object_unref (res);
 }
 
@@ -1050,6 +1290,189 @@ g_input_stream_real_read_finish (GInputStream  *stream,
   return op->count_read;
 }
 
+static gssize
+g_input_stream_real_readv (GInputStream  *stream,
+			   GInputVector  *vectors,
+			   gsize          n_vectors,
+			   GCancellable  *cancellable,
+			   GError       **error)
+{
+  GInputStreamClass *class;
+  gboolean pollable;
+  gsize bytes_read;
+  gssize res;
+  gsize i;
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+  pollable = G_IS_POLLABLE_INPUT_STREAM (stream) &&
+    g_pollable_input_stream_can_poll (G_POLLABLE_INPUT_STREAM (stream));
+
+  bytes_read = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size == 0)
+	continue;
+
+      /* Don't block for more once we have something to return */
+      if (bytes_read > 0 && pollable &&
+	  !g_pollable_input_stream_is_readable (G_POLLABLE_INPUT_STREAM (stream)))
+	break;
+
+      /* Ignore errors once some data has been read */
+      res = class->read_fn (stream, vectors[i].buffer, vectors[i].size,
+			    cancellable, bytes_read > 0 ? NULL : error);
+      if (res < 0)
+	return bytes_read > 0 ? (gssize) bytes_read : -1;
+
+      bytes_read += res;
+      if ((gsize) res < vectors[i].size)
+	break;
+    }
+
+  return bytes_read;
+}
+
+typedef struct {
+  GInputVector      *vectors;
+  gsize              n_vectors;
+  gssize             count_read;
+
+  GCancellable      *cancellable;
+  gint               io_priority;
+  gboolean           need_idle;
+} ReadvData;
+
+static void
+readv_data_free (ReadvData *op)
+{
+  g_free (op->vectors);
+  if (op->cancellable)
+    g_object_unref (op->cancellable);
+  g_slice_free (ReadvData, op);
+}
+
+static void
+readv_async_thread (GSimpleAsyncResult *res,
+		    GObject            *object,
+		    GCancellable       *cancellable)
+{
+  ReadvData *op;
+  GInputStreamClass *class;
+  GError *error = NULL;
+
+  op = g_simple_async_result_get_op_res_gpointer (res);
+
+  class = G_INPUT_STREAM_GET_CLASS (object);
+
+  op->count_read = class->readv_fn (G_INPUT_STREAM (object),
+				    op->vectors, op->n_vectors,
+				    cancellable, &error);
+  if (op->count_read == -1)
+    g_simple_async_result_take_error (res, error);
+}
+
+static void readv_async_pollable (GPollableInputStream *stream,
+				  GSimpleAsyncResult   *result);
+
+static gboolean
+readv_async_pollable_ready (GPollableInputStream *stream,
+			    gpointer              user_data)
+{
+  GSimpleAsyncResult *result = user_data;
+
+  readv_async_pollable (stream, result);
+  return FALSE;
+}
+
+static void
+readv_async_pollable (GPollableInputStream *stream,
+		      GSimpleAsyncResult   *result)
+{
+  GError *error = NULL;
+  ReadvData *op = g_simple_async_result_get_op_res_gpointer (result);
+
+  if (g_cancellable_set_error_if_cancelled (op->cancellable, &error))
+    op->count_read = -1;
+  else
+    {
+      op->count_read = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream)->
+	readv_nonblocking (stream, op->vectors, op->n_vectors, &error);
+    }
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+      GSource *source;
+
+      g_error_free (error);
+      op->need_idle = FALSE;
+
+      source = g_pollable_input_stream_create_source (stream, op->cancellable);
+      g_source_set_callback (source,
+			     (GSourceFunc) readv_async_pollable_ready,
+			     g_object_ref (result), g_object_unref);
+      g_source_set_priority (source, op->io_priority);
+      g_source_attach (source, g_main_context_get_thread_default ());
+      g_source_unref (source);
+      return;
+    }
+
+  if (op->count_read == -1)
+    g_simple_async_result_take_error (result, error);
+
+  if (op->need_idle)
+    g_simple_async_result_complete_in_idle (result);
+  else
+    g_simple_async_result_complete (result);
+}
+
+static void
+g_input_stream_real_readv_async (GInputStream        *stream,
+				 GInputVector        *vectors,
+				 gsize                n_vectors,
+				 int                  io_priority,
+				 GCancellable        *cancellable,
+				 GAsyncReadyCallback  callback,
+				 gpointer             user_data)
+{
+  GSimpleAsyncResult *res;
+  ReadvData *op;
+
+  op = g_slice_new0 (ReadvData);
+  res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				   g_input_stream_real_readv_async);
+  g_simple_async_result_set_op_res_gpointer (res, op, (GDestroyNotify) readv_data_free);
+  op->vectors = g_memdup (vectors, n_vectors * sizeof (GInputVector));
+  op->n_vectors = n_vectors;
+  op->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  op->io_priority = io_priority;
+  op->need_idle = TRUE;
+
+  if (G_IS_POLLABLE_INPUT_STREAM (stream) &&
+      g_pollable_input_stream_can_poll (G_POLLABLE_INPUT_STREAM (stream)))
+    readv_async_pollable (G_POLLABLE_INPUT_STREAM (stream), res);
+  else
+    _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                               readv_async_thread, io_priority,
+                                               cancellable);
+  g_object_unref (res);
+}
+
+static gssize
+g_input_stream_real_readv_finish (GInputStream  *stream,
+				  GAsyncResult  *result,
+				  GError       **error)
+{
+  GSimpleAsyncResult *simple = G_SIMPLE_ASYNC_RESULT (result);
+  ReadvData *op;
+
+  g_warn_if_fail (g_simple_async_result_get_source_tag (simple) ==
+		  g_input_stream_real_readv_async);
+
+  op = g_simple_async_result_get_op_res_gpointer (simple);
+
+  return op->count_read;
+}
+
 typedef struct {
   gsize count_requested;
   gssize count_skipped;
@@ -1166,7 +1589,9 @@ g_input_stream_real_skip_async (GInputStream        *stream,
 
       op->count_requested = count;
 
-      g_simple_async_result_run_in_thread (res, skip_async_thread, io_priority, cancellable);
+      _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                                 skip_async_thread, io_priority,
+                                                 cancellable);
       g_object_unref (res);
     }
   else
@@ -102,11 +102,25 @@ struct _GInputStreamClass
                              GAsyncResult        *result,
                              GError             **error);
 
+  /* Vectored reads: (optional in derived classes) */
+  gssize   (* readv_fn)     (GInputStream        *stream,
+                             GInputVector        *vectors,
+                             gsize                n_vectors,
+                             GCancellable        *cancellable,
+                             GError             **error);
+  void     (* readv_async)  (GInputStream        *stream,
+                             GInputVector        *vectors,
+                             gsize                n_vectors,
+                             int                  io_priority,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data);
+  gssize   (* readv_finish) (GInputStream        *stream,
+                             GAsyncResult        *result,
+                             GError             **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
-  void (*_g_reserved2) (void);
-  void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
   void (*_g_reserved5) (void);
 };
@@ -124,6 +138,12 @@ gboolean g_input_stream_read_all      (GInputStream          *stream,
 				       gsize                 *bytes_read,
 				       GCancellable          *cancellable,
 				       GError               **error);
+GLIB_AVAILABLE_IN_2_34
+gssize   g_input_stream_readv         (GInputStream          *stream,
+				       GInputVector          *vectors,
+				       gsize                  n_vectors,
+				       GCancellable          *cancellable,
+				       GError               **error);
 gssize   g_input_stream_skip          (GInputStream          *stream,
 				       gsize                  count,
 				       GCancellable          *cancellable,
@@ -141,6 +161,18 @@ void     g_input_stream_read_async    (GInputStream          *stream,
 gssize   g_input_stream_read_finish   (GInputStream          *stream,
 				       GAsyncResult          *result,
 				       GError               **error);
+GLIB_AVAILABLE_IN_2_34
+void     g_input_stream_readv_async   (GInputStream          *stream,
+				       GInputVector          *vectors,
+				       gsize                  n_vectors,
+				       int                    io_priority,
+				       GCancellable          *cancellable,
+				       GAsyncReadyCallback    callback,
+				       gpointer               user_data);
+GLIB_AVAILABLE_IN_2_34
+gssize   g_input_stream_readv_finish  (GInputStream          *stream,
+				       GAsyncResult          *result,
+				       GError               **error);
 void     g_input_stream_skip_async    (GInputStream          *stream,
 				       gsize                  count,
 				       int                    io_priority,
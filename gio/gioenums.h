@@ -692,6 +692,9 @@ typedef enum {
  * GResourceFlags:
  * @G_RESOURCE_FLAGS_NONE: No flags set.
  * @G_RESOURCE_FLAGS_COMPRESSED: The file is compressed.
+ * @G_RESOURCE_FLAGS_LZ4: The file is compressed with LZ4 instead of
+ *     zlib. This is always set together with
+ *     %G_RESOURCE_FLAGS_COMPRESSED. Since 2.34
  *
  * GResourceFlags give information about a particular file inside a resource
  * bundle.
@@ -700,7 +703,8 @@ typedef enum {
  **/
 typedef enum {
   G_RESOURCE_FLAGS_NONE       = 0,
-  G_RESOURCE_FLAGS_COMPRESSED = (1<<0)
+  G_RESOURCE_FLAGS_COMPRESSED = (1<<0),
+  G_RESOURCE_FLAGS_LZ4        = (1<<1)
 } GResourceFlags;
 
 /**
@@ -1652,6 +1656,25 @@ typedef enum /*< flags >*/ {
   G_TEST_DBUS_NONE = 0,
 } GTestDBusFlags;
 
+/**
+ * GIOSchedulerPool:
+ * @G_IO_SCHEDULER_POOL_METADATA: The pool for short operations such as
+ *     querying file information, enumerating directories or opening
+ *     files. This is the pool used by g_io_scheduler_push_job().
+ * @G_IO_SCHEDULER_POOL_DATA: The pool for operations that move large
+ *     amounts of data, such as reading, writing, splicing or copying.
+ *
+ * The #GIOScheduler worker pools. Jobs in different pools do not
+ * compete for the same threads, so a long-running copy cannot hold
+ * up the lookups that a user interface is waiting for.
+ *
+ * Since: 2.34
+ */
+typedef enum {
+  G_IO_SCHEDULER_POOL_METADATA,
+  G_IO_SCHEDULER_POOL_DATA
+} GIOSchedulerPool;
+
 G_END_DECLS
 
 #endif /* __GIO_ENUMS_H__ */
@@ -24,6 +24,7 @@
 
 #include "gioscheduler.h"
 #include "gcancellable.h"
+#include "gasynchelper.h"
 
 
 /**
@@ -42,24 +43,46 @@
  * It is recommended to choose priorities between %G_PRIORITY_LOW and 
  * %G_PRIORITY_HIGH, with %G_PRIORITY_DEFAULT as a default.
  * </para>
+ *
+ * Jobs run in one of two worker pools, see #GIOSchedulerPool. Short
+ * metadata operations and bulk data transfers are queued separately,
+ * so that a large copy does not delay the operations that are quick
+ * to answer. g_io_scheduler_get_stats() reports the queue depth of
+ * each pool.
+ *
+ * Callbacks that jobs send back to a main context are delivered
+ * together: results for the same context are queued and dispatched
+ * from a single source, rather than one idle source per callback.
  **/
 
 struct _GIOSchedulerJob {
-  GSList *active_link;
+  GList *active_link;
   GIOSchedulerJobFunc job_func;
-  GSourceFunc cancel_func; /* Runs under job map lock */
   gpointer data;
   GDestroyNotify destroy_notify;
 
   gint io_priority;
   GCancellable *cancellable;
+  gulong cancelled_id;
   GMainContext *context;
+  GIOSchedulerPool pool;
 };
 
+typedef struct {
+  GThreadPool *thread_pool;
+  gint max_threads;
+  gboolean resort_jobs;
+  GIOSchedulerStats stats;
+} IOPool;
+
+/* The active_jobs lock also protects the pool counters and flags */
 G_LOCK_DEFINE_STATIC(active_jobs);
-static GSList *active_jobs = NULL;
+static GList *active_jobs = NULL;
 
-static GThreadPool *job_thread_pool = NULL;
+static IOPool io_pools[] = {
+  { NULL, 10, },        /* G_IO_SCHEDULER_POOL_METADATA */
+  { NULL, 4, }          /* G_IO_SCHEDULER_POOL_DATA */
+};
 
 static void io_job_thread (gpointer data,
 			   gpointer user_data);
@@ -95,59 +118,76 @@ g_io_job_compare (gconstpointer a,
 static gpointer
 init_scheduler (gpointer arg)
 {
-  if (job_thread_pool == NULL)
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (io_pools); i++)
     {
       /* TODO: thread_pool_new can fail */
-      job_thread_pool = g_thread_pool_new (io_job_thread,
-					   NULL,
-					   10,
-					   FALSE,
-					   NULL);
-      if (job_thread_pool != NULL)
-	{
-	  g_thread_pool_set_sort_function (job_thread_pool,
-					   g_io_job_compare,
-					   NULL);
-	  /* It's kinda weird that this is a global setting
-	   * instead of per threadpool. However, we really
-	   * want to cache some threads, but not keep around
-	   * those threads forever. */
-	  g_thread_pool_set_max_idle_time (15 * 1000);
-	  g_thread_pool_set_max_unused_threads (2);
-	}
+      io_pools[i].thread_pool = g_thread_pool_new (io_job_thread,
+                                                   NULL,
+                                                   io_pools[i].max_threads,
+                                                   FALSE,
+                                                   NULL);
+      if (io_pools[i].thread_pool != NULL)
+        g_thread_pool_set_sort_function (io_pools[i].thread_pool,
+                                         g_io_job_compare,
+                                         NULL);
     }
+
+  /* It's kinda weird that this is a global setting
+   * instead of per threadpool. However, we really
+   * want to cache some threads, but not keep around
+   * those threads forever. */
+  g_thread_pool_set_max_idle_time (15 * 1000);
+  g_thread_pool_set_max_unused_threads (2);
+
   return NULL;
 }
 
 static void
-remove_active_job (GIOSchedulerJob *job)
+ensure_scheduler (void)
 {
-  GIOSchedulerJob *other_job;
-  GSList *l;
-  gboolean resort_jobs;
-  
+  static GOnce once_init = G_ONCE_INIT;
+
+  g_once (&once_init, init_scheduler, NULL);
+}
+
+/* Runs in whichever thread cancelled the job. Rather than resorting
+ * the queue for every cancellation, mark the pool and let the next
+ * job to finish do it once, before the pool picks another job. */
+static void
+job_cancelled (GCancellable *cancellable,
+               gpointer      user_data)
+{
+  GIOSchedulerJob *job = user_data;
+
   G_LOCK (active_jobs);
-  active_jobs = g_slist_delete_link (active_jobs, job->active_link);
-  
-  resort_jobs = FALSE;
-  for (l = active_jobs; l != NULL; l = l->next)
+  if (job->io_priority >= 0)
     {
-      other_job = l->data;
-      if (other_job->io_priority >= 0 &&
-	  g_cancellable_is_cancelled (other_job->cancellable))
-	{
-	  other_job->io_priority = -1;
-	  resort_jobs = TRUE;
-	}
+      job->io_priority = -1;
+      io_pools[job->pool].resort_jobs = TRUE;
     }
   G_UNLOCK (active_jobs);
-  
-  if (resort_jobs &&
-      job_thread_pool != NULL)
-    g_thread_pool_set_sort_function (job_thread_pool,
+}
+
+static void
+remove_active_job (GIOSchedulerJob *job)
+{
+  IOPool *pool = &io_pools[job->pool];
+  gboolean resort_jobs;
+
+  G_LOCK (active_jobs);
+  active_jobs = g_list_delete_link (active_jobs, job->active_link);
+  pool->stats.n_running--;
+  pool->stats.n_completed++;
+  resort_jobs = pool->resort_jobs;
+  pool->resort_jobs = FALSE;
+  G_UNLOCK (active_jobs);
+
+  if (resort_jobs)
+    g_thread_pool_set_sort_function (pool->thread_pool,
 				     g_io_job_compare,
 				     NULL);
-
 }
 
 static void
@@ -158,6 +198,7 @@ job_destroy (gpointer data)
   if (job->destroy_notify)
     job->destroy_notify (job->data);
 
+  g_cancellable_disconnect (job->cancellable, job->cancelled_id);
   remove_active_job (job);
   g_io_job_free (job);
 }
@@ -167,8 +208,14 @@ io_job_thread (gpointer data,
 	       gpointer user_data)
 {
   GIOSchedulerJob *job = data;
+  IOPool *pool = &io_pools[job->pool];
   gboolean result;
 
+  G_LOCK (active_jobs);
+  pool->stats.n_queued--;
+  pool->stats.n_running++;
+  G_UNLOCK (active_jobs);
+
   if (job->cancellable)
     g_cancellable_push_current (job->cancellable);
 
@@ -201,6 +248,10 @@ io_job_thread (gpointer data,
  * If @cancellable is not %NULL, it can be used to cancel the I/O job
  * by calling g_cancellable_cancel() or by calling 
  * g_io_scheduler_cancel_all_jobs().
+ *
+ * The job runs in the %G_IO_SCHEDULER_POOL_METADATA pool; use
+ * g_io_scheduler_push_job_to_pool() for jobs that transfer a lot
+ * of data.
  **/
 void
 g_io_scheduler_push_job (GIOSchedulerJobFunc  job_func,
@@ -209,29 +260,122 @@ g_io_scheduler_push_job (GIOSchedulerJobFunc  job_func,
 			 gint                 io_priority,
 			 GCancellable        *cancellable)
 {
-  static GOnce once_init = G_ONCE_INIT;
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_METADATA,
+                                   job_func, user_data, notify,
+                                   io_priority, cancellable);
+}
+
+/**
+ * g_io_scheduler_push_job_to_pool:
+ * @pool: the #GIOSchedulerPool to run the job in
+ * @job_func: a #GIOSchedulerJobFunc.
+ * @user_data: data to pass to @job_func
+ * @notify: (allow-none): a #GDestroyNotify for @user_data, or %NULL
+ * @io_priority: the <link linkend="gioscheduler">I/O priority</link>
+ * of the request.
+ * @cancellable: optional #GCancellable object, %NULL to ignore.
+ *
+ * Like g_io_scheduler_push_job(), but runs the job in @pool.
+ *
+ * Within a pool, jobs are started in order of @io_priority. Cancelling
+ * @cancellable moves a job that has not started yet to the front of
+ * its pool's queue, so that it can finish (and report the
+ * cancellation) promptly.
+ *
+ * Since: 2.34
+ **/
+void
+g_io_scheduler_push_job_to_pool (GIOSchedulerPool     pool,
+                                 GIOSchedulerJobFunc  job_func,
+                                 gpointer             user_data,
+                                 GDestroyNotify       notify,
+                                 gint                 io_priority,
+                                 GCancellable        *cancellable)
+{
   GIOSchedulerJob *job;
+  IOPool *io_pool;
 
+  g_return_if_fail (pool <= G_IO_SCHEDULER_POOL_DATA);
   g_return_if_fail (job_func != NULL);
 
+  ensure_scheduler ();
+  io_pool = &io_pools[pool];
+
   job = g_new0 (GIOSchedulerJob, 1);
   job->job_func = job_func;
   job->data = user_data;
   job->destroy_notify = notify;
   job->io_priority = io_priority;
-    
-  if (cancellable)
-    job->cancellable = g_object_ref (cancellable);
+  job->pool = pool;
 
   job->context = g_main_context_ref_thread_default ();
 
+  if (cancellable)
+    {
+      job->cancellable = g_object_ref (cancellable);
+      if (g_cancellable_is_cancelled (cancellable))
+        job->io_priority = -1;
+      else
+        job->cancelled_id = g_cancellable_connect (cancellable,
+                                                   G_CALLBACK (job_cancelled),
+                                                   job, NULL);
+    }
+
   G_LOCK (active_jobs);
-  active_jobs = g_slist_prepend (active_jobs, job);
+  active_jobs = g_list_prepend (active_jobs, job);
   job->active_link = active_jobs;
+  io_pool->stats.n_queued++;
+  if (io_pool->stats.n_queued > io_pool->stats.max_queued)
+    io_pool->stats.max_queued = io_pool->stats.n_queued;
   G_UNLOCK (active_jobs);
 
-  g_once (&once_init, init_scheduler, NULL);
-  g_thread_pool_push (job_thread_pool, job, NULL);
+  g_thread_pool_push (io_pool->thread_pool, job, NULL);
+}
+
+/**
+ * g_io_scheduler_set_max_threads:
+ * @pool: a #GIOSchedulerPool
+ * @max_threads: the maximum number of worker threads for @pool
+ *
+ * Sets the maximum number of jobs that @pool runs at the same time.
+ * By default the %G_IO_SCHEDULER_POOL_METADATA pool uses up to 10
+ * threads and the %G_IO_SCHEDULER_POOL_DATA pool up to 4.
+ *
+ * Since: 2.34
+ **/
+void
+g_io_scheduler_set_max_threads (GIOSchedulerPool pool,
+                                gint             max_threads)
+{
+  g_return_if_fail (pool <= G_IO_SCHEDULER_POOL_DATA);
+  g_return_if_fail (max_threads > 0);
+
+  ensure_scheduler ();
+  io_pools[pool].max_threads = max_threads;
+  g_thread_pool_set_max_threads (io_pools[pool].thread_pool,
+                                 max_threads, NULL);
+}
+
+/**
+ * g_io_scheduler_get_stats:
+ * @pool: a #GIOSchedulerPool
+ * @stats: (out caller-allocates): return location for the statistics
+ *
+ * Fills in @stats with the current queue depth of @pool and the
+ * number of jobs it has run so far.
+ *
+ * Since: 2.34
+ **/
+void
+g_io_scheduler_get_stats (GIOSchedulerPool   pool,
+                          GIOSchedulerStats *stats)
+{
+  g_return_if_fail (pool <= G_IO_SCHEDULER_POOL_DATA);
+  g_return_if_fail (stats != NULL);
+
+  G_LOCK (active_jobs);
+  *stats = io_pools[pool].stats;
+  G_UNLOCK (active_jobs);
 }
 
 /**
@@ -246,12 +390,13 @@ void
 g_io_scheduler_cancel_all_jobs (void)
 {
   GSList *cancellable_list, *l;
+  GList *j;
   
   G_LOCK (active_jobs);
   cancellable_list = NULL;
-  for (l = active_jobs; l != NULL; l = l->next)
+  for (j = active_jobs; j != NULL; j = j->next)
     {
-      GIOSchedulerJob *job = l->data;
+      GIOSchedulerJob *job = j->data;
       if (job->cancellable)
 	cancellable_list = g_slist_prepend (cancellable_list,
 					    g_object_ref (job->cancellable));
@@ -304,6 +449,190 @@ mainloop_proxy_free (MainLoopProxy *proxy)
   g_free (proxy);
 }
 
+/* Results for a given main context are collected in a single source
+ * instead of attaching an idle source per callback. Worker threads
+ * append to the queue and wake the context; one dispatch then runs
+ * everything that has arrived since the last iteration. The source
+ * removes itself once the queue has drained.
+ */
+typedef struct {
+  GSource       source;
+  GMainContext *context;
+  GQueue        pending;    /* of CompletionItem, under completions lock */
+} CompletionSource;
+
+typedef struct {
+  GSourceFunc    func;
+  gpointer       data;
+  GDestroyNotify notify;
+} CompletionItem;
+
+G_LOCK_DEFINE_STATIC(completions);
+static GHashTable *completion_sources = NULL;
+
+static gboolean
+completion_source_ready (GSource *source)
+{
+  CompletionSource *completion_source = (CompletionSource *)source;
+  gboolean ready;
+
+  G_LOCK (completions);
+  ready = !g_queue_is_empty (&completion_source->pending);
+  G_UNLOCK (completions);
+
+  return ready;
+}
+
+static gboolean
+completion_source_prepare (GSource *source,
+                           gint    *timeout)
+{
+  *timeout = -1;
+  return completion_source_ready (source);
+}
+
+static gboolean
+completion_source_check (GSource *source)
+{
+  return completion_source_ready (source);
+}
+
+static gboolean
+completion_source_dispatch (GSource     *source,
+                            GSourceFunc  callback,
+                            gpointer     user_data)
+{
+  CompletionSource *completion_source = (CompletionSource *)source;
+  CompletionItem *item;
+  guint n_items;
+
+  G_LOCK (completions);
+  n_items = completion_source->pending.length;
+  G_UNLOCK (completions);
+
+  /* Items are taken one at a time so that a callback which runs a
+   * nested main loop on this context still sees the remaining ones.
+   * Anything that arrives while we are dispatching waits for the next
+   * iteration, so a steady stream of results cannot starve the loop.
+   */
+  while (n_items-- > 0)
+    {
+      G_LOCK (completions);
+      item = g_queue_pop_head (&completion_source->pending);
+      G_UNLOCK (completions);
+
+      if (item == NULL)
+        break;
+
+      item->func (item->data);
+      if (item->notify)
+        item->notify (item->data);
+      g_slice_free (CompletionItem, item);
+    }
+
+  G_LOCK (completions);
+  if (!g_queue_is_empty (&completion_source->pending))
+    {
+      G_UNLOCK (completions);
+      return TRUE;
+    }
+
+  if (g_hash_table_lookup (completion_sources,
+                           completion_source->context) == source)
+    g_hash_table_remove (completion_sources, completion_source->context);
+  G_UNLOCK (completions);
+
+  return FALSE;
+}
+
+static void
+completion_source_finalize (GSource *source)
+{
+  CompletionSource *completion_source = (CompletionSource *)source;
+  CompletionItem *item;
+
+  /* Only reached with items pending if the context itself went away */
+  G_LOCK (completions);
+  if (g_hash_table_lookup (completion_sources,
+                           completion_source->context) == source)
+    g_hash_table_remove (completion_sources, completion_source->context);
+  while ((item = g_queue_pop_head (&completion_source->pending)))
+    g_slice_free (CompletionItem, item);
+  G_UNLOCK (completions);
+}
+
+static GSourceFuncs completion_source_funcs = {
+  completion_source_prepare,
+  completion_source_check,
+  completion_source_dispatch,
+  completion_source_finalize
+};
+
+/*
+ * _g_io_scheduler_invoke_in_context:
+ * @context: (allow-none): the #GMainContext to run @func in
+ * @func: the function to call
+ * @user_data: data to pass to @func
+ * @notify: (allow-none): a #GDestroyNotify for @user_data, or %NULL
+ *
+ * Arranges for @func to be called once from @context, at
+ * %G_PRIORITY_DEFAULT; its return value is ignored. Calls queued from
+ * any number of threads are delivered in order and in batches, from a
+ * single source per context.
+ */
+void
+_g_io_scheduler_invoke_in_context (GMainContext   *context,
+                                   GSourceFunc     func,
+                                   gpointer        user_data,
+                                   GDestroyNotify  notify)
+{
+  CompletionSource *completion_source;
+  CompletionItem *item;
+  gboolean wakeup;
+
+  if (context == NULL)
+    context = g_main_context_default ();
+
+  item = g_slice_new (CompletionItem);
+  item->func = func;
+  item->data = user_data;
+  item->notify = notify;
+
+  G_LOCK (completions);
+
+  if (completion_sources == NULL)
+    completion_sources = g_hash_table_new (NULL, NULL);
+
+  completion_source = g_hash_table_lookup (completion_sources, context);
+  if (completion_source == NULL)
+    {
+      GSource *source;
+
+      source = g_source_new (&completion_source_funcs,
+                             sizeof (CompletionSource));
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_can_recurse (source, TRUE);
+      completion_source = (CompletionSource *)source;
+      completion_source->context = context;
+      g_queue_init (&completion_source->pending);
+      g_queue_push_tail (&completion_source->pending, item);
+      g_hash_table_insert (completion_sources, context, source);
+      G_UNLOCK (completions);
+
+      /* Attaching wakes the context up */
+      g_source_attach (source, context);
+      g_source_unref (source);
+      return;
+    }
+
+  wakeup = g_queue_is_empty (&completion_source->pending);
+  g_queue_push_tail (&completion_source->pending, item);
+  G_UNLOCK (completions);
+
+  if (wakeup)
+    g_main_context_wakeup (context);
+}
+
 /**
  * g_io_scheduler_job_send_to_mainloop:
  * @job: a #GIOSchedulerJob
@@ -323,7 +652,6 @@ g_io_scheduler_job_send_to_mainloop (GIOSchedulerJob *job,
 				     gpointer         user_data,
 				     GDestroyNotify   notify)
 {
-  GSource *source;
   MainLoopProxy *proxy;
   gboolean ret_val;
 
@@ -338,13 +666,8 @@ g_io_scheduler_job_send_to_mainloop (GIOSchedulerJob *job,
   g_cond_init (&proxy->ack_condition);
   g_mutex_lock (&proxy->ack_lock);
 
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (source, mainloop_proxy_func, proxy,
-			 NULL);
-
-  g_source_attach (source, job->context);
-  g_source_unref (source);
+  _g_io_scheduler_invoke_in_context (job->context, mainloop_proxy_func,
+                                     proxy, NULL);
 
   while (!proxy->ack)
     g_cond_wait (&proxy->ack_condition, &proxy->ack_lock);
@@ -379,7 +702,6 @@ g_io_scheduler_job_send_to_mainloop_async (GIOSchedulerJob *job,
 					   gpointer         user_data,
 					   GDestroyNotify   notify)
 {
-  GSource *source;
   MainLoopProxy *proxy;
 
   g_return_if_fail (job != NULL);
@@ -392,11 +714,7 @@ g_io_scheduler_job_send_to_mainloop_async (GIOSchedulerJob *job,
   g_mutex_init (&proxy->ack_lock);
   g_cond_init (&proxy->ack_condition);
 
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (source, mainloop_proxy_func, proxy,
-			 (GDestroyNotify)mainloop_proxy_free);
-
-  g_source_attach (source, job->context);
-  g_source_unref (source);
+  _g_io_scheduler_invoke_in_context (job->context, mainloop_proxy_func,
+                                     proxy,
+                                     (GDestroyNotify)mainloop_proxy_free);
 }
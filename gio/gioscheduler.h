@@ -31,12 +31,43 @@
 
 G_BEGIN_DECLS
 
+/**
+ * GIOSchedulerStats:
+ * @n_queued: the number of jobs waiting for a worker thread
+ * @n_running: the number of jobs currently running
+ * @max_queued: the largest value @n_queued has reached
+ * @n_completed: the number of jobs that have finished
+ *
+ * Queue-depth statistics for one #GIOSchedulerPool, as returned by
+ * g_io_scheduler_get_stats().
+ *
+ * Since: 2.34
+ */
+typedef struct {
+  guint   n_queued;
+  guint   n_running;
+  guint   max_queued;
+  guint64 n_completed;
+} GIOSchedulerStats;
 
 void     g_io_scheduler_push_job                   (GIOSchedulerJobFunc  job_func,
 						    gpointer             user_data,
 						    GDestroyNotify       notify,
 						    gint                 io_priority,
 						    GCancellable        *cancellable);
+GLIB_AVAILABLE_IN_2_34
+void     g_io_scheduler_push_job_to_pool           (GIOSchedulerPool     pool,
+						    GIOSchedulerJobFunc  job_func,
+						    gpointer             user_data,
+						    GDestroyNotify       notify,
+						    gint                 io_priority,
+						    GCancellable        *cancellable);
+GLIB_AVAILABLE_IN_2_34
+void     g_io_scheduler_set_max_threads            (GIOSchedulerPool     pool,
+						    gint                 max_threads);
+GLIB_AVAILABLE_IN_2_34
+void     g_io_scheduler_get_stats                  (GIOSchedulerPool     pool,
+						    GIOSchedulerStats   *stats);
 void     g_io_scheduler_cancel_all_jobs            (void);
 gboolean g_io_scheduler_job_send_to_mainloop       (GIOSchedulerJob     *job,
 						    GSourceFunc          func,
@@ -292,6 +292,44 @@ typedef gboolean (* GFileReadMoreCallback) (const char *file_contents,
                                             goffset file_size,
                                             gpointer callback_data);
 
+/**
+ * GFileWalkFunc:
+ * @directory: the directory that @infos were read from
+ * @infos: (element-type GFileInfo): a batch of #GFileInfo<!-- -->s for
+ *     children of @directory
+ * @user_data: user data passed to g_file_walk()
+ *
+ * Called by g_file_walk() and g_file_walk_async() for each batch of
+ * children found during a walk. Neither @infos nor the #GFileInfo<!--
+ * -->s in it belong to the function; take a reference on any info
+ * that you want to keep.
+ *
+ * Returns: %TRUE to continue the walk, %FALSE to stop it.
+ *
+ * Since: 2.34
+ **/
+typedef gboolean (* GFileWalkFunc) (GFile    *directory,
+                                    GList    *infos,
+                                    gpointer  user_data);
+
+/**
+ * GFileWalkFilterFunc:
+ * @directory: the parent directory of @info
+ * @info: the #GFileInfo of a subdirectory of @directory
+ * @user_data: user data passed to g_file_walk()
+ *
+ * Called by g_file_walk() and g_file_walk_async() for each
+ * subdirectory, after the batch it is part of has been passed to the
+ * #GFileWalkFunc, to decide whether the walk descends into it.
+ *
+ * Returns: %TRUE to walk the subdirectory, %FALSE to prune it.
+ *
+ * Since: 2.34
+ **/
+typedef gboolean (* GFileWalkFilterFunc) (GFile     *directory,
+                                          GFileInfo *info,
+                                          gpointer   user_data);
+
 
 /**
  * GIOSchedulerJobFunc:
@@ -379,6 +417,79 @@ struct _GOutputVector {
   gsize size;
 };
 
+/**
+ * GOutputMessage:
+ * @address: (allow-none): a #GSocketAddress, or %NULL
+ * @vectors: pointer to an array of output vectors
+ * @num_vectors: the number of output vectors pointed to by @vectors.
+ * @bytes_sent: initialize to 0. Will be set to the number of bytes
+ *     that have been sent
+ * @control_messages: (array length=num_control_messages) (allow-none): a pointer
+ *   to an array of #GSocketControlMessages, or %NULL.
+ * @num_control_messages: number of elements in @control_messages.
+ *
+ * Structure used for scatter/gather data output when sending multiple
+ * messages or packets in one go. You generally pass in an array of
+ * #GOutputVector<!-- -->s and the operation will use all the buffers
+ * as if they were one buffer.
+ *
+ * If @address is %NULL then the message is sent to the default receiver
+ * (as previously set by g_socket_connect()).
+ *
+ * Since: 2.34
+ */
+typedef struct _GOutputMessage GOutputMessage;
+
+struct _GOutputMessage {
+  GSocketAddress         *address;
+
+  GOutputVector          *vectors;
+  guint                   num_vectors;
+
+  guint                   bytes_sent;
+
+  GSocketControlMessage **control_messages;
+  guint                   num_control_messages;
+};
+
+/**
+ * GInputMessage:
+ * @address: (allow-none): return location for a #GSocketAddress, or %NULL
+ * @vectors: pointer to an array of input vectors
+ * @num_vectors: the number of input vectors pointed to by @vectors
+ * @bytes_received: will be set to the number of bytes that have been
+ *     received
+ * @flags: will be set to the #GSocketMsgFlags of the received message
+ * @control_messages: (allow-none): return location for a
+ *     %NULL-terminated array of #GSocketControlMessages, or %NULL
+ * @num_control_messages: (allow-none): return location for the number
+ *     of elements in @control_messages, or %NULL
+ *
+ * Structure used for scatter/gather data input when receiving multiple
+ * messages or packets in one go. You generally pass in an array of
+ * #GInputVector<!-- -->s and the operation will store the read data
+ * starting in the first buffer, switching to the next as needed.
+ *
+ * The output fields are set as by g_socket_receive_message() for a
+ * single message.
+ *
+ * Since: 2.34
+ */
+typedef struct _GInputMessage GInputMessage;
+
+struct _GInputMessage {
+  GSocketAddress         **address;
+
+  GInputVector            *vectors;
+  guint                    num_vectors;
+
+  gsize                    bytes_received;
+  gint                     flags;
+
+  GSocketControlMessage ***control_messages;
+  guint                   *num_control_messages;
+};
+
 typedef struct _GCredentials                  GCredentials;
 typedef struct _GUnixCredentialsMessage       GUnixCredentialsMessage;
 typedef struct _GUnixFDList                   GUnixFDList;
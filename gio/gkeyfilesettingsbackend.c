@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "gfile.h"
@@ -40,6 +41,20 @@
 #define G_IS_KEYFILE_SETTINGS_BACKEND(inst)  (G_TYPE_CHECK_INSTANCE_TYPE ((inst),      \
                                               G_TYPE_KEYFILE_SETTINGS_BACKEND))
 
+/* Changes are not written to disk immediately.  Instead, the file is
+ * rewritten (atomically, in one go) at most FLUSH_DELAY_MS after the
+ * first unwritten change, or as soon as FLUSH_MAX_PENDING changes have
+ * accumulated, whichever comes first.  g_settings_backend_sync() and
+ * the exit of the process flush any outstanding changes.
+ *
+ * The delayed flushes of all keyfile backends run in a thread of their
+ * own, so that they happen whether or not the thread that made the
+ * changes iterates a main loop.  A pending flush holds a reference on
+ * its backend, so unwritten changes survive the last unref as well.
+ */
+#define FLUSH_DELAY_MS     500
+#define FLUSH_MAX_PENDING  256
+
 
 typedef GSettingsBackendClass GKeyfileSettingsBackendClass;
 
@@ -61,6 +76,12 @@ typedef struct
   guint8             digest[32];
   GFile             *dir;
   GFileMonitor      *dir_monitor;
+
+  /* protects keyfile, digest, flush_source and n_pending, which are
+   * used from the flush thread as well as by the callers */
+  GMutex             lock;
+  GSource           *flush_source;
+  guint              n_pending;
 } GKeyfileSettingsBackend;
 
 static GType g_keyfile_settings_backend_get_type (void);
@@ -83,12 +104,83 @@ compute_checksum (guint8        *digest,
   g_assert (len == 32);
 }
 
+/* Backends with a pending flush, to write them out at exit */
+G_LOCK_DEFINE_STATIC (pending_backends);
+static GSList *pending_backends;
+
+static void g_keyfile_settings_backend_flush_at_exit (void);
+
+static gpointer
+g_keyfile_settings_backend_flush_thread (gpointer user_data)
+{
+  GMainContext *context = user_data;
+  GMainLoop *loop;
+
+  g_main_context_push_thread_default (context);
+  loop = g_main_loop_new (context, FALSE);
+  g_main_loop_run (loop);
+
+  return NULL;
+}
+
+static GMainContext *
+g_keyfile_settings_backend_get_flush_context (void)
+{
+  static gsize flush_context = 0;
+
+  if (g_once_init_enter (&flush_context))
+    {
+      GMainContext *context;
+
+      context = g_main_context_new ();
+      g_thread_unref (g_thread_new ("gsettings-keyfile",
+                                    g_keyfile_settings_backend_flush_thread,
+                                    context));
+      atexit (g_keyfile_settings_backend_flush_at_exit);
+
+      g_once_init_leave (&flush_context, (gsize) context);
+    }
+
+  return (GMainContext *) flush_context;
+}
+
+/* Called with kfsb->lock held, like the other functions that touch
+ * the keyfile or the flush state.  Since dropping the flush source may
+ * drop the last reference on @kfsb, callers that are not invoked
+ * through a reference of their own have to hold one.
+ */
 static void
-g_keyfile_settings_backend_keyfile_write (GKeyfileSettingsBackend *kfsb)
+g_keyfile_settings_backend_cancel_flush (GKeyfileSettingsBackend *kfsb)
+{
+  if (kfsb->flush_source)
+    {
+      G_LOCK (pending_backends);
+      pending_backends = g_slist_remove (pending_backends, kfsb);
+      G_UNLOCK (pending_backends);
+
+      g_source_destroy (kfsb->flush_source);
+      g_source_unref (kfsb->flush_source);
+      kfsb->flush_source = NULL;
+    }
+
+  kfsb->n_pending = 0;
+}
+
+static void
+g_keyfile_settings_backend_keyfile_flush (GKeyfileSettingsBackend *kfsb)
 {
   gchar *contents;
   gsize length;
 
+  if (kfsb->n_pending == 0)
+    return;
+
+  g_keyfile_settings_backend_cancel_flush (kfsb);
+
+  /* g_file_replace_contents() writes to a temporary file and renames
+   * it over the original, so readers (and a crash) will only ever see
+   * either the previous or the new contents, never a mixture.
+   */
   contents = g_key_file_to_data (kfsb->keyfile, &length, NULL);
   g_file_replace_contents (kfsb->file, contents, length, NULL, FALSE,
                            G_FILE_CREATE_REPLACE_DESTINATION,
@@ -98,6 +190,70 @@ g_keyfile_settings_backend_keyfile_write (GKeyfileSettingsBackend *kfsb)
   g_free (contents);
 }
 
+static gboolean
+g_keyfile_settings_backend_flush_timeout (gpointer user_data)
+{
+  GKeyfileSettingsBackend *kfsb = user_data;
+
+  g_mutex_lock (&kfsb->lock);
+
+  /* A sync on another thread may have beaten us to it */
+  if (!g_source_is_destroyed (g_main_current_source ()))
+    g_keyfile_settings_backend_keyfile_flush (kfsb);
+
+  g_mutex_unlock (&kfsb->lock);
+
+  return FALSE;
+}
+
+static void
+g_keyfile_settings_backend_flush_at_exit (void)
+{
+  G_LOCK (pending_backends);
+
+  while (pending_backends != NULL)
+    {
+      GKeyfileSettingsBackend *kfsb;
+
+      /* alive: its flush source holds a reference while it is listed */
+      kfsb = g_object_ref (pending_backends->data);
+      G_UNLOCK (pending_backends);
+
+      g_mutex_lock (&kfsb->lock);
+      g_keyfile_settings_backend_keyfile_flush (kfsb);
+      g_mutex_unlock (&kfsb->lock);
+      g_object_unref (kfsb);
+
+      G_LOCK (pending_backends);
+    }
+
+  G_UNLOCK (pending_backends);
+}
+
+static void
+g_keyfile_settings_backend_keyfile_write (GKeyfileSettingsBackend *kfsb)
+{
+  if (++kfsb->n_pending >= FLUSH_MAX_PENDING)
+    {
+      g_keyfile_settings_backend_keyfile_flush (kfsb);
+      return;
+    }
+
+  if (kfsb->flush_source == NULL)
+    {
+      kfsb->flush_source = g_timeout_source_new (FLUSH_DELAY_MS);
+      g_source_set_callback (kfsb->flush_source,
+                             g_keyfile_settings_backend_flush_timeout,
+                             g_object_ref (kfsb), g_object_unref);
+      g_source_attach (kfsb->flush_source,
+                       g_keyfile_settings_backend_get_flush_context ());
+
+      G_LOCK (pending_backends);
+      pending_backends = g_slist_prepend (pending_backends, kfsb);
+      G_UNLOCK (pending_backends);
+    }
+}
+
 static gboolean
 group_name_matches (const gchar *group_name,
                     const gchar *prefix)
@@ -255,11 +411,16 @@ g_keyfile_settings_backend_read (GSettingsBackend   *backend,
                                  gboolean            default_value)
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
+  GVariant *value;
 
   if (default_value)
     return NULL;
 
-  return get_from_keyfile (kfsb, expected_type, key);
+  g_mutex_lock (&kfsb->lock);
+  value = get_from_keyfile (kfsb, expected_type, key);
+  g_mutex_unlock (&kfsb->lock);
+
+  return value;
 }
 
 typedef struct
@@ -307,8 +468,10 @@ g_keyfile_settings_backend_write_tree (GSettingsBackend *backend,
   if (data.failed)
     return FALSE;
 
+  g_mutex_lock (&data.kfsb->lock);
   g_tree_foreach (tree, g_keyfile_settings_backend_write_one, &data);
   g_keyfile_settings_backend_keyfile_write (data.kfsb);
+  g_mutex_unlock (&data.kfsb->lock);
 
   g_settings_backend_changed_tree (backend, tree, origin_tag);
 
@@ -327,13 +490,14 @@ g_keyfile_settings_backend_write (GSettingsBackend *backend,
   if (!kfsb->writable)
     return FALSE;
 
+  g_mutex_lock (&kfsb->lock);
   success = set_to_keyfile (kfsb, key, value);
+  if (success)
+    g_keyfile_settings_backend_keyfile_write (kfsb);
+  g_mutex_unlock (&kfsb->lock);
 
   if (success)
-    {
-      g_settings_backend_changed (backend, key, origin_tag);
-      g_keyfile_settings_backend_keyfile_write (kfsb);
-    }
+    g_settings_backend_changed (backend, key, origin_tag);
 
   return success;
 }
@@ -345,12 +509,24 @@ g_keyfile_settings_backend_reset (GSettingsBackend *backend,
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
 
+  g_mutex_lock (&kfsb->lock);
   if (set_to_keyfile (kfsb, key, NULL))
     g_keyfile_settings_backend_keyfile_write (kfsb);
+  g_mutex_unlock (&kfsb->lock);
 
   g_settings_backend_changed (backend, key, origin_tag);
 }
 
+static void
+g_keyfile_settings_backend_sync (GSettingsBackend *backend)
+{
+  GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
+
+  g_mutex_lock (&kfsb->lock);
+  g_keyfile_settings_backend_keyfile_flush (kfsb);
+  g_mutex_unlock (&kfsb->lock);
+}
+
 static gboolean
 g_keyfile_settings_backend_get_writable (GSettingsBackend *backend,
                                          const gchar      *name)
@@ -428,6 +604,7 @@ keyfile_to_tree (GKeyfileSettingsBackend *kfsb,
 static void
 g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
 {
+  GTree *tree = NULL;
   guint8 digest[32];
   gchar *contents;
   gsize length;
@@ -435,13 +612,16 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
   contents = NULL;
   length = 0;
 
+  /* cancelling the flush may drop a reference */
+  g_object_ref (kfsb);
+  g_mutex_lock (&kfsb->lock);
+
   g_file_load_contents (kfsb->file, NULL, &contents, &length, NULL, NULL);
   compute_checksum (digest, contents, length);
 
   if (memcmp (kfsb->digest, digest, sizeof digest) != 0)
     {
       GKeyFile *keyfiles[2];
-      GTree *tree;
 
       tree = g_tree_new_full ((GCompareDataFunc) strcmp, NULL,
                               g_free, g_free);
@@ -459,15 +639,28 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
       g_key_file_free (keyfiles[0]);
       kfsb->keyfile = keyfiles[1];
 
+      /* Someone else replaced the file while we had changes that were
+       * not yet written out.  Their version is newer than ours, so it
+       * wins: the change notifications emitted below tell everyone
+       * about the values that we drop.
+       */
+      g_keyfile_settings_backend_cancel_flush (kfsb);
+
+      memcpy (kfsb->digest, digest, sizeof digest);
+    }
+
+  g_mutex_unlock (&kfsb->lock);
+  g_free (contents);
+
+  if (tree != NULL)
+    {
       if (g_tree_nnodes (tree) > 0)
         g_settings_backend_changed_tree (&kfsb->parent_instance, tree, NULL);
 
       g_tree_unref (tree);
-
-      memcpy (kfsb->digest, digest, sizeof digest);
     }
 
-  g_free (contents);
+  g_object_unref (kfsb);
 }
 
 static void
@@ -500,6 +693,10 @@ g_keyfile_settings_backend_finalize (GObject *object)
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (object);
 
+  /* A pending flush holds a reference, so everything is written */
+  g_assert (kfsb->flush_source == NULL);
+  g_mutex_clear (&kfsb->lock);
+
   g_key_file_free (kfsb->keyfile);
   g_object_unref (kfsb->permission);
 
@@ -521,6 +718,7 @@ g_keyfile_settings_backend_finalize (GObject *object)
 static void
 g_keyfile_settings_backend_init (GKeyfileSettingsBackend *kfsb)
 {
+  g_mutex_init (&kfsb->lock);
 }
 
 static void
@@ -534,6 +732,7 @@ g_keyfile_settings_backend_class_init (GKeyfileSettingsBackendClass *class)
   class->write = g_keyfile_settings_backend_write;
   class->write_tree = g_keyfile_settings_backend_write_tree;
   class->reset = g_keyfile_settings_backend_reset;
+  class->sync = g_keyfile_settings_backend_sync;
   class->get_writable = g_keyfile_settings_backend_get_writable;
   class->get_permission = g_keyfile_settings_backend_get_permission;
   /* No need to implement subscribed/unsubscribe: the only point would be to
@@ -612,6 +811,13 @@ dir_changed (GFileMonitor       *monitor,
  * inability to rewrite the keyfile (ie: the containing directory is not
  * writable).
  *
+ * Changes are not written to the keyfile immediately.  Writes that
+ * happen in quick succession are merged and the keyfile is replaced
+ * atomically, shortly after the first change, by a thread that GIO
+ * runs for this purpose.  Changes that are still outstanding when the
+ * process exits normally are written then.  Use
+ * g_settings_backend_sync() to force outstanding changes to be written.
+ *
  * There is no checking done for your key namespace clashing with the
  * syntax of the key file format.  For example, if you have '[' or ']'
  * characters in your path names or '=' in your key names you may be in
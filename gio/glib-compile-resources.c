@@ -37,6 +37,7 @@
 #include <sys/wait.h>
 #endif
 
+#include <gio/gioerror.h>
 #include <gio/gmemoryoutputstream.h>
 #include <gio/gzlibcompressor.h>
 #include <gio/gconverteroutputstream.h>
@@ -47,6 +48,7 @@
 
 #include <glib.h>
 #include "gvdb/gvdb-builder.h"
+#include "glz4.h"
 
 #include "gconstructor_as_data.h"
 
@@ -71,6 +73,7 @@ typedef struct
   /* per file */
   char *alias;
   gboolean compressed;
+  char *compression;
   char *preproc_options;
 
   GString *string;  /* non-NULL when accepting text */
@@ -133,6 +136,7 @@ start_element (GMarkupParseContext  *context,
 	{
 	  COLLECT (OPTIONAL | STRDUP, "alias", &state->alias,
 		   OPTIONAL | BOOL, "compressed", &state->compressed,
+		   OPTIONAL | STRDUP, "compression", &state->compression,
                    OPTIONAL | STRDUP, "preprocess", &state->preproc_options);
 	  state->string = g_string_new ("");
 	  return;
@@ -411,7 +415,32 @@ end_element (GMarkupParseContext  *context,
       /* Include zero termination in content_size for uncompressed files (but not in size) */
       data->content_size = data->size + 1;
 
-      if (state->compressed)
+      if (state->compression != NULL)
+        {
+          if (strcmp (state->compression, "lz4") == 0)
+            data->flags |= G_RESOURCE_FLAGS_LZ4;
+          else if (strcmp (state->compression, "zlib") != 0)
+            {
+              g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                           _("Unknown compression \"%s\""), state->compression);
+              goto cleanup;
+            }
+
+          state->compressed = TRUE;
+        }
+
+      if (state->compressed && (data->flags & G_RESOURCE_FLAGS_LZ4))
+        {
+          gchar *compressed;
+
+          compressed = (gchar *) _g_lz4_compress ((const guint8 *) data->content,
+                                                  data->size, &data->content_size);
+          g_free (data->content);
+          data->content = compressed;
+
+          data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
+        }
+      else if (state->compressed)
 	{
 	  GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
 	  GZlibCompressor *compressor =
@@ -448,6 +477,8 @@ end_element (GMarkupParseContext  *context,
 
       g_free (state->alias);
       state->alias = NULL;
+      g_free (state->compression);
+      state->compression = NULL;
       g_string_free (state->string, TRUE);
       state->string = NULL;
       g_free (state->preproc_options);
@@ -582,13 +613,14 @@ parse_resource_file (const gchar *filename,
 static gboolean
 write_to_file (GHashTable   *table,
 	       const gchar  *filename,
+	       gboolean      perfect_hash,
 	       GError      **error)
 {
   gboolean success;
 
-  success = gvdb_table_write_contents (table, filename,
-				       G_BYTE_ORDER != G_LITTLE_ENDIAN,
-				       error);
+  success = gvdb_table_write_contents_full (table, filename,
+					    G_BYTE_ORDER != G_LITTLE_ENDIAN,
+					    perfect_hash, error);
 
   return success;
 }
@@ -605,6 +637,7 @@ main (int argc, char **argv)
   gboolean generate_source = FALSE;
   gboolean generate_header = FALSE;
   gboolean manual_register = FALSE;
+  gboolean perfect_hash = FALSE;
   gboolean generate_dependencies = FALSE;
   char *c_name = NULL;
   char *c_name_no_underscores;
@@ -618,6 +651,7 @@ main (int argc, char **argv)
     { "generate-dependencies", 0, 0, G_OPTION_ARG_NONE, &generate_dependencies, N_("Generate dependency list"), NULL },
     { "manual-register", 0, 0, G_OPTION_ARG_NONE, &manual_register, N_("Don't automatically create and register resource"), NULL },
     { "c-name", 0, 0, G_OPTION_ARG_STRING, &c_name, N_("C identifier name used for the generated source code"), NULL },
+    { "perfect-hash", 0, 0, G_OPTION_ARG_NONE, &perfect_hash, N_("Lay out the hash table so that each lookup checks a single entry"), NULL },
     { NULL }
   };
 
@@ -783,7 +817,7 @@ main (int argc, char **argv)
     c_name_no_underscores++;
 
   if (binary_target != NULL &&
-      !write_to_file (table, binary_target, &error))
+      !write_to_file (table, binary_target, perfect_hash, &error))
     {
       g_printerr ("%s\n", error->message);
       g_free (target);
@@ -1671,6 +1671,7 @@ output_schema (gpointer key,
 static gboolean
 write_to_file (GHashTable   *schema_table,
                const gchar  *filename,
+               gboolean      perfect_hash,
                GError      **error)
 {
   WriteToFileData data;
@@ -1682,9 +1683,9 @@ write_to_file (GHashTable   *schema_table,
 
   g_hash_table_foreach (schema_table, output_schema, &data);
 
-  success = gvdb_table_write_contents (data.root_pair.table, filename,
-                                       G_BYTE_ORDER != G_LITTLE_ENDIAN,
-                                       error);
+  success = gvdb_table_write_contents_full (data.root_pair.table, filename,
+                                            G_BYTE_ORDER != G_LITTLE_ENDIAN,
+                                            perfect_hash, error);
   g_hash_table_unref (data.root_pair.table);
 
   return success;
@@ -1987,6 +1988,7 @@ main (int argc, char **argv)
   gchar *targetdir = NULL;
   gchar *target;
   gboolean dry_run = FALSE;
+  gboolean perfect_hash = FALSE;
   gboolean strict = FALSE;
   gchar **schema_files = NULL;
   gchar **override_files = NULL;
@@ -1996,6 +1998,7 @@ main (int argc, char **argv)
     { "strict", 0, 0, G_OPTION_ARG_NONE, &strict, N_("Abort on any errors in schemas"), NULL },
     { "dry-run", 0, 0, G_OPTION_ARG_NONE, &dry_run, N_("Do not write the gschema.compiled file"), NULL },
     { "allow-any-name", 0, 0, G_OPTION_ARG_NONE, &allow_any_name, N_("Do not enforce key name restrictions") },
+    { "perfect-hash", 0, 0, G_OPTION_ARG_NONE, &perfect_hash, N_("Lay out the hash table so that each lookup checks a single entry"), NULL },
 
     /* These options are only for use in the gschema-compile tests */
     { "schema-file", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_FILENAME_ARRAY, &schema_files, NULL, NULL },
@@ -2113,7 +2116,7 @@ main (int argc, char **argv)
       return 1;
     }
 
-  if (!dry_run && !write_to_file (table, target, &error))
+  if (!dry_run && !write_to_file (table, target, perfect_hash, &error))
     {
       fprintf (stderr, "%s\n", error->message);
       g_free (target);
@@ -43,13 +43,33 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 typedef struct {
   char *name;
-  long inode;
+  guint64 inode;
   GFileType type;
 } DirEntry;
 
+/* On Linux, read the directory with getdents64() into a large buffer
+ * rather than through readdir(), so that a chunk of CHUNK_SIZE
+ * entries usually takes only a couple of system calls. */
+#if defined (SYS_getdents64) && defined (HAVE_STRUCT_DIRENT_D_TYPE)
+#define USE_GETDENTS64
+#define DENTS_BUFFER_SIZE (64 * 1024)
+
+struct linux_dirent64 {
+  guint64        d_ino;
+  gint64         d_off;
+  unsigned short d_reclen;
+  unsigned char  d_type;
+  char           d_name[];
+};
+#endif
+
 #endif
 
 struct _GLocalFileEnumerator
@@ -72,6 +92,11 @@ struct _GLocalFileEnumerator
   DirEntry *entries;
   int entries_pos;
   gboolean at_end;
+#ifdef USE_GETDENTS64
+  char *dents;
+  int dents_len;
+  int dents_pos;
+#endif
 #endif
   
   gboolean follow_symlinks;
@@ -127,6 +152,9 @@ g_local_file_enumerator_finalize (GObject *object)
     }
 
   free_entries (local);
+#ifdef USE_GETDENTS64
+  g_free (local->dents);
+#endif
 
   G_OBJECT_CLASS (g_local_file_enumerator_parent_class)->finalize (object);
 }
@@ -270,7 +298,7 @@ sort_by_inode (const void *_a, const void *_b)
 
   a = _a;
   b = _b;
-  return a->inode - b->inode;
+  return (a->inode > b->inode) - (a->inode < b->inode);
 }
 
 #ifdef HAVE_STRUCT_DIRENT_D_TYPE
@@ -297,10 +325,73 @@ file_type_from_dirent (char d_type)
 }
 #endif
 
+/* Returns the next directory entry other than "." and "..", or
+ * %FALSE at the end of the directory.  @name is only valid until the
+ * next call. */
+static gboolean
+read_dir_entry (GLocalFileEnumerator  *local,
+                const char           **name,
+                guint64               *inode,
+                GFileType             *type)
+{
+#ifdef USE_GETDENTS64
+  struct linux_dirent64 *dent;
+
+  while (TRUE)
+    {
+      if (local->dents_pos >= local->dents_len)
+        {
+          if (local->dents == NULL)
+            local->dents = g_malloc (DENTS_BUFFER_SIZE);
+
+          local->dents_len = syscall (SYS_getdents64, dirfd (local->dir),
+                                      local->dents, DENTS_BUFFER_SIZE);
+          local->dents_pos = 0;
+          if (local->dents_len <= 0)
+            {
+              local->dents_len = 0;
+              return FALSE;
+            }
+        }
+
+      dent = (struct linux_dirent64 *) (local->dents + local->dents_pos);
+      local->dents_pos += dent->d_reclen;
+
+      if (strcmp (dent->d_name, ".") != 0 &&
+          strcmp (dent->d_name, "..") != 0)
+        {
+          *name = dent->d_name;
+          *inode = dent->d_ino;
+          *type = file_type_from_dirent (dent->d_type);
+          return TRUE;
+        }
+    }
+#else
+  struct dirent *entry;
+
+  do
+    entry = readdir (local->dir);
+  while (entry != NULL &&
+         (0 == strcmp (entry->d_name, ".") ||
+          0 == strcmp (entry->d_name, "..")));
+
+  if (entry == NULL)
+    return FALSE;
+
+  *name = entry->d_name;
+  *inode = entry->d_ino;
+#ifdef HAVE_STRUCT_DIRENT_D_TYPE
+  *type = file_type_from_dirent (entry->d_type);
+#else
+  *type = G_FILE_TYPE_UNKNOWN;
+#endif
+  return TRUE;
+#endif
+}
+
 static const char *
 next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
 {
-  struct dirent *entry;
   const char *filename;
   int i;
 
@@ -321,24 +412,14 @@ next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
       
       for (i = 0; i < CHUNK_SIZE; i++)
 	{
-	  entry = readdir (local->dir);
-	  while (entry 
-		 && (0 == strcmp (entry->d_name, ".") ||
-		     0 == strcmp (entry->d_name, "..")))
-	    entry = readdir (local->dir);
-
-	  if (entry)
-	    {
-	      local->entries[i].name = g_strdup (entry->d_name);
-	      local->entries[i].inode = entry->d_ino;
-#if HAVE_STRUCT_DIRENT_D_TYPE
-              local->entries[i].type = file_type_from_dirent (entry->d_type);
-#else
-              local->entries[i].type = G_FILE_TYPE_UNKNOWN;
-#endif
-	    }
-	  else
+	  const char *name;
+
+	  if (!read_dir_entry (local, &name,
+			       &local->entries[i].inode,
+			       &local->entries[i].type))
 	    break;
+
+	  local->entries[i].name = g_strdup (name);
 	}
       local->entries[i].name = NULL;
       local->entries_pos = 0;
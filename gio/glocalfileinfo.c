@@ -35,6 +35,9 @@
 #endif
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_STATX
+#include <sys/sysmacros.h>
+#endif
 #ifdef HAVE_GRP_H
 #include <grp.h>
 #endif
@@ -1449,6 +1452,95 @@ _g_local_file_info_get_nostat (GFileInfo              *info,
     }
 }
 
+#ifndef G_OS_WIN32
+
+#ifdef HAVE_STATX
+/* Timestamps and block counts can cost extra work on network file
+ * systems, so only ask for them when they are wanted.  Everything
+ * else is used implicitly (type, owner, etag, content type, ...). */
+static unsigned int
+statx_mask_for_matcher (GFileAttributeMatcher *attribute_matcher)
+{
+  unsigned int mask;
+
+  mask = STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_UID | STATX_GID |
+         STATX_INO | STATX_SIZE | STATX_MTIME;
+
+  if (_g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_TIME_ACCESS) ||
+      _g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_TIME_ACCESS_USEC))
+    mask |= STATX_ATIME;
+  if (_g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_TIME_CHANGED) ||
+      _g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_TIME_CHANGED_USEC))
+    mask |= STATX_CTIME;
+  if (_g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_UNIX_BLOCKS) ||
+      _g_file_attribute_matcher_matches_id (attribute_matcher,
+                                            G_FILE_ATTRIBUTE_ID_STANDARD_ALLOCATED_SIZE))
+    mask |= STATX_BLOCKS;
+
+  return mask;
+}
+#endif
+
+/* Like g_lstat() or stat(), but on Linux uses statx() to fetch only
+ * the fields that @attribute_matcher needs.  Fields that were not
+ * requested are left as zero. */
+static int
+local_file_stat (const char            *path,
+                 gboolean               follow_symlinks,
+                 GFileAttributeMatcher *attribute_matcher,
+                 GLocalFileStat        *statbuf)
+{
+#ifdef HAVE_STATX
+  static gboolean statx_missing = FALSE;
+  struct statx stx;
+
+  if (!statx_missing)
+    {
+      if (statx (AT_FDCWD, path,
+                 follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW,
+                 statx_mask_for_matcher (attribute_matcher), &stx) == 0)
+        {
+          memset (statbuf, 0, sizeof *statbuf);
+          statbuf->st_dev = makedev (stx.stx_dev_major, stx.stx_dev_minor);
+          statbuf->st_ino = stx.stx_ino;
+          statbuf->st_mode = stx.stx_mode;
+          statbuf->st_nlink = stx.stx_nlink;
+          statbuf->st_uid = stx.stx_uid;
+          statbuf->st_gid = stx.stx_gid;
+          statbuf->st_rdev = makedev (stx.stx_rdev_major, stx.stx_rdev_minor);
+          statbuf->st_size = stx.stx_size;
+          statbuf->st_blksize = stx.stx_blksize;
+          statbuf->st_blocks = stx.stx_blocks;
+          statbuf->st_atime = stx.stx_atime.tv_sec;
+          statbuf->st_mtime = stx.stx_mtime.tv_sec;
+          statbuf->st_ctime = stx.stx_ctime.tv_sec;
+#if defined (HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+          statbuf->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+          statbuf->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+          statbuf->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+#endif
+          return 0;
+        }
+
+      /* Old kernel, or statx() filtered out by a sandbox */
+      if (errno != ENOSYS && errno != EPERM)
+        return -1;
+      statx_missing = TRUE;
+    }
+#endif
+
+  if (follow_symlinks)
+    return stat (path, statbuf);
+  return g_lstat (path, statbuf);
+}
+
+#endif /* !G_OS_WIN32 */
+
 GFileInfo *
 _g_local_file_info_get (const char             *basename,
 			const char             *path,
@@ -1487,7 +1579,7 @@ _g_local_file_info_get (const char             *basename,
     }
 
 #ifndef G_OS_WIN32
-  res = g_lstat (path, &statbuf);
+  res = local_file_stat (path, FALSE, attribute_matcher, &statbuf);
 #else
   {
     wchar_t *wpath = g_utf8_to_utf16 (path, -1, NULL, NULL, error);
@@ -1553,7 +1645,7 @@ _g_local_file_info_get (const char             *basename,
       /* Unless NOFOLLOW was set we default to following symlinks */
       if (!(flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS))
 	{
-	  res = stat (path, &statbuf2);
+	  res = local_file_stat (path, TRUE, attribute_matcher, &statbuf2);
 
 	  /* Report broken links as symlinks */
 	  if (res != -1)
@@ -36,10 +36,12 @@
 #include "gioerror.h"
 #include "glocalfileinputstream.h"
 #include "glocalfileinfo.h"
+#include "glocalfileuring.h"
 #include "glibintl.h"
 
 #ifdef G_OS_UNIX
 #include "gfiledescriptorbased.h"
+#include "gasynchelper.h"
 #endif
 
 #ifdef G_OS_WIN32
@@ -72,6 +74,13 @@ static gssize     g_local_file_input_stream_read       (GInputStream      *strea
 							gsize              count,
 							GCancellable      *cancellable,
 							GError           **error);
+#ifdef G_OS_UNIX
+static gssize     g_local_file_input_stream_readv      (GInputStream      *stream,
+							GInputVector      *vectors,
+							gsize              n_vectors,
+							GCancellable      *cancellable,
+							GError           **error);
+#endif
 static gssize     g_local_file_input_stream_skip       (GInputStream      *stream,
 							gsize              count,
 							GCancellable      *cancellable,
@@ -79,6 +88,24 @@ static gssize     g_local_file_input_stream_skip       (GInputStream      *strea
 static gboolean   g_local_file_input_stream_close      (GInputStream      *stream,
 							GCancellable      *cancellable,
 							GError           **error);
+static void       g_local_file_input_stream_read_async (GInputStream      *stream,
+							void              *buffer,
+							gsize              count,
+							int                io_priority,
+							GCancellable      *cancellable,
+							GAsyncReadyCallback callback,
+							gpointer           user_data);
+static gssize     g_local_file_input_stream_read_finish (GInputStream     *stream,
+							 GAsyncResult     *result,
+							 GError          **error);
+static void       g_local_file_input_stream_close_async (GInputStream     *stream,
+							 int               io_priority,
+							 GCancellable     *cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer          user_data);
+static gboolean   g_local_file_input_stream_close_finish (GInputStream    *stream,
+							  GAsyncResult    *result,
+							  GError         **error);
 static goffset    g_local_file_input_stream_tell       (GFileInputStream  *stream);
 static gboolean   g_local_file_input_stream_can_seek   (GFileInputStream  *stream);
 static gboolean   g_local_file_input_stream_seek       (GFileInputStream  *stream,
@@ -119,8 +146,15 @@ g_local_file_input_stream_class_init (GLocalFileInputStreamClass *klass)
   gobject_class->finalize = g_local_file_input_stream_finalize;
 
   stream_class->read_fn = g_local_file_input_stream_read;
+#ifdef G_OS_UNIX
+  stream_class->readv_fn = g_local_file_input_stream_readv;
+#endif
   stream_class->skip = g_local_file_input_stream_skip;
   stream_class->close_fn = g_local_file_input_stream_close;
+  stream_class->read_async = g_local_file_input_stream_read_async;
+  stream_class->read_finish = g_local_file_input_stream_read_finish;
+  stream_class->close_async = g_local_file_input_stream_close_async;
+  stream_class->close_finish = g_local_file_input_stream_close_finish;
   file_stream_class->tell = g_local_file_input_stream_tell;
   file_stream_class->can_seek = g_local_file_input_stream_can_seek;
   file_stream_class->seek = g_local_file_input_stream_seek;
@@ -192,6 +226,45 @@ g_local_file_input_stream_read (GInputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+static gssize
+g_local_file_input_stream_readv (GInputStream  *stream,
+				 GInputVector  *vectors,
+				 gsize          n_vectors,
+				 GCancellable  *cancellable,
+				 GError       **error)
+{
+  GLocalFileInputStream *file;
+  gssize res;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  res = -1;
+  while (1)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	break;
+      res = _g_fd_readv (file->priv->fd, vectors, n_vectors);
+      if (res == -1)
+	{
+          int errsv = errno;
+
+	  if (errsv == EINTR)
+	    continue;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error reading from file: %s"),
+		       g_strerror (errsv));
+	}
+
+      break;
+    }
+
+  return res;
+}
+#endif
+
 static gssize
 g_local_file_input_stream_skip (GInputStream  *stream,
 				gsize          count,
@@ -268,6 +341,98 @@ g_local_file_input_stream_close (GInputStream  *stream,
 }
 
 
+/* On Linux, reads and closes are handed to io_uring when the kernel
+ * supports it; otherwise the default thread-based versions are used.
+ */
+static void
+g_local_file_input_stream_read_async (GInputStream        *stream,
+				      void                *buffer,
+				      gsize                count,
+				      int                  io_priority,
+				      GCancellable        *cancellable,
+				      GAsyncReadyCallback  callback,
+				      gpointer             user_data)
+{
+  GLocalFileInputStream *file;
+  GSimpleAsyncResult *res;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  if (_g_local_file_uring_available ())
+    {
+      gboolean queued;
+
+      res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				       g_local_file_input_stream_read_async);
+      queued = _g_local_file_uring_read (res, file->priv->fd,
+					 buffer, count, cancellable);
+      g_object_unref (res);
+
+      if (queued)
+	return;
+    }
+
+  G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+    read_async (stream, buffer, count, io_priority,
+		cancellable, callback, user_data);
+}
+
+static gssize
+g_local_file_input_stream_read_finish (GInputStream  *stream,
+				       GAsyncResult  *result,
+				       GError       **error)
+{
+  if (g_simple_async_result_is_valid (result, G_OBJECT (stream),
+				      g_local_file_input_stream_read_async))
+    return g_simple_async_result_get_op_res_gssize (G_SIMPLE_ASYNC_RESULT (result));
+
+  return G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+    read_finish (stream, result, error);
+}
+
+static void
+g_local_file_input_stream_close_async (GInputStream        *stream,
+				       int                  io_priority,
+				       GCancellable        *cancellable,
+				       GAsyncReadyCallback  callback,
+				       gpointer             user_data)
+{
+  GLocalFileInputStream *file;
+  GSimpleAsyncResult *res;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  if (file->priv->do_close && file->priv->fd != -1 &&
+      _g_local_file_uring_available ())
+    {
+      gboolean queued;
+
+      res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				       g_local_file_input_stream_close_async);
+      queued = _g_local_file_uring_close (res, file->priv->fd, FALSE, NULL);
+      g_object_unref (res);
+
+      if (queued)
+	return;
+    }
+
+  G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+    close_async (stream, io_priority, cancellable, callback, user_data);
+}
+
+static gboolean
+g_local_file_input_stream_close_finish (GInputStream  *stream,
+					GAsyncResult  *result,
+					GError       **error)
+{
+  if (g_simple_async_result_is_valid (result, G_OBJECT (stream),
+				      g_local_file_input_stream_close_async))
+    return TRUE;
+
+  return G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+    close_finish (stream, result, error);
+}
+
 static goffset
 g_local_file_input_stream_tell (GFileInputStream *stream)
 {
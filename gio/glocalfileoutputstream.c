@@ -38,9 +38,11 @@
 #include "gcancellable.h"
 #include "glocalfileoutputstream.h"
 #include "glocalfileinfo.h"
+#include "glocalfileuring.h"
 
 #ifdef G_OS_UNIX
 #include "gfiledescriptorbased.h"
+#include "gasynchelper.h"
 #endif
 
 #ifdef G_OS_WIN32
@@ -94,9 +96,34 @@ static gssize     g_local_file_output_stream_write        (GOutputStream      *s
 							   gsize               count,
 							   GCancellable       *cancellable,
 							   GError            **error);
+#ifdef G_OS_UNIX
+static gssize     g_local_file_output_stream_writev       (GOutputStream      *stream,
+							   const GOutputVector *vectors,
+							   gsize               n_vectors,
+							   GCancellable       *cancellable,
+							   GError            **error);
+#endif
 static gboolean   g_local_file_output_stream_close        (GOutputStream      *stream,
 							   GCancellable       *cancellable,
 							   GError            **error);
+static void       g_local_file_output_stream_write_async  (GOutputStream      *stream,
+							   const void         *buffer,
+							   gsize               count,
+							   int                 io_priority,
+							   GCancellable       *cancellable,
+							   GAsyncReadyCallback callback,
+							   gpointer            user_data);
+static gssize     g_local_file_output_stream_write_finish (GOutputStream      *stream,
+							   GAsyncResult       *result,
+							   GError            **error);
+static void       g_local_file_output_stream_close_async  (GOutputStream      *stream,
+							   int                 io_priority,
+							   GCancellable       *cancellable,
+							   GAsyncReadyCallback callback,
+							   gpointer            user_data);
+static gboolean   g_local_file_output_stream_close_finish (GOutputStream      *stream,
+							   GAsyncResult       *result,
+							   GError            **error);
 static GFileInfo *g_local_file_output_stream_query_info   (GFileOutputStream  *stream,
 							   const char         *attributes,
 							   GCancellable       *cancellable,
@@ -146,7 +173,14 @@ g_local_file_output_stream_class_init (GLocalFileOutputStreamClass *klass)
   gobject_class->finalize = g_local_file_output_stream_finalize;
 
   stream_class->write_fn = g_local_file_output_stream_write;
+#ifdef G_OS_UNIX
+  stream_class->writev_fn = g_local_file_output_stream_writev;
+#endif
   stream_class->close_fn = g_local_file_output_stream_close;
+  stream_class->write_async = g_local_file_output_stream_write_async;
+  stream_class->write_finish = g_local_file_output_stream_write_finish;
+  stream_class->close_async = g_local_file_output_stream_close_async;
+  stream_class->close_finish = g_local_file_output_stream_close_finish;
   file_stream_class->query_info = g_local_file_output_stream_query_info;
   file_stream_class->get_etag = g_local_file_output_stream_get_etag;
   file_stream_class->tell = g_local_file_output_stream_tell;
@@ -209,6 +243,44 @@ g_local_file_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+static gssize
+g_local_file_output_stream_writev (GOutputStream        *stream,
+				   const GOutputVector  *vectors,
+				   gsize                 n_vectors,
+				   GCancellable         *cancellable,
+				   GError              **error)
+{
+  GLocalFileOutputStream *file;
+  gssize res;
+
+  file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+
+  while (1)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	return -1;
+      res = _g_fd_writev (file->priv->fd, vectors, n_vectors);
+      if (res == -1)
+	{
+          int errsv = errno;
+
+	  if (errsv == EINTR)
+	    continue;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error writing to file: %s"),
+		       g_strerror (errsv));
+	}
+
+      break;
+    }
+
+  return res;
+}
+#endif
+
 void
 _g_local_file_output_stream_set_do_close (GLocalFileOutputStream *out,
 					  gboolean do_close)
@@ -388,6 +460,103 @@ g_local_file_output_stream_close (GOutputStream  *stream,
   return TRUE;
 }
 
+/* On Linux, writes and simple closes are handed to io_uring when the
+ * kernel supports it.  Closing a stream that replaces a file needs
+ * renames and backups, so that still goes through a thread.
+ */
+static void
+g_local_file_output_stream_write_async (GOutputStream       *stream,
+					const void          *buffer,
+					gsize                count,
+					int                  io_priority,
+					GCancellable        *cancellable,
+					GAsyncReadyCallback  callback,
+					gpointer             user_data)
+{
+  GLocalFileOutputStream *file;
+  GSimpleAsyncResult *res;
+
+  file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+
+  if (_g_local_file_uring_available ())
+    {
+      gboolean queued;
+
+      res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				       g_local_file_output_stream_write_async);
+      queued = _g_local_file_uring_write (res, file->priv->fd,
+					  buffer, count, cancellable);
+      g_object_unref (res);
+
+      if (queued)
+	return;
+    }
+
+  G_OUTPUT_STREAM_CLASS (g_local_file_output_stream_parent_class)->
+    write_async (stream, buffer, count, io_priority,
+		 cancellable, callback, user_data);
+}
+
+static gssize
+g_local_file_output_stream_write_finish (GOutputStream  *stream,
+					 GAsyncResult   *result,
+					 GError        **error)
+{
+  if (g_simple_async_result_is_valid (result, G_OBJECT (stream),
+				      g_local_file_output_stream_write_async))
+    return g_simple_async_result_get_op_res_gssize (G_SIMPLE_ASYNC_RESULT (result));
+
+  return G_OUTPUT_STREAM_CLASS (g_local_file_output_stream_parent_class)->
+    write_finish (stream, result, error);
+}
+
+static void
+g_local_file_output_stream_close_async (GOutputStream       *stream,
+					int                  io_priority,
+					GCancellable        *cancellable,
+					GAsyncReadyCallback  callback,
+					gpointer             user_data)
+{
+  GLocalFileOutputStream *file;
+  GSimpleAsyncResult *res;
+
+  file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+
+#ifndef G_OS_WIN32
+  if (file->priv->do_close && file->priv->tmp_filename == NULL &&
+      _g_local_file_uring_available ())
+    {
+      gboolean queued;
+
+      res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				       g_local_file_output_stream_close_async);
+      queued = _g_local_file_uring_close (res, file->priv->fd,
+					  file->priv->sync_on_close,
+					  &file->priv->etag);
+      g_object_unref (res);
+
+      if (queued)
+	return;
+    }
+#endif
+
+  G_OUTPUT_STREAM_CLASS (g_local_file_output_stream_parent_class)->
+    close_async (stream, io_priority, cancellable, callback, user_data);
+}
+
+static gboolean
+g_local_file_output_stream_close_finish (GOutputStream  *stream,
+					 GAsyncResult   *result,
+					 GError        **error)
+{
+  if (g_simple_async_result_is_valid (result, G_OBJECT (stream),
+				      g_local_file_output_stream_close_async))
+    return TRUE;
+
+  return G_OUTPUT_STREAM_CLASS (g_local_file_output_stream_parent_class)->
+    close_finish (stream, result, error);
+}
+
 static char *
 g_local_file_output_stream_get_etag (GFileOutputStream *stream)
 {
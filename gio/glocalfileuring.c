@@ -0,0 +1,788 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include "glocalfileuring.h"
+
+/* Asynchronous reads, writes and closes of local files, using the
+ * Linux io_uring interface when the running kernel provides it.
+ *
+ * Each GMainContext that starts such an operation gets its own ring,
+ * wrapped in a GSource that polls the ring's file descriptor. The
+ * kernel performs the I/O and the completion is dispatched straight
+ * from that source, so no GIOScheduler thread is involved.
+ *
+ * All entry points return %FALSE if the operation could not be
+ * queued (no kernel support, or the ring is full); the caller then
+ * falls back to the thread-based default implementation.
+ */
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <linux/io_uring.h>
+
+#include "gioerror.h"
+#include "glocalfileinfo.h"
+#include "glibintl.h"
+
+#define URING_ENTRIES 64
+
+/* The low bits of each submission's user_data say which step of an
+ * operation it belongs to; the rest is the URingOp pointer. */
+#define URING_STEP_MASK    ((guint64) 7)
+enum {
+  URING_STEP_IO = 1,
+  URING_STEP_FSYNC,
+  URING_STEP_STATX,
+  URING_STEP_CLOSE
+};
+
+typedef enum {
+  URING_OP_READ,
+  URING_OP_WRITE,
+  URING_OP_CLOSE
+} URingOpKind;
+
+typedef struct {
+  GSource       source;
+  GPollFD       pollfd;
+  GMainContext *context;
+
+  GMutex        lock;           /* protects the submission queue */
+  GSList       *cancels;        /* URingOps whose cancellation waits
+                                 * for a free submission slot */
+  guint        *sq_head;
+  guint        *sq_tail;
+  guint        *sq_mask;
+  guint        *sq_array;
+  struct io_uring_sqe *sqes;
+
+  guint        *cq_head;
+  guint        *cq_tail;
+  guint        *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  gpointer      ring_map;
+  gsize         ring_map_size;
+  gpointer      sqes_map;
+  gsize         sqes_map_size;
+} URingSource;
+
+typedef struct {
+  URingSource        *ring;
+  URingOpKind         kind;
+  GSimpleAsyncResult *simple;
+  GCancellable       *cancellable;
+  gulong              cancelled_id;
+  int                 fd;
+
+  guint               n_pending;
+  gint                result;
+  gint                error_step;
+  gboolean            closed;
+
+  char              **etag_out;
+  gboolean            have_statx;
+  struct statx        statx_buf;
+} URingOp;
+
+G_LOCK_DEFINE_STATIC (rings);
+static GHashTable *rings = NULL;
+
+static int
+uring_setup (unsigned int            entries,
+             struct io_uring_params *params)
+{
+  return syscall (__NR_io_uring_setup, entries, params);
+}
+
+static int
+uring_enter (int          fd,
+             unsigned int to_submit,
+             unsigned int min_complete,
+             unsigned int flags)
+{
+  return syscall (__NR_io_uring_enter, fd, to_submit, min_complete,
+                  flags, NULL, 0);
+}
+
+static int
+uring_register (int          fd,
+                unsigned int opcode,
+                void        *arg,
+                unsigned int nr_args)
+{
+  return syscall (__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static gpointer
+uring_check_support (gpointer data)
+{
+  static const guint8 needed_ops[] = {
+    IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC,
+    IORING_OP_STATX, IORING_OP_CLOSE, IORING_OP_ASYNC_CANCEL
+  };
+  const guint needed_features = IORING_FEAT_SINGLE_MMAP |
+                                IORING_FEAT_NODROP |
+                                IORING_FEAT_RW_CUR_POS;
+  struct io_uring_params params;
+  struct io_uring_probe *probe;
+  gboolean supported = FALSE;
+  gsize probe_size;
+  guint i;
+  int fd;
+
+  memset (&params, 0, sizeof params);
+  fd = uring_setup (4, &params);
+  if (fd < 0)
+    return GINT_TO_POINTER (FALSE);
+
+  probe_size = sizeof (struct io_uring_probe) +
+               IORING_OP_LAST * sizeof (struct io_uring_probe_op);
+  probe = g_malloc0 (probe_size);
+
+  if ((params.features & needed_features) == needed_features &&
+      uring_register (fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0)
+    {
+      supported = TRUE;
+      for (i = 0; i < G_N_ELEMENTS (needed_ops); i++)
+        if (needed_ops[i] > probe->last_op ||
+            !(probe->ops[needed_ops[i]].flags & IO_URING_OP_SUPPORTED))
+          supported = FALSE;
+    }
+
+  g_free (probe);
+  close (fd);
+
+  return GINT_TO_POINTER (supported);
+}
+
+gboolean
+_g_local_file_uring_available (void)
+{
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, uring_check_support, NULL);
+
+  return GPOINTER_TO_INT (once.retval);
+}
+
+static void
+uring_op_complete (URingOp *op)
+{
+  GSimpleAsyncResult *simple = op->simple;
+  int errsv = -op->result;
+
+  g_cancellable_disconnect (op->cancellable, op->cancelled_id);
+
+  /* A cancellation that never made it to the kernel is moot now */
+  g_mutex_lock (&op->ring->lock);
+  op->ring->cancels = g_slist_remove (op->ring->cancels, op);
+  g_mutex_unlock (&op->ring->lock);
+
+  if (op->kind == URING_OP_CLOSE)
+    {
+      if (!op->closed)
+        close (op->fd);
+
+      if (op->have_statx && op->etag_out != NULL)
+        {
+          GLocalFileStat statbuf;
+
+          memset (&statbuf, 0, sizeof statbuf);
+          statbuf.st_mtime = op->statx_buf.stx_mtime.tv_sec;
+#if defined (HAVE_STRUCT_STAT_ST_MTIMENSEC)
+          statbuf.st_mtimensec = op->statx_buf.stx_mtime.tv_nsec;
+#elif defined (HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+          statbuf.st_mtim.tv_nsec = op->statx_buf.stx_mtime.tv_nsec;
+#endif
+          g_free (*op->etag_out);
+          *op->etag_out = _g_local_file_info_create_etag (&statbuf);
+        }
+
+      if (op->result < 0 && op->error_step == URING_STEP_FSYNC)
+        g_simple_async_result_set_error (simple, G_IO_ERROR,
+                                         g_io_error_from_errno (errsv),
+                                         _("Error writing to file: %s"),
+                                         g_strerror (errsv));
+      else if (op->result < 0)
+        g_simple_async_result_set_error (simple, G_IO_ERROR,
+                                         g_io_error_from_errno (errsv),
+                                         _("Error closing file: %s"),
+                                         g_strerror (errsv));
+      else
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    }
+  else if (op->result == -ECANCELED || op->result == -EINTR)
+    g_simple_async_result_set_error (simple, G_IO_ERROR,
+                                     G_IO_ERROR_CANCELLED,
+                                     "%s", _("Operation was cancelled"));
+  else if (op->result < 0)
+    g_simple_async_result_set_error (simple, G_IO_ERROR,
+                                     g_io_error_from_errno (errsv),
+                                     op->kind == URING_OP_READ ?
+                                       _("Error reading from file: %s") :
+                                       _("Error writing to file: %s"),
+                                     g_strerror (errsv));
+  else
+    g_simple_async_result_set_op_res_gssize (simple, op->result);
+
+  g_simple_async_result_complete (simple);
+
+  if (op->cancellable)
+    g_object_unref (op->cancellable);
+  g_object_unref (simple);
+  g_free (op);
+}
+
+static void
+uring_handle_cqe (guint64 user_data,
+                  gint    res)
+{
+  URingOp *op;
+  gint step;
+
+  /* Cancellation requests carry no operation */
+  if (user_data == 0)
+    return;
+
+  op = (URingOp *) (gsize) (user_data & ~URING_STEP_MASK);
+  step = user_data & URING_STEP_MASK;
+
+  if (step == URING_STEP_STATX)
+    op->have_statx = (res == 0);
+  else if (step == URING_STEP_CLOSE && res != -ECANCELED)
+    op->closed = TRUE;      /* the descriptor is gone even on error */
+  else if (step == URING_STEP_IO)
+    op->result = res;
+
+  /* Steps after a failed one in a chain report -ECANCELED; keep the
+   * error of the step that actually failed.  A failed statx only
+   * means that there is no etag, as with the synchronous close. */
+  if (res < 0 && step != URING_STEP_STATX && op->error_step == 0)
+    {
+      op->result = res;
+      op->error_step = step;
+    }
+
+  if (--op->n_pending == 0)
+    uring_op_complete (op);
+}
+
+static gboolean
+uring_source_ready (URingSource *ring)
+{
+  return *ring->cq_head != (guint) g_atomic_int_get ((gint *) ring->cq_tail);
+}
+
+static gboolean uring_flush (URingSource *ring);
+
+static gboolean
+uring_source_prepare (GSource *source,
+                      gint    *timeout)
+{
+  URingSource *ring = (URingSource *) source;
+  gboolean flushed;
+
+  /* Hand over submissions the kernel refused earlier.  If it still
+   * can't take them (its completion queue is full, or it is out of
+   * memory), dispatching our completions or just waiting a little
+   * will fix that, so poll again soon. */
+  g_mutex_lock (&ring->lock);
+  flushed = uring_flush (ring);
+  g_mutex_unlock (&ring->lock);
+
+  *timeout = flushed ? -1 : 1;
+  return uring_source_ready (ring);
+}
+
+static gboolean
+uring_source_check (GSource *source)
+{
+  return uring_source_ready ((URingSource *) source);
+}
+
+static gboolean
+uring_source_dispatch (GSource     *source,
+                       GSourceFunc  callback,
+                       gpointer     user_data)
+{
+  URingSource *ring = (URingSource *) source;
+  guint head, tail;
+
+  tail = g_atomic_int_get ((gint *) ring->cq_tail);
+  for (head = *ring->cq_head; head != tail; head = *ring->cq_head)
+    {
+      struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+      guint64 cqe_data = cqe->user_data;
+      gint res = cqe->res;
+
+      /* Hand the slot back before running the callback, which may
+       * start more operations or iterate this context again. */
+      g_atomic_int_set ((gint *) ring->cq_head, head + 1);
+      uring_handle_cqe (cqe_data, res);
+    }
+
+  return TRUE;
+}
+
+static void
+uring_source_finalize (GSource *source)
+{
+  URingSource *ring = (URingSource *) source;
+
+  G_LOCK (rings);
+  if (g_hash_table_lookup (rings, ring->context) == ring)
+    g_hash_table_remove (rings, ring->context);
+  G_UNLOCK (rings);
+
+  munmap (ring->sqes_map, ring->sqes_map_size);
+  munmap (ring->ring_map, ring->ring_map_size);
+  close (ring->pollfd.fd);
+  g_slist_free (ring->cancels);
+  g_mutex_clear (&ring->lock);
+}
+
+static GSourceFuncs uring_source_funcs = {
+  uring_source_prepare,
+  uring_source_check,
+  uring_source_dispatch,
+  uring_source_finalize
+};
+
+static URingSource *
+uring_source_new (GMainContext *context)
+{
+  struct io_uring_params params;
+  URingSource *ring;
+  guint8 *map, *sqes;
+  gsize map_size, sqes_size;
+  int fd;
+
+  memset (&params, 0, sizeof params);
+  fd = uring_setup (URING_ENTRIES, &params);
+  if (fd < 0)
+    return NULL;
+
+  /* IORING_FEAT_SINGLE_MMAP: both rings share one mapping */
+  map_size = MAX (params.sq_off.array + params.sq_entries * sizeof (guint),
+                  params.cq_off.cqes +
+                  params.cq_entries * sizeof (struct io_uring_cqe));
+  map = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (map == MAP_FAILED)
+    {
+      close (fd);
+      return NULL;
+    }
+
+  sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+  sqes = mmap (NULL, sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    {
+      munmap (map, map_size);
+      close (fd);
+      return NULL;
+    }
+
+  ring = (URingSource *) g_source_new (&uring_source_funcs,
+                                       sizeof (URingSource));
+  ring->context = context;
+  g_mutex_init (&ring->lock);
+
+  ring->ring_map = map;
+  ring->ring_map_size = map_size;
+  ring->sq_head = (guint *) (map + params.sq_off.head);
+  ring->sq_tail = (guint *) (map + params.sq_off.tail);
+  ring->sq_mask = (guint *) (map + params.sq_off.ring_mask);
+  ring->sq_array = (guint *) (map + params.sq_off.array);
+  ring->cq_head = (guint *) (map + params.cq_off.head);
+  ring->cq_tail = (guint *) (map + params.cq_off.tail);
+  ring->cq_mask = (guint *) (map + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) (map + params.cq_off.cqes);
+  ring->sqes_map = sqes;
+  ring->sqes_map_size = sqes_size;
+  ring->sqes = (struct io_uring_sqe *) sqes;
+
+  ring->pollfd.fd = fd;
+  ring->pollfd.events = G_IO_IN;
+  g_source_add_poll ((GSource *) ring, &ring->pollfd);
+  g_source_set_can_recurse ((GSource *) ring, TRUE);
+
+  return ring;
+}
+
+/* Returns the ring of the thread-default main context, creating it
+ * on first use.  The ring stays attached for the lifetime of the
+ * context. */
+static URingSource *
+uring_get_ring (void)
+{
+  GMainContext *context;
+  URingSource *ring;
+
+  context = g_main_context_get_thread_default ();
+  if (context == NULL)
+    context = g_main_context_default ();
+
+  G_LOCK (rings);
+  if (rings == NULL)
+    rings = g_hash_table_new (NULL, NULL);
+
+  ring = g_hash_table_lookup (rings, context);
+  if (ring == NULL)
+    {
+      ring = uring_source_new (context);
+      if (ring != NULL)
+        {
+          g_hash_table_insert (rings, context, ring);
+          g_source_attach ((GSource *) ring, context);
+          g_source_unref ((GSource *) ring);
+        }
+    }
+  G_UNLOCK (rings);
+
+  return ring;
+}
+
+/* Must be called with ring->lock held.  Returns %NULL unless @n
+ * consecutive submission slots are free. */
+static struct io_uring_sqe *
+uring_get_sqes (URingSource *ring,
+                guint        n)
+{
+  guint head, tail, i;
+
+  head = g_atomic_int_get ((gint *) ring->sq_head);
+  tail = *ring->sq_tail;
+  if (tail - head + n > *ring->sq_mask + 1)
+    return NULL;
+
+  for (i = 0; i < n; i++)
+    {
+      guint index = (tail + i) & *ring->sq_mask;
+
+      memset (&ring->sqes[index], 0, sizeof (struct io_uring_sqe));
+      ring->sq_array[index] = index;
+    }
+
+  return &ring->sqes[tail & *ring->sq_mask];
+}
+
+/* Must be called with ring->lock held.  Queues a request to cancel
+ * the I/O step of @op, if there is a free slot for it. */
+static gboolean
+uring_prep_cancel (URingSource *ring,
+                   URingOp     *op)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = uring_get_sqes (ring, 1);
+  if (sqe == NULL)
+    return FALSE;
+
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->addr = (guint64) (gsize) op | URING_STEP_IO;
+  sqe->user_data = 0;
+  g_atomic_int_set ((gint *) ring->sq_tail, *ring->sq_tail + 1);
+
+  return TRUE;
+}
+
+/* Must be called with ring->lock held.  Passes everything queued to
+ * the kernel; returns %FALSE if some of it is left over because the
+ * kernel refused it for now (EAGAIN, EBUSY), in which case the ring
+ * source retries from its prepare function. */
+static gboolean
+uring_flush (URingSource *ring)
+{
+  guint pending;
+
+  while (ring->cancels != NULL &&
+         uring_prep_cancel (ring, ring->cancels->data))
+    ring->cancels = g_slist_delete_link (ring->cancels, ring->cancels);
+
+  pending = *ring->sq_tail - g_atomic_int_get ((gint *) ring->sq_head);
+  while (pending > 0)
+    {
+      int res;
+
+      res = uring_enter (ring->pollfd.fd, pending, 0, 0);
+      if (res == 0 || (res < 0 && errno != EINTR))
+        return FALSE;
+
+      pending = *ring->sq_tail - g_atomic_int_get ((gint *) ring->sq_head);
+    }
+
+  return ring->cancels == NULL;
+}
+
+/* Must be called with ring->lock held */
+static void
+uring_submit (URingSource *ring,
+              guint        n)
+{
+  g_atomic_int_set ((gint *) ring->sq_tail, *ring->sq_tail + n);
+
+  /* The context may be sleeping without a timeout; wake it up so
+   * that the source retries what the kernel did not take. */
+  if (!uring_flush (ring))
+    g_main_context_wakeup (ring->context);
+}
+
+#define SQE_AT(ring, first, i) \
+  (&(ring)->sqes[(((first) - (ring)->sqes) + (i)) & *(ring)->sq_mask])
+
+static void
+uring_cancelled (GCancellable *cancellable,
+                 gpointer      user_data)
+{
+  URingOp *op = user_data;
+  URingSource *ring = op->ring;
+
+  /* With the ring full, keep the request until a slot frees up
+   * rather than dropping it */
+  g_mutex_lock (&ring->lock);
+  if (!uring_prep_cancel (ring, op))
+    ring->cancels = g_slist_append (ring->cancels, op);
+  if (!uring_flush (ring))
+    g_main_context_wakeup (ring->context);
+  g_mutex_unlock (&ring->lock);
+}
+
+static gboolean
+uring_start_rw (URingOpKind         kind,
+                GSimpleAsyncResult *simple,
+                int                 fd,
+                const void         *buffer,
+                gsize               count,
+                GCancellable       *cancellable)
+{
+  URingSource *ring;
+  struct io_uring_sqe *sqe;
+  URingOp *op;
+
+  if (!_g_local_file_uring_available () || count > G_MAXINT)
+    return FALSE;
+
+  if (g_cancellable_is_cancelled (cancellable))
+    {
+      g_simple_async_result_set_error (simple, G_IO_ERROR,
+                                       G_IO_ERROR_CANCELLED,
+                                       "%s", _("Operation was cancelled"));
+      g_simple_async_result_complete_in_idle (simple);
+      return TRUE;
+    }
+
+  ring = uring_get_ring ();
+  if (ring == NULL)
+    return FALSE;
+
+  op = g_new0 (URingOp, 1);
+  op->ring = ring;
+  op->kind = kind;
+  op->simple = g_object_ref (simple);
+  op->fd = fd;
+  op->n_pending = 1;
+
+  /* Connect before submitting: once submitted, another thread
+   * iterating the context may complete and free the operation. */
+  if (cancellable)
+    {
+      op->cancellable = g_object_ref (cancellable);
+      op->cancelled_id = g_cancellable_connect (cancellable,
+                                                G_CALLBACK (uring_cancelled),
+                                                op, NULL);
+    }
+
+  g_mutex_lock (&ring->lock);
+  sqe = uring_get_sqes (ring, 1);
+  if (sqe == NULL)
+    {
+      g_mutex_unlock (&ring->lock);
+      if (op->cancellable)
+        {
+          g_cancellable_disconnect (op->cancellable, op->cancelled_id);
+          g_object_unref (op->cancellable);
+        }
+      g_object_unref (op->simple);
+      g_free (op);
+      return FALSE;
+    }
+
+  sqe->opcode = kind == URING_OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+  sqe->fd = fd;
+  sqe->off = (guint64) -1;          /* use and update the file position */
+  sqe->addr = (guint64) (gsize) buffer;
+  sqe->len = count;
+  sqe->user_data = (guint64) (gsize) op | URING_STEP_IO;
+  uring_submit (ring, 1);
+  g_mutex_unlock (&ring->lock);
+
+  return TRUE;
+}
+
+gboolean
+_g_local_file_uring_read (GSimpleAsyncResult *simple,
+                          int                 fd,
+                          void               *buffer,
+                          gsize               count,
+                          GCancellable       *cancellable)
+{
+  return uring_start_rw (URING_OP_READ, simple, fd, buffer, count,
+                         cancellable);
+}
+
+gboolean
+_g_local_file_uring_write (GSimpleAsyncResult *simple,
+                           int                 fd,
+                           const void         *buffer,
+                           gsize               count,
+                           GCancellable       *cancellable)
+{
+  return uring_start_rw (URING_OP_WRITE, simple, fd, buffer, count,
+                         cancellable);
+}
+
+/* Closes @fd, optionally preceded by an fsync(); if @etag_out is
+ * given the file is also stat'ed just before closing it, and the
+ * resulting etag stored in *@etag_out. */
+gboolean
+_g_local_file_uring_close (GSimpleAsyncResult *simple,
+                           int                 fd,
+                           gboolean            sync_first,
+                           char              **etag_out)
+{
+  static const char empty_path[] = "";
+  URingSource *ring;
+  struct io_uring_sqe *first, *sqe;
+  URingOp *op;
+  guint n, i;
+
+  if (!_g_local_file_uring_available ())
+    return FALSE;
+
+  ring = uring_get_ring ();
+  if (ring == NULL)
+    return FALSE;
+
+  op = g_new0 (URingOp, 1);
+  op->ring = ring;
+  op->kind = URING_OP_CLOSE;
+  op->fd = fd;
+  op->etag_out = etag_out;
+  n = 1 + (sync_first ? 1 : 0) + (etag_out ? 1 : 0);
+  op->n_pending = n;
+
+  g_mutex_lock (&ring->lock);
+  first = uring_get_sqes (ring, n);
+  if (first == NULL)
+    {
+      g_mutex_unlock (&ring->lock);
+      g_free (op);
+      return FALSE;
+    }
+
+  op->simple = g_object_ref (simple);
+
+  i = 0;
+  if (sync_first)
+    {
+      /* A failed fsync cancels the rest of the chain */
+      sqe = SQE_AT (ring, first, i++);
+      sqe->opcode = IORING_OP_FSYNC;
+      sqe->flags = IOSQE_IO_LINK;
+      sqe->fd = fd;
+      sqe->user_data = (guint64) (gsize) op | URING_STEP_FSYNC;
+    }
+
+  if (etag_out)
+    {
+      /* ...but a failed statx must not keep the file open */
+      sqe = SQE_AT (ring, first, i++);
+      sqe->opcode = IORING_OP_STATX;
+      sqe->flags = IOSQE_IO_HARDLINK;
+      sqe->fd = fd;
+      sqe->addr = (guint64) (gsize) empty_path;
+      sqe->len = STATX_MTIME;
+      sqe->off = (guint64) (gsize) &op->statx_buf;
+      sqe->statx_flags = AT_EMPTY_PATH;
+      sqe->user_data = (guint64) (gsize) op | URING_STEP_STATX;
+    }
+
+  sqe = SQE_AT (ring, first, i++);
+  sqe->opcode = IORING_OP_CLOSE;
+  sqe->fd = fd;
+  sqe->user_data = (guint64) (gsize) op | URING_STEP_CLOSE;
+
+  uring_submit (ring, n);
+  g_mutex_unlock (&ring->lock);
+
+  return TRUE;
+}
+
+#else /* !HAVE_LINUX_IO_URING_H */
+
+gboolean
+_g_local_file_uring_available (void)
+{
+  return FALSE;
+}
+
+gboolean
+_g_local_file_uring_read (GSimpleAsyncResult *simple,
+                          int                 fd,
+                          void               *buffer,
+                          gsize               count,
+                          GCancellable       *cancellable)
+{
+  return FALSE;
+}
+
+gboolean
+_g_local_file_uring_write (GSimpleAsyncResult *simple,
+                           int                 fd,
+                           const void         *buffer,
+                           gsize               count,
+                           GCancellable       *cancellable)
+{
+  return FALSE;
+}
+
+gboolean
+_g_local_file_uring_close (GSimpleAsyncResult *simple,
+                           int                 fd,
+                           gboolean            sync_first,
+                           char              **etag_out)
+{
+  return FALSE;
+}
+
+#endif /* HAVE_LINUX_IO_URING_H */
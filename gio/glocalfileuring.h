@@ -0,0 +1,47 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __G_LOCAL_FILE_URING_H__
+#define __G_LOCAL_FILE_URING_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+gboolean _g_local_file_uring_available (void);
+
+gboolean _g_local_file_uring_read      (GSimpleAsyncResult *simple,
+                                        int                 fd,
+                                        void               *buffer,
+                                        gsize               count,
+                                        GCancellable       *cancellable);
+gboolean _g_local_file_uring_write     (GSimpleAsyncResult *simple,
+                                        int                 fd,
+                                        const void         *buffer,
+                                        gsize               count,
+                                        GCancellable       *cancellable);
+gboolean _g_local_file_uring_close     (GSimpleAsyncResult *simple,
+                                        int                 fd,
+                                        gboolean            sync_first,
+                                        char              **etag_out);
+
+G_END_DECLS
+
+#endif /* __G_LOCAL_FILE_URING_H__ */
@@ -0,0 +1,279 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* A small implementation of the LZ4 block format, used for resources
+ * that are marked compression="lz4".  LZ4 compresses less than zlib,
+ * but decompresses many times faster, which matters for resources that
+ * are looked up often.
+ *
+ * A block is a series of sequences.  Each sequence starts with a token
+ * byte, whose high nibble is the number of literal bytes and whose low
+ * nibble is the match length minus 4; a nibble of 15 is followed by
+ * extra length bytes, added up until one is not 255.  The literals
+ * follow, then the little-endian 16-bit offset of the match.  The last
+ * sequence only has literals.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "glz4.h"
+
+#define MIN_MATCH     4
+#define LAST_LITERALS 5   /* the last bytes of a block are always literals */
+#define MF_LIMIT      12  /* the last match starts this far from the end */
+#define MAX_OFFSET    65535
+#define HASH_BITS     16
+
+static inline guint32
+read32 (const guint8 *p)
+{
+  guint32 v;
+
+  memcpy (&v, p, sizeof v);
+
+  return v;
+}
+
+static inline guint
+hash32 (guint32 v)
+{
+  return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static guint8 *
+write_length (guint8 *op,
+              gsize   len)
+{
+  while (len >= 255)
+    {
+      *op++ = 255;
+      len -= 255;
+    }
+  *op++ = len;
+
+  return op;
+}
+
+static guint8 *
+write_sequence (guint8       *op,
+                const guint8 *literals,
+                gsize         n_literals,
+                gsize         offset,
+                gsize         match_len)
+{
+  guint8 *token = op++;
+
+  if (n_literals >= 15)
+    {
+      *token = 15 << 4;
+      op = write_length (op, n_literals - 15);
+    }
+  else
+    *token = n_literals << 4;
+
+  memcpy (op, literals, n_literals);
+  op += n_literals;
+
+  if (match_len == 0)
+    return op;
+
+  *op++ = offset & 0xff;
+  *op++ = offset >> 8;
+
+  match_len -= MIN_MATCH;
+  if (match_len >= 15)
+    {
+      *token |= 15;
+      op = write_length (op, match_len - 15);
+    }
+  else
+    *token |= match_len;
+
+  return op;
+}
+
+/*
+ * _g_lz4_compress:
+ * @src: the data to compress
+ * @src_len: the length of @src
+ * @dest_len: (out): return location for the length of the result
+ *
+ * Compresses @src into a newly allocated LZ4 block.
+ *
+ * Returns: the compressed data, free with g_free()
+ */
+guint8 *
+_g_lz4_compress (const guint8 *src,
+                 gsize         src_len,
+                 gsize        *dest_len)
+{
+  guint8 *dest, *op;
+  gsize *table;
+  gsize ip, anchor;
+
+  /* worst case: all literals */
+  dest = g_malloc (src_len + src_len / 255 + 16);
+  op = dest;
+
+  table = g_new0 (gsize, 1 << HASH_BITS);
+
+  ip = 0;
+  anchor = 0;
+
+  while (ip + MF_LIMIT <= src_len)
+    {
+      guint32 sequence;
+      gsize ref, len;
+      guint h;
+
+      sequence = read32 (src + ip);
+      h = hash32 (sequence);
+      ref = table[h];       /* position + 1, or 0 */
+      table[h] = ip + 1;
+
+      if (ref == 0 || ip - (ref - 1) > MAX_OFFSET ||
+          read32 (src + ref - 1) != sequence)
+        {
+          ip++;
+          continue;
+        }
+
+      ref--;
+      len = MIN_MATCH;
+      while (ip + len < src_len - LAST_LITERALS && src[ref + len] == src[ip + len])
+        len++;
+
+      op = write_sequence (op, src + anchor, ip - anchor, ip - ref, len);
+
+      ip += len;
+      anchor = ip;
+    }
+
+  op = write_sequence (op, src + anchor, src_len - anchor, 0, 0);
+
+  g_free (table);
+
+  *dest_len = op - dest;
+
+  return dest;
+}
+
+static inline gboolean
+read_length (const guint8 **ip,
+             const guint8  *end,
+             gsize         *len)
+{
+  guint8 b;
+
+  do
+    {
+      if (*ip >= end)
+        return FALSE;
+
+      b = *(*ip)++;
+      *len += b;
+    }
+  while (b == 255);
+
+  return TRUE;
+}
+
+/*
+ * _g_lz4_decompress:
+ * @src: an LZ4 block
+ * @src_len: the length of @src
+ * @dest: the buffer for the decompressed data
+ * @dest_len: the size of the decompressed data
+ *
+ * Decompresses @src into @dest, which must be exactly as big as the
+ * decompressed data.  Malformed input is detected and never causes
+ * reads or writes outside of the buffers.
+ *
+ * Returns: %TRUE if @src was decompressed into exactly @dest_len bytes
+ */
+gboolean
+_g_lz4_decompress (const guint8 *src,
+                   gsize         src_len,
+                   guint8       *dest,
+                   gsize         dest_len)
+{
+  const guint8 *ip = src;
+  const guint8 *iend = src + src_len;
+  guint8 *op = dest;
+  guint8 *oend = dest + dest_len;
+
+  while (ip < iend)
+    {
+      const guint8 *match;
+      gsize len, offset;
+      guint8 token;
+
+      token = *ip++;
+
+      len = token >> 4;
+      if (len == 15 && !read_length (&ip, iend, &len))
+        return FALSE;
+
+      if (len > (gsize) (iend - ip) || len > (gsize) (oend - op))
+        return FALSE;
+
+      memcpy (op, ip, len);
+      op += len;
+      ip += len;
+
+      /* the last sequence has no match */
+      if (ip == iend)
+        break;
+
+      if (iend - ip < 2)
+        return FALSE;
+
+      offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+
+      if (offset == 0 || offset > (gsize) (op - dest))
+        return FALSE;
+
+      len = token & 15;
+      if (len == 15 && !read_length (&ip, iend, &len))
+        return FALSE;
+      len += MIN_MATCH;
+
+      if (len > (gsize) (oend - op))
+        return FALSE;
+
+      match = op - offset;
+      if (offset >= len)
+        {
+          memcpy (op, match, len);
+          op += len;
+        }
+      else
+        {
+          /* overlapping match, repeating the last @offset bytes */
+          while (len--)
+            *op++ = *match++;
+        }
+    }
+
+  return op == oend;
+}
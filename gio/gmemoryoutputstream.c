@@ -44,6 +44,14 @@
  *
  * As of GLib 2.34, #GMemoryOutputStream implements
  * #GPollableOutputStream.
+ *
+ * Also since GLib 2.34, a stream created with
+ * g_memory_output_stream_new_chunked() stores its data in a list of
+ * fixed-size segments instead of a single buffer that is reallocated
+ * as it grows, so that writing large amounts of data never copies
+ * what has already been written. The result can be retrieved without
+ * any copy using g_memory_output_stream_steal_chunks(), or as a single
+ * #GBytes using g_memory_output_stream_steal_as_bytes().
  */
 
 #define MIN_ARRAY_SIZE  16
@@ -54,9 +62,15 @@ enum {
   PROP_SIZE,
   PROP_DATA_SIZE,
   PROP_REALLOC_FUNCTION,
-  PROP_DESTROY_FUNCTION
+  PROP_DESTROY_FUNCTION,
+  PROP_CHUNK_SIZE
 };
 
+typedef struct {
+  guint8 *data;
+  gsize   size;
+} MemorySegment;
+
 struct _GMemoryOutputStreamPrivate {
   
   gpointer       data; /* Write buffer */
@@ -67,6 +81,11 @@ struct _GMemoryOutputStreamPrivate {
 
   GReallocFunc   realloc_fn;
   GDestroyNotify destroy;
+
+  gsize          chunk_size; /* Non-zero for chunked streams */
+  GArray        *segments; /* MemorySegment array, in chunked mode */
+  guint          seg_hint; /* Segment last looked up, and its offset */
+  gsize          seg_hint_start;
 };
 
 static void     g_memory_output_stream_set_property (GObject      *object,
@@ -125,6 +144,129 @@ G_DEFINE_TYPE_WITH_CODE (GMemoryOutputStream, g_memory_output_stream, G_TYPE_OUT
                                                 g_memory_output_stream_pollable_iface_init))
 
 
+/* Chunked mode helpers. The segments cover the offsets [0, priv->len)
+ * of the stream back to back; bytes beyond priv->valid_len are kept
+ * zeroed, as with the contiguous buffer.
+ */
+static void
+segments_free (GMemoryOutputStreamPrivate *priv,
+               guint                       first)
+{
+  guint i;
+
+  for (i = first; i < priv->segments->len; i++)
+    g_free (g_array_index (priv->segments, MemorySegment, i).data);
+
+  g_array_set_size (priv->segments, first);
+  priv->seg_hint = 0;
+  priv->seg_hint_start = 0;
+}
+
+static void
+segments_append (GMemoryOutputStreamPrivate *priv)
+{
+  MemorySegment segment;
+
+  if (!priv->segments)
+    priv->segments = g_array_new (FALSE, FALSE, sizeof (MemorySegment));
+
+  segment.data = g_malloc0 (priv->chunk_size);
+  segment.size = priv->chunk_size;
+  g_array_append_val (priv->segments, segment);
+
+  priv->len += priv->chunk_size;
+}
+
+/* Returns the index of the segment containing @offset and stores its
+ * starting offset in @start. If @offset is not smaller than priv->len,
+ * returns the number of segments and the offset of their end.
+ * Sequential writes hit the cached hint and don't rescan the array.
+ */
+static guint
+segments_find (GMemoryOutputStreamPrivate *priv,
+               gsize                       offset,
+               gsize                      *start)
+{
+  guint i;
+  gsize pos;
+
+  if (!priv->segments || priv->segments->len == 0)
+    {
+      *start = 0;
+      return 0;
+    }
+
+  if (priv->seg_hint < priv->segments->len &&
+      priv->seg_hint_start <= offset)
+    {
+      i = priv->seg_hint;
+      pos = priv->seg_hint_start;
+    }
+  else
+    {
+      i = 0;
+      pos = 0;
+    }
+
+  while (i < priv->segments->len &&
+         pos + g_array_index (priv->segments, MemorySegment, i).size <= offset)
+    {
+      pos += g_array_index (priv->segments, MemorySegment, i).size;
+      i++;
+    }
+
+  priv->seg_hint = i;
+  priv->seg_hint_start = pos;
+  *start = pos;
+
+  return i;
+}
+
+/* Forgets the segments after their memory was handed to the caller */
+static void
+segments_forget (GMemoryOutputStreamPrivate *priv)
+{
+  if (priv->segments)
+    g_array_set_size (priv->segments, 0);
+
+  priv->len = 0;
+  priv->valid_len = 0;
+  priv->pos = 0;
+  priv->seg_hint = 0;
+  priv->seg_hint_start = 0;
+}
+
+/* Merges all segments into a single one and returns its data */
+static gpointer
+segments_flatten (GMemoryOutputStreamPrivate *priv)
+{
+  MemorySegment segment;
+  gsize pos;
+  guint i;
+
+  if (!priv->segments || priv->segments->len == 0)
+    return NULL;
+
+  if (priv->segments->len == 1)
+    return g_array_index (priv->segments, MemorySegment, 0).data;
+
+  segment.data = g_malloc (priv->len);
+  segment.size = priv->len;
+
+  for (i = 0, pos = 0; i < priv->segments->len; i++)
+    {
+      MemorySegment *s = &g_array_index (priv->segments, MemorySegment, i);
+
+      memcpy (segment.data + pos, s->data, s->size);
+      pos += s->size;
+    }
+
+  segments_free (priv, 0);
+  g_array_append_val (priv->segments, segment);
+
+  return segment.data;
+}
+
 static void
 g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
 {
@@ -221,6 +363,26 @@ g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
                                                          P_("Function called with the buffer as argument when the stream is destroyed."),
                                                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
                                                          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GMemoryOutputStream:chunk-size:
+   *
+   * If non-zero, the stream stores its data in separately allocated
+   * segments of this size rather than in a single reallocated buffer.
+   * The #GMemoryOutputStream:data, #GMemoryOutputStream:realloc-function
+   * and #GMemoryOutputStream:destroy-function properties are not used
+   * for storage in that case.
+   *
+   * Since: 2.34
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CHUNK_SIZE,
+                                   g_param_spec_ulong ("chunk-size",
+                                                       P_("Chunk Size"),
+                                                       P_("Size of the segments the data is stored in, or 0 for a single buffer."),
+                                                       0, G_MAXULONG, 0,
+                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -256,6 +418,9 @@ g_memory_output_stream_set_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       priv->destroy = g_value_get_pointer (value);
       break;
+    case PROP_CHUNK_SIZE:
+      priv->chunk_size = g_value_get_ulong (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -277,7 +442,7 @@ g_memory_output_stream_get_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_DATA:
-      g_value_set_pointer (value, priv->data);
+      g_value_set_pointer (value, g_memory_output_stream_get_data (stream));
       break;
     case PROP_SIZE:
       g_value_set_ulong (value, priv->len);
@@ -291,6 +456,9 @@ g_memory_output_stream_get_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       g_value_set_pointer (value, priv->destroy);
       break;
+    case PROP_CHUNK_SIZE:
+      g_value_set_ulong (value, priv->chunk_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -309,6 +477,12 @@ g_memory_output_stream_finalize (GObject *object)
   if (priv->destroy)
     priv->destroy (priv->data);
 
+  if (priv->segments)
+    {
+      segments_free (priv, 0);
+      g_array_free (priv->segments, TRUE);
+    }
+
   G_OBJECT_CLASS (g_memory_output_stream_parent_class)->finalize (object);
 }
 
@@ -381,6 +555,37 @@ g_memory_output_stream_new (gpointer       data,
   return stream;
 }
 
+/**
+ * g_memory_output_stream_new_chunked:
+ * @chunk_size: the size of the segments to store the data in
+ *
+ * Creates a new growable #GMemoryOutputStream that stores its data
+ * in segments of @chunk_size bytes, allocated with g_malloc() as the
+ * stream grows. Unlike a stream created with g_memory_output_stream_new()
+ * and a realloc function, data that has been written is never moved,
+ * which avoids copying the whole buffer over and over when writing
+ * large amounts of data in small pieces.
+ *
+ * The data can be retrieved without copying it with
+ * g_memory_output_stream_steal_chunks(). Functions that need the
+ * data to be contiguous, such as g_memory_output_stream_get_data(),
+ * g_memory_output_stream_steal_data() and
+ * g_memory_output_stream_steal_as_bytes(), merge the segments first.
+ *
+ * Return value: A newly created #GMemoryOutputStream object.
+ *
+ * Since: 2.34
+ **/
+GOutputStream *
+g_memory_output_stream_new_chunked (gsize chunk_size)
+{
+  g_return_val_if_fail (chunk_size > 0, NULL);
+
+  return g_object_new (G_TYPE_MEMORY_OUTPUT_STREAM,
+                       "chunk-size", chunk_size,
+                       NULL);
+}
+
 /**
  * g_memory_output_stream_get_data:
  * @ostream: a #GMemoryOutputStream
@@ -390,6 +595,10 @@ g_memory_output_stream_new (gpointer       data,
  * Note that the returned pointer may become invalid on the next
  * write or truncate operation on the stream.
  *
+ * If @ostream was created with g_memory_output_stream_new_chunked(),
+ * this merges the segments written so far into a single one, which
+ * involves copying them.
+ *
  * Returns: (transfer none): pointer to the stream's data
  **/
 gpointer
@@ -397,6 +606,9 @@ g_memory_output_stream_get_data (GMemoryOutputStream *ostream)
 {
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
 
+  if (ostream->priv->chunk_size)
+    return segments_flatten (ostream->priv);
+
   return ostream->priv->data;
 }
 
@@ -453,7 +665,8 @@ g_memory_output_stream_get_data_size (GMemoryOutputStream *ostream)
  * Gets any loaded data from the @ostream. Ownership of the data
  * is transferred to the caller; when no longer needed it must be
  * freed using the free function set in @ostream's
- * #GMemoryOutputStream:destroy-function property.
+ * #GMemoryOutputStream:destroy-function property, or with g_free()
+ * if @ostream was created with g_memory_output_stream_new_chunked().
  *
  * @ostream must be closed before calling this function.
  *
@@ -469,12 +682,132 @@ g_memory_output_stream_steal_data (GMemoryOutputStream *ostream)
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
   g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
 
+  if (ostream->priv->chunk_size)
+    {
+      data = segments_flatten (ostream->priv);
+      segments_forget (ostream->priv);
+
+      return data;
+    }
+
   data = ostream->priv->data;
   ostream->priv->data = NULL;
 
   return data;
 }
 
+/**
+ * g_memory_output_stream_steal_as_bytes:
+ * @ostream: a #GMemoryOutputStream
+ *
+ * Returns data from the @ostream as a #GBytes. @ostream must be
+ * closed before calling this function.
+ *
+ * The returned #GBytes holds the first
+ * g_memory_output_stream_get_data_size() bytes of the stream's
+ * buffer, which is not copied for a contiguous stream. For a stream
+ * created with g_memory_output_stream_new_chunked(), the segments are
+ * merged into a single buffer if there is more than one; use
+ * g_memory_output_stream_steal_chunks() to avoid that copy.
+ *
+ * Returns: (transfer full): the stream's data
+ *
+ * Since: 2.34
+ **/
+GBytes *
+g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream)
+{
+  GMemoryOutputStreamPrivate *priv;
+  GBytes *result;
+  gpointer data;
+
+  g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
+  g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
+
+  priv = ostream->priv;
+
+  if (priv->chunk_size)
+    {
+      gsize size = priv->valid_len;
+
+      /* Segments past the written data don't need to be merged */
+      if (priv->segments && priv->valid_len <= priv->chunk_size)
+        segments_free (priv, MIN (priv->segments->len, 1));
+
+      data = g_memory_output_stream_steal_data (ostream);
+
+      return g_bytes_new_take (data, size);
+    }
+
+  result = g_bytes_new_with_free_func (priv->data,
+                                       priv->valid_len,
+                                       priv->destroy,
+                                       priv->data);
+  priv->data = NULL;
+
+  return result;
+}
+
+/**
+ * g_memory_output_stream_steal_chunks:
+ * @ostream: a #GMemoryOutputStream
+ *
+ * Returns the data from the @ostream as a list of #GBytes which,
+ * concatenated in order, hold the first
+ * g_memory_output_stream_get_data_size() bytes of the stream.
+ * @ostream must be closed before calling this function.
+ *
+ * For a stream created with g_memory_output_stream_new_chunked(),
+ * there is one #GBytes per segment written to and no data is copied.
+ * Other streams return their buffer as a single #GBytes, as
+ * g_memory_output_stream_steal_as_bytes() does.
+ *
+ * Returns: (transfer full) (element-type GBytes): a #GPtrArray of
+ *     #GBytes, which frees its elements when it is freed
+ *
+ * Since: 2.34
+ **/
+GPtrArray *
+g_memory_output_stream_steal_chunks (GMemoryOutputStream *ostream)
+{
+  GMemoryOutputStreamPrivate *priv;
+  GPtrArray *chunks;
+  gsize pos;
+  guint i;
+
+  g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
+  g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
+
+  priv = ostream->priv;
+  chunks = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+
+  if (!priv->chunk_size)
+    {
+      g_ptr_array_add (chunks, g_memory_output_stream_steal_as_bytes (ostream));
+      return chunks;
+    }
+
+  if (!priv->segments)
+    return chunks;
+
+  for (i = 0, pos = 0; i < priv->segments->len && pos < priv->valid_len; i++)
+    {
+      MemorySegment *segment = &g_array_index (priv->segments, MemorySegment, i);
+
+      g_ptr_array_add (chunks, g_bytes_new_take (segment->data,
+                                                 MIN (segment->size,
+                                                      priv->valid_len - pos)));
+      pos += segment->size;
+    }
+
+  /* The segments up to i now belong to the returned bytes */
+  g_array_remove_range (priv->segments, 0, i);
+  segments_free (priv, 0);
+  segments_forget (priv);
+
+  return chunks;
+}
+
 static gboolean
 array_resize (GMemoryOutputStream  *ostream,
               gsize                 size,
@@ -560,6 +893,36 @@ g_memory_output_stream_write (GOutputStream  *stream,
   if (count == 0)
     return 0;
 
+  if (priv->chunk_size)
+    {
+      gsize start, written;
+      guint i;
+
+      if (priv->pos + count < priv->pos)
+        goto overflow;
+
+      while (priv->pos + count > priv->len)
+        segments_append (priv);
+
+      i = segments_find (priv, priv->pos, &start);
+      for (written = 0; written < count; i++)
+        {
+          MemorySegment *segment = &g_array_index (priv->segments, MemorySegment, i);
+          gsize offset = priv->pos - start;
+          gsize n = MIN (segment->size - offset, count - written);
+
+          memcpy (segment->data + offset, (const guint8 *)buffer + written, n);
+          written += n;
+          priv->pos += n;
+          start += segment->size;
+        }
+
+      if (priv->pos > priv->valid_len)
+        priv->valid_len = priv->pos;
+
+      return count;
+    }
+
   /* Check for address space overflow, but only if the buffer is resizable.
      Otherwise we just do a short write and don't worry. */
   if (priv->realloc_fn && priv->pos + count < priv->pos)
@@ -740,7 +1103,40 @@ g_memory_output_stream_can_truncate (GSeekable *seekable)
   ostream = G_MEMORY_OUTPUT_STREAM (seekable);
   priv = ostream->priv;
 
-  return priv->realloc_fn != NULL;
+  return priv->chunk_size != 0 || priv->realloc_fn != NULL;
+}
+
+static void
+segments_truncate (GMemoryOutputStreamPrivate *priv,
+                   gsize                       size)
+{
+  MemorySegment *segment;
+  gsize start;
+  guint i;
+
+  if (size >= priv->len)
+    {
+      while (priv->len < size)
+        segments_append (priv);
+    }
+  else if (size == 0)
+    {
+      segments_free (priv, 0);
+      priv->len = 0;
+    }
+  else
+    {
+      /* Keep the segment holding the last byte, zeroing its tail */
+      i = segments_find (priv, size - 1, &start);
+      segments_free (priv, i + 1);
+
+      segment = &g_array_index (priv->segments, MemorySegment, i);
+      memset (segment->data + (size - start), 0, segment->size - (size - start));
+      priv->len = start + segment->size;
+    }
+
+  if (priv->valid_len > size)
+    priv->valid_len = size;
 }
 
 static gboolean
@@ -751,6 +1147,12 @@ g_memory_output_stream_truncate (GSeekable     *seekable,
 {
   GMemoryOutputStream *ostream = G_MEMORY_OUTPUT_STREAM (seekable);
 
+  if (ostream->priv->chunk_size)
+    {
+      segments_truncate (ostream->priv, offset);
+      return TRUE;
+    }
+
   if (!array_resize (ostream, offset, FALSE, error))
     return FALSE;
 
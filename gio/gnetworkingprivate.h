@@ -122,6 +122,17 @@ gchar *  _g_uri_from_authority             (const gchar      *protocol,
 					    guint             port,
 					    const gchar      *userinfo);
 
+gssize   _g_socket_send_message_with_blocking (GSocket                *socket,
+                                               GSocketAddress         *address,
+                                               GOutputVector          *vectors,
+                                               gint                    num_vectors,
+                                               GSocketControlMessage **messages,
+                                               gint                    num_messages,
+                                               gint                    flags,
+                                               gboolean                blocking,
+                                               GCancellable           *cancellable,
+                                               GError                **error);
+
 G_END_DECLS
 
 #endif /* __G_NETWORKINGPRIVATE_H__ */
@@ -21,6 +21,14 @@
  */
 
 #include "config.h"
+#ifdef HAVE_SPLICE
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 #include "goutputstream.h"
 #include "gcancellable.h"
 #include "gasyncresult.h"
@@ -29,6 +37,10 @@
 #include "gioerror.h"
 #include "glibintl.h"
 #include "gpollableoutputstream.h"
+#include "gasynchelper.h"
+#ifdef HAVE_SPLICE
+#include "gfiledescriptorbased.h"
+#endif
 
 /**
  * SECTION:goutputstream
@@ -39,8 +51,14 @@
  * to close a stream (g_output_stream_close()) and to flush pending writes
  * (g_output_stream_flush()). 
  *
+ * To write the contents of several buffers at once, use
+ * g_output_stream_writev().
+ *
  * To copy the content of an input stream to an output stream without 
  * manually handling the reads and writes, use g_output_stream_splice(). 
+ * When both streams are backed by file descriptors this moves the data
+ * inside the kernel where possible, without copying it through user
+ * space.
  *
  * All of these functions have async variants too.
  **/
@@ -95,6 +113,21 @@ static void     g_output_stream_real_close_async   (GOutputStream             *s
 static gboolean g_output_stream_real_close_finish  (GOutputStream             *stream,
 						    GAsyncResult              *result,
 						    GError                   **error);
+static gssize   g_output_stream_real_writev        (GOutputStream             *stream,
+						    const GOutputVector       *vectors,
+						    gsize                      n_vectors,
+						    GCancellable              *cancellable,
+						    GError                   **error);
+static void     g_output_stream_real_writev_async  (GOutputStream             *stream,
+						    const GOutputVector       *vectors,
+						    gsize                      n_vectors,
+						    int                        io_priority,
+						    GCancellable              *cancellable,
+						    GAsyncReadyCallback        callback,
+						    gpointer                   user_data);
+static gssize   g_output_stream_real_writev_finish (GOutputStream             *stream,
+						    GAsyncResult              *result,
+						    GError                   **error);
 static gboolean _g_output_stream_close_internal    (GOutputStream             *stream,
                                                     GCancellable              *cancellable,
                                                     GError                   **error);
@@ -132,6 +165,9 @@ g_output_stream_class_init (GOutputStreamClass *klass)
   
   klass->write_async = g_output_stream_real_write_async;
   klass->write_finish = g_output_stream_real_write_finish;
+  klass->writev_fn = g_output_stream_real_writev;
+  klass->writev_async = g_output_stream_real_writev_async;
+  klass->writev_finish = g_output_stream_real_writev_finish;
   klass->splice_async = g_output_stream_real_splice_async;
   klass->splice_finish = g_output_stream_real_splice_finish;
   klass->flush_async = g_output_stream_real_flush_async;
@@ -292,6 +328,203 @@ g_output_stream_write_all (GOutputStream  *stream,
   return TRUE;
 }
 
+static gboolean
+check_vectors_size (const GOutputVector  *vectors,
+		    gsize                 n_vectors,
+		    gsize                *total,
+		    GError              **error)
+{
+  gsize i;
+
+  *total = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      *total += vectors[i].size;
+      if (((gssize) *total) < 0 || *total < vectors[i].size)
+	{
+	  g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		       _("Too large count value passed to %s"), G_STRFUNC);
+	  return FALSE;
+	}
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_output_stream_writev:
+ * @stream: a #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write
+ * @n_vectors: the number of elements in @vectors
+ * @cancellable: (allow-none): optional cancellable object
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Tries to write the data in @vectors into the stream, in order, as
+ * if they had been concatenated into a single buffer and passed to
+ * g_output_stream_write(). Will block during the operation.
+ *
+ * Streams that can write several buffers at once (such as file
+ * descriptor and socket based streams) do so with a single system
+ * call; others fall back to writing one buffer at a time.
+ *
+ * If the total size of @vectors is 0, returns 0 and does nothing. A
+ * total size larger than %G_MAXSSIZE will cause a
+ * %G_IO_ERROR_INVALID_ARGUMENT error.
+ *
+ * On success, the number of bytes written to the stream is returned.
+ * As with g_output_stream_write(), this may be less than the total
+ * size of @vectors; use g_output_stream_writev_all() to write
+ * everything.
+ *
+ * On error -1 is returned and @error is set accordingly.
+ *
+ * Virtual: writev_fn
+ *
+ * Return value: Number of bytes written, or -1 on error
+ *
+ * Since: 2.34
+ **/
+gssize
+g_output_stream_writev (GOutputStream        *stream,
+			const GOutputVector  *vectors,
+			gsize                 n_vectors,
+			GCancellable         *cancellable,
+			GError              **error)
+{
+  GOutputStreamClass *class;
+  gsize total;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+
+  if (!check_vectors_size (vectors, n_vectors, &total, error))
+    return -1;
+
+  if (total == 0)
+    return 0;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  if (class->writev_fn == g_output_stream_real_writev &&
+      class->write_fn == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Output stream doesn't implement write"));
+      return -1;
+    }
+
+  if (!g_output_stream_set_pending (stream, error))
+    return -1;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = class->writev_fn (stream, vectors, n_vectors, cancellable, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  g_output_stream_clear_pending (stream);
+
+  return res;
+}
+
+/**
+ * g_output_stream_writev_all:
+ * @stream: a #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write
+ * @n_vectors: the number of elements in @vectors
+ * @bytes_written: (out): location to store the number of bytes that was
+ *     written to the stream
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore.
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Tries to write all the data in @vectors into the stream. Will block
+ * during the operation.
+ *
+ * This function is similar to g_output_stream_writev(), except it tries
+ * to write as many bytes as requested, only stopping on an error. It is
+ * to g_output_stream_writev() what g_output_stream_write_all() is to
+ * g_output_stream_write().
+ *
+ * If there is an error during the operation %FALSE is returned and @error
+ * is set to indicate the error status, @bytes_written is updated to contain
+ * the number of bytes written into the stream before the error occurred.
+ *
+ * Return value: %TRUE on success, %FALSE if there was an error
+ *
+ * Since: 2.34
+ **/
+gboolean
+g_output_stream_writev_all (GOutputStream        *stream,
+			    const GOutputVector  *vectors,
+			    gsize                 n_vectors,
+			    gsize                *bytes_written,
+			    GCancellable         *cancellable,
+			    GError              **error)
+{
+  GOutputVector *copy = NULL;
+  gsize _bytes_written;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, FALSE);
+
+  _bytes_written = 0;
+  while (n_vectors > 0)
+    {
+      if (vectors[0].size == 0)
+	{
+	  vectors++;
+	  n_vectors--;
+	  continue;
+	}
+
+      res = g_output_stream_writev (stream, vectors, n_vectors,
+				    cancellable, error);
+      if (res == -1)
+	{
+	  if (bytes_written)
+	    *bytes_written = _bytes_written;
+	  g_free (copy);
+	  return FALSE;
+	}
+
+      if (res == 0)
+	g_warning ("Write returned zero without error");
+
+      _bytes_written += res;
+
+      while (n_vectors > 0 && (gsize) res >= vectors[0].size)
+	{
+	  res -= vectors[0].size;
+	  vectors++;
+	  n_vectors--;
+	}
+
+      if (res > 0)
+	{
+	  /* The caller's array is const, so adjust the partially
+	   * written vector in a private copy of the remainder.
+	   */
+	  if (copy == NULL)
+	    {
+	      copy = g_memdup (vectors, n_vectors * sizeof (GOutputVector));
+	      vectors = copy;
+	    }
+	  copy[vectors - copy].buffer = (const guint8 *) vectors[0].buffer + res;
+	  copy[vectors - copy].size -= res;
+	}
+    }
+
+  if (bytes_written)
+    *bytes_written = _bytes_written;
+
+  g_free (copy);
+  return TRUE;
+}
+
 /**
  * g_output_stream_flush:
  * @stream: a #GOutputStream.
@@ -353,6 +586,11 @@ g_output_stream_flush (GOutputStream  *stream,
  *
  * Splices an input stream into an output stream.
  *
+ * If both streams are backed by file descriptors (see
+ * #GFileDescriptorBased), the data is moved with sendfile() or
+ * splice() on systems that have them, without being copied through
+ * user space.
+ *
  * Returns: a #gssize containing the size of the data spliced, or
  *     -1 if an error occurred. Note that if the number of bytes
  *     spliced is greater than %G_MAXSSIZE, then that will be
@@ -397,6 +635,253 @@ g_output_stream_splice (GOutputStream             *stream,
   return bytes_copied;
 }
 
+#ifdef HAVE_SPLICE
+
+/* A pipe holds 64k by default, so there is no point in moving more
+ * than that through it at once. sendfile() has no such limit.
+ */
+#define SPLICE_CHUNK_SIZE   (64 * 1024)
+#define SENDFILE_CHUNK_SIZE (1024 * 1024)
+
+static gboolean
+splice_wait (int            fd,
+	     GIOCondition   condition,
+	     GCancellable  *cancellable,
+	     GError       **error)
+{
+  GPollFD poll_fds[2];
+  int nfds;
+  int poll_ret;
+
+  poll_fds[0].fd = fd;
+  poll_fds[0].events = condition;
+
+  if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+    nfds = 2;
+  else
+    nfds = 1;
+
+  poll_fds[0].revents = poll_fds[1].revents = 0;
+  do
+    poll_ret = g_poll (poll_fds, nfds, -1);
+  while (poll_ret == -1 && errno == EINTR);
+
+  if (nfds == 2)
+    g_cancellable_release_fd (cancellable);
+
+  if (poll_ret == -1)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR,
+		   g_io_error_from_errno (errsv),
+		   _("Error splicing file: %s"),
+		   g_strerror (errsv));
+      return FALSE;
+    }
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+static void
+set_splice_error (int       errsv,
+		  gboolean  can_fall_back,
+		  GError  **error)
+{
+  if (can_fall_back && (errsv == EINVAL || errsv == ENOSYS))
+    g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			 _("Splice not supported"));
+  else
+    g_set_error (error, G_IO_ERROR,
+		 g_io_error_from_errno (errsv),
+		 _("Error splicing file: %s"),
+		 g_strerror (errsv));
+}
+
+/* Writes out whatever is left in @pipe_fd when @out_fd turns out not
+ * to accept splice(), so that no data read from the source is lost.
+ */
+static gboolean
+drain_pipe (int            pipe_fd,
+	    gsize          count,
+	    int            out_fd,
+	    gsize         *bytes_copied,
+	    GCancellable  *cancellable,
+	    GError       **error)
+{
+  char buffer[8192], *p;
+  gssize n_read, n_written;
+
+  while (count > 0)
+    {
+      n_read = read (pipe_fd, buffer, MIN (count, sizeof (buffer)));
+      if (n_read == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  set_splice_error (errno, FALSE, error);
+	  return FALSE;
+	}
+      count -= n_read;
+
+      p = buffer;
+      while (n_read > 0)
+	{
+	  n_written = write (out_fd, p, n_read);
+	  if (n_written == -1)
+	    {
+	      int errsv = errno;
+
+	      if (errsv == EINTR)
+		continue;
+	      if (errsv == EAGAIN)
+		{
+		  if (!splice_wait (out_fd, G_IO_OUT, cancellable, error))
+		    return FALSE;
+		  continue;
+		}
+	      set_splice_error (errsv, FALSE, error);
+	      return FALSE;
+	    }
+
+	  p += n_written;
+	  n_read -= n_written;
+	  *bytes_copied += n_written;
+	}
+    }
+
+  return TRUE;
+}
+
+/* Copies everything from @in_fd to @out_fd without going through
+ * user space, first with sendfile() (which needs a source that can
+ * be mmapped, i.e. a regular file) and then with splice() through a
+ * pipe. Returns %G_IO_ERROR_NOT_SUPPORTED if the kernel can't do
+ * either for these descriptors; by then everything consumed from
+ * @in_fd has been written and counted in @bytes_copied, so the caller
+ * can carry on with a plain read/write loop.
+ */
+static gboolean
+splice_fds (int            in_fd,
+	    int            out_fd,
+	    gsize         *bytes_copied,
+	    GCancellable  *cancellable,
+	    GError       **error)
+{
+  int pipe_fds[2] = { -1, -1 };
+  gboolean res = FALSE;
+  gssize n_read, n_written;
+
+#ifdef HAVE_SYS_SENDFILE_H
+  while (TRUE)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	return FALSE;
+
+      n_written = sendfile (out_fd, in_fd, NULL, SENDFILE_CHUNK_SIZE);
+      if (n_written == 0)
+	return TRUE;
+
+      if (n_written > 0)
+	{
+	  *bytes_copied += n_written;
+	  continue;
+	}
+
+      if (errno == EINTR)
+	continue;
+      if (errno == EAGAIN)
+	{
+	  if (!splice_wait (out_fd, G_IO_OUT, cancellable, error))
+	    return FALSE;
+	  continue;
+	}
+      if (*bytes_copied == 0 && (errno == EINVAL || errno == ENOSYS))
+	break;
+
+      set_splice_error (errno, FALSE, error);
+      return FALSE;
+    }
+#endif
+
+  if (pipe (pipe_fds) != 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			   _("Splice not supported"));
+      return FALSE;
+    }
+
+  while (TRUE)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	goto out;
+
+      n_read = splice (in_fd, NULL, pipe_fds[1], NULL, SPLICE_CHUNK_SIZE,
+		       SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (n_read == 0)
+	break;
+
+      if (n_read == -1)
+	{
+	  int errsv = errno;
+
+	  if (errsv == EINTR)
+	    continue;
+	  if (errsv == EAGAIN)
+	    {
+	      if (!splice_wait (in_fd, G_IO_IN, cancellable, error))
+		goto out;
+	      continue;
+	    }
+
+	  set_splice_error (errsv, *bytes_copied == 0, error);
+	  goto out;
+	}
+
+      while (n_read > 0)
+	{
+	  n_written = splice (pipe_fds[0], NULL, out_fd, NULL, n_read,
+			      SPLICE_F_MOVE | SPLICE_F_MORE);
+	  if (n_written == -1)
+	    {
+	      int errsv = errno;
+
+	      if (errsv == EINTR)
+		continue;
+	      if (errsv == EAGAIN)
+		{
+		  if (!splice_wait (out_fd, G_IO_OUT, cancellable, error))
+		    goto out;
+		  continue;
+		}
+	      if (errsv == EINVAL || errsv == ENOSYS)
+		{
+		  if (drain_pipe (pipe_fds[0], n_read, out_fd,
+				  bytes_copied, cancellable, error))
+		    set_splice_error (errsv, TRUE, error);
+		  goto out;
+		}
+
+	      set_splice_error (errsv, FALSE, error);
+	      goto out;
+	    }
+
+	  n_read -= n_written;
+	  *bytes_copied += n_written;
+	}
+    }
+
+  res = TRUE;
+
+ out:
+  close (pipe_fds[0]);
+  close (pipe_fds[1]);
+
+  return res;
+}
+
+#endif /* HAVE_SPLICE */
+
 static gssize
 g_output_stream_real_splice (GOutputStream             *stream,
                              GInputStream              *source,
@@ -416,10 +901,45 @@ g_output_stream_real_splice (GOutputStream             *stream,
       g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
                            _("Output stream doesn't implement write"));
       res = FALSE;
-      goto notsupported;
+      goto out;
     }
 
   res = TRUE;
+
+#ifdef HAVE_SPLICE
+  if (G_IS_FILE_DESCRIPTOR_BASED (source) &&
+      G_IS_FILE_DESCRIPTOR_BASED (stream))
+    {
+      GError *splice_error = NULL;
+
+      if (!g_input_stream_set_pending (source, error))
+	{
+	  res = FALSE;
+	  goto out;
+	}
+
+      res = splice_fds (g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (source)),
+			g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (stream)),
+			&bytes_copied, cancellable, &splice_error);
+
+      g_input_stream_clear_pending (source);
+
+      if (bytes_copied > G_MAXSSIZE)
+	bytes_copied = G_MAXSSIZE;
+
+      if (res || !g_error_matches (splice_error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+	{
+	  if (!res)
+	    g_propagate_error (error, splice_error);
+	  goto out;
+	}
+
+      /* Fall back to copying */
+      g_clear_error (&splice_error);
+      res = TRUE;
+    }
+#endif
+
   do
     {
       n_read = g_input_stream_read (source, buffer, sizeof (buffer), cancellable, error);
@@ -452,7 +972,7 @@ g_output_stream_real_splice (GOutputStream             *stream,
     }
   while (res);
 
- notsupported:
+ out:
   if (!res)
     error = NULL; /* Ignore further errors */
 
@@ -809,6 +1329,121 @@ g_output_stream_write_finish (GOutputStream  *stream,
   return class->write_finish (stream, result, error);
 }
 
+/**
+ * g_output_stream_writev_async:
+ * @stream: A #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write
+ * @n_vectors: the number of elements in @vectors
+ * @io_priority: the io priority of the request.
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore.
+ * @callback: (scope async): callback to call when the request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Request an asynchronous write of the data in @vectors into the
+ * stream. When the operation is finished @callback will be called.
+ * You can then call g_output_stream_writev_finish() to get the result
+ * of the operation.
+ *
+ * This is the asynchronous version of g_output_stream_writev(), and
+ * behaves like g_output_stream_write_async() otherwise. The @vectors
+ * array itself is copied, but the buffers it points to must stay
+ * valid until the operation has finished.
+ *
+ * Since: 2.34
+ **/
+void
+g_output_stream_writev_async (GOutputStream        *stream,
+			      const GOutputVector  *vectors,
+			      gsize                 n_vectors,
+			      int                   io_priority,
+			      GCancellable         *cancellable,
+			      GAsyncReadyCallback   callback,
+			      gpointer              user_data)
+{
+  GOutputStreamClass *class;
+  GSimpleAsyncResult *simple;
+  GError *error = NULL;
+  gsize total;
+
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (vectors != NULL || n_vectors == 0);
+
+  if (!check_vectors_size (vectors, n_vectors, &total, &error))
+    {
+      g_simple_async_report_take_gerror_in_idle (G_OBJECT (stream),
+						 callback,
+						 user_data,
+						 error);
+      return;
+    }
+
+  if (total == 0)
+    {
+      simple = g_simple_async_result_new (G_OBJECT (stream),
+					  callback,
+					  user_data,
+					  g_output_stream_writev_async);
+      g_simple_async_result_complete_in_idle (simple);
+      g_object_unref (simple);
+      return;
+    }
+
+  if (!g_output_stream_set_pending (stream, &error))
+    {
+      g_simple_async_report_take_gerror_in_idle (G_OBJECT (stream),
+						 callback,
+						 user_data,
+						 error);
+      return;
+    }
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  stream->priv->outstanding_callback = callback;
+  g_object_ref (stream);
+  class->writev_async (stream, vectors, n_vectors, io_priority, cancellable,
+		       async_ready_callback_wrapper, user_data);
+}
+
+/**
+ * g_output_stream_writev_finish:
+ * @stream: a #GOutputStream.
+ * @result: a #GAsyncResult.
+ * @error: a #GError location to store the error occurring, or %NULL to
+ * ignore.
+ *
+ * Finishes a stream writev operation.
+ *
+ * Returns: a #gssize containing the number of bytes written to the stream.
+ *
+ * Since: 2.34
+ **/
+gssize
+g_output_stream_writev_finish (GOutputStream  *stream,
+			       GAsyncResult   *result,
+			       GError        **error)
+{
+  GSimpleAsyncResult *simple;
+  GOutputStreamClass *class;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (G_IS_ASYNC_RESULT (result), -1);
+
+  if (G_IS_SIMPLE_ASYNC_RESULT (result))
+    {
+      simple = G_SIMPLE_ASYNC_RESULT (result);
+      if (g_simple_async_result_propagate_error (simple, error))
+	return -1;
+
+      /* Special case writes of 0 bytes */
+      if (g_simple_async_result_get_source_tag (simple) == g_output_stream_writev_async)
+	return 0;
+    }
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+  return class->writev_finish (stream, result, error);
+}
+
 typedef struct {
   GInputStream *source;
   gpointer user_data;
@@ -1365,7 +2000,9 @@ g_output_stream_real_write_async (GOutputStream       *stream,
       g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (stream)))
     write_async_pollable (G_POLLABLE_OUTPUT_STREAM (stream), res);
   else
-    g_simple_async_result_run_in_thread (res, write_async_thread, io_priority, cancellable);
+    _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                               write_async_thread, io_priority,
+                                               cancellable);
   g_object_unref (res);
 }
 
@@ -1382,6 +2019,176 @@ g_output_stream_real_write_finish (GOutputStream  *stream,
   return op->count_written;
 }
 
+static gssize
+g_output_stream_real_writev (GOutputStream        *stream,
+			     const GOutputVector  *vectors,
+			     gsize                 n_vectors,
+			     GCancellable         *cancellable,
+			     GError              **error)
+{
+  GOutputStreamClass *class;
+  gsize bytes_written;
+  gssize res;
+  gsize i;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  bytes_written = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size == 0)
+	continue;
+
+      /* Ignore errors once some data has been written */
+      res = class->write_fn (stream, vectors[i].buffer, vectors[i].size,
+			     cancellable, bytes_written > 0 ? NULL : error);
+      if (res < 0)
+	return bytes_written > 0 ? (gssize) bytes_written : -1;
+
+      bytes_written += res;
+      if ((gsize) res < vectors[i].size)
+	break;
+    }
+
+  return bytes_written;
+}
+
+typedef struct {
+  GOutputVector      *vectors;
+  gsize               n_vectors;
+  gssize              count_written;
+
+  GCancellable       *cancellable;
+  gint                io_priority;
+  gboolean            need_idle;
+} WritevData;
+
+static void
+writev_data_free (WritevData *op)
+{
+  g_free (op->vectors);
+  if (op->cancellable)
+    g_object_unref (op->cancellable);
+  g_slice_free (WritevData, op);
+}
+
+static void
+writev_async_thread (GSimpleAsyncResult *res,
+		     GObject            *object,
+		     GCancellable       *cancellable)
+{
+  WritevData *op;
+  GOutputStreamClass *class;
+  GError *error = NULL;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (object);
+  op = g_simple_async_result_get_op_res_gpointer (res);
+  op->count_written = class->writev_fn (G_OUTPUT_STREAM (object),
+					op->vectors, op->n_vectors,
+					cancellable, &error);
+  if (op->count_written == -1)
+    g_simple_async_result_take_error (res, error);
+}
+
+static void writev_async_pollable (GPollableOutputStream *stream,
+				   GSimpleAsyncResult    *result);
+
+static gboolean
+writev_async_pollable_ready (GPollableOutputStream *stream,
+			     gpointer               user_data)
+{
+  GSimpleAsyncResult *result = user_data;
+
+  writev_async_pollable (stream, result);
+  return FALSE;
+}
+
+static void
+writev_async_pollable (GPollableOutputStream *stream,
+		       GSimpleAsyncResult    *result)
+{
+  GError *error = NULL;
+  WritevData *op = g_simple_async_result_get_op_res_gpointer (result);
+
+  if (g_cancellable_set_error_if_cancelled (op->cancellable, &error))
+    op->count_written = -1;
+  else
+    {
+      op->count_written = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream)->
+	writev_nonblocking (stream, op->vectors, op->n_vectors, &error);
+    }
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+      GSource *source;
+
+      g_error_free (error);
+      op->need_idle = FALSE;
+
+      source = g_pollable_output_stream_create_source (stream, op->cancellable);
+      g_source_set_callback (source,
+			     (GSourceFunc) writev_async_pollable_ready,
+			     g_object_ref (result), g_object_unref);
+      g_source_set_priority (source, op->io_priority);
+      g_source_attach (source, g_main_context_get_thread_default ());
+      g_source_unref (source);
+      return;
+    }
+
+  if (op->count_written == -1)
+    g_simple_async_result_take_error (result, error);
+
+  if (op->need_idle)
+    g_simple_async_result_complete_in_idle (result);
+  else
+    g_simple_async_result_complete (result);
+}
+
+static void
+g_output_stream_real_writev_async (GOutputStream        *stream,
+				   const GOutputVector  *vectors,
+				   gsize                 n_vectors,
+				   int                   io_priority,
+				   GCancellable         *cancellable,
+				   GAsyncReadyCallback   callback,
+				   gpointer              user_data)
+{
+  GSimpleAsyncResult *res;
+  WritevData *op;
+
+  op = g_slice_new0 (WritevData);
+  res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data,
+				   g_output_stream_real_writev_async);
+  g_simple_async_result_set_op_res_gpointer (res, op, (GDestroyNotify) writev_data_free);
+  op->vectors = g_memdup (vectors, n_vectors * sizeof (GOutputVector));
+  op->n_vectors = n_vectors;
+  op->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  op->io_priority = io_priority;
+  op->need_idle = TRUE;
+
+  if (G_IS_POLLABLE_OUTPUT_STREAM (stream) &&
+      g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (stream)))
+    writev_async_pollable (G_POLLABLE_OUTPUT_STREAM (stream), res);
+  else
+    _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                               writev_async_thread, io_priority,
+                                               cancellable);
+  g_object_unref (res);
+}
+
+static gssize
+g_output_stream_real_writev_finish (GOutputStream  *stream,
+				    GAsyncResult   *result,
+				    GError        **error)
+{
+  GSimpleAsyncResult *simple = G_SIMPLE_ASYNC_RESULT (result);
+  WritevData *op;
+
+  g_warn_if_fail (g_simple_async_result_get_source_tag (simple) == g_output_stream_real_writev_async);
+  op = g_simple_async_result_get_op_res_gpointer (simple);
+  return op->count_written;
+}
+
 typedef struct {
   GInputStream *source;
   GOutputStreamSpliceFlags flags;
@@ -1432,7 +2239,9 @@ g_output_stream_real_splice_async (GOutputStream             *stream,
   /* TODO: In the case where both source and destintion have
      non-threadbased async calls we can use a true async copy here */
   
-  g_simple_async_result_run_in_thread (res, splice_async_thread, io_priority, cancellable);
+  _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                             splice_async_thread, io_priority,
+                                             cancellable);
   g_object_unref (res);
 }
 
@@ -1479,7 +2288,9 @@ g_output_stream_real_flush_async (GOutputStream       *stream,
 
   res = g_simple_async_result_new (G_OBJECT (stream), callback, user_data, g_output_stream_real_write_async);
   
-  g_simple_async_result_run_in_thread (res, flush_async_thread, io_priority, cancellable);
+  _g_simple_async_result_run_in_thread_pool (res, G_IO_SCHEDULER_POOL_DATA,
+                                             flush_async_thread, io_priority,
+                                             cancellable);
   g_object_unref (res);
 }
 
@@ -47,12 +47,17 @@ static gssize   g_pollable_input_stream_default_read_nonblocking (GPollableInput
 								  void                  *buffer,
 								  gsize                  count,
 								  GError               **error);
+static gssize   g_pollable_input_stream_default_readv_nonblocking (GPollableInputStream  *stream,
+								   GInputVector          *vectors,
+								   gsize                  n_vectors,
+								   GError               **error);
 
 static void
 g_pollable_input_stream_default_init (GPollableInputStreamInterface *iface)
 {
-  iface->can_poll         = g_pollable_input_stream_default_can_poll;
-  iface->read_nonblocking = g_pollable_input_stream_default_read_nonblocking;
+  iface->can_poll          = g_pollable_input_stream_default_can_poll;
+  iface->read_nonblocking  = g_pollable_input_stream_default_read_nonblocking;
+  iface->readv_nonblocking = g_pollable_input_stream_default_readv_nonblocking;
 }
 
 static gboolean
@@ -219,3 +224,98 @@ g_pollable_input_stream_read_nonblocking (GPollableInputStream  *stream,
 
   return res;
 }
+
+static gssize
+g_pollable_input_stream_default_readv_nonblocking (GPollableInputStream  *stream,
+						   GInputVector          *vectors,
+						   gsize                  n_vectors,
+						   GError               **error)
+{
+  GPollableInputStreamInterface *iface;
+  gsize bytes_read;
+  gssize res;
+  gsize i;
+
+  iface = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream);
+
+  bytes_read = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size == 0)
+	continue;
+
+      /* Ignore errors once some data has been read */
+      res = iface->read_nonblocking (stream, vectors[i].buffer, vectors[i].size,
+				     bytes_read > 0 ? NULL : error);
+      if (res < 0)
+	return bytes_read > 0 ? (gssize) bytes_read : -1;
+
+      bytes_read += res;
+      if ((gsize) res < vectors[i].size)
+	break;
+    }
+
+  return bytes_read;
+}
+
+/**
+ * g_pollable_input_stream_readv_nonblocking:
+ * @stream: a #GPollableInputStream
+ * @vectors: (array length=n_vectors): the buffers to read data into
+ * @n_vectors: the number of elements in @vectors
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Attempts to read data from @stream into @vectors, filling them in
+ * order, as with g_input_stream_readv(). If @stream is not currently
+ * readable, this will immediately return %G_IO_ERROR_WOULD_BLOCK, as
+ * g_pollable_input_stream_read_nonblocking() does.
+ *
+ * Virtual: readv_nonblocking
+ * Return value: the number of bytes read, or -1 on error (including
+ *   %G_IO_ERROR_WOULD_BLOCK).
+ *
+ * Since: 2.34
+ */
+gssize
+g_pollable_input_stream_readv_nonblocking (GPollableInputStream  *stream,
+					   GInputVector          *vectors,
+					   gsize                  n_vectors,
+					   GCancellable          *cancellable,
+					   GError               **error)
+{
+  gsize total, i;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_POLLABLE_INPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+  total = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      total += vectors[i].size;
+      if (((gssize) total) < 0 || total < vectors[i].size)
+	{
+	  g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		       _("Too large count value passed to %s"), G_STRFUNC);
+	  return -1;
+	}
+    }
+
+  if (total == 0)
+    return 0;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream)->
+    readv_nonblocking (stream, vectors, n_vectors, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  return res;
+}
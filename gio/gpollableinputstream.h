@@ -51,6 +51,8 @@ typedef struct _GPollableInputStreamInterface GPollableInputStreamInterface;
  * @create_source: Creates a #GSource to poll the stream
  * @read_nonblocking: Does a non-blocking read or returns
  *   %G_IO_ERROR_WOULD_BLOCK
+ * @readv_nonblocking: Does a non-blocking vectored read or returns
+ *   %G_IO_ERROR_WOULD_BLOCK. Since 2.34
  *
  * The interface for pollable input streams.
  *
@@ -63,6 +65,10 @@ typedef struct _GPollableInputStreamInterface GPollableInputStreamInterface;
  * implementation may return %TRUE when the stream is not actually
  * readable.
  *
+ * The default implementation of @readv_nonblocking calls
+ * @read_nonblocking for each vector in turn, until one of them is
+ * not filled completely.
+ *
  * Since: 2.28
  */
 struct _GPollableInputStreamInterface
@@ -79,6 +85,10 @@ struct _GPollableInputStreamInterface
 				    void                  *buffer,
 				    gsize                  count,
 				    GError               **error);
+  gssize       (*readv_nonblocking) (GPollableInputStream *stream,
+				     GInputVector         *vectors,
+				     gsize                 n_vectors,
+				     GError              **error);
 };
 
 GType    g_pollable_input_stream_get_type         (void) G_GNUC_CONST;
@@ -94,6 +104,12 @@ gssize   g_pollable_input_stream_read_nonblocking (GPollableInputStream  *stream
 						   gsize                  count,
 						   GCancellable          *cancellable,
 						   GError               **error);
+GLIB_AVAILABLE_IN_2_34
+gssize   g_pollable_input_stream_readv_nonblocking (GPollableInputStream  *stream,
+						    GInputVector          *vectors,
+						    gsize                  n_vectors,
+						    GCancellable          *cancellable,
+						    GError               **error);
 
 G_END_DECLS
 
@@ -48,12 +48,17 @@ static gssize   g_pollable_output_stream_default_write_nonblocking (GPollableOut
 								    const void             *buffer,
 								    gsize                   count,
 								    GError                **error);
+static gssize   g_pollable_output_stream_default_writev_nonblocking (GPollableOutputStream  *stream,
+								     const GOutputVector    *vectors,
+								     gsize                   n_vectors,
+								     GError                **error);
 
 static void
 g_pollable_output_stream_default_init (GPollableOutputStreamInterface *iface)
 {
-  iface->can_poll          = g_pollable_output_stream_default_can_poll;
-  iface->write_nonblocking = g_pollable_output_stream_default_write_nonblocking;
+  iface->can_poll           = g_pollable_output_stream_default_can_poll;
+  iface->write_nonblocking  = g_pollable_output_stream_default_write_nonblocking;
+  iface->writev_nonblocking = g_pollable_output_stream_default_writev_nonblocking;
 }
 
 static gboolean
@@ -220,3 +225,98 @@ g_pollable_output_stream_write_nonblocking (GPollableOutputStream  *stream,
 
   return res;
 }
+
+static gssize
+g_pollable_output_stream_default_writev_nonblocking (GPollableOutputStream  *stream,
+						     const GOutputVector    *vectors,
+						     gsize                   n_vectors,
+						     GError                **error)
+{
+  GPollableOutputStreamInterface *iface;
+  gsize bytes_written;
+  gssize res;
+  gsize i;
+
+  iface = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream);
+
+  bytes_written = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size == 0)
+	continue;
+
+      /* Ignore errors once some data has been written */
+      res = iface->write_nonblocking (stream, vectors[i].buffer, vectors[i].size,
+				      bytes_written > 0 ? NULL : error);
+      if (res < 0)
+	return bytes_written > 0 ? (gssize) bytes_written : -1;
+
+      bytes_written += res;
+      if ((gsize) res < vectors[i].size)
+	break;
+    }
+
+  return bytes_written;
+}
+
+/**
+ * g_pollable_output_stream_writev_nonblocking:
+ * @stream: a #GPollableOutputStream
+ * @vectors: (array length=n_vectors): the buffers to write data from
+ * @n_vectors: the number of elements in @vectors
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Attempts to write the data in @vectors to @stream, in order, as
+ * with g_output_stream_writev(). If @stream is not currently writable,
+ * this will immediately return %G_IO_ERROR_WOULD_BLOCK, as
+ * g_pollable_output_stream_write_nonblocking() does.
+ *
+ * Virtual: writev_nonblocking
+ * Return value: the number of bytes written, or -1 on error (including
+ *   %G_IO_ERROR_WOULD_BLOCK).
+ *
+ * Since: 2.34
+ */
+gssize
+g_pollable_output_stream_writev_nonblocking (GPollableOutputStream  *stream,
+					     const GOutputVector    *vectors,
+					     gsize                   n_vectors,
+					     GCancellable           *cancellable,
+					     GError                **error)
+{
+  gsize total, i;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_POLLABLE_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+  total = 0;
+  for (i = 0; i < n_vectors; i++)
+    {
+      total += vectors[i].size;
+      if (((gssize) total) < 0 || total < vectors[i].size)
+	{
+	  g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		       _("Too large count value passed to %s"), G_STRFUNC);
+	  return -1;
+	}
+    }
+
+  if (total == 0)
+    return 0;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream)->
+    writev_nonblocking (stream, vectors, n_vectors, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  return res;
+}
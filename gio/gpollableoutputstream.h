@@ -51,6 +51,8 @@ typedef struct _GPollableOutputStreamInterface GPollableOutputStreamInterface;
  * @create_source: Creates a #GSource to poll the stream
  * @write_nonblocking: Does a non-blocking write or returns
  *   %G_IO_ERROR_WOULD_BLOCK
+ * @writev_nonblocking: Does a non-blocking vectored write or returns
+ *   %G_IO_ERROR_WOULD_BLOCK. Since 2.34
  *
  * The interface for pollable output streams.
  *
@@ -63,6 +65,10 @@ typedef struct _GPollableOutputStreamInterface GPollableOutputStreamInterface;
  * implementation may return %TRUE when the stream is not actually
  * writable.
  *
+ * The default implementation of @writev_nonblocking calls
+ * @write_nonblocking for each vector in turn, until one of them is
+ * not written completely.
+ *
  * Since: 2.28
  */
 struct _GPollableOutputStreamInterface
@@ -79,6 +85,10 @@ struct _GPollableOutputStreamInterface
 				     const void             *buffer,
 				     gsize                   count,
 				     GError                **error);
+  gssize       (*writev_nonblocking) (GPollableOutputStream *stream,
+				      const GOutputVector   *vectors,
+				      gsize                  n_vectors,
+				      GError               **error);
 };
 
 GType    g_pollable_output_stream_get_type          (void) G_GNUC_CONST;
@@ -94,6 +104,12 @@ gssize   g_pollable_output_stream_write_nonblocking (GPollableOutputStream  *str
 						     gsize                   count,
 						     GCancellable           *cancellable,
 						     GError                **error);
+GLIB_AVAILABLE_IN_2_34
+gssize   g_pollable_output_stream_writev_nonblocking (GPollableOutputStream  *stream,
+						      const GOutputVector    *vectors,
+						      gsize                   n_vectors,
+						      GCancellable           *cancellable,
+						      GError                **error);
 
 G_END_DECLS
 
@@ -30,14 +30,31 @@
 #include <gio/gmemoryinputstream.h>
 #include <gio/gzlibdecompressor.h>
 #include <gio/gconverterinputstream.h>
+#include "glz4.h"
 
 struct _GResource
 {
   int ref_count;
 
   GvdbTable *table;
+
+  /* Decompressed data of compressed files, see
+   * g_resource_set_cache_size()
+   */
+  GMutex cache_lock;
+  GHashTable *cache;  /* path -> CacheEntry */
+  GQueue cache_lru;   /* of CacheEntry, most recently used first */
+  gsize cache_size;
+  gsize cache_max_size;
 };
 
+typedef struct
+{
+  gchar *path;
+  GBytes *data;
+  GList link;
+} CacheEntry;
+
 static void register_lazy_static_resources ();
 
 G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
@@ -64,6 +81,11 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * in a compressed form, but will be automatically uncompressed when the resource is used. This
  * is very useful e.g. for larger text files that are parsed once (or rarely) and then thrown away.
  *
+ * By default compressed files use zlib. Setting the <literal>compression</literal> attribute
+ * to <literal>lz4</literal> instead selects LZ4, which compresses less but decompresses many
+ * times faster, and is a better fit for files that are looked up often. Files that are looked
+ * up repeatedly can also be kept in decompressed form, see g_resource_set_cache_size().
+ *
  * Resource files can also be marked to be preprocessed, by setting the value of the
  * <literal>preprocess</literal> attribute to a comma-separated list of preprocessing options.
  * The only options currently supported are:
@@ -91,6 +113,7 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  *   <gresource prefix="/org/gtk/Example">
  *     <file>data/splashscreen.png</file>
  *     <file compressed="true">dialog.ui</file>
+ *     <file compression="lz4">style.css</file>
  *     <file preprocess="xml-stripblanks">menumarkup.xml</file>
  *   </gresource>
  * </gresources>
@@ -100,6 +123,7 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * <programlisting><![CDATA[
  * /org/gtk/Example/data/splashscreen.png
  * /org/gtk/Example/dialog.ui
+ * /org/gtk/Example/style.css
  * /org/gtk/Example/menumarkup.xml
  * ]]></programlisting>
  *
@@ -179,6 +203,9 @@ g_resource_unref (GResource *resource)
   if (g_atomic_int_dec_and_test (&resource->ref_count))
     {
       gvdb_table_unref (resource->table);
+      if (resource->cache)
+        g_hash_table_unref (resource->cache);
+      g_mutex_clear (&resource->cache_lock);
       g_free (resource);
     }
 }
@@ -194,9 +221,10 @@ g_resource_new_from_table (GvdbTable *table)
 {
   GResource *resource;
 
-  resource = g_new (GResource, 1);
+  resource = g_new0 (GResource, 1);
   resource->ref_count = 1;
   resource->table = table;
+  g_mutex_init (&resource->cache_lock);
 
   return resource;
 }
@@ -363,6 +391,25 @@ g_resource_open_stream (GResource             *resource,
   if (!do_lookup (resource, path, lookup_flags, NULL, &flags, &data, &data_size, error))
     return NULL;
 
+  /* There is no streaming LZ4 decompressor; the data is decompressed
+   * in one go anyway, and possibly cached
+   */
+  if (flags & G_RESOURCE_FLAGS_LZ4)
+    {
+      GBytes *bytes;
+
+      bytes = g_resource_lookup_data (resource, path, lookup_flags, error);
+      if (bytes == NULL)
+        return NULL;
+
+      stream = g_memory_input_stream_new_from_data (g_bytes_get_data (bytes, NULL),
+                                                    g_bytes_get_size (bytes),
+                                                    NULL);
+      g_object_set_data_full (G_OBJECT (stream), "g-resource-data",
+                              bytes, (GDestroyNotify)g_bytes_unref);
+      return stream;
+    }
+
   stream = g_memory_input_stream_new_from_data (data, data_size, NULL);
   g_object_set_data_full (G_OBJECT (stream), "g-resource",
                           g_resource_ref (resource),
@@ -382,6 +429,165 @@ g_resource_open_stream (GResource             *resource,
   return stream;
 }
 
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_free (entry->path);
+  g_bytes_unref (entry->data);
+  g_slice_free (CacheEntry, entry);
+}
+
+/* Drops the least recently used entries until the cache fits in
+ * cache_max_size.  Called with cache_lock held.
+ */
+static void
+cache_trim (GResource *resource)
+{
+  while (resource->cache_size > resource->cache_max_size)
+    {
+      CacheEntry *entry = g_queue_peek_tail (&resource->cache_lru);
+
+      g_queue_unlink (&resource->cache_lru, &entry->link);
+      resource->cache_size -= g_bytes_get_size (entry->data);
+      g_hash_table_remove (resource->cache, entry->path);
+    }
+}
+
+static GBytes *
+cache_lookup (GResource   *resource,
+              const gchar *path)
+{
+  CacheEntry *entry;
+  GBytes *data = NULL;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  if (resource->cache != NULL &&
+      (entry = g_hash_table_lookup (resource->cache, path)) != NULL)
+    {
+      g_queue_unlink (&resource->cache_lru, &entry->link);
+      g_queue_push_head_link (&resource->cache_lru, &entry->link);
+      data = g_bytes_ref (entry->data);
+    }
+
+  g_mutex_unlock (&resource->cache_lock);
+
+  return data;
+}
+
+static void
+cache_insert (GResource   *resource,
+              const gchar *path,
+              GBytes      *data)
+{
+  CacheEntry *entry;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  if (resource->cache != NULL &&
+      g_bytes_get_size (data) <= resource->cache_max_size &&
+      !g_hash_table_contains (resource->cache, path))
+    {
+      entry = g_slice_new (CacheEntry);
+      entry->path = g_strdup (path);
+      entry->data = g_bytes_ref (data);
+      entry->link.data = entry;
+      entry->link.prev = entry->link.next = NULL;
+
+      g_hash_table_insert (resource->cache, entry->path, entry);
+      g_queue_push_head_link (&resource->cache_lru, &entry->link);
+      resource->cache_size += g_bytes_get_size (data);
+
+      cache_trim (resource);
+    }
+
+  g_mutex_unlock (&resource->cache_lock);
+}
+
+static GBytes *
+decompress_zlib (const gchar  *path,
+                 const void   *data,
+                 gsize         data_size,
+                 gsize         size,
+                 GError      **error)
+{
+  char *uncompressed, *d;
+  const char *s;
+  GConverterResult res;
+  gsize d_size, s_size;
+  gsize bytes_read, bytes_written;
+  GZlibDecompressor *decompressor;
+
+  decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+
+  uncompressed = g_malloc (size + 1);
+
+  s = data;
+  s_size = data_size;
+  d = uncompressed;
+  d_size = size;
+
+  do
+    {
+      res = g_converter_convert (G_CONVERTER (decompressor),
+                                 s, s_size,
+                                 d, d_size,
+                                 G_CONVERTER_INPUT_AT_END,
+                                 &bytes_read,
+                                 &bytes_written,
+                                 NULL);
+      if (res == G_CONVERTER_ERROR)
+        {
+          g_free (uncompressed);
+          g_object_unref (decompressor);
+
+          g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                       _("The resource at '%s' failed to decompress"),
+                       path);
+          return NULL;
+        }
+      s += bytes_read;
+      s_size -= bytes_read;
+      d += bytes_written;
+      d_size -= bytes_written;
+    }
+  while (res != G_CONVERTER_FINISHED);
+
+  uncompressed[size] = 0; /* Zero terminate */
+
+  g_object_unref (decompressor);
+
+  return g_bytes_new_take (uncompressed, size);
+}
+
+static GBytes *
+decompress_lz4 (const gchar  *path,
+                const void   *data,
+                gsize         data_size,
+                gsize         size,
+                GError      **error)
+{
+  guint8 *uncompressed;
+
+  uncompressed = g_malloc (size + 1);
+
+  if (!_g_lz4_decompress (data, data_size, uncompressed, size))
+    {
+      g_free (uncompressed);
+
+      g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                   _("The resource at '%s' failed to decompress"),
+                   path);
+      return NULL;
+    }
+
+  uncompressed[size] = 0; /* Zero terminate */
+
+  return g_bytes_new_take (uncompressed, size);
+}
+
 /**
  * g_resource_lookup_data:
  * @resource: A #GResource
@@ -400,7 +606,9 @@ g_resource_open_stream (GResource             *resource,
  * For uncompressed resource files this is a pointer directly into
  * the resource bundle, which is typically in some readonly data section
  * in the program binary. For compressed files we allocate memory on
- * the heap and automatically uncompress the data.
+ * the heap and automatically uncompress the data, unless the
+ * uncompressed data is still in the cache of @resource (see
+ * g_resource_set_cache_size()).
  *
  * @lookup_flags controls the behaviour of the lookup.
  *
@@ -419,64 +627,76 @@ g_resource_lookup_data (GResource             *resource,
   guint32 flags;
   gsize data_size;
   gsize size;
+  GBytes *bytes;
+
+  /* Only compressed files are cached, so a hit saves the lookup too */
+  bytes = cache_lookup (resource, path);
+  if (bytes != NULL)
+    return bytes;
 
   if (!do_lookup (resource, path, lookup_flags, &size, &flags, &data, &data_size, error))
     return NULL;
 
   if (flags & G_RESOURCE_FLAGS_COMPRESSED)
     {
-      char *uncompressed, *d;
-      const char *s;
-      GConverterResult res;
-      gsize d_size, s_size;
-      gsize bytes_read, bytes_written;
+      if (flags & G_RESOURCE_FLAGS_LZ4)
+        bytes = decompress_lz4 (path, data, data_size, size, error);
+      else
+        bytes = decompress_zlib (path, data, data_size, size, error);
 
+      if (bytes != NULL)
+        cache_insert (resource, path, bytes);
 
-      GZlibDecompressor *decompressor =
-        g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+      return bytes;
+    }
+  else
+    return g_bytes_new_with_free_func (data, data_size, (GDestroyNotify)g_resource_unref, g_resource_ref (resource));
+}
 
-      uncompressed = g_malloc (size + 1);
+/**
+ * g_resource_set_cache_size:
+ * @resource: A #GResource
+ * @max_size: the maximal number of bytes to keep cached, or 0 to
+ *     disable the cache
+ *
+ * Makes @resource keep the uncompressed data of up to @max_size bytes
+ * of its compressed files, so that looking them up again with
+ * g_resource_lookup_data() or g_resources_lookup_data() returns a new
+ * reference to the same #GBytes instead of decompressing the file
+ * again. When the cache is full, the least recently looked up files
+ * are dropped from it.
+ *
+ * Uncompressed files are never cached, since looking them up does not
+ * copy their data. By default, the cache is disabled.
+ *
+ * Since: 2.34
+ **/
+void
+g_resource_set_cache_size (GResource *resource,
+                           gsize      max_size)
+{
+  g_return_if_fail (resource != NULL);
 
-      s = data;
-      s_size = data_size;
-      d = uncompressed;
-      d_size = size;
+  g_mutex_lock (&resource->cache_lock);
 
-      do
-        {
-          res = g_converter_convert (G_CONVERTER (decompressor),
-                                     s, s_size,
-                                     d, d_size,
-                                     G_CONVERTER_INPUT_AT_END,
-                                     &bytes_read,
-                                     &bytes_written,
-                                     NULL);
-          if (res == G_CONVERTER_ERROR)
-            {
-              g_free (uncompressed);
-              g_object_unref (decompressor);
-
-              g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
-                           _("The resource at '%s' failed to decompress"),
-                           path);
-              return NULL;
-
-            }
-          s += bytes_read;
-          s_size -= bytes_read;
-          d += bytes_written;
-          d_size -= bytes_written;
-        }
-      while (res != G_CONVERTER_FINISHED);
+  resource->cache_max_size = max_size;
 
-      uncompressed[size] = 0; /* Zero terminate */
+  if (max_size > 0 && resource->cache == NULL)
+    resource->cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             NULL, cache_entry_free);
 
-      g_object_unref (decompressor);
+  if (resource->cache != NULL)
+    {
+      cache_trim (resource);
 
-      return g_bytes_new_take (uncompressed, size);
+      if (max_size == 0)
+        {
+          g_hash_table_unref (resource->cache);
+          resource->cache = NULL;
+        }
     }
-  else
-    return g_bytes_new_with_free_func (data, data_size, (GDestroyNotify)g_resource_unref, g_resource_ref (resource));
+
+  g_mutex_unlock (&resource->cache_lock);
 }
 
 /**
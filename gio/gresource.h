@@ -84,6 +84,9 @@ gboolean      g_resource_get_info            (GResource             *resource,
 					      gsize                 *size,
 					      guint32               *flags,
 					      GError               **error);
+GLIB_AVAILABLE_IN_2_34
+void          g_resource_set_cache_size      (GResource             *resource,
+					      gsize                  max_size);
 
 void          g_resources_register           (GResource             *resource);
 void          g_resources_unregister         (GResource             *resource);
@@ -231,6 +231,32 @@
  * </refsect2>
  **/
 
+typedef union
+{
+  gint64   integer;
+  guint64  uinteger;
+  gdouble  floating;
+} CachedValue;
+
+/* A slot is written at most by one thread at a time (the one that
+ * managed to make 'seq' odd) and can be read by any number of threads
+ * without locking: a reader checks that 'seq' was even and unchanged
+ * across its copy of the contents.  A 'seq' of 0 means empty.
+ */
+typedef struct
+{
+  gint          seq;
+  gint          generation;
+  GVariantClass class;
+  CachedValue   value;
+} CacheSlot;
+
+typedef struct
+{
+  GHashTable *index;  /* key name -> slot number + 1; never modified */
+  CacheSlot  *slots;
+} ValueCache;
+
 struct _GSettingsPrivate
 {
   /* where the signals go... */
@@ -241,6 +267,8 @@ struct _GSettingsPrivate
   gchar *path;
 
   GDelayedSettingsBackend *delayed;
+
+  ValueCache *cache;
 };
 
 enum
@@ -585,6 +613,13 @@ g_settings_finalize (GObject *object)
   g_settings_schema_unref (settings->priv->schema);
   g_free (settings->priv->path);
 
+  if (settings->priv->cache)
+    {
+      g_hash_table_unref (settings->priv->cache->index);
+      g_free (settings->priv->cache->slots);
+      g_slice_free (ValueCache, settings->priv->cache);
+    }
+
   G_OBJECT_CLASS (g_settings_parent_class)->finalize (object);
 }
 
@@ -1039,6 +1074,193 @@ g_settings_read_from_backend (GSettings          *settings,
   return fixup;
 }
 
+/* Value cache {{{1
+ *
+ * Values of basic types are cached per GSettings object so that
+ * reading them does not have to go to the backend (with its locking
+ * and path building) every time.  An entry is valid for as long as the
+ * generation of the backend stays the same; the backend bumps it
+ * synchronously whenever it emits a change notification, so cached
+ * values are never stale, even for writes made from other threads or
+ * by other GSettings objects.
+ *
+ * The cache is not used in delay-apply mode, since the delayed backend
+ * only learns about changes to the real backend from the main loop.
+ */
+static CacheSlot *
+g_settings_cache_get_slot (GSettings   *settings,
+                           const gchar *key)
+{
+  ValueCache *cache;
+  gint n;
+
+  if (settings->priv->delayed)
+    return NULL;
+
+  if (g_once_init_enter (&settings->priv->cache))
+    {
+      const GQuark *keys;
+      gint n_keys;
+      gint i;
+
+      keys = g_settings_schema_list (settings->priv->schema, &n_keys);
+
+      cache = g_slice_new (ValueCache);
+      cache->index = g_hash_table_new (g_str_hash, g_str_equal);
+      cache->slots = g_new0 (CacheSlot, n_keys);
+
+      for (i = 0; i < n_keys; i++)
+        g_hash_table_insert (cache->index,
+                             (gpointer) g_quark_to_string (keys[i]),
+                             GINT_TO_POINTER (i + 1));
+
+      g_once_init_leave (&settings->priv->cache, cache);
+    }
+
+  cache = settings->priv->cache;
+  n = GPOINTER_TO_INT (g_hash_table_lookup (cache->index, key));
+
+  return n ? &cache->slots[n - 1] : NULL;
+}
+
+static gboolean
+g_settings_read_from_cache (GSettings     *settings,
+                            const gchar   *key,
+                            GVariantClass *class,
+                            CachedValue   *value)
+{
+  CacheSlot *slot;
+  gint generation;
+  gint seq;
+
+  if (!G_IS_SETTINGS (settings) || key == NULL)
+    return FALSE;
+
+  if ((slot = g_settings_cache_get_slot (settings, key)) == NULL)
+    return FALSE;
+
+  seq = g_atomic_int_get (&slot->seq);
+  if (seq == 0 || seq & 1)
+    return FALSE;
+
+  *class = slot->class;
+  *value = slot->value;
+  generation = slot->generation;
+
+  if (g_atomic_int_get (&slot->seq) != seq)
+    return FALSE;
+
+  return generation == g_settings_backend_get_generation (settings->priv->backend);
+}
+
+static void
+g_settings_write_to_cache (GSettings   *settings,
+                           const gchar *key,
+                           gint         generation,
+                           GVariant    *value)
+{
+  GVariantClass class;
+  CachedValue cached;
+  CacheSlot *slot;
+  gint seq;
+
+  class = g_variant_classify (value);
+
+  switch (class)
+    {
+    case G_VARIANT_CLASS_BOOLEAN:
+      cached.integer = g_variant_get_boolean (value);
+      break;
+
+    case G_VARIANT_CLASS_BYTE:
+      cached.integer = g_variant_get_byte (value);
+      break;
+
+    case G_VARIANT_CLASS_INT16:
+      cached.integer = g_variant_get_int16 (value);
+      break;
+
+    case G_VARIANT_CLASS_UINT16:
+      cached.integer = g_variant_get_uint16 (value);
+      break;
+
+    case G_VARIANT_CLASS_INT32:
+      cached.integer = g_variant_get_int32 (value);
+      break;
+
+    case G_VARIANT_CLASS_UINT32:
+      cached.integer = g_variant_get_uint32 (value);
+      break;
+
+    case G_VARIANT_CLASS_INT64:
+      cached.integer = g_variant_get_int64 (value);
+      break;
+
+    case G_VARIANT_CLASS_UINT64:
+      cached.uinteger = g_variant_get_uint64 (value);
+      break;
+
+    case G_VARIANT_CLASS_DOUBLE:
+      cached.floating = g_variant_get_double (value);
+      break;
+
+    default:
+      return;
+    }
+
+  if ((slot = g_settings_cache_get_slot (settings, key)) == NULL)
+    return;
+
+  /* if another thread is busy filling this slot, let it */
+  seq = g_atomic_int_get (&slot->seq);
+  if (seq & 1 || !g_atomic_int_compare_and_exchange (&slot->seq, seq, seq + 1))
+    return;
+
+  slot->class = class;
+  slot->value = cached;
+  slot->generation = generation;
+
+  g_atomic_int_inc (&slot->seq);
+}
+
+static GVariant *
+g_settings_value_from_cache (GVariantClass      class,
+                             const CachedValue *cached)
+{
+  switch (class)
+    {
+    case G_VARIANT_CLASS_BOOLEAN:
+      return g_variant_new_boolean (cached->integer);
+
+    case G_VARIANT_CLASS_BYTE:
+      return g_variant_new_byte (cached->integer);
+
+    case G_VARIANT_CLASS_INT16:
+      return g_variant_new_int16 (cached->integer);
+
+    case G_VARIANT_CLASS_UINT16:
+      return g_variant_new_uint16 (cached->integer);
+
+    case G_VARIANT_CLASS_INT32:
+      return g_variant_new_int32 (cached->integer);
+
+    case G_VARIANT_CLASS_UINT32:
+      return g_variant_new_uint32 (cached->integer);
+
+    case G_VARIANT_CLASS_INT64:
+      return g_variant_new_int64 (cached->integer);
+
+    case G_VARIANT_CLASS_UINT64:
+      return g_variant_new_uint64 (cached->uinteger);
+
+    case G_VARIANT_CLASS_DOUBLE:
+      return g_variant_new_double (cached->floating);
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 /* Public Get/Set API {{{1 (get, get_value, set, set_value, get_mapped) */
 /**
  * g_settings_get_value:
@@ -1059,11 +1281,22 @@ g_settings_get_value (GSettings   *settings,
                       const gchar *key)
 {
   GSettingsSchemaKey skey;
+  GVariantClass class;
+  CachedValue cached;
   GVariant *value;
+  gint generation;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
+  if (g_settings_read_from_cache (settings, key, &class, &cached))
+    return g_variant_ref_sink (g_settings_value_from_cache (class, &cached));
+
+  /* must be fetched before reading: a change that happens while we
+   * read will then leave the cache entry invalid
+   */
+  generation = g_settings_backend_get_generation (settings->priv->backend);
+
   g_settings_schema_key_init (&skey, settings->priv->schema, key);
   value = g_settings_read_from_backend (settings, &skey);
 
@@ -1075,6 +1308,8 @@ g_settings_get_value (GSettings   *settings,
 
   g_settings_schema_key_clear (&skey);
 
+  g_settings_write_to_cache (settings, key, generation, value);
+
   return value;
 }
 
@@ -1597,9 +1832,15 @@ gint
 g_settings_get_int (GSettings   *settings,
                     const gchar *key)
 {
+  GVariantClass class;
+  CachedValue cached;
   GVariant *value;
   gint result;
 
+  if (g_settings_read_from_cache (settings, key, &class, &cached) &&
+      class == G_VARIANT_CLASS_INT32)
+    return cached.integer;
+
   value = g_settings_get_value (settings, key);
   result = g_variant_get_int32 (value);
   g_variant_unref (value);
@@ -1654,9 +1895,15 @@ guint
 g_settings_get_uint (GSettings   *settings,
                      const gchar *key)
 {
+  GVariantClass class;
+  CachedValue cached;
   GVariant *value;
   guint result;
 
+  if (g_settings_read_from_cache (settings, key, &class, &cached) &&
+      class == G_VARIANT_CLASS_UINT32)
+    return cached.integer;
+
   value = g_settings_get_value (settings, key);
   result = g_variant_get_uint32 (value);
   g_variant_unref (value);
@@ -1711,9 +1958,15 @@ gdouble
 g_settings_get_double (GSettings   *settings,
                        const gchar *key)
 {
+  GVariantClass class;
+  CachedValue cached;
   GVariant *value;
   gdouble result;
 
+  if (g_settings_read_from_cache (settings, key, &class, &cached) &&
+      class == G_VARIANT_CLASS_DOUBLE)
+    return cached.floating;
+
   value = g_settings_get_value (settings, key);
   result = g_variant_get_double (value);
   g_variant_unref (value);
@@ -1767,9 +2020,15 @@ gboolean
 g_settings_get_boolean (GSettings  *settings,
                        const gchar *key)
 {
+  GVariantClass class;
+  CachedValue cached;
   GVariant *value;
   gboolean result;
 
+  if (g_settings_read_from_cache (settings, key, &class, &cached) &&
+      class == G_VARIANT_CLASS_BOOLEAN)
+    return cached.integer;
+
   value = g_settings_get_value (settings, key);
   result = g_variant_get_boolean (value);
   g_variant_unref (value);
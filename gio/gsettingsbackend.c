@@ -42,6 +42,9 @@ struct _GSettingsBackendPrivate
 {
   GSettingsBackendWatch *watches;
   GMutex lock;
+
+  /* incremented whenever a value may have changed */
+  gint generation;
 };
 
 /* For g_settings_backend_sync_default(), we only want to actually do
@@ -397,6 +400,8 @@ g_settings_backend_changed (GSettingsBackend *backend,
   g_return_if_fail (G_IS_SETTINGS_BACKEND (backend));
   g_return_if_fail (is_key (key));
 
+  g_atomic_int_inc (&backend->priv->generation);
+
   g_settings_backend_dispatch_signal (backend,
                                       G_STRUCT_OFFSET (GSettingsListenerVTable,
                                                        changed),
@@ -446,6 +451,8 @@ g_settings_backend_keys_changed (GSettingsBackend    *backend,
   /* XXX: should do stricter checking (ie: inspect each item) */
   g_return_if_fail (items != NULL);
 
+  g_atomic_int_inc (&backend->priv->generation);
+
   g_settings_backend_dispatch_signal (backend,
                                       G_STRUCT_OFFSET (GSettingsListenerVTable,
                                                        keys_changed),
@@ -493,6 +500,8 @@ g_settings_backend_path_changed (GSettingsBackend *backend,
   g_return_if_fail (G_IS_SETTINGS_BACKEND (backend));
   g_return_if_fail (is_path (path));
 
+  g_atomic_int_inc (&backend->priv->generation);
+
   g_settings_backend_dispatch_signal (backend,
                                       G_STRUCT_OFFSET (GSettingsListenerVTable,
                                                        path_changed),
@@ -700,6 +709,24 @@ g_settings_backend_changed_tree (GSettingsBackend *backend,
   g_free (keys);
 }
 
+/*< private >
+ * g_settings_backend_get_generation:
+ * @backend: a #GSettingsBackend
+ *
+ * Returns a number that changes whenever any value in @backend may
+ * have changed, ie: whenever a change notification is emitted.  It is
+ * incremented before the notification is dispatched, so a value read
+ * after observing a given generation is known to be current for as
+ * long as the generation stays the same.
+ *
+ * Returns: the current generation of @backend
+ */
+gint
+g_settings_backend_get_generation (GSettingsBackend *backend)
+{
+  return g_atomic_int_get (&backend->priv->generation);
+}
+
 /*< private >
  * g_settings_backend_read:
  * @backend: a #GSettingsBackend implementation
@@ -1013,6 +1040,36 @@ g_settings_backend_get_permission (GSettingsBackend *backend,
   return g_simple_permission_new (TRUE);
 }
 
+/**
+ * g_settings_backend_sync:
+ * @backend: a #GSettingsBackend
+ *
+ * Ensures that all writes made to @backend so far have been committed
+ * to permanent storage.
+ *
+ * Backends are free to delay writing out changes (for example, in
+ * order to merge a burst of writes into a single update of their
+ * storage).  This call blocks until any such pending changes have been
+ * written.  It does nothing for backends that have nothing to sync.
+ *
+ * This is the per-backend equivalent of g_settings_sync(), which only
+ * applies to the default backend.
+ *
+ * Since: 2.34
+ **/
+void
+g_settings_backend_sync (GSettingsBackend *backend)
+{
+  GSettingsBackendClass *class;
+
+  g_return_if_fail (G_IS_SETTINGS_BACKEND (backend));
+
+  class = G_SETTINGS_BACKEND_GET_CLASS (backend);
+
+  if (class->sync)
+    class->sync (backend);
+}
+
 /*< private >
  * g_settings_backend_sync_default:
  *
@@ -1022,14 +1079,5 @@ void
 g_settings_backend_sync_default (void)
 {
   if (g_settings_has_backend)
-    {
-      GSettingsBackendClass *class;
-      GSettingsBackend *backend;
-
-      backend = g_settings_backend_get_default ();
-      class = G_SETTINGS_BACKEND_GET_CLASS (backend);
-
-      if (class->sync)
-        class->sync (backend);
-    }
+    g_settings_backend_sync (g_settings_backend_get_default ());
 }
@@ -131,6 +131,9 @@ void                    g_settings_backend_changed_tree                 (GSettin
 
 GSettingsBackend *      g_settings_backend_get_default                  (void);
 
+GLIB_AVAILABLE_IN_2_34
+void                    g_settings_backend_sync                         (GSettingsBackend    *backend);
+
 GSettingsBackend *      g_keyfile_settings_backend_new                  (const gchar         *filename,
                                                                          const gchar         *root_path,
                                                                          const gchar         *root_group);
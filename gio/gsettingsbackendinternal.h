@@ -67,6 +67,8 @@ GVariant *              g_settings_backend_read                         (GSettin
                                                                          const GVariantType             *expected_type,
                                                                          gboolean                        default_value);
 G_GNUC_INTERNAL
+gint                    g_settings_backend_get_generation               (GSettingsBackend               *backend);
+G_GNUC_INTERNAL
 gboolean                g_settings_backend_write                        (GSettingsBackend               *backend,
                                                                          const gchar                    *key,
                                                                          GVariant                       *value,
@@ -463,8 +463,6 @@ ensure_schema_lists (void)
       GSettingsSchemaSource *source;
       GHashTable *single, *reloc;
       const gchar **ptr;
-      gchar **list;
-      gint i;
 
       initialise_schema_sources ();
 
@@ -476,32 +474,39 @@ ensure_schema_lists (void)
 
       for (source = schema_sources; source; source = source->parent)
         {
-          list = gvdb_table_list (source->table, "");
+          GvdbTableIter iter;
+          const gchar *name;
+          gsize name_len;
 
-          /* empty schema cache file? */
-          if (list == NULL)
-            continue;
+          /* an empty schema cache file has no list, and the loop
+           * below does nothing
+           */
+          gvdb_table_iter_init (&iter, source->table, "");
 
-          for (i = 0; list[i]; i++)
+          while (gvdb_table_iter_next (&iter, &name, &name_len))
             {
-              if (!g_hash_table_lookup (single, list[i]) &&
-                  !g_hash_table_lookup (reloc, list[i]))
+              gchar *id;
+
+              id = g_strndup (name, name_len);
+
+              if (!g_hash_table_lookup_extended (single, id, NULL, NULL) &&
+                  !g_hash_table_lookup_extended (reloc, id, NULL, NULL))
                 {
                   GvdbTable *table;
 
-                  table = gvdb_table_get_table (source->table, list[i]);
+                  table = gvdb_table_iter_get_table (&iter);
                   g_assert (table != NULL);
 
                   if (gvdb_table_has_value (table, ".path"))
-                    g_hash_table_insert (single, g_strdup (list[i]), NULL);
+                    g_hash_table_insert (single, id, NULL);
                   else
-                    g_hash_table_insert (reloc, g_strdup (list[i]), NULL);
+                    g_hash_table_insert (reloc, id, NULL);
 
                   gvdb_table_unref (table);
                 }
+              else
+                g_free (id);
             }
-
-          g_strfreev (list);
         }
 
       ptr = g_new (const gchar *, g_hash_table_size (single) + 1);
@@ -686,25 +691,32 @@ const GQuark *
 g_settings_schema_list (GSettingsSchema *schema,
                         gint            *n_items)
 {
-  gint i, j;
-
   if (schema->items == NULL)
     {
-      gchar **list;
-      gint len;
-
-      list = gvdb_table_list (schema->table, "");
-      len = list ? g_strv_length (list) : 0;
-
-      schema->items = g_new (GQuark, len);
-      j = 0;
+      GvdbTableIter iter;
+      const gchar *name;
+      gsize name_len;
+      GArray *items;
+      GString *key;
+
+      gvdb_table_iter_init (&iter, schema->table, "");
+      items = g_array_new (FALSE, FALSE, sizeof (GQuark));
+      key = g_string_new (NULL);
+
+      while (gvdb_table_iter_next (&iter, &name, &name_len))
+        if (name_len == 0 || name[0] != '.')
+          {
+            GQuark quark;
 
-      for (i = 0; i < len; i++)
-        if (list[i][0] != '.')
-          schema->items[j++] = g_quark_from_string (list[i]);
-      schema->n_items = j;
+            g_string_truncate (key, 0);
+            g_string_append_len (key, name, name_len);
+            quark = g_quark_from_string (key->str);
+            g_array_append_val (items, quark);
+          }
 
-      g_strfreev (list);
+      schema->n_items = items->len;
+      schema->items = (GQuark *) g_array_free (items, FALSE);
+      g_string_free (key, TRUE);
     }
 
   *n_items = schema->n_items;
@@ -35,6 +35,7 @@
 #include "gasyncresult.h"
 #include "gcancellable.h"
 #include "gioscheduler.h"
+#include "gasynchelper.h"
 #include <gio/gioerror.h>
 #include "glibintl.h"
 
@@ -849,7 +850,6 @@ run_in_thread (GIOSchedulerJob *job,
 {
   RunInThreadData *data = _data;
   GSimpleAsyncResult *simple = data->simple;
-  GSource *source;
  
   if (simple->handle_cancellation &&
       g_cancellable_is_cancelled (c))
@@ -862,12 +862,9 @@ run_in_thread (GIOSchedulerJob *job,
                 simple->source_object,
                 c);
 
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (source, complete_in_idle_cb_for_thread, data, NULL);
-
-  g_source_attach (source, simple->context);
-  g_source_unref (source);
+  _g_io_scheduler_invoke_in_context (simple->context,
+                                     complete_in_idle_cb_for_thread,
+                                     data, NULL);
 
   return FALSE;
 }
@@ -891,6 +888,20 @@ g_simple_async_result_run_in_thread (GSimpleAsyncResult     *simple,
                                      GSimpleAsyncThreadFunc  func,
                                      int                     io_priority,
                                      GCancellable           *cancellable)
+{
+  _g_simple_async_result_run_in_thread_pool (simple,
+                                             G_IO_SCHEDULER_POOL_METADATA,
+                                             func, io_priority, cancellable);
+}
+
+/* Like g_simple_async_result_run_in_thread(), but lets the bulk data
+ * operations in gio run in their own #GIOScheduler pool. */
+void
+_g_simple_async_result_run_in_thread_pool (GSimpleAsyncResult     *simple,
+                                           GIOSchedulerPool        pool,
+                                           GSimpleAsyncThreadFunc  func,
+                                           int                     io_priority,
+                                           GCancellable           *cancellable)
 {
   RunInThreadData *data;
 
@@ -903,7 +914,8 @@ g_simple_async_result_run_in_thread (GSimpleAsyncResult     *simple,
   data->cancellable = cancellable;
   if (cancellable)
     g_object_ref (cancellable);
-  g_io_scheduler_push_job (run_in_thread, data, NULL, io_priority, cancellable);
+  g_io_scheduler_push_job_to_pool (pool, run_in_thread, data, NULL,
+                                   io_priority, cancellable);
 }
 
 /**
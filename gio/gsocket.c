@@ -122,6 +122,17 @@ static gboolean g_socket_initable_init       (GInitable       *initable,
 					      GCancellable    *cancellable,
 					      GError         **error);
 
+static gssize   g_socket_receive_message_with_blocking (GSocket                 *socket,
+                                                        GSocketAddress         **address,
+                                                        GInputVector            *vectors,
+                                                        gint                     num_vectors,
+                                                        GSocketControlMessage ***messages,
+                                                        gint                    *num_messages,
+                                                        gint                    *flags,
+                                                        gboolean                 blocking,
+                                                        GCancellable            *cancellable,
+                                                        GError                 **error);
+
 G_DEFINE_TYPE_WITH_CODE (GSocket, g_socket, G_TYPE_OBJECT,
 			 G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
 						g_socket_initable_iface_init));
@@ -3588,6 +3599,104 @@ g_socket_condition_timed_wait (GSocket       *socket,
   #endif
 }
 
+#ifndef G_OS_WIN32
+/* Returns the size of the control buffer needed to send @messages */
+static gsize
+control_messages_space (GSocketControlMessage **messages,
+                        gint                    num_messages)
+{
+  gsize space = 0;
+  gint i;
+
+  for (i = 0; i < num_messages; i++)
+    space += CMSG_SPACE (g_socket_control_message_get_size (messages[i]));
+
+  return space;
+}
+
+/* Serializes @messages into the control buffer of @msg, which must be
+ * zeroed and control_messages_space() bytes long. */
+static void
+control_messages_serialize (struct msghdr          *msg,
+                            GSocketControlMessage **messages,
+                            gint                    num_messages)
+{
+  struct cmsghdr *cmsg;
+  gint i;
+
+  cmsg = CMSG_FIRSTHDR (msg);
+  for (i = 0; i < num_messages; i++)
+    {
+      cmsg->cmsg_level = g_socket_control_message_get_level (messages[i]);
+      cmsg->cmsg_type = g_socket_control_message_get_msg_type (messages[i]);
+      cmsg->cmsg_len = CMSG_LEN (g_socket_control_message_get_size (messages[i]));
+      g_socket_control_message_serialize (messages[i],
+                                          CMSG_DATA (cmsg));
+      cmsg = CMSG_NXTHDR (msg, cmsg);
+    }
+  g_assert (cmsg == NULL);
+}
+
+/* Decodes the control messages received in @msg, as described for
+ * g_socket_receive_message(). */
+static void
+control_messages_deserialize (struct msghdr            *msg,
+                              GSocketControlMessage  ***messages,
+                              gint                     *num_messages)
+{
+  GPtrArray *my_messages = NULL;
+  struct cmsghdr *cmsg;
+
+  for (cmsg = CMSG_FIRSTHDR (msg); cmsg; cmsg = CMSG_NXTHDR (msg, cmsg))
+    {
+      GSocketControlMessage *message;
+
+      message = g_socket_control_message_deserialize (cmsg->cmsg_level,
+                                                      cmsg->cmsg_type,
+                                                      cmsg->cmsg_len - ((char *)CMSG_DATA (cmsg) - (char *)cmsg),
+                                                      CMSG_DATA (cmsg));
+      if (message == NULL)
+        /* We've already spewed about the problem in the
+           deserialization code, so just continue */
+        continue;
+
+      if (messages == NULL)
+        {
+          /* we have to do it this way if the user ignores the
+           * messages so that we will close any received fds.
+           */
+          g_object_unref (message);
+        }
+      else
+        {
+          if (my_messages == NULL)
+            my_messages = g_ptr_array_new ();
+          g_ptr_array_add (my_messages, message);
+        }
+    }
+
+  if (num_messages)
+    *num_messages = my_messages != NULL ? my_messages->len : 0;
+
+  if (messages)
+    {
+      if (my_messages == NULL)
+        {
+          *messages = NULL;
+        }
+      else
+        {
+          g_ptr_array_add (my_messages, NULL);
+          *messages = (GSocketControlMessage **) g_ptr_array_free (my_messages, FALSE);
+        }
+    }
+  else
+    {
+      g_assert (my_messages == NULL);
+    }
+}
+#endif
+
 /**
  * g_socket_send_message:
  * @socket: a #GSocket
@@ -3654,6 +3763,30 @@ g_socket_send_message (GSocket                *socket,
 		       gint                    flags,
 		       GCancellable           *cancellable,
 		       GError                **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), -1);
+
+  return _g_socket_send_message_with_blocking (socket, address,
+                                               vectors, num_vectors,
+                                               messages, num_messages,
+                                               flags, socket->priv->blocking,
+                                               cancellable, error);
+}
+
+/* Like g_socket_send_message(), but with the blocking mode given by
+ * @blocking rather than by the socket, as g_socket_send_with_blocking()
+ * does for g_socket_send(). */
+gssize
+_g_socket_send_message_with_blocking (GSocket                *socket,
+                                      GSocketAddress         *address,
+                                      GOutputVector          *vectors,
+                                      gint                    num_vectors,
+                                      GSocketControlMessage **messages,
+                                      gint                    num_messages,
+                                      gint                    flags,
+                                      gboolean                blocking,
+                                      GCancellable           *cancellable,
+                                      GError                **error)
 {
   GOutputVector one_vector;
   char zero;
@@ -3744,38 +3877,19 @@ g_socket_send_message (GSocket                *socket,
     }
 
     /* control */
-    {
-      struct cmsghdr *cmsg;
-      gint i;
-
-      msg.msg_controllen = 0;
-      for (i = 0; i < num_messages; i++)
-	msg.msg_controllen += CMSG_SPACE (g_socket_control_message_get_size (messages[i]));
-
-      if (msg.msg_controllen == 0)
-        msg.msg_control = NULL;
-      else
-        {
-          msg.msg_control = g_alloca (msg.msg_controllen);
-          memset (msg.msg_control, '\0', msg.msg_controllen);
-        }
-
-      cmsg = CMSG_FIRSTHDR (&msg);
-      for (i = 0; i < num_messages; i++)
-	{
-	  cmsg->cmsg_level = g_socket_control_message_get_level (messages[i]);
-	  cmsg->cmsg_type = g_socket_control_message_get_msg_type (messages[i]);
-	  cmsg->cmsg_len = CMSG_LEN (g_socket_control_message_get_size (messages[i]));
-	  g_socket_control_message_serialize (messages[i],
-					      CMSG_DATA (cmsg));
-	  cmsg = CMSG_NXTHDR (&msg, cmsg);
-	}
-      g_assert (cmsg == NULL);
-    }
+    msg.msg_controllen = control_messages_space (messages, num_messages);
+    if (msg.msg_controllen == 0)
+      msg.msg_control = NULL;
+    else
+      {
+        msg.msg_control = g_alloca (msg.msg_controllen);
+        memset (msg.msg_control, '\0', msg.msg_controllen);
+      }
+    control_messages_serialize (&msg, messages, num_messages);
 
     while (1)
       {
-	if (socket->priv->blocking &&
+	if (blocking &&
 	    !g_socket_condition_wait (socket,
 				      G_IO_OUT, cancellable, error))
 	  return -1;
@@ -3788,7 +3902,7 @@ g_socket_send_message (GSocket                *socket,
 	    if (errsv == EINTR)
 	      continue;
 
-	    if (socket->priv->blocking &&
+	    if (blocking &&
 		(errsv == EWOULDBLOCK ||
 		 errsv == EAGAIN))
 	      continue;
@@ -3843,7 +3957,7 @@ g_socket_send_message (GSocket                *socket,
 
     while (1)
       {
-	if (socket->priv->blocking &&
+	if (blocking &&
 	    !g_socket_condition_wait (socket,
 				      G_IO_OUT, cancellable, error))
 	  return -1;
@@ -3870,7 +3984,7 @@ g_socket_send_message (GSocket                *socket,
 	    if (errsv == WSAEWOULDBLOCK)
 	      win32_unset_event_mask (socket, FD_WRITE);
 
-	    if (socket->priv->blocking &&
+	    if (blocking &&
 		errsv == WSAEWOULDBLOCK)
 	      continue;
 
@@ -3976,6 +4090,29 @@ g_socket_receive_message (GSocket                 *socket,
 			  gint                    *flags,
 			  GCancellable            *cancellable,
 			  GError                 **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), -1);
+
+  return g_socket_receive_message_with_blocking (socket, address,
+                                                 vectors, num_vectors,
+                                                 messages, num_messages,
+                                                 flags, socket->priv->blocking,
+                                                 cancellable, error);
+}
+
+/* Like g_socket_receive_message(), but with the blocking mode given
+ * by @blocking rather than by the socket. */
+static gssize
+g_socket_receive_message_with_blocking (GSocket                 *socket,
+                                        GSocketAddress         **address,
+                                        GInputVector            *vectors,
+                                        gint                     num_vectors,
+                                        GSocketControlMessage ***messages,
+                                        gint                    *num_messages,
+                                        gint                    *flags,
+                                        gboolean                 blocking,
+                                        GCancellable            *cancellable,
+                                        GError                 **error)
 {
   GInputVector one_vector;
   char one_byte;
@@ -4071,7 +4208,7 @@ g_socket_receive_message (GSocket                 *socket,
     /* do it */
     while (1)
       {
-	if (socket->priv->blocking &&
+	if (blocking &&
 	    !g_socket_condition_wait (socket,
 				      G_IO_IN, cancellable, error))
 	  return -1;
@@ -4093,7 +4230,7 @@ g_socket_receive_message (GSocket                 *socket,
 	    if (errsv == EINTR)
 	      continue;
 
-	    if (socket->priv->blocking &&
+	    if (blocking &&
 		(errsv == EWOULDBLOCK ||
 		 errsv == EAGAIN))
 	      continue;
@@ -4118,58 +4255,7 @@ g_socket_receive_message (GSocket                 *socket,
       }
 
     /* decode control messages */
-    {
-      GPtrArray *my_messages = NULL;
-      struct cmsghdr *cmsg;
-
-      for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg))
-	{
-	  GSocketControlMessage *message;
-
-	  message = g_socket_control_message_deserialize (cmsg->cmsg_level,
-							  cmsg->cmsg_type,
-							  cmsg->cmsg_len - ((char *)CMSG_DATA (cmsg) - (char *)cmsg),
-							  CMSG_DATA (cmsg));
-	  if (message == NULL)
-	    /* We've already spewed about the problem in the
-	       deserialization code, so just continue */
-	    continue;
-
-	  if (messages == NULL)
-	    {
-	      /* we have to do it this way if the user ignores the
-	       * messages so that we will close any received fds.
-	       */
-	      g_object_unref (message);
-	    }
-	  else
-	    {
-	      if (my_messages == NULL)
-		my_messages = g_ptr_array_new ();
-	      g_ptr_array_add (my_messages, message);
-	    }
-	}
-
-      if (num_messages)
-	*num_messages = my_messages != NULL ? my_messages->len : 0;
-
-      if (messages)
-	{
-	  if (my_messages == NULL)
-	    {
-	      *messages = NULL;
-	    }
-	  else
-	    {
-	      g_ptr_array_add (my_messages, NULL);
-	      *messages = (GSocketControlMessage **) g_ptr_array_free (my_messages, FALSE);
-	    }
-	}
-      else
-	{
-	  g_assert (my_messages == NULL);
-	}
-    }
+    control_messages_deserialize (&msg, messages, num_messages);
 
     /* capture the flags */
     if (flags != NULL)
@@ -4204,7 +4290,7 @@ g_socket_receive_message (GSocket                 *socket,
     /* do it */
     while (1)
       {
-	if (socket->priv->blocking &&
+	if (blocking &&
 	    !g_socket_condition_wait (socket,
 				      G_IO_IN, cancellable, error))
 	  return -1;
@@ -4230,7 +4316,7 @@ g_socket_receive_message (GSocket                 *socket,
 
 	    win32_unset_event_mask (socket, FD_READ);
 
-	    if (socket->priv->blocking &&
+	    if (blocking &&
 		errsv == WSAEWOULDBLOCK)
 	      continue;
 
@@ -4267,6 +4353,608 @@ g_socket_receive_message (GSocket                 *socket,
 #endif
 }
 
+/* The number of messages passed to the kernel in one sendmmsg() or
+ * recvmmsg() call, which is limited to UIO_MAXIOV on Linux. */
+#define MAX_MMSG_BATCH 1024
+
+/* Space reserved for control messages per received message, as
+ * g_socket_receive_message() does. */
+#define RECV_CONTROL_SPACE 2048
+
+/* Whether a vector struct can be handed to the kernel as a struct
+ * iovec; this entire expression will be evaluated at compile time */
+#define VECTOR_IS_IOVEC(type) \
+  (sizeof (struct iovec) == sizeof (type) && \
+   sizeof ((struct iovec *) 0)->iov_base == sizeof ((type *) 0)->buffer && \
+   G_STRUCT_OFFSET (struct iovec, iov_base) == G_STRUCT_OFFSET (type, buffer) && \
+   sizeof ((struct iovec *) 0)->iov_len == sizeof ((type *) 0)->size && \
+   G_STRUCT_OFFSET (struct iovec, iov_len) == G_STRUCT_OFFSET (type, size))
+
+#if defined (HAVE_SENDMMSG) && !defined (G_OS_WIN32)
+/* Sends up to MAX_MMSG_BATCH of @messages with a single sendmmsg().
+ * Sets %G_IO_ERROR_NOT_SUPPORTED if the kernel lacks the call. */
+static gint
+socket_send_mmsg (GSocket         *socket,
+                  GOutputMessage  *messages,
+                  guint            num_messages,
+                  gint             flags,
+                  GCancellable    *cancellable,
+                  GError         **error)
+{
+  struct mmsghdr *msgvec;
+  struct sockaddr_storage *addrs = NULL;
+  guint8 *control = NULL;
+  gsize control_size = 0;
+  guint i;
+  gint result = -1;
+
+  num_messages = MIN (num_messages, MAX_MMSG_BATCH);
+  msgvec = g_new0 (struct mmsghdr, num_messages);
+
+  for (i = 0; i < num_messages; i++)
+    control_size += control_messages_space (messages[i].control_messages,
+                                            messages[i].num_control_messages);
+  if (control_size > 0)
+    control = g_malloc0 (control_size);
+
+  for (i = 0, control_size = 0; i < num_messages; i++)
+    {
+      GOutputMessage *message = &messages[i];
+      struct msghdr *msg = &msgvec[i].msg_hdr;
+
+      if (message->address)
+        {
+          if (addrs == NULL)
+            addrs = g_new (struct sockaddr_storage, num_messages);
+
+          msg->msg_name = &addrs[i];
+          msg->msg_namelen = g_socket_address_get_native_size (message->address);
+          if (!g_socket_address_to_native (message->address, msg->msg_name,
+                                           sizeof addrs[i], error))
+            goto out;
+        }
+
+      msg->msg_iov = (struct iovec *) message->vectors;
+      msg->msg_iovlen = message->num_vectors;
+
+      msg->msg_controllen = control_messages_space (message->control_messages,
+                                                    message->num_control_messages);
+      if (msg->msg_controllen > 0)
+        {
+          msg->msg_control = control + control_size;
+          control_messages_serialize (msg, message->control_messages,
+                                      message->num_control_messages);
+          control_size += msg->msg_controllen;
+        }
+    }
+
+  while (1)
+    {
+      if (socket->priv->blocking &&
+          !g_socket_condition_wait (socket,
+                                    G_IO_OUT, cancellable, error))
+        goto out;
+
+      result = sendmmsg (socket->priv->fd, msgvec, num_messages,
+                         flags | G_SOCKET_DEFAULT_SEND_FLAGS);
+      if (result < 0)
+        {
+          int errsv = get_socket_errno ();
+
+          if (errsv == EINTR)
+            continue;
+
+          if (socket->priv->blocking &&
+              (errsv == EWOULDBLOCK ||
+               errsv == EAGAIN))
+            continue;
+
+          if (errsv == ENOSYS)
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                 socket_strerror (errsv));
+          else
+            g_set_error (error, G_IO_ERROR,
+                         socket_io_error_from_errno (errsv),
+                         _("Error sending message: %s"), socket_strerror (errsv));
+          goto out;
+        }
+      break;
+    }
+
+  for (i = 0; i < (guint) result; i++)
+    messages[i].bytes_sent = msgvec[i].msg_len;
+
+ out:
+  g_free (control);
+  g_free (addrs);
+  g_free (msgvec);
+
+  return result;
+}
+#endif
+
+/* Returns the number of bytes in the vectors of @message */
+static gsize
+output_message_size (GOutputMessage *message)
+{
+  gsize size = 0;
+  guint i;
+
+  for (i = 0; i < message->num_vectors; i++)
+    size += message->vectors[i].size;
+
+  return size;
+}
+
+/* Sends the bytes of @message after the first @bytes_sent ones, which
+ * a stream socket did not take with the rest, and updates @bytes_sent.
+ */
+static gboolean
+socket_send_message_rest (GSocket         *socket,
+                          GOutputMessage  *message,
+                          gint             flags,
+                          GCancellable    *cancellable,
+                          GError         **error)
+{
+  GOutputVector *vectors;
+  gboolean success = TRUE;
+
+  vectors = g_new (GOutputVector, message->num_vectors);
+
+  while (success)
+    {
+      gsize skip = message->bytes_sent;
+      guint i, n = 0;
+      gssize result;
+
+      for (i = 0; i < message->num_vectors; i++)
+        {
+          if (skip >= message->vectors[i].size)
+            {
+              skip -= message->vectors[i].size;
+              continue;
+            }
+
+          vectors[n].buffer = (const guint8 *) message->vectors[i].buffer + skip;
+          vectors[n].size = message->vectors[i].size - skip;
+          skip = 0;
+          n++;
+        }
+
+      if (n == 0)
+        break;
+
+      result = g_socket_send_message (socket, NULL, vectors, n, NULL, 0,
+                                      flags, cancellable, error);
+      if (result < 0)
+        success = FALSE;
+      else
+        message->bytes_sent += result;
+    }
+
+  g_free (vectors);
+
+  return success;
+}
+
+/**
+ * g_socket_send_messages:
+ * @socket: a #GSocket
+ * @messages: (array length=num_messages): an array of #GOutputMessage structs
+ * @num_messages: the number of elements in @messages
+ * @flags: an int containing #GSocketMsgFlags flags
+ * @cancellable: (allow-none): a %GCancellable or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Send multiple data messages from @socket in one go.  This is the most
+ * complicated and fully-featured version of this call. For easier use, see
+ * g_socket_send(), g_socket_send_to(), and g_socket_send_message().
+ *
+ * @messages must point to an array of #GOutputMessage structs and
+ * @num_messages must be the length of this array. Each #GOutputMessage
+ * contains an address to send the data to, and a pointer to an array of
+ * #GOutputVector structs to describe the buffers that the data to be sent
+ * for each message will be gathered from, as well as the control messages
+ * to send along with it, just like the arguments of
+ * g_socket_send_message(). On return, the @bytes_sent field of each
+ * message that was sent is set to the number of bytes sent for it.
+ *
+ * @flags modify how all messages are sent. The commonly available
+ * arguments for this are available in the #GSocketMsgFlags enum, but the
+ * values there are the same as the system values, and the flags
+ * are passed in as-is, so you can pass in system-specific flags too.
+ *
+ * Where the platform has sendmmsg(), as Linux does, many messages are
+ * passed to the kernel in a single system call, which is considerably
+ * cheaper than calling g_socket_send_message() once per datagram.
+ * Elsewhere, and for stream sockets, the messages are sent one at a
+ * time.
+ *
+ * If the socket is in blocking mode the call will block until there is
+ * space for all the data in the socket queue. If the socket is in
+ * non-blocking mode, as many messages as fit are sent and their number
+ * is returned; if none can be sent, a %G_IO_ERROR_WOULD_BLOCK error is
+ * returned. An error that occurs after some messages have been sent is
+ * not reported; the number of messages sent so far is returned instead,
+ * and the error will normally occur again on the next call.
+ *
+ * A stream socket may accept only part of a message. In blocking mode
+ * the rest of it is sent before going on with the next message. In
+ * non-blocking mode, or if sending the rest fails, the partly sent
+ * message is the last one counted in the return value, and its
+ * @bytes_sent is smaller than the total size of its vectors; the
+ * caller has to send the remaining bytes itself.
+ *
+ * On error -1 is returned and @error is set accordingly.
+ *
+ * Returns: number of messages sent, or -1 on error. Note that the number
+ *     of messages sent may be smaller than @num_messages if the socket is
+ *     non-blocking or if an error occurred after the first message.
+ *
+ * Since: 2.34
+ */
+gint
+g_socket_send_messages (GSocket         *socket,
+                        GOutputMessage  *messages,
+                        guint            num_messages,
+                        gint             flags,
+                        GCancellable    *cancellable,
+                        GError         **error)
+{
+  GError *my_error = NULL;
+  guint sent = 0;
+  gssize result;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), -1);
+  g_return_val_if_fail (num_messages == 0 || messages != NULL, -1);
+  g_return_val_if_fail (error == NULL || *error == NULL, -1);
+
+  if (!check_socket (socket, error))
+    return -1;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+#if defined (HAVE_SENDMMSG) && !defined (G_OS_WIN32)
+  /* sendmmsg() does not stop after a message that a stream socket
+   * only took part of, so it is only used for the other types.
+   */
+  if (VECTOR_IS_IOVEC (GOutputVector) &&
+      socket->priv->type != G_SOCKET_TYPE_STREAM)
+    {
+      while (sent < num_messages)
+        {
+          result = socket_send_mmsg (socket, messages + sent,
+                                     num_messages - sent, flags,
+                                     cancellable, &my_error);
+          if (result < 0)
+            break;
+
+          sent += result;
+        }
+
+      if (sent > 0 || my_error == NULL)
+        {
+          g_clear_error (&my_error);
+          return sent;
+        }
+
+      if (!g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      /* No sendmmsg() in the running kernel */
+      g_clear_error (&my_error);
+    }
+#endif
+
+  for (; sent < num_messages; sent++)
+    {
+      GOutputMessage *message = &messages[sent];
+
+      result = g_socket_send_message (socket, message->address,
+                                      message->vectors, message->num_vectors,
+                                      message->control_messages,
+                                      message->num_control_messages,
+                                      flags, cancellable, &my_error);
+      if (result < 0)
+        {
+          if (sent > 0)
+            {
+              g_error_free (my_error);
+              return sent;
+            }
+
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      message->bytes_sent = result;
+
+      /* Nothing may follow a message that was not sent completely */
+      if (message->bytes_sent < output_message_size (message) &&
+          (!socket->priv->blocking ||
+           !socket_send_message_rest (socket, message, flags,
+                                      cancellable, NULL)))
+        return sent + 1;
+    }
+
+  return sent;
+}
+
+#if defined (HAVE_RECVMMSG) && !defined (G_OS_WIN32)
+/* Receives up to MAX_MMSG_BATCH of @messages with a single recvmmsg().
+ * Sets %G_IO_ERROR_NOT_SUPPORTED if the kernel lacks the call. */
+static gint
+socket_receive_mmsg (GSocket         *socket,
+                     GInputMessage   *messages,
+                     guint            num_messages,
+                     gint             flags,
+                     GCancellable    *cancellable,
+                     GError         **error)
+{
+  struct mmsghdr *msgvec;
+  struct sockaddr_storage *addrs = NULL;
+  guint8 *control = NULL;
+  guint n_control = 0;
+  guint i;
+  gint result = -1;
+
+  num_messages = MIN (num_messages, MAX_MMSG_BATCH);
+  msgvec = g_new0 (struct mmsghdr, num_messages);
+
+  /* Only messages whose caller wants control messages get a buffer
+   * for them; the kernel discards (and closes) the others. */
+  for (i = 0; i < num_messages; i++)
+    if (messages[i].control_messages != NULL)
+      n_control++;
+  if (n_control > 0)
+    control = g_malloc (n_control * RECV_CONTROL_SPACE);
+
+  for (i = 0, n_control = 0; i < num_messages; i++)
+    {
+      GInputMessage *message = &messages[i];
+      struct msghdr *msg = &msgvec[i].msg_hdr;
+
+      if (message->address)
+        {
+          if (addrs == NULL)
+            addrs = g_new (struct sockaddr_storage, num_messages);
+
+          msg->msg_name = &addrs[i];
+          msg->msg_namelen = sizeof (struct sockaddr_storage);
+        }
+
+      msg->msg_iov = (struct iovec *) message->vectors;
+      msg->msg_iovlen = message->num_vectors;
+
+      if (message->control_messages != NULL)
+        {
+          msg->msg_control = control + n_control++ * RECV_CONTROL_SPACE;
+          msg->msg_controllen = RECV_CONTROL_SPACE;
+        }
+    }
+
+  /* We always set the close-on-exec flag so we don't leak file
+   * descriptors into child processes, as g_socket_receive_message()
+   * does.
+   */
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  while (1)
+    {
+      if (socket->priv->blocking &&
+          !g_socket_condition_wait (socket,
+                                    G_IO_IN, cancellable, error))
+        goto out;
+
+      result = recvmmsg (socket->priv->fd, msgvec, num_messages, flags, NULL);
+#ifdef MSG_CMSG_CLOEXEC
+      if (result < 0 && get_socket_errno () == EINVAL)
+        {
+          /* We must be running on an old kernel.  Call without the flag. */
+          flags &= ~(MSG_CMSG_CLOEXEC);
+          result = recvmmsg (socket->priv->fd, msgvec, num_messages, flags, NULL);
+        }
+#endif
+
+      if (result < 0)
+        {
+          int errsv = get_socket_errno ();
+
+          if (errsv == EINTR)
+            continue;
+
+          if (socket->priv->blocking &&
+              (errsv == EWOULDBLOCK ||
+               errsv == EAGAIN))
+            continue;
+
+          if (errsv == ENOSYS)
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                 socket_strerror (errsv));
+          else
+            g_set_error (error, G_IO_ERROR,
+                         socket_io_error_from_errno (errsv),
+                         _("Error receiving message: %s"), socket_strerror (errsv));
+          goto out;
+        }
+      break;
+    }
+
+  for (i = 0; i < (guint) result; i++)
+    {
+      GInputMessage *message = &messages[i];
+      struct msghdr *msg = &msgvec[i].msg_hdr;
+
+      message->bytes_received = msgvec[i].msg_len;
+      message->flags = msg->msg_flags;
+
+      if (message->address != NULL)
+        {
+          if (msg->msg_namelen > 0)
+            *message->address = g_socket_address_new_from_native (msg->msg_name,
+                                                                  msg->msg_namelen);
+          else
+            *message->address = NULL;
+        }
+
+      if (message->control_messages != NULL)
+        {
+          gint n;
+
+          control_messages_deserialize (msg, message->control_messages, &n);
+          if (message->num_control_messages != NULL)
+            *message->num_control_messages = n;
+        }
+      else if (message->num_control_messages != NULL)
+        *message->num_control_messages = 0;
+    }
+
+ out:
+  g_free (control);
+  g_free (addrs);
+  g_free (msgvec);
+
+  return result;
+}
+#endif
+
+/**
+ * g_socket_receive_messages:
+ * @socket: a #GSocket
+ * @messages: (array length=num_messages): an array of #GInputMessage structs
+ * @num_messages: the number of elements in @messages
+ * @flags: an int containing #GSocketMsgFlags flags for the overall operation
+ * @cancellable: (allow-none): a %GCancellable or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore
+ *
+ * Receive multiple data messages from @socket in one go.  This is the most
+ * complicated and fully-featured version of this call. For easier use, see
+ * g_socket_receive(), g_socket_receive_from(), and
+ * g_socket_receive_message().
+ *
+ * @messages must point to an array of #GInputMessage structs and
+ * @num_messages must be the length of this array. Each #GInputMessage
+ * describes the buffers that the data of one received message will be
+ * scattered into, and where to store its source address, its control
+ * messages and its flags, just like the arguments of
+ * g_socket_receive_message(). On return, the @bytes_received field of
+ * each message that was received is set to the number of bytes received
+ * for it.
+ *
+ * @flags modify how all messages are received. The commonly available
+ * arguments for this are available in the #GSocketMsgFlags enum, but the
+ * values there are the same as the system values, and the flags
+ * are passed in as-is, so you can pass in system-specific flags too.
+ *
+ * Where the platform has recvmmsg(), as Linux does, all the messages
+ * already queued on the socket, up to @num_messages, are fetched in a
+ * single system call. Elsewhere they are received one at a time.
+ *
+ * As with g_socket_receive(), data may be discarded if @socket is
+ * %G_SOCKET_TYPE_DATAGRAM or %G_SOCKET_TYPE_SEQPACKET and you do not
+ * provide enough buffer space to read a complete message.
+ *
+ * If the socket is in blocking mode the call will block until there
+ * is at least one message to receive, and then return the messages that
+ * can be received without blocking. If there is no data available and
+ * the socket is in non-blocking mode, a %G_IO_ERROR_WOULD_BLOCK error
+ * will be returned. To be notified when data is available, wait for the
+ * %G_IO_IN condition.
+ *
+ * On error -1 is returned and @error is set accordingly. An error that
+ * occurs after some messages have been received is not reported; the
+ * number of messages received so far is returned instead.
+ *
+ * Returns: number of messages received, or -1 on error. Note that the
+ *     number of messages received may be smaller than @num_messages.
+ *
+ * Since: 2.34
+ */
+gint
+g_socket_receive_messages (GSocket         *socket,
+                           GInputMessage   *messages,
+                           guint            num_messages,
+                           gint             flags,
+                           GCancellable    *cancellable,
+                           GError         **error)
+{
+  GError *my_error = NULL;
+  guint received;
+  gssize result;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), -1);
+  g_return_val_if_fail (num_messages == 0 || messages != NULL, -1);
+  g_return_val_if_fail (error == NULL || *error == NULL, -1);
+
+  if (!check_socket (socket, error))
+    return -1;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+  if (num_messages == 0)
+    return 0;
+
+#if defined (HAVE_RECVMMSG) && !defined (G_OS_WIN32)
+  if (VECTOR_IS_IOVEC (GInputVector))
+    {
+      result = socket_receive_mmsg (socket, messages, num_messages, flags,
+                                    cancellable, &my_error);
+      if (result >= 0)
+        return result;
+
+      if (!g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      /* No recvmmsg() in the running kernel */
+      g_clear_error (&my_error);
+    }
+#endif
+
+  /* Only the first message may block */
+  for (received = 0; received < num_messages; received++)
+    {
+      GInputMessage *message = &messages[received];
+      gint msg_flags = flags;
+      gint n_control;
+
+      result = g_socket_receive_message_with_blocking (socket, message->address,
+                                                       message->vectors,
+                                                       message->num_vectors,
+                                                       message->control_messages,
+                                                       &n_control, &msg_flags,
+                                                       received == 0 && socket->priv->blocking,
+                                                       cancellable, &my_error);
+      if (result < 0)
+        {
+          if (received > 0)
+            {
+              g_error_free (my_error);
+              return received;
+            }
+
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      message->bytes_received = result;
+      message->flags = msg_flags;
+      if (message->num_control_messages != NULL)
+        *message->num_control_messages = n_control;
+    }
+
+  return received;
+}
+
 /**
  * g_socket_get_credentials:
  * @socket: a #GSocket.
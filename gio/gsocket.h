@@ -195,6 +195,20 @@ gssize                 g_socket_send_message            (GSocket
 							 gint                     flags,
 							 GCancellable            *cancellable,
 							 GError                 **error);
+GLIB_AVAILABLE_IN_2_34
+gint                   g_socket_receive_messages        (GSocket                 *socket,
+							 GInputMessage           *messages,
+							 guint                    num_messages,
+							 gint                     flags,
+							 GCancellable            *cancellable,
+							 GError                 **error);
+GLIB_AVAILABLE_IN_2_34
+gint                   g_socket_send_messages           (GSocket                 *socket,
+							 GOutputMessage          *messages,
+							 guint                    num_messages,
+							 gint                     flags,
+							 GCancellable            *cancellable,
+							 GError                 **error);
 gboolean               g_socket_close                   (GSocket                 *socket,
 							 GError                 **error);
 gboolean               g_socket_shutdown                (GSocket                 *socket,
@@ -36,6 +36,14 @@
 #include "gioerror.h"
 #include "glibintl.h"
 #include "gfiledescriptorbased.h"
+#include "gnetworkingprivate.h"
+
+#include <limits.h>
+
+/* sendmsg() fails with EMSGSIZE beyond this; POSIX guarantees 16 */
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
 
 static void g_socket_output_stream_pollable_iface_init (GPollableOutputStreamInterface *iface);
 #ifdef G_OS_UNIX
@@ -136,6 +144,39 @@ g_socket_output_stream_write (GOutputStream  *stream,
 				      cancellable, error);
 }
 
+static gssize
+g_socket_output_stream_writev_with_blocking (GSocketOutputStream  *output_stream,
+					     const GOutputVector  *vectors,
+					     gsize                 n_vectors,
+					     gboolean              blocking,
+					     GCancellable         *cancellable,
+					     GError              **error)
+{
+  if (n_vectors > IOV_MAX)
+    n_vectors = IOV_MAX;
+
+  /* The vectors are only read from */
+  return _g_socket_send_message_with_blocking (output_stream->priv->socket,
+					       NULL,
+					       (GOutputVector *) vectors,
+					       n_vectors,
+					       NULL, 0, 0,
+					       blocking,
+					       cancellable, error);
+}
+
+static gssize
+g_socket_output_stream_writev (GOutputStream        *stream,
+			       const GOutputVector  *vectors,
+			       gsize                 n_vectors,
+			       GCancellable         *cancellable,
+			       GError              **error)
+{
+  return g_socket_output_stream_writev_with_blocking (G_SOCKET_OUTPUT_STREAM (stream),
+						      vectors, n_vectors, TRUE,
+						      cancellable, error);
+}
+
 static gboolean
 g_socket_output_stream_pollable_is_writable (GPollableOutputStream *pollable)
 {
@@ -157,6 +198,17 @@ g_socket_output_stream_pollable_write_nonblocking (GPollableOutputStream  *polla
 				      NULL, error);
 }
 
+static gssize
+g_socket_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *pollable,
+						    const GOutputVector    *vectors,
+						    gsize                   n_vectors,
+						    GError                **error)
+{
+  return g_socket_output_stream_writev_with_blocking (G_SOCKET_OUTPUT_STREAM (pollable),
+						      vectors, n_vectors, FALSE,
+						      NULL, error);
+}
+
 static GSource *
 g_socket_output_stream_pollable_create_source (GPollableOutputStream *pollable,
 					       GCancellable          *cancellable)
@@ -197,6 +249,7 @@ g_socket_output_stream_class_init (GSocketOutputStreamClass *klass)
   gobject_class->set_property = g_socket_output_stream_set_property;
 
   goutputstream_class->write_fn = g_socket_output_stream_write;
+  goutputstream_class->writev_fn = g_socket_output_stream_writev;
 
   g_object_class_install_property (gobject_class, PROP_SOCKET,
 				   g_param_spec_object ("socket",
@@ -220,6 +273,7 @@ g_socket_output_stream_pollable_iface_init (GPollableOutputStreamInterface *ifac
   iface->is_writable = g_socket_output_stream_pollable_is_writable;
   iface->create_source = g_socket_output_stream_pollable_create_source;
   iface->write_nonblocking = g_socket_output_stream_pollable_write_nonblocking;
+  iface->writev_nonblocking = g_socket_output_stream_pollable_writev_nonblocking;
 }
 
 static void
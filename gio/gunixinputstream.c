@@ -92,6 +92,11 @@ static gssize   g_unix_input_stream_read         (GInputStream         *stream,
 						  gsize                 count,
 						  GCancellable         *cancellable,
 						  GError              **error);
+static gssize   g_unix_input_stream_readv        (GInputStream         *stream,
+						  GInputVector         *vectors,
+						  gsize                 n_vectors,
+						  GCancellable         *cancellable,
+						  GError              **error);
 static gboolean g_unix_input_stream_close        (GInputStream         *stream,
 						  GCancellable         *cancellable,
 						  GError              **error);
@@ -115,6 +120,10 @@ static gboolean g_unix_input_stream_close_finish (GInputStream         *stream,
 
 static gboolean g_unix_input_stream_pollable_can_poll      (GPollableInputStream *stream);
 static gboolean g_unix_input_stream_pollable_is_readable   (GPollableInputStream *stream);
+static gssize   g_unix_input_stream_pollable_readv_nonblocking (GPollableInputStream  *stream,
+								GInputVector          *vectors,
+								gsize                  n_vectors,
+								GError               **error);
 static GSource *g_unix_input_stream_pollable_create_source (GPollableInputStream *stream,
 							    GCancellable         *cancellable);
 
@@ -137,6 +146,7 @@ g_unix_input_stream_class_init (GUnixInputStreamClass *klass)
   gobject_class->finalize = g_unix_input_stream_finalize;
 
   stream_class->read_fn = g_unix_input_stream_read;
+  stream_class->readv_fn = g_unix_input_stream_readv;
   stream_class->close_fn = g_unix_input_stream_close;
   if (0)
     {
@@ -184,6 +194,7 @@ g_unix_input_stream_pollable_iface_init (GPollableInputStreamInterface *iface)
   iface->can_poll = g_unix_input_stream_pollable_can_poll;
   iface->is_readable = g_unix_input_stream_pollable_is_readable;
   iface->create_source = g_unix_input_stream_pollable_create_source;
+  iface->readv_nonblocking = g_unix_input_stream_pollable_readv_nonblocking;
 }
 
 static void
@@ -412,6 +423,75 @@ g_unix_input_stream_read (GInputStream  *stream,
   return res;
 }
 
+static gssize
+g_unix_input_stream_readv (GInputStream  *stream,
+			   GInputVector  *vectors,
+			   gsize          n_vectors,
+			   GCancellable  *cancellable,
+			   GError       **error)
+{
+  GUnixInputStream *unix_stream;
+  gssize res = -1;
+  GPollFD poll_fds[2];
+  int nfds;
+  int poll_ret;
+
+  unix_stream = G_UNIX_INPUT_STREAM (stream);
+
+  poll_fds[0].fd = unix_stream->priv->fd;
+  poll_fds[0].events = G_IO_IN;
+  if (unix_stream->priv->is_pipe_or_socket &&
+      g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+    nfds = 2;
+  else
+    nfds = 1;
+
+  while (1)
+    {
+      poll_fds[0].revents = poll_fds[1].revents = 0;
+      do
+	poll_ret = g_poll (poll_fds, nfds, -1);
+      while (poll_ret == -1 && errno == EINTR);
+
+      if (poll_ret == -1)
+	{
+          int errsv = errno;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error reading from file descriptor: %s"),
+		       g_strerror (errsv));
+	  break;
+	}
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	break;
+
+      if (!poll_fds[0].revents)
+	continue;
+
+      res = _g_fd_readv (unix_stream->priv->fd, vectors, n_vectors);
+      if (res == -1)
+	{
+          int errsv = errno;
+
+	  if (errsv == EINTR || errsv == EAGAIN)
+	    continue;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error reading from file descriptor: %s"),
+		       g_strerror (errsv));
+	}
+
+      break;
+    }
+
+  if (nfds == 2)
+    g_cancellable_release_fd (cancellable);
+  return res;
+}
+
 static gboolean
 g_unix_input_stream_close (GInputStream  *stream,
 			   GCancellable  *cancellable,
@@ -585,6 +665,23 @@ g_unix_input_stream_pollable_is_readable (GPollableInputStream *stream)
   return poll_fd.revents != 0;
 }
 
+static gssize
+g_unix_input_stream_pollable_readv_nonblocking (GPollableInputStream  *stream,
+						GInputVector          *vectors,
+						gsize                  n_vectors,
+						GError               **error)
+{
+  if (!g_pollable_input_stream_is_readable (stream))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK,
+			   g_strerror (EAGAIN));
+      return -1;
+    }
+
+  return g_unix_input_stream_readv (G_INPUT_STREAM (stream),
+				    vectors, n_vectors, NULL, error);
+}
+
 static GSource *
 g_unix_input_stream_pollable_create_source (GPollableInputStream *stream,
 					    GCancellable         *cancellable)
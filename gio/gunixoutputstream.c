@@ -92,6 +92,11 @@ static gssize   g_unix_output_stream_write        (GOutputStream        *stream,
 						   gsize                 count,
 						   GCancellable         *cancellable,
 						   GError              **error);
+static gssize   g_unix_output_stream_writev       (GOutputStream        *stream,
+						   const GOutputVector  *vectors,
+						   gsize                 n_vectors,
+						   GCancellable         *cancellable,
+						   GError              **error);
 static gboolean g_unix_output_stream_close        (GOutputStream        *stream,
 						   GCancellable         *cancellable,
 						   GError              **error);
@@ -105,6 +110,10 @@ static gboolean g_unix_output_stream_close_finish (GOutputStream        *stream,
 						   GError              **error);
 
 static gboolean g_unix_output_stream_pollable_is_writable   (GPollableOutputStream *stream);
+static gssize   g_unix_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *stream,
+								  const GOutputVector    *vectors,
+								  gsize                   n_vectors,
+								  GError                **error);
 static GSource *g_unix_output_stream_pollable_create_source (GPollableOutputStream *stream,
 							     GCancellable         *cancellable);
 
@@ -127,6 +136,7 @@ g_unix_output_stream_class_init (GUnixOutputStreamClass *klass)
   gobject_class->finalize = g_unix_output_stream_finalize;
 
   stream_class->write_fn = g_unix_output_stream_write;
+  stream_class->writev_fn = g_unix_output_stream_writev;
   stream_class->close_fn = g_unix_output_stream_close;
   stream_class->close_async = g_unix_output_stream_close_async;
   stream_class->close_finish = g_unix_output_stream_close_finish;
@@ -167,6 +177,7 @@ g_unix_output_stream_pollable_iface_init (GPollableOutputStreamInterface *iface)
 {
   iface->is_writable = g_unix_output_stream_pollable_is_writable;
   iface->create_source = g_unix_output_stream_pollable_create_source;
+  iface->writev_nonblocking = g_unix_output_stream_pollable_writev_nonblocking;
 }
 
 static void
@@ -396,6 +407,76 @@ g_unix_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+static gssize
+g_unix_output_stream_writev (GOutputStream        *stream,
+			     const GOutputVector  *vectors,
+			     gsize                 n_vectors,
+			     GCancellable         *cancellable,
+			     GError              **error)
+{
+  GUnixOutputStream *unix_stream;
+  gssize res = -1;
+  GPollFD poll_fds[2];
+  int nfds;
+  int poll_ret;
+
+  unix_stream = G_UNIX_OUTPUT_STREAM (stream);
+
+  poll_fds[0].fd = unix_stream->priv->fd;
+  poll_fds[0].events = G_IO_OUT;
+
+  if (unix_stream->priv->is_pipe_or_socket &&
+      g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+    nfds = 2;
+  else
+    nfds = 1;
+
+  while (1)
+    {
+      poll_fds[0].revents = poll_fds[1].revents = 0;
+      do
+	poll_ret = g_poll (poll_fds, nfds, -1);
+      while (poll_ret == -1 && errno == EINTR);
+
+      if (poll_ret == -1)
+	{
+          int errsv = errno;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error writing to file descriptor: %s"),
+		       g_strerror (errsv));
+	  break;
+	}
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	break;
+
+      if (!poll_fds[0].revents)
+	continue;
+
+      res = _g_fd_writev (unix_stream->priv->fd, vectors, n_vectors);
+      if (res == -1)
+	{
+          int errsv = errno;
+
+	  if (errsv == EINTR || errsv == EAGAIN)
+	    continue;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error writing to file descriptor: %s"),
+		       g_strerror (errsv));
+	}
+
+      break;
+    }
+
+  if (nfds == 2)
+    g_cancellable_release_fd (cancellable);
+  return res;
+}
+
 static gboolean
 g_unix_output_stream_close (GOutputStream  *stream,
 			    GCancellable   *cancellable,
@@ -532,6 +613,23 @@ g_unix_output_stream_pollable_is_writable (GPollableOutputStream *stream)
   return poll_fd.revents != 0;
 }
 
+static gssize
+g_unix_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *stream,
+						  const GOutputVector    *vectors,
+						  gsize                   n_vectors,
+						  GError                **error)
+{
+  if (!g_pollable_output_stream_is_writable (stream))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK,
+			   g_strerror (EAGAIN));
+      return -1;
+    }
+
+  return g_unix_output_stream_writev (G_OUTPUT_STREAM (stream),
+				      vectors, n_vectors, NULL, error);
+}
+
 static GSource *
 g_unix_output_stream_pollable_create_source (GPollableOutputStream *stream,
 					     GCancellable          *cancellable)
@@ -164,6 +164,7 @@ gvdb_item_set_parent (GvdbItem *item,
 typedef struct
 {
   GvdbItem **buckets;
+  guchar *seeds;
   gint n_buckets;
 } HashTable;
 
@@ -174,6 +175,7 @@ hash_table_new (gint n_buckets)
 
   table = g_slice_new (HashTable);
   table->buckets = g_new0 (GvdbItem *, n_buckets);
+  table->seeds = g_new0 (guchar, n_buckets);
   table->n_buckets = n_buckets;
 
   return table;
@@ -183,6 +185,7 @@ static void
 hash_table_free (HashTable *table)
 {
   g_free (table->buckets);
+  g_free (table->seeds);
 
   g_slice_free (HashTable, table);
 }
@@ -202,6 +205,71 @@ hash_table_insert (gpointer key,
   table->buckets[bucket] = item;
 }
 
+/* Beyond this, finding a seed that works becomes unlikely */
+#define MAX_PERFECT_BUCKET 12
+
+static guchar
+hash_table_make_bucket_perfect (GvdbItem **bucket)
+{
+  GvdbItem *items[MAX_PERFECT_BUCKET];
+  GvdbItem *slots[MAX_PERFECT_BUCKET];
+  GvdbItem *item;
+  guint n_items = 0;
+  guint seed;
+  guint i;
+
+  for (item = *bucket; item; item = item->next)
+    {
+      if (n_items == MAX_PERFECT_BUCKET)
+        return 0;
+
+      items[n_items++] = item;
+    }
+
+  if (n_items < 2)
+    return 0;
+
+  for (seed = 1; seed <= G_MAXUINT8; seed++)
+    {
+      memset (slots, 0, sizeof slots);
+
+      for (i = 0; i < n_items; i++)
+        {
+          guint32 slot;
+
+          slot = gvdb_perfect_slot (items[i]->hash_value, seed, n_items);
+
+          if (slots[slot] != NULL)
+            break;
+
+          slots[slot] = items[i];
+        }
+
+      if (i == n_items)
+        {
+          /* relink the chain in slot order */
+          for (i = 0; i < n_items - 1; i++)
+            slots[i]->next = slots[i + 1];
+          slots[n_items - 1]->next = NULL;
+          *bucket = slots[0];
+
+          return seed;
+        }
+    }
+
+  return 0;
+}
+
+static void
+hash_table_make_perfect (HashTable *table)
+{
+  gint bucket;
+
+  for (bucket = 0; bucket < table->n_buckets; bucket++)
+    table->seeds[bucket] =
+      hash_table_make_bucket_perfect (&table->buckets[bucket]);
+}
+
 static guint32_le
 item_to_index (GvdbItem *item)
 {
@@ -216,6 +284,7 @@ typedef struct
   GQueue *chunks;
   guint64 offset;
   gboolean byteswap;
+  gboolean perfect_hash;
 } FileBuilder;
 
 typedef struct
@@ -358,6 +427,9 @@ file_builder_add_hash (FileBuilder         *fb,
   g_hash_table_foreach (table, hash_table_insert, mytable);
   index = 0;
 
+  if (fb->perfect_hash)
+    hash_table_make_perfect (mytable);
+
   for (bucket = 0; bucket < mytable->n_buckets; bucket++)
     for (item = mytable->buckets[bucket]; item; item = item->next)
       item->assigned_index = guint32_to_le (index++);
@@ -378,7 +450,11 @@ file_builder_add_hash (FileBuilder         *fb,
           g_assert (index == guint32_from_le (item->assigned_index));
           entry->hash_value = guint32_to_le (item->hash_value);
           entry->parent = item_to_index (item->parent);
-          entry->unused = 0;
+
+          if (item == mytable->buckets[bucket])
+            entry->seed = mytable->seeds[bucket];
+          else
+            entry->seed = 0;
 
           if (item->parent != NULL)
             basename = item->key + strlen (item->parent->key);
@@ -432,7 +508,8 @@ file_builder_add_hash (FileBuilder         *fb,
 }
 
 static FileBuilder *
-file_builder_new (gboolean byteswap)
+file_builder_new (gboolean byteswap,
+                  gboolean perfect_hash)
 {
   FileBuilder *builder;
 
@@ -440,6 +517,7 @@ file_builder_new (gboolean byteswap)
   builder->chunks = g_queue_new ();
   builder->offset = sizeof (struct gvdb_header);
   builder->byteswap = byteswap;
+  builder->perfect_hash = perfect_hash;
 
   return builder;
 }
@@ -499,13 +577,29 @@ gvdb_table_write_contents (GHashTable   *table,
                            const gchar  *filename,
                            gboolean      byteswap,
                            GError      **error)
+{
+  return gvdb_table_write_contents_full (table, filename,
+                                         byteswap, FALSE, error);
+}
+
+/* With @perfect_hash, the items of each bucket are arranged so that
+ * a lookup finds its item with a single probe (see gvdb-format.h).
+ * This makes writing slower but the result can still be read by
+ * readers that do not know about it.
+ */
+gboolean
+gvdb_table_write_contents_full (GHashTable   *table,
+                                const gchar  *filename,
+                                gboolean      byteswap,
+                                gboolean      perfect_hash,
+                                GError      **error)
 {
   struct gvdb_pointer root;
   gboolean status;
   FileBuilder *fb;
   GString *str;
 
-  fb = file_builder_new (byteswap);
+  fb = file_builder_new (byteswap, perfect_hash);
   file_builder_add_hash (fb, table, &root);
   str = file_builder_serialise (fb, root);
 
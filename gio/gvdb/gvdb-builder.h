@@ -22,7 +22,7 @@
 #ifndef __gvdb_builder_h__
 #define __gvdb_builder_h__
 
-#include <gio/gio.h>
+#include <glib.h>
 
 typedef struct _GvdbItem GvdbItem;
 
@@ -53,5 +53,11 @@ gboolean                gvdb_table_write_contents                       (GHashTa
                                                                          const gchar    *filename,
                                                                          gboolean        byteswap,
                                                                          GError        **error);
+G_GNUC_INTERNAL
+gboolean                gvdb_table_write_contents_full                  (GHashTable     *table,
+                                                                         const gchar    *filename,
+                                                                         gboolean        byteswap,
+                                                                         gboolean        perfect_hash,
+                                                                         GError        **error);
 
 #endif /* __gvdb_builder_h__ */
@@ -44,7 +44,7 @@ struct gvdb_hash_item {
   guint32_le key_start;
   guint16_le key_size;
   gchar type;
-  gchar unused;
+  guchar seed;
 
   union
   {
@@ -79,6 +79,27 @@ static inline guint16 guint16_from_le (guint16_le value) {
   return GUINT16_FROM_LE (value.value);
 }
 
+/* A bucket holding more than one item may be laid out as a minimal
+ * perfect hash: if the 'seed' of the first item in the bucket is
+ * non-zero then each item sits at the offset given by
+ * gvdb_perfect_slot() within the bucket, so a lookup only needs to
+ * look at a single item.  Buckets with a zero seed (including every
+ * bucket written by older builders) are searched linearly, and since
+ * items are still grouped by bucket, readers that ignore the seed
+ * continue to work.
+ */
+static inline guint32 gvdb_perfect_slot (guint32 hash_value,
+                                         guchar  seed,
+                                         guint32 n_slots) {
+  guint32 value = hash_value ^ (seed * 0x9e3779b9u);
+
+  value ^= value >> 16;
+  value *= 0x85ebca6bu;
+  value ^= value >> 13;
+
+  return ((guint64) value * n_slots) >> 32;
+}
+
 #define GVDB_SIGNATURE0 1918981703
 #define GVDB_SIGNATURE1 1953390953
 #define GVDB_SWAPPED_SIGNATURE0 GUINT32_SWAP_LE_BE (GVDB_SIGNATURE0)
@@ -304,13 +304,28 @@ gvdb_table_check_name (GvdbTable             *file,
   return FALSE;
 }
 
-static const struct gvdb_hash_item *
-gvdb_table_lookup (GvdbTable   *file,
-                   const gchar *key,
-                   gchar        type)
+static guint32
+gvdb_table_hash_key (const gchar *key,
+                     guint       *key_length)
 {
   guint32 hash_value = 5381;
-  guint key_length;
+  guint length;
+
+  for (length = 0; key[length]; length++)
+    hash_value = (hash_value * 33) + ((signed char *) key)[length];
+
+  *key_length = length;
+
+  return hash_value;
+}
+
+static const struct gvdb_hash_item *
+gvdb_table_lookup_hashed (GvdbTable   *file,
+                          const gchar *key,
+                          guint        key_length,
+                          guint32      hash_value,
+                          gchar        type)
+{
   guint32 bucket;
   guint32 lastno;
   guint32 itemno;
@@ -318,9 +333,6 @@ gvdb_table_lookup (GvdbTable   *file,
   if G_UNLIKELY (file->n_buckets == 0 || file->n_hash_items == 0)
     return NULL;
 
-  for (key_length = 0; key[key_length]; key_length++)
-    hash_value = (hash_value * 33) + ((signed char *) key)[key_length];
-
   if (!gvdb_table_bloom_filter (file, hash_value))
     return NULL;
 
@@ -331,6 +343,14 @@ gvdb_table_lookup (GvdbTable   *file,
       (lastno = guint32_from_le(file->hash_buckets[bucket + 1])) > file->n_hash_items)
     lastno = file->n_hash_items;
 
+  if (itemno + 1 < lastno && file->hash_items[itemno].seed != 0)
+    {
+      itemno += gvdb_perfect_slot (hash_value,
+                                   file->hash_items[itemno].seed,
+                                   lastno - itemno);
+      lastno = itemno + 1;
+    }
+
   while G_LIKELY (itemno < lastno)
     {
       struct gvdb_hash_item *item = &file->hash_items[itemno];
@@ -346,6 +366,19 @@ gvdb_table_lookup (GvdbTable   *file,
   return NULL;
 }
 
+static const struct gvdb_hash_item *
+gvdb_table_lookup (GvdbTable   *file,
+                   const gchar *key,
+                   gchar        type)
+{
+  guint32 hash_value;
+  guint key_length;
+
+  hash_value = gvdb_table_hash_key (key, &key_length);
+
+  return gvdb_table_lookup_hashed (file, key, key_length, hash_value, type);
+}
+
 static const struct gvdb_hash_item *
 gvdb_table_get_item (GvdbTable  *table,
                      guint32_le  item_no)
@@ -481,6 +514,26 @@ gvdb_table_value_from_item (GvdbTable                   *table,
   return value;
 }
 
+static GVariant *
+gvdb_table_cooked_value_from_item (GvdbTable                   *table,
+                                   const struct gvdb_hash_item *item)
+{
+  GVariant *value;
+
+  value = gvdb_table_value_from_item (table, item);
+
+  if (value && table->byteswapped)
+    {
+      GVariant *tmp;
+
+      tmp = g_variant_byteswap (value);
+      g_variant_unref (value);
+      value = tmp;
+    }
+
+  return value;
+}
+
 /**
  * gvdb_table_get_value:
  * @file: a #GvdbTable
@@ -501,23 +554,11 @@ gvdb_table_get_value (GvdbTable    *file,
                       const gchar  *key)
 {
   const struct gvdb_hash_item *item;
-  GVariant *value;
 
   if ((item = gvdb_table_lookup (file, key, 'v')) == NULL)
     return NULL;
 
-  value = gvdb_table_value_from_item (file, item);
-
-  if (value && file->byteswapped)
-    {
-      GVariant *tmp;
-
-      tmp = g_variant_byteswap (value);
-      g_variant_unref (value);
-      value = tmp;
-    }
-
-  return value;
+  return gvdb_table_cooked_value_from_item (file, item);
 }
 
 /**
@@ -543,6 +584,103 @@ gvdb_table_get_raw_value (GvdbTable   *table,
   return gvdb_table_value_from_item (table, item);
 }
 
+#if defined(__GNUC__)
+#define gvdb_prefetch(address) __builtin_prefetch (address)
+#else
+#define gvdb_prefetch(address)
+#endif
+
+#define BATCH_SIZE 16
+
+/**
+ * gvdb_table_get_values:
+ * @table: a #GvdbTable
+ * @keys: an array of @n_keys strings
+ * @n_keys: the length of @keys
+ * @values: an array with room for @n_keys #GVariant pointers
+ *
+ * Looks up all of @keys in @table, storing the result of
+ * gvdb_table_get_value() for each of them in the corresponding
+ * element of @values.
+ *
+ * This gives the same results as calling gvdb_table_get_value() in a
+ * loop but is faster for large numbers of keys: all of the keys in a
+ * batch are hashed up front and the parts of the table they need are
+ * prefetched, so the cache misses of one lookup overlap with those of
+ * the others.
+ *
+ * You should call g_variant_unref() on each non-%NULL value when you
+ * no longer require it.
+ **/
+void
+gvdb_table_get_values (GvdbTable           *table,
+                       const gchar * const *keys,
+                       gsize                n_keys,
+                       GVariant           **values)
+{
+  guint32 hash_values[BATCH_SIZE];
+  guint key_lengths[BATCH_SIZE];
+  gsize start, i;
+
+  for (start = 0; start < n_keys; start += BATCH_SIZE)
+    {
+      gsize n = MIN (n_keys - start, BATCH_SIZE);
+
+      for (i = 0; i < n; i++)
+        {
+          hash_values[i] = gvdb_table_hash_key (keys[start + i], &key_lengths[i]);
+
+          if (table->n_buckets)
+            gvdb_prefetch (&table->hash_buckets[hash_values[i] % table->n_buckets]);
+        }
+
+      if (table->n_buckets)
+        for (i = 0; i < n; i++)
+          {
+            guint32 itemno;
+
+            itemno = guint32_from_le (table->hash_buckets[hash_values[i] % table->n_buckets]);
+
+            if (itemno < table->n_hash_items)
+              gvdb_prefetch (&table->hash_items[itemno]);
+          }
+
+      for (i = 0; i < n; i++)
+        {
+          const struct gvdb_hash_item *item;
+
+          item = gvdb_table_lookup_hashed (table, keys[start + i], key_lengths[i],
+                                           hash_values[i], 'v');
+
+          if (item != NULL)
+            values[start + i] = gvdb_table_cooked_value_from_item (table, item);
+          else
+            values[start + i] = NULL;
+        }
+    }
+}
+
+static GvdbTable *
+gvdb_table_table_from_item (GvdbTable                   *file,
+                            const struct gvdb_hash_item *item)
+{
+  GvdbTable *new;
+
+  new = g_slice_new0 (GvdbTable);
+  new->user_data = file->ref_user_data ? file->ref_user_data (file->user_data) : file->user_data;
+  new->ref_user_data = file->ref_user_data;
+  new->unref_user_data = file->unref_user_data;
+  new->byteswapped = file->byteswapped;
+  new->trusted = file->trusted;
+  new->data = file->data;
+  new->size = file->size;
+  new->ref_count = 1;
+
+  gvdb_table_setup_root (new, &item->value.pointer);
+
+  return new;
+}
+
 /**
  * gvdb_table_get_table:
  * @file: a #GvdbTable
@@ -567,26 +705,13 @@ gvdb_table_get_table (GvdbTable   *file,
                       const gchar *key)
 {
   const struct gvdb_hash_item *item;
-  GvdbTable *new;
 
   item = gvdb_table_lookup (file, key, 'H');
 
   if (item == NULL)
     return NULL;
 
-  new = g_slice_new0 (GvdbTable);
-  new->user_data = file->ref_user_data ? file->ref_user_data (file->user_data) : file->user_data;
-  new->ref_user_data = file->ref_user_data;
-  new->unref_user_data = file->unref_user_data;
-  new->byteswapped = file->byteswapped;
-  new->trusted = file->trusted;
-  new->data = file->data;
-  new->size = file->size;
-  new->ref_count = 1;
-
-  gvdb_table_setup_root (new, &item->value.pointer);
-
-  return new;
+  return gvdb_table_table_from_item (file, item);
 }
 
 /**
@@ -741,3 +866,173 @@ gvdb_table_walk (GvdbTable         *table,
         }
     }
 }
+
+/**
+ * gvdb_table_iter_init:
+ * @iter: an uninitialised #GvdbTableIter
+ * @table: a #GvdbTable
+ * @key: a key corresponding to a list
+ * @returns: %TRUE if @key names a list
+ *
+ * Prepares @iter for iterating over the items of the list at @key.
+ *
+ * Unlike gvdb_table_list(), iterating does not allocate anything: the
+ * names are returned as pointers into the data of @table, and the
+ * value, list or table of the current item can be fetched without
+ * looking its name up again.
+ *
+ * If @key does not name a list then %FALSE is returned and the first
+ * call to gvdb_table_iter_next() will return %FALSE.
+ *
+ * @table must not be freed while @iter is in use.
+ **/
+gboolean
+gvdb_table_iter_init (GvdbTableIter *iter,
+                      GvdbTable     *table,
+                      const gchar   *key)
+{
+  const struct gvdb_hash_item *item;
+  const guint32_le *list;
+  guint length;
+
+  iter->table = table;
+  iter->list = NULL;
+  iter->length = 0;
+  iter->index = 0;
+  iter->item = NULL;
+
+  if ((item = gvdb_table_lookup (table, key, 'L')) == NULL)
+    return FALSE;
+
+  if (!gvdb_table_list_from_item (table, item, &list, &length))
+    return FALSE;
+
+  iter->list = list;
+  iter->length = length;
+
+  return TRUE;
+}
+
+/**
+ * gvdb_table_iter_next:
+ * @iter: a #GvdbTableIter
+ * @name: return location for the name of the next item
+ * @name_len: return location for the length of @name
+ * @returns: %FALSE if there are no more items
+ *
+ * Advances @iter to the next item of the list.
+ *
+ * @name points into the data of the table and is not nul-terminated.
+ * Like the strings returned by gvdb_table_list(), it can be appended to
+ * the key that @iter was initialised with to obtain the full name of
+ * the item.
+ **/
+gboolean
+gvdb_table_iter_next (GvdbTableIter  *iter,
+                      const gchar   **name,
+                      gsize          *name_len)
+{
+  const guint32_le *list = iter->list;
+
+  while (iter->index < iter->length)
+    {
+      const struct gvdb_hash_item *item;
+      const gchar *string;
+      gsize size;
+
+      item = gvdb_table_get_item (iter->table, list[iter->index++]);
+
+      if (item != NULL &&
+          (string = gvdb_table_item_get_key (iter->table, item, &size)))
+        {
+          iter->item = item;
+          *name = string;
+          *name_len = size;
+
+          return TRUE;
+        }
+    }
+
+  iter->item = NULL;
+
+  return FALSE;
+}
+
+/**
+ * gvdb_table_iter_get_item_type:
+ * @iter: a #GvdbTableIter
+ * @returns: the type of the current item
+ *
+ * Returns 'v' if the current item of @iter is a value, 'L' if it is a
+ * list and 'H' if it is a hash table.
+ **/
+gchar
+gvdb_table_iter_get_item_type (GvdbTableIter *iter)
+{
+  const struct gvdb_hash_item *item = iter->item;
+
+  g_return_val_if_fail (item != NULL, 0);
+
+  return item->type;
+}
+
+/**
+ * gvdb_table_iter_get_value:
+ * @iter: a #GvdbTableIter
+ * @returns: a #GVariant, or %NULL
+ *
+ * Gets the value of the current item of @iter, byteswapped in the same
+ * way as gvdb_table_get_value().  If the item is not a value, %NULL is
+ * returned.
+ *
+ * The value refers directly to the data of the table.
+ **/
+GVariant *
+gvdb_table_iter_get_value (GvdbTableIter *iter)
+{
+  const struct gvdb_hash_item *item = iter->item;
+
+  if (item == NULL || item->type != 'v')
+    return NULL;
+
+  return gvdb_table_cooked_value_from_item (iter->table, item);
+}
+
+/**
+ * gvdb_table_iter_get_raw_value:
+ * @iter: a #GvdbTableIter
+ * @returns: a #GVariant, or %NULL
+ *
+ * This call is equivalent to gvdb_table_iter_get_value() except that
+ * it never byteswaps the value.
+ **/
+GVariant *
+gvdb_table_iter_get_raw_value (GvdbTableIter *iter)
+{
+  const struct gvdb_hash_item *item = iter->item;
+
+  if (item == NULL || item->type != 'v')
+    return NULL;
+
+  return gvdb_table_value_from_item (iter->table, item);
+}
+
+/**
+ * gvdb_table_iter_get_table:
+ * @iter: a #GvdbTableIter
+ * @returns: a new #GvdbTable, or %NULL
+ *
+ * Gets the hash table of the current item of @iter, as
+ * gvdb_table_get_table() would.  If the item is not a hash table,
+ * %NULL is returned.
+ **/
+GvdbTable *
+gvdb_table_iter_get_table (GvdbTableIter *iter)
+{
+  const struct gvdb_hash_item *item = iter->item;
+
+  if (item == NULL || item->type != 'H')
+    return NULL;
+
+  return gvdb_table_table_from_item (iter->table, item);
+}
@@ -28,6 +28,16 @@ typedef struct _GvdbTable GvdbTable;
 
 typedef gpointer (*GvdbRefFunc) (gpointer data);
 
+typedef struct
+{
+  /*< private >*/
+  GvdbTable     *table;
+  gconstpointer  list;
+  guint          length;
+  guint          index;
+  gconstpointer  item;
+} GvdbTableIter;
+
 G_BEGIN_DECLS
 
 G_GNUC_INTERNAL
@@ -59,6 +69,11 @@ GVariant *              gvdb_table_get_raw_value                        (GvdbTab
 G_GNUC_INTERNAL
 GVariant *              gvdb_table_get_value                            (GvdbTable    *table,
                                                                          const gchar  *key);
+G_GNUC_INTERNAL
+void                    gvdb_table_get_values                           (GvdbTable           *table,
+                                                                         const gchar * const *keys,
+                                                                         gsize                n_keys,
+                                                                         GVariant           **values);
 
 G_GNUC_INTERNAL
 gboolean                gvdb_table_has_value                            (GvdbTable    *table,
@@ -85,6 +100,23 @@ void                    gvdb_table_walk                                 (GvdbTab
                                                                          GvdbWalkCloseFunc  close_func,
                                                                          gpointer           user_data);
 
+G_GNUC_INTERNAL
+gboolean                gvdb_table_iter_init                            (GvdbTableIter     *iter,
+                                                                         GvdbTable         *table,
+                                                                         const gchar       *key);
+G_GNUC_INTERNAL
+gboolean                gvdb_table_iter_next                            (GvdbTableIter     *iter,
+                                                                         const gchar      **name,
+                                                                         gsize             *name_len);
+G_GNUC_INTERNAL
+gchar                   gvdb_table_iter_get_item_type                   (GvdbTableIter     *iter);
+G_GNUC_INTERNAL
+GVariant *              gvdb_table_iter_get_value                       (GvdbTableIter     *iter);
+G_GNUC_INTERNAL
+GVariant *              gvdb_table_iter_get_raw_value                   (GvdbTableIter     *iter);
+G_GNUC_INTERNAL
+GvdbTable *             gvdb_table_iter_get_table                       (GvdbTableIter     *iter);
+
 G_END_DECLS
 
 #endif /* __gvdb_reader_h__ */
@@ -283,6 +283,65 @@ test_close (void)
   g_object_unref (base);
 }
 
+static void
+test_wrap (void)
+{
+  GInputStream *base;
+  GInputStream *in;
+  GBufferedInputStream *bin;
+  GError *error = NULL;
+  const gchar *data;
+  gchar buffer[8];
+  gsize available;
+  gssize n;
+
+  base = g_memory_input_stream_new_from_data ("abcdefghijklmnop", -1, NULL);
+  in = g_buffered_input_stream_new_sized (base, 8);
+  bin = G_BUFFERED_INPUT_STREAM (in);
+
+  n = g_buffered_input_stream_fill (bin, -1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 8);
+
+  n = g_input_stream_read (in, buffer, 6, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 6);
+  g_assert (memcmp (buffer, "abcdef", 6) == 0);
+
+  /* The next fill goes to the start of the buffer, behind "gh" */
+  n = g_buffered_input_stream_fill (bin, -1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 6);
+  g_assert_cmpint (g_buffered_input_stream_get_available (bin), ==, 8);
+
+  memset (buffer, 0, sizeof (buffer));
+  n = g_buffered_input_stream_peek (bin, buffer, 1, 4);
+  g_assert_cmpint (n, ==, 4);
+  g_assert (memcmp (buffer, "hijk", 4) == 0);
+
+  /* Consumed bytes are still there to seek back to */
+  g_assert (g_seekable_seek (G_SEEKABLE (in), 1, G_SEEK_CUR, NULL, &error));
+  g_assert_no_error (error);
+  g_assert (g_seekable_seek (G_SEEKABLE (in), -1, G_SEEK_CUR, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (g_buffered_input_stream_read_byte (bin, NULL, &error), ==, 'g');
+  g_assert_no_error (error);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, 7);
+
+  /* The data is made contiguous when the buffer is asked for */
+  data = g_buffered_input_stream_peek_buffer (bin, &available);
+  g_assert_cmpint (available, ==, 7);
+  g_assert (memcmp (data, "hijklmn", 7) == 0);
+
+  n = g_input_stream_read (in, buffer, 8, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 8);
+  g_assert (memcmp (buffer, "hijklmno", 8) == 0);
+
+  g_object_unref (in);
+  g_object_unref (base);
+}
+
 static void
 test_seek (void)
 {
@@ -383,6 +442,7 @@ main (int   argc,
   g_test_add_func ("/buffered-input-stream/read", test_read);
   g_test_add_func ("/buffered-input-stream/skip", test_skip);
   g_test_add_func ("/buffered-input-stream/seek", test_seek);
+  g_test_add_func ("/buffered-input-stream/wrap", test_wrap);
   g_test_add_func ("/filter-input-stream/close", test_close);
 
   return g_test_run();
@@ -150,6 +150,67 @@ test_read_lines_any (void)
   test_read_lines (G_DATA_STREAM_NEWLINE_TYPE_ANY);
 }
 
+static void
+check_lines_in_place (GDataStreamNewlineType  newline_type,
+                      const gchar            *data,
+                      const gchar           **expected)
+{
+  GInputStream *base_stream;
+  GDataInputStream *stream;
+  GError *error = NULL;
+  const char *line;
+  gsize length;
+  gsize buffer_size;
+  gint i;
+
+  /* Small buffers make lines and newlines straddle fills */
+  for (buffer_size = 1; buffer_size <= 8; buffer_size++)
+    {
+      base_stream = g_memory_input_stream_new_from_data (data, -1, NULL);
+      stream = g_data_input_stream_new (base_stream);
+      g_data_input_stream_set_newline_type (stream, newline_type);
+      g_buffered_input_stream_set_buffer_size (G_BUFFERED_INPUT_STREAM (stream),
+                                               buffer_size);
+
+      for (i = 0; expected[i]; i++)
+        {
+          line = g_data_input_stream_read_line_in_place (stream, &length,
+                                                         NULL, &error);
+          g_assert_no_error (error);
+          g_assert (line != NULL);
+          g_assert_cmpint (length, ==, strlen (expected[i]));
+          g_assert (memcmp (line, expected[i], length) == 0);
+        }
+
+      line = g_data_input_stream_read_line_in_place (stream, &length,
+                                                     NULL, &error);
+      g_assert_no_error (error);
+      g_assert (line == NULL);
+      g_assert_cmpint (length, ==, 0);
+
+      g_object_unref (stream);
+      g_object_unref (base_stream);
+    }
+}
+
+static void
+test_read_lines_in_place (void)
+{
+  const gchar *lf[] = { "", "one", "two", "", "three\r", "four", NULL };
+  const gchar *cr[] = { "\n", "one\n", "two", "", "three", "\nfour", NULL };
+  const gchar *cr_lf[] = { "\r", "one\r", "", "two\n\r", "four", NULL };
+  const gchar *any[] = { "", "one", "two", "", "three", "", "four", NULL };
+
+  check_lines_in_place (G_DATA_STREAM_NEWLINE_TYPE_LF,
+                        "\none\ntwo\n\nthree\r\nfour", lf);
+  check_lines_in_place (G_DATA_STREAM_NEWLINE_TYPE_CR,
+                        "\n\rone\n\rtwo\r\rthree\r\nfour", cr);
+  check_lines_in_place (G_DATA_STREAM_NEWLINE_TYPE_CR_LF,
+                        "\r\r\none\r\r\n\r\ntwo\n\r\r\nfour", cr_lf);
+  check_lines_in_place (G_DATA_STREAM_NEWLINE_TYPE_ANY,
+                        "\none\rtwo\r\n\nthree\r\r\nfour\n", any);
+}
+
 static void
 test_read_lines_LF_valid_utf8 (void)
 {
@@ -495,6 +556,7 @@ main (int   argc,
   g_test_add_func ("/data-input-stream/read-lines-CR", test_read_lines_CR);
   g_test_add_func ("/data-input-stream/read-lines-CR-LF", test_read_lines_CR_LF);
   g_test_add_func ("/data-input-stream/read-lines-any", test_read_lines_any);
+  g_test_add_func ("/data-input-stream/read-lines-in-place", test_read_lines_in_place);
   g_test_add_func ("/data-input-stream/read-until", test_read_until);
   g_test_add_func ("/data-input-stream/read-upto", test_read_upto);
   g_test_add_func ("/data-input-stream/read-int", test_read_int);
@@ -592,6 +592,547 @@ test_replace_load (void)
   free (path);
 }
 
+static void
+got_result_cb (GObject      *source,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+  GAsyncResult **result = user_data;
+
+  *result = g_object_ref (res);
+}
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **result)
+{
+  while (*result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  return *result;
+}
+
+static void
+test_async_stream_io (void)
+{
+  const gchar *contents = "The quick brown fox jumps over the lazy dog";
+  GAsyncResult *result;
+  GFile *file;
+  GFileIOStream *iostream;
+  GFileOutputStream *ostream;
+  GFileInputStream *istream;
+  GFileInfo *info;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  gchar buffer[100];
+  gchar *etag;
+  gssize n, total;
+  gsize len;
+
+  file = g_file_new_tmp ("g_file_async_stream_io_XXXXXX", &iostream, NULL);
+  g_assert (file != NULL);
+  g_object_unref (iostream);
+  g_file_delete (file, NULL, NULL);
+
+  ostream = g_file_create (file, 0, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Write in several pieces; each write continues where the last stopped */
+  len = strlen (contents);
+  for (total = 0; total < len; total += n)
+    {
+      result = NULL;
+      g_output_stream_write_async (G_OUTPUT_STREAM (ostream),
+                                   contents + total, MIN (10, len - total),
+                                   0, NULL, got_result_cb, &result);
+      n = g_output_stream_write_finish (G_OUTPUT_STREAM (ostream),
+                                        wait_for_result (&result), &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+      g_object_unref (result);
+    }
+
+  result = NULL;
+  g_output_stream_close_async (G_OUTPUT_STREAM (ostream), 0, NULL,
+                               got_result_cb, &result);
+  g_assert (g_output_stream_close_finish (G_OUTPUT_STREAM (ostream),
+                                          wait_for_result (&result), &error));
+  g_assert_no_error (error);
+  g_object_unref (result);
+
+  /* The etag is that of the file as closed */
+  etag = g_file_output_stream_get_etag (ostream);
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_ETAG_VALUE, 0,
+                            NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (etag, ==, g_file_info_get_etag (info));
+  g_object_unref (info);
+  g_free (etag);
+  g_object_unref (ostream);
+
+  istream = g_file_read (file, NULL, &error);
+  g_assert_no_error (error);
+
+  total = 0;
+  do
+    {
+      result = NULL;
+      g_input_stream_read_async (G_INPUT_STREAM (istream),
+                                 buffer + total, 7, 0, NULL,
+                                 got_result_cb, &result);
+      n = g_input_stream_read_finish (G_INPUT_STREAM (istream),
+                                      wait_for_result (&result), &error);
+      g_assert_no_error (error);
+      g_object_unref (result);
+      total += n;
+    }
+  while (n > 0);
+  g_assert_cmpint (total, ==, len);
+  g_assert (memcmp (buffer, contents, len) == 0);
+
+  /* A cancelled read fails without touching the stream */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  result = NULL;
+  g_input_stream_read_async (G_INPUT_STREAM (istream), buffer, 7, 0,
+                             cancellable, got_result_cb, &result);
+  n = g_input_stream_read_finish (G_INPUT_STREAM (istream),
+                                  wait_for_result (&result), &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint (n, ==, -1);
+  g_clear_error (&error);
+  g_object_unref (result);
+  g_object_unref (cancellable);
+
+  result = NULL;
+  g_input_stream_close_async (G_INPUT_STREAM (istream), 0, NULL,
+                              got_result_cb, &result);
+  g_assert (g_input_stream_close_finish (G_INPUT_STREAM (istream),
+                                         wait_for_result (&result), &error));
+  g_assert_no_error (error);
+  g_object_unref (result);
+  g_object_unref (istream);
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+}
+
+#define N_ENUMERATE_FILES 2000
+
+static void
+check_enumerate (GFile       *dir,
+                 const gchar *attributes)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GError *error = NULL;
+  gboolean *seen;
+  gint n_files, n_dirs, n;
+
+  seen = g_new0 (gboolean, N_ENUMERATE_FILES);
+  n_files = n_dirs = 0;
+
+  enumerator = g_file_enumerate_children (dir, attributes, 0, NULL, &error);
+  g_assert_no_error (error);
+
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, &error)) != NULL)
+    {
+      const gchar *name = g_file_info_get_name (info);
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        {
+          g_assert_cmpstr (name, ==, "subdir");
+          n_dirs++;
+        }
+      else
+        {
+          g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_REGULAR);
+          g_assert (g_str_has_prefix (name, "file-"));
+          n = atoi (name + 5);
+          g_assert_cmpint (n, >=, 0);
+          g_assert_cmpint (n, <, N_ENUMERATE_FILES);
+          g_assert (!seen[n]);
+          seen[n] = TRUE;
+          n_files++;
+
+          if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE))
+            g_assert_cmpint (g_file_info_get_size (info), ==, strlen (name));
+        }
+
+      g_object_unref (info);
+    }
+  g_assert_no_error (error);
+
+  g_assert_cmpint (n_files, ==, N_ENUMERATE_FILES);
+  g_assert_cmpint (n_dirs, ==, 1);
+
+  g_file_enumerator_close (enumerator, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (enumerator);
+  g_free (seen);
+}
+
+static void
+test_enumerate (void)
+{
+  GFile *dir, *child;
+  GError *error = NULL;
+  gchar *path, *name;
+  gint i;
+
+  path = g_dir_make_tmp ("g_file_enumerate_XXXXXX", &error);
+  g_assert_no_error (error);
+  dir = g_file_new_for_path (path);
+
+  for (i = 0; i < N_ENUMERATE_FILES; i++)
+    {
+      name = g_strdup_printf ("file-%d", i);
+      child = g_file_get_child (dir, name);
+      g_file_replace_contents (child, name, strlen (name), NULL, FALSE,
+                               0, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (child);
+      g_free (name);
+    }
+
+  child = g_file_get_child (dir, "subdir");
+  g_file_make_directory (child, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (child);
+
+  /* Only names and types: answered from the directory entries */
+  check_enumerate (dir, G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                        G_FILE_ATTRIBUTE_STANDARD_TYPE);
+  /* Needs a stat of every entry */
+  check_enumerate (dir, G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                        G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                        G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                        G_FILE_ATTRIBUTE_TIME_ACCESS);
+
+  for (i = 0; i < N_ENUMERATE_FILES; i++)
+    {
+      name = g_strdup_printf ("file-%d", i);
+      child = g_file_get_child (dir, name);
+      g_file_delete (child, NULL, NULL);
+      g_object_unref (child);
+      g_free (name);
+    }
+  child = g_file_get_child (dir, "subdir");
+  g_file_delete (child, NULL, NULL);
+  g_object_unref (child);
+  g_file_delete (dir, NULL, &error);
+  g_assert_no_error (error);
+
+  g_object_unref (dir);
+  g_free (path);
+}
+
+/* A tree of WALK_DEPTH levels with WALK_WIDTH subdirectories and
+ * WALK_WIDTH files in each directory, plus a link back to the top */
+#define WALK_DEPTH 3
+#define WALK_WIDTH 4
+
+static void
+make_walk_tree (GFile *dir,
+                gint   depth)
+{
+  GFile *child;
+  GError *error = NULL;
+  gchar *name;
+  gint i;
+
+  for (i = 0; i < WALK_WIDTH; i++)
+    {
+      name = g_strdup_printf ("file-%d", i);
+      child = g_file_get_child (dir, name);
+      g_file_replace_contents (child, name, strlen (name), NULL, FALSE,
+                               0, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (child);
+      g_free (name);
+
+      if (depth > 1)
+        {
+          name = g_strdup_printf ("dir-%d", i);
+          child = g_file_get_child (dir, name);
+          g_file_make_directory (child, NULL, &error);
+          g_assert_no_error (error);
+          make_walk_tree (child, depth - 1);
+          g_object_unref (child);
+          g_free (name);
+        }
+    }
+}
+
+static void
+delete_walk_tree (GFile *dir)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *child;
+
+  enumerator = g_file_enumerate_children (dir, "standard::name,standard::type",
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          NULL, NULL);
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)) != NULL)
+    {
+      child = g_file_get_child (dir, g_file_info_get_name (info));
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        delete_walk_tree (child);
+      else
+        g_file_delete (child, NULL, NULL);
+      g_object_unref (child);
+      g_object_unref (info);
+    }
+  g_object_unref (enumerator);
+  g_file_delete (dir, NULL, NULL);
+}
+
+typedef struct {
+  GFile *root;
+  gint n_files;
+  gint n_dirs;
+  gint n_batches;
+  gint stop_after;
+  gboolean prune;
+  gboolean done;
+  GHashTable *seen;
+} WalkData;
+
+static gboolean
+walk_filter (GFile     *directory,
+             GFileInfo *info,
+             gpointer   user_data)
+{
+  WalkData *data = user_data;
+
+  return !data->prune || strcmp (g_file_info_get_name (info), "dir-0") != 0;
+}
+
+static gboolean
+walk_cb (GFile    *directory,
+         GList    *infos,
+         gpointer  user_data)
+{
+  WalkData *data = user_data;
+  GList *l;
+  gchar *path;
+
+  /* Parents are reported before their children */
+  if (!g_file_equal (directory, data->root))
+    {
+      path = g_file_get_path (directory);
+      g_assert (g_hash_table_lookup (data->seen, path) != NULL);
+      g_free (path);
+    }
+
+  for (l = infos; l; l = l->next)
+    {
+      GFileInfo *info = l->data;
+      GFile *child;
+
+      g_assert (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE));
+      g_assert (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+      child = g_file_get_child (directory, g_file_info_get_name (info));
+      path = g_file_get_path (child);
+      g_assert (g_hash_table_lookup (data->seen, path) == NULL);
+      g_hash_table_insert (data->seen, path, path);
+      g_object_unref (child);
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        data->n_dirs++;
+      else
+        data->n_files++;
+    }
+
+  data->n_batches++;
+
+  return data->n_batches != data->stop_after;
+}
+
+static void
+walk_done_cb (GObject      *source,
+              GAsyncResult *res,
+              gpointer      user_data)
+{
+  WalkData *data = user_data;
+  GError *error = NULL;
+
+  g_assert (g_file_walk_finish (G_FILE (source), res, &error));
+  g_assert_no_error (error);
+  data->done = TRUE;
+}
+
+static void
+run_walk (WalkData *data,
+          gboolean  async)
+{
+  GError *error = NULL;
+
+  data->n_files = data->n_dirs = data->n_batches = 0;
+  data->seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (async)
+    {
+      data->done = FALSE;
+      g_file_walk_async (data->root, G_FILE_ATTRIBUTE_STANDARD_SIZE, 0, 2,
+                         G_PRIORITY_DEFAULT, NULL, walk_filter, walk_cb, data,
+                         walk_done_cb, data);
+      while (!data->done)
+        g_main_context_iteration (NULL, TRUE);
+    }
+  else
+    {
+      g_assert (g_file_walk (data->root, G_FILE_ATTRIBUTE_STANDARD_SIZE, 0, 2,
+                             NULL, walk_filter, walk_cb, data, &error));
+      g_assert_no_error (error);
+    }
+
+  g_hash_table_unref (data->seen);
+}
+
+static void
+test_walk (void)
+{
+  WalkData data = { NULL, };
+  GFile *link, *missing;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  gchar *path;
+  gint async;
+
+  path = g_dir_make_tmp ("g_file_walk_XXXXXX", &error);
+  g_assert_no_error (error);
+  data.root = g_file_new_for_path (path);
+  make_walk_tree (data.root, WALK_DEPTH);
+
+  /* The loop is reported, but not followed */
+  link = g_file_resolve_relative_path (data.root, "dir-1/dir-1/top");
+  g_file_make_symbolic_link (link, path, NULL, &error);
+  g_assert_no_error (error);
+
+  for (async = 0; async < 2; async++)
+    {
+      data.stop_after = -1;
+      data.prune = FALSE;
+      run_walk (&data, async);
+      /* 4 + 16 + 64 files, 4 + 16 directories and the link */
+      g_assert_cmpint (data.n_files, ==, 84);
+      g_assert_cmpint (data.n_dirs, ==, 21);
+
+      data.prune = TRUE;
+      run_walk (&data, async);
+      /* dir-0 directories are reported, but their contents are not */
+      g_assert_cmpint (data.n_files, ==, 52);
+      g_assert_cmpint (data.n_dirs, ==, 17);
+
+      data.prune = FALSE;
+      data.stop_after = 1;
+      run_walk (&data, async);
+      g_assert_cmpint (data.n_batches, ==, 1);
+    }
+
+  /* Errors */
+  missing = g_file_get_child (data.root, "missing");
+  g_assert (!g_file_walk (missing, G_FILE_ATTRIBUTE_STANDARD_SIZE, 0, 0,
+                          NULL, NULL, walk_cb, &data, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+  g_clear_error (&error);
+  g_object_unref (missing);
+
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  g_assert (!g_file_walk (data.root, G_FILE_ATTRIBUTE_STANDARD_SIZE, 0, 0,
+                          cancellable, NULL, walk_cb, &data, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  g_file_delete (link, NULL, NULL);
+  g_object_unref (link);
+  delete_walk_tree (data.root);
+  g_object_unref (data.root);
+  g_free (path);
+}
+
+static void
+test_vectored_io (void)
+{
+  GOutputVector out_vectors[3] = {
+    { "The quick brown fox ", 20 },
+    { "jumps over ", 11 },
+    { "the lazy dog", 12 }
+  };
+  GAsyncResult *result;
+  GFile *file;
+  GFileIOStream *iostream;
+  GFileOutputStream *ostream;
+  GFileInputStream *istream;
+  GInputVector in_vectors[2];
+  GError *error = NULL;
+  gchar head[4], tail[100];
+  gsize written;
+  gssize n;
+
+  file = g_file_new_tmp ("g_file_vectored_io_XXXXXX", &iostream, NULL);
+  g_assert (file != NULL);
+  g_object_unref (iostream);
+
+  ostream = g_file_replace (file, NULL, FALSE, 0, NULL, &error);
+  g_assert_no_error (error);
+
+  g_output_stream_writev_all (G_OUTPUT_STREAM (ostream), out_vectors, 3,
+                              &written, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (written, ==, 43);
+
+  result = NULL;
+  g_output_stream_writev_async (G_OUTPUT_STREAM (ostream), out_vectors, 3,
+                                0, NULL, got_result_cb, &result);
+  n = g_output_stream_writev_finish (G_OUTPUT_STREAM (ostream),
+                                     wait_for_result (&result), &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 43);
+  g_object_unref (result);
+
+  g_output_stream_close (G_OUTPUT_STREAM (ostream), NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (ostream);
+
+  istream = g_file_read (file, NULL, &error);
+  g_assert_no_error (error);
+
+  in_vectors[0].buffer = head;
+  in_vectors[0].size = sizeof (head);
+  in_vectors[1].buffer = tail;
+  in_vectors[1].size = sizeof (tail);
+
+  n = g_input_stream_readv (G_INPUT_STREAM (istream), in_vectors, 2,
+                            NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 86);
+  g_assert (memcmp (head, "The ", 4) == 0);
+  g_assert (memcmp (tail, "quick brown fox jumps over the lazy dog"
+                    "The quick brown fox jumps over the lazy dog", 82) == 0);
+
+  g_seekable_seek (G_SEEKABLE (istream), 0, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+
+  result = NULL;
+  g_input_stream_readv_async (G_INPUT_STREAM (istream), in_vectors, 2,
+                              0, NULL, got_result_cb, &result);
+  n = g_input_stream_readv_finish (G_INPUT_STREAM (istream),
+                                   wait_for_result (&result), &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 86);
+  g_assert (memcmp (head, "The ", 4) == 0);
+  g_object_unref (result);
+
+  g_object_unref (istream);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -609,6 +1150,10 @@ main (int argc, char *argv[])
   g_test_add_data_func ("/file/async-create-delete/25", GINT_TO_POINTER (25), test_create_delete);
   g_test_add_data_func ("/file/async-create-delete/4096", GINT_TO_POINTER (4096), test_create_delete);
   g_test_add_func ("/file/replace-load", test_replace_load);
+  g_test_add_func ("/file/async-stream-io", test_async_stream_io);
+  g_test_add_func ("/file/vectored-io", test_vectored_io);
+  g_test_add_func ("/file/enumerate", test_enumerate);
+  g_test_add_func ("/file/walk", test_walk);
 
   return g_test_run ();
 }
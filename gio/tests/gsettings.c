@@ -308,6 +308,66 @@ test_basic_types (void)
   str = NULL;
 }
 
+/* Test that cached values follow changes made through other
+ * GSettings objects and in delay-apply mode
+ */
+static void
+test_read_cache (void)
+{
+  GSettings *settings;
+  GSettings *settings2;
+  GSettings *delayed;
+  GVariant *value;
+
+  settings = g_settings_new ("org.gtk.test.basic-types");
+  settings2 = g_settings_new ("org.gtk.test.basic-types");
+  delayed = g_settings_new ("org.gtk.test.basic-types");
+  g_settings_delay (delayed);
+
+  g_settings_reset (settings, "test-int32");
+  g_settings_reset (settings, "test-boolean");
+  g_settings_reset (settings, "test-double");
+
+  /* fill the caches */
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, -123456);
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, -123456);
+  g_assert (g_settings_get_boolean (settings, "test-boolean"));
+  g_assert_cmpfloat (g_settings_get_double (settings, "test-double"), ==, 123.456);
+  g_assert_cmpint (g_settings_get_int (delayed, "test-int32"), ==, -123456);
+
+  /* written through another object: seen without a main loop */
+  g_settings_set_int (settings2, "test-int32", 42);
+  g_settings_set_boolean (settings2, "test-boolean", FALSE);
+  g_settings_set_double (settings2, "test-double", 0.5);
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, 42);
+  g_assert (!g_settings_get_boolean (settings, "test-boolean"));
+  g_assert_cmpfloat (g_settings_get_double (settings, "test-double"), ==, 0.5);
+
+  value = g_settings_get_value (settings, "test-int32");
+  g_assert_cmpint (g_variant_get_int32 (value), ==, 42);
+  g_assert (!g_variant_is_floating (value));
+  g_variant_unref (value);
+
+  /* delayed writes are only seen by the delayed object */
+  g_settings_set_int (delayed, "test-int32", 7);
+  g_assert_cmpint (g_settings_get_int (delayed, "test-int32"), ==, 7);
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, 42);
+
+  g_settings_apply (delayed);
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, 7);
+  g_assert_cmpint (g_settings_get_int (settings2, "test-int32"), ==, 7);
+
+  g_settings_reset (settings2, "test-int32");
+  g_assert_cmpint (g_settings_get_int (settings, "test-int32"), ==, -123456);
+
+  g_settings_reset (settings, "test-boolean");
+  g_settings_reset (settings, "test-double");
+
+  g_object_unref (delayed);
+  g_object_unref (settings2);
+  g_object_unref (settings);
+}
+
 /* Check that we can read an set complex types like
  * tuples, arrays and dictionaries
  */
@@ -1468,9 +1528,10 @@ test_keyfile (void)
 
   kf_backend = g_keyfile_settings_backend_new ("gsettings.store", "/", "root");
   settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
-  g_object_unref (kf_backend);
 
   g_settings_set (settings, "greeting", "s", "see if this works");
+  g_settings_backend_sync (kf_backend);
+  g_object_unref (kf_backend);
 
   keyfile = g_key_file_new ();
   g_assert (g_key_file_load_from_file (keyfile, "gsettings.store", 0, NULL));
@@ -1483,6 +1544,147 @@ test_keyfile (void)
   g_object_unref (settings);
 }
 
+static gchar *
+keyfile_flush_read (const gchar *filename,
+                    const gchar *key)
+{
+  GKeyFile *keyfile;
+  gchar *str;
+
+  keyfile = g_key_file_new ();
+  if (g_key_file_load_from_file (keyfile, filename, 0, NULL))
+    str = g_key_file_get_string (keyfile, "tests", key, NULL);
+  else
+    str = NULL;
+  g_key_file_free (keyfile);
+
+  return str;
+}
+
+/* Test that the keyfile backend merges bursts of writes, that what it
+ * writes out is always complete and that nothing is lost on sync or
+ * when the backend goes away.
+ */
+static void
+test_keyfile_flush (void)
+{
+  const gchar *filename = "keyfile-flush/gsettings.store";
+  GSettingsBackend *kf_backend;
+  GSettings *settings;
+  gchar *last_seen;
+  gint n_updates;
+  const gchar *name;
+  GDir *dir;
+  gchar *str;
+  gint i;
+
+  g_remove (filename);
+
+  kf_backend = g_keyfile_settings_backend_new (filename, "/", "root");
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  /* a burst of writes does not touch the file... */
+  for (i = 0; i < 100; i++)
+    {
+      str = g_strdup_printf ("burst %d", i);
+      g_settings_set (settings, "greeting", "s", str);
+      g_free (str);
+    }
+  g_assert (!g_file_test (filename, G_FILE_TEST_EXISTS));
+
+  /* ...until it is synced */
+  g_settings_backend_sync (kf_backend);
+  str = keyfile_flush_read (filename, "greeting");
+  g_assert_cmpstr (str, ==, "'burst 99'");
+  g_free (str);
+
+  /* Enough changes force a flush even without a sync.  Whatever state
+   * the file is in, it must always contain both keys of each applied
+   * change, never one without the other.
+   */
+  g_settings_delay (settings);
+  last_seen = keyfile_flush_read (filename, "greeting");
+  n_updates = 0;
+
+  for (i = 0; i < 600; i++)
+    {
+      gchar *greeting, *farewell;
+
+      str = g_strdup_printf ("%d", i);
+      g_settings_set (settings, "greeting", "s", str);
+      g_settings_set (settings, "farewell", "s", str);
+      g_settings_apply (settings);
+      g_free (str);
+
+      greeting = keyfile_flush_read (filename, "greeting");
+      farewell = keyfile_flush_read (filename, "farewell");
+      g_assert (greeting != NULL);
+
+      if (g_strcmp0 (greeting, last_seen) != 0)
+        {
+          g_assert_cmpstr (greeting, ==, farewell);
+          g_free (last_seen);
+          last_seen = g_strdup (greeting);
+          n_updates++;
+        }
+
+      g_free (greeting);
+      g_free (farewell);
+    }
+
+  g_assert_cmpint (n_updates, >, 0);
+  g_assert_cmpint (n_updates, <, 10);
+  g_free (last_seen);
+
+  g_settings_revert (settings);
+  g_object_unref (settings);
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  /* a lone change gets written out after a short while, even though
+   * no main loop runs here
+   */
+  g_settings_set (settings, "greeting", "s", "timed");
+  g_usleep (1500 * 1000);
+
+  str = keyfile_flush_read (filename, "greeting");
+  g_assert_cmpstr (str, ==, "'timed'");
+  g_free (str);
+
+  /* nothing is lost when the backend is dropped with changes pending */
+  g_settings_set (settings, "greeting", "s", "goodbye");
+  g_object_unref (settings);
+  g_object_unref (kf_backend);
+  g_usleep (1500 * 1000);
+
+  str = keyfile_flush_read (filename, "greeting");
+  g_assert_cmpstr (str, ==, "'goodbye'");
+  g_free (str);
+
+  /* what is still unwritten when the process exits is written then */
+  if (g_test_trap_fork (0, 0))
+    {
+      kf_backend = g_keyfile_settings_backend_new (filename, "/", "root");
+      settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+      g_settings_set (settings, "greeting", "s", "at exit");
+      exit (0);
+    }
+  g_test_trap_assert_passed ();
+
+  str = keyfile_flush_read (filename, "greeting");
+  g_assert_cmpstr (str, ==, "'at exit'");
+  g_free (str);
+
+  /* and no temporary files are left behind */
+  dir = g_dir_open ("keyfile-flush", 0, NULL);
+  g_assert (dir != NULL);
+  while ((name = g_dir_read_name (dir)))
+    g_assert_cmpstr (name, ==, "gsettings.store");
+  g_dir_close (dir);
+
+  g_remove (filename);
+  g_rmdir ("keyfile-flush");
+}
+
 /* Test that getting child schemas works
  */
 static void
@@ -1815,6 +2017,11 @@ test_list_items (void)
   g_object_unref (settings);
 }
 
+/* Test that the schema lists only contain each schema once, as it is
+ * in the first source that has it.  The system-wide source set up in
+ * main() has an org.gtk.test.no-path with a path, which must not show
+ * up.
+ */
 static void
 test_list_schemas (void)
 {
@@ -2092,6 +2299,24 @@ main (int argc, char *argv[])
                                        NULL, NULL, &result, NULL));
   g_assert (result == 0);
 
+  /* A system-wide schema that is shadowed by the relocatable one of the
+   * same name in GSETTINGS_SCHEMA_DIR.
+   */
+  g_remove ("glib-2.0/schemas/gschemas.compiled");
+  g_mkdir_with_parents ("glib-2.0/schemas", 0777);
+  g_assert (g_file_set_contents ("glib-2.0/schemas/shadowed.gschema.xml",
+                                 "<schemalist>"
+                                 "  <schema id='org.gtk.test.no-path' path='/tests/shadowed/'>"
+                                 "    <key name='test-boolean' type='b'>"
+                                 "      <default>false</default>"
+                                 "    </key>"
+                                 "  </schema>"
+                                 "</schemalist>",
+                                 -1, NULL));
+  g_assert (g_spawn_command_line_sync ("../glib-compile-schemas glib-2.0/schemas",
+                                       NULL, NULL, &result, NULL));
+  g_assert (result == 0);
+
   g_test_add_func ("/gsettings/basic", test_basic);
 
   if (!backend_set)
@@ -2105,6 +2330,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/gsettings/basic-types", test_basic_types);
   g_test_add_func ("/gsettings/complex-types", test_complex_types);
+  g_test_add_func ("/gsettings/read-cache", test_read_cache);
   g_test_add_func ("/gsettings/changes", test_changes);
 
   if (glib_translations_work ())
@@ -2132,6 +2358,7 @@ main (int argc, char *argv[])
     }
 
   g_test_add_func ("/gsettings/keyfile", test_keyfile);
+  g_test_add_func ("/gsettings/keyfile-flush", test_keyfile_flush);
   g_test_add_func ("/gsettings/child-schema", test_child_schema);
   g_test_add_func ("/gsettings/strinfo", test_strinfo);
   g_test_add_func ("/gsettings/enums", test_enums);
@@ -0,0 +1,455 @@
+/*
+ * Copyright © 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the licence, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "gvdb/gvdb-builder.h"
+#include "gvdb/gvdb-reader.h"
+
+#define N_DIRS 64
+
+/* Builds a table with @n_keys values, half of them stored as plain
+ * keys and half as children of N_DIRS directory lists, so that the
+ * parent-pointer name checks get exercised as well.
+ */
+static gchar *
+make_filename (void)
+{
+  GError *error = NULL;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("gvdb-test-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  return filename;
+}
+
+static gchar *
+write_table (gint     n_keys,
+             gboolean byteswap,
+             gboolean perfect_hash)
+{
+  GvdbItem *dirs[N_DIRS];
+  GHashTable *table;
+  GError *error = NULL;
+  gchar *filename;
+  gint i;
+
+  filename = make_filename ();
+  table = gvdb_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < N_DIRS; i++)
+    {
+      gchar *key;
+
+      key = g_strdup_printf ("/dir%d/", i);
+      dirs[i] = gvdb_hash_table_insert (table, key);
+      g_free (key);
+    }
+
+  for (i = 0; i < n_keys; i++)
+    {
+      GvdbItem *item;
+      gchar *key;
+
+      if (i % 2)
+        key = g_strdup_printf ("/dir%d/key%d", i % N_DIRS, i);
+      else
+        key = g_strdup_printf ("/org/gtk/test/key%d", i);
+
+      item = gvdb_hash_table_insert (table, key);
+      gvdb_item_set_value (item, g_variant_new_int32 (i));
+      if (i % 2)
+        gvdb_item_set_parent (item, dirs[i % N_DIRS]);
+      g_free (key);
+    }
+
+  gvdb_table_write_contents_full (table, filename, byteswap, perfect_hash, &error);
+  g_assert_no_error (error);
+  g_hash_table_unref (table);
+
+  return filename;
+}
+
+static void
+check_table (GvdbTable *table,
+             gint       n_keys)
+{
+  gchar **names;
+  gint i;
+
+  for (i = 0; i < n_keys; i++)
+    {
+      GVariant *value;
+      gchar *key;
+
+      if (i % 2)
+        key = g_strdup_printf ("/dir%d/key%d", i % N_DIRS, i);
+      else
+        key = g_strdup_printf ("/org/gtk/test/key%d", i);
+
+      value = gvdb_table_get_value (table, key);
+      g_assert (value != NULL);
+      g_assert_cmpint (g_variant_get_int32 (value), ==, i);
+      g_variant_unref (value);
+      g_free (key);
+
+      /* misses, including ones that only differ in the parent */
+      key = g_strdup_printf ("/org/gtk/test/key%d", n_keys + i);
+      g_assert (!gvdb_table_has_value (table, key));
+      g_free (key);
+
+      key = g_strdup_printf ("/dir%d/key%d", (i + 1) % N_DIRS, i);
+      g_assert (!gvdb_table_has_value (table, key));
+      g_free (key);
+    }
+
+  names = gvdb_table_list (table, "/dir1/");
+  g_assert (names != NULL);
+  g_assert_cmpint (g_strv_length (names), ==, (n_keys + N_DIRS - 2) / N_DIRS);
+  g_strfreev (names);
+}
+
+static void
+test_perfect_hash (void)
+{
+  gint n_keys;
+
+  /* enough keys that every directory has children */
+  for (n_keys = 200; n_keys <= 20000; n_keys *= 10)
+    {
+      gint i;
+
+      for (i = 0; i < 4; i++)
+        {
+          GvdbTable *table;
+          GError *error = NULL;
+          gchar *filename;
+
+          filename = write_table (n_keys, i & 1, i & 2);
+          table = gvdb_table_new (filename, TRUE, &error);
+          g_assert_no_error (error);
+
+          check_table (table, n_keys);
+
+          gvdb_table_unref (table);
+          g_unlink (filename);
+          g_free (filename);
+        }
+    }
+}
+
+static void
+test_iter (void)
+{
+  GvdbTableIter iter;
+  GvdbTable *table;
+  GError *error = NULL;
+  gchar *filename;
+  gchar **names;
+  const gchar *name;
+  gsize name_len;
+  gint n_keys = 2000;
+  gint i, n;
+
+  filename = write_table (n_keys, FALSE, TRUE);
+  table = gvdb_table_new (filename, TRUE, &error);
+  g_assert_no_error (error);
+
+  /* the same names, in the same order, as gvdb_table_list() */
+  names = gvdb_table_list (table, "/dir3/");
+  g_assert (gvdb_table_iter_init (&iter, table, "/dir3/"));
+
+  for (i = 0; gvdb_table_iter_next (&iter, &name, &name_len); i++)
+    {
+      GVariant *value;
+      gint expected;
+
+      g_assert (names[i] != NULL);
+      g_assert_cmpint (name_len, ==, strlen (names[i]));
+      g_assert (memcmp (name, names[i], name_len) == 0);
+      g_assert_cmpint (gvdb_table_iter_get_item_type (&iter), ==, 'v');
+      g_assert (gvdb_table_iter_get_table (&iter) == NULL);
+
+      g_assert (g_str_has_prefix (names[i], "key"));
+      expected = atoi (names[i] + 3);
+      g_assert_cmpint (expected % N_DIRS, ==, 3);
+
+      value = gvdb_table_iter_get_value (&iter);
+      g_assert_cmpint (g_variant_get_int32 (value), ==, expected);
+      g_variant_unref (value);
+
+      value = gvdb_table_iter_get_raw_value (&iter);
+      g_assert_cmpint (g_variant_get_int32 (value), ==, expected);
+      g_variant_unref (value);
+    }
+  g_assert (names[i] == NULL);
+  g_assert_cmpint (i, ==, (n_keys + N_DIRS - 4) / N_DIRS);
+  g_strfreev (names);
+
+  /* values are not lists */
+  g_assert (!gvdb_table_iter_init (&iter, table, "/dir3/key3"));
+  g_assert (!gvdb_table_iter_next (&iter, &name, &name_len));
+  g_assert (!gvdb_table_iter_init (&iter, table, "/nonexistent/"));
+  g_assert (!gvdb_table_iter_next (&iter, &name, &name_len));
+
+  gvdb_table_unref (table);
+  g_unlink (filename);
+  g_free (filename);
+
+  /* nested tables */
+  {
+    GHashTable *root, *child;
+    GvdbItem *item;
+    GvdbTable *sub;
+
+    root = gvdb_hash_table_new (NULL, NULL);
+    item = gvdb_hash_table_insert (root, "");
+    child = gvdb_hash_table_new (root, "child");
+    gvdb_hash_table_insert_string (child, "greeting", "hello");
+    gvdb_item_set_parent (g_hash_table_lookup (root, "child"), item);
+    filename = make_filename ();
+    gvdb_table_write_contents (root, filename, FALSE, &error);
+    g_assert_no_error (error);
+    g_hash_table_unref (root);
+    g_hash_table_unref (child);
+
+    table = gvdb_table_new (filename, TRUE, &error);
+    g_assert_no_error (error);
+
+    g_assert (gvdb_table_iter_init (&iter, table, ""));
+    n = 0;
+    while (gvdb_table_iter_next (&iter, &name, &name_len))
+      {
+        GVariant *value;
+
+        g_assert_cmpint (name_len, ==, 5);
+        g_assert (memcmp (name, "child", 5) == 0);
+        g_assert_cmpint (gvdb_table_iter_get_item_type (&iter), ==, 'H');
+        g_assert (gvdb_table_iter_get_value (&iter) == NULL);
+
+        sub = gvdb_table_iter_get_table (&iter);
+        g_assert (sub != NULL);
+        value = gvdb_table_get_value (sub, "greeting");
+        g_assert_cmpstr (g_variant_get_string (value, NULL), ==, "hello");
+        g_variant_unref (value);
+        gvdb_table_unref (sub);
+        n++;
+      }
+    g_assert_cmpint (n, ==, 1);
+
+    gvdb_table_unref (table);
+    g_unlink (filename);
+    g_free (filename);
+  }
+}
+
+static void
+test_batch (void)
+{
+  gint n_keys = 1000;
+  gint i;
+
+  for (i = 0; i < 4; i++)
+    {
+      GvdbTable *table;
+      GError *error = NULL;
+      GVariant **values;
+      gchar **keys;
+      gchar *filename;
+      gint j;
+
+      filename = write_table (n_keys, i & 1, i & 2);
+      table = gvdb_table_new (filename, TRUE, &error);
+      g_assert_no_error (error);
+
+      /* every other key is missing */
+      keys = g_new0 (gchar *, 2 * n_keys + 1);
+      for (j = 0; j < 2 * n_keys; j++)
+        if (j % 2)
+          keys[j] = g_strdup_printf ("/dir%d/key%d", j % N_DIRS, j);
+        else
+          keys[j] = g_strdup_printf ("/org/gtk/test/key%d", j);
+
+      values = g_new (GVariant *, 2 * n_keys);
+      gvdb_table_get_values (table, (const gchar **) keys, 2 * n_keys, values);
+
+      for (j = 0; j < 2 * n_keys; j++)
+        {
+          GVariant *value;
+
+          value = gvdb_table_get_value (table, keys[j]);
+
+          if (j < n_keys)
+            {
+              g_assert (values[j] != NULL);
+              g_assert (g_variant_equal (values[j], value));
+              g_variant_unref (values[j]);
+              g_variant_unref (value);
+            }
+          else
+            {
+              g_assert (values[j] == NULL);
+              g_assert (value == NULL);
+            }
+        }
+
+      g_free (values);
+      g_strfreev (keys);
+      gvdb_table_unref (table);
+      g_unlink (filename);
+      g_free (filename);
+    }
+}
+
+#define PERF_KEYS 100000
+#define PERF_LOOKUPS 2000000
+
+static void
+test_batch_lookup_performance (void)
+{
+  GvdbTable *table;
+  GError *error = NULL;
+  GVariant *values[64];
+  const gchar *batch[64];
+  gchar *filename;
+  gchar **keys;
+  gdouble elapsed;
+  gdouble result;
+  GRand *rand;
+  guint i, j;
+
+  if (!g_test_perf ())
+    return;
+
+  filename = write_table (PERF_KEYS, FALSE, TRUE);
+  table = gvdb_table_new (filename, TRUE, &error);
+  g_assert_no_error (error);
+
+  keys = g_new (gchar *, PERF_KEYS);
+  for (i = 0; i < PERF_KEYS; i++)
+    if (i % 2)
+      keys[i] = g_strdup_printf ("/dir%d/key%d", i % N_DIRS, i);
+    else
+      keys[i] = g_strdup_printf ("/org/gtk/test/key%d", i);
+
+  rand = g_rand_new_with_seed (42);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < PERF_LOOKUPS; i += G_N_ELEMENTS (batch))
+    {
+      for (j = 0; j < G_N_ELEMENTS (batch); j++)
+        batch[j] = keys[g_rand_int_range (rand, 0, PERF_KEYS)];
+
+      gvdb_table_get_values (table, batch, G_N_ELEMENTS (batch), values);
+
+      for (j = 0; j < G_N_ELEMENTS (batch); j++)
+        g_variant_unref (values[j]);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+
+  result = PERF_LOOKUPS / elapsed * 1.0e-6;
+  g_test_maximized_result (result, "%6.2f million lookups/s", result);
+
+  g_rand_free (rand);
+  for (i = 0; i < PERF_KEYS; i++)
+    g_free (keys[i]);
+  g_free (keys);
+  gvdb_table_unref (table);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static void
+test_lookup_performance (gconstpointer data)
+{
+  gboolean perfect_hash = GPOINTER_TO_INT (data);
+  GvdbTable *table;
+  GError *error = NULL;
+  gchar *filename;
+  gchar **keys;
+  gdouble elapsed;
+  gdouble result;
+  GRand *rand;
+  gint i;
+
+  if (!g_test_perf ())
+    return;
+
+  filename = write_table (PERF_KEYS, FALSE, perfect_hash);
+  table = gvdb_table_new (filename, TRUE, &error);
+  g_assert_no_error (error);
+
+  keys = g_new (gchar *, PERF_KEYS);
+  for (i = 0; i < PERF_KEYS; i++)
+    if (i % 2)
+      keys[i] = g_strdup_printf ("/dir%d/key%d", i % N_DIRS, i);
+    else
+      keys[i] = g_strdup_printf ("/org/gtk/test/key%d", i);
+
+  rand = g_rand_new_with_seed (42);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < PERF_LOOKUPS; i++)
+    {
+      GVariant *value;
+
+      value = gvdb_table_get_value (table, keys[g_rand_int_range (rand, 0, PERF_KEYS)]);
+      g_variant_unref (value);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+
+  result = PERF_LOOKUPS / elapsed * 1.0e-6;
+  g_test_maximized_result (result, "%6.2f million lookups/s", result);
+
+  g_rand_free (rand);
+  for (i = 0; i < PERF_KEYS; i++)
+    g_free (keys[i]);
+  g_free (keys);
+  gvdb_table_unref (table);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/gvdb/perfect-hash", test_perfect_hash);
+  g_test_add_func ("/gvdb/iter", test_iter);
+  g_test_add_func ("/gvdb/batch", test_batch);
+  g_test_add_data_func ("/gvdb/perf/lookup", GINT_TO_POINTER (FALSE),
+                        test_lookup_performance);
+  g_test_add_data_func ("/gvdb/perf/lookup-perfect-hash", GINT_TO_POINTER (TRUE),
+                        test_lookup_performance);
+  g_test_add_func ("/gvdb/perf/batch-lookup", test_batch_lookup_performance);
+
+  return g_test_run ();
+}
@@ -0,0 +1,311 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gio/gio.h>
+
+/* A job that blocks its worker thread until released */
+static GMutex gate_lock;
+static GCond gate_cond;
+static gboolean gate_open;
+static gboolean gate_entered;
+
+static gboolean
+gate_job (GIOSchedulerJob *job,
+          GCancellable    *cancellable,
+          gpointer         user_data)
+{
+  g_mutex_lock (&gate_lock);
+  gate_entered = TRUE;
+  g_cond_broadcast (&gate_cond);
+  while (!gate_open)
+    g_cond_wait (&gate_cond, &gate_lock);
+  g_mutex_unlock (&gate_lock);
+
+  return FALSE;
+}
+
+static void
+close_gate (GIOSchedulerPool pool)
+{
+  gate_open = FALSE;
+  gate_entered = FALSE;
+
+  g_io_scheduler_push_job_to_pool (pool, gate_job, NULL, NULL,
+                                   G_PRIORITY_DEFAULT, NULL);
+
+  g_mutex_lock (&gate_lock);
+  while (!gate_entered)
+    g_cond_wait (&gate_cond, &gate_lock);
+  g_mutex_unlock (&gate_lock);
+}
+
+static void
+open_gate (void)
+{
+  g_mutex_lock (&gate_lock);
+  gate_open = TRUE;
+  g_cond_broadcast (&gate_cond);
+  g_mutex_unlock (&gate_lock);
+}
+
+static void
+wait_for_completed (GIOSchedulerPool pool,
+                    guint64          n_completed)
+{
+  GIOSchedulerStats stats;
+
+  do
+    {
+      g_usleep (1000);
+      g_io_scheduler_get_stats (pool, &stats);
+    }
+  while (stats.n_completed < n_completed);
+}
+
+/* Records the order in which jobs ran */
+static GMutex order_lock;
+static GString *order;
+
+static gboolean
+record_job (GIOSchedulerJob *job,
+            GCancellable    *cancellable,
+            gpointer         user_data)
+{
+  g_mutex_lock (&order_lock);
+  g_string_append (order, user_data);
+  g_mutex_unlock (&order_lock);
+
+  return FALSE;
+}
+
+static void
+test_pools (void)
+{
+  GIOSchedulerStats stats, before;
+
+  order = g_string_new (NULL);
+  g_io_scheduler_set_max_threads (G_IO_SCHEDULER_POOL_DATA, 1);
+
+  close_gate (G_IO_SCHEDULER_POOL_DATA);
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_DATA, &before);
+  g_assert_cmpuint (before.n_running, ==, 1);
+
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA, record_job,
+                                   "d", NULL, G_PRIORITY_DEFAULT, NULL);
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA, record_job,
+                                   "d", NULL, G_PRIORITY_DEFAULT, NULL);
+
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_DATA, &stats);
+  g_assert_cmpuint (stats.n_queued, ==, 2);
+  g_assert_cmpuint (stats.max_queued, >=, 2);
+
+  /* The metadata pool is not held up by the blocked data pool */
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_METADATA, &before);
+  g_io_scheduler_push_job (record_job, "m", NULL, G_PRIORITY_DEFAULT, NULL);
+  wait_for_completed (G_IO_SCHEDULER_POOL_METADATA, before.n_completed + 1);
+
+  g_mutex_lock (&order_lock);
+  g_assert_cmpstr (order->str, ==, "m");
+  g_mutex_unlock (&order_lock);
+
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_DATA, &before);
+  open_gate ();
+  wait_for_completed (G_IO_SCHEDULER_POOL_DATA, before.n_completed + 3);
+
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_DATA, &stats);
+  g_assert_cmpuint (stats.n_queued, ==, 0);
+  g_assert_cmpuint (stats.n_running, ==, 0);
+  g_assert_cmpstr (order->str, ==, "mdd");
+
+  g_string_free (order, TRUE);
+}
+
+static void
+test_cancel (void)
+{
+  GIOSchedulerStats before;
+  GCancellable *cancellable;
+
+  order = g_string_new (NULL);
+  cancellable = g_cancellable_new ();
+  g_io_scheduler_set_max_threads (G_IO_SCHEDULER_POOL_DATA, 1);
+
+  close_gate (G_IO_SCHEDULER_POOL_DATA);
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_DATA, &before);
+
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA, record_job,
+                                   "a", NULL, G_PRIORITY_DEFAULT, NULL);
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA, record_job,
+                                   "b", NULL, G_PRIORITY_LOW, NULL);
+  g_io_scheduler_push_job_to_pool (G_IO_SCHEDULER_POOL_DATA, record_job,
+                                   "c", NULL, G_PRIORITY_LOW, cancellable);
+
+  /* A cancelled job jumps the queue so that it finishes promptly */
+  g_cancellable_cancel (cancellable);
+  open_gate ();
+  wait_for_completed (G_IO_SCHEDULER_POOL_DATA, before.n_completed + 4);
+
+  g_assert_cmpstr (order->str, ==, "cab");
+
+  g_object_unref (cancellable);
+  g_string_free (order, TRUE);
+}
+
+/* Results sent back to the main context */
+#define N_RESULTS 100
+
+static gint n_results;
+static gint n_nested;
+
+static gboolean
+result_cb (gpointer user_data)
+{
+  g_assert_cmpint (GPOINTER_TO_INT (user_data), ==, n_results);
+  n_results++;
+
+  return FALSE;
+}
+
+static gboolean
+send_results_job (GIOSchedulerJob *job,
+                  GCancellable    *cancellable,
+                  gpointer         user_data)
+{
+  gint i;
+
+  for (i = 0; i < N_RESULTS; i++)
+    g_io_scheduler_job_send_to_mainloop_async (job, result_cb,
+                                               GINT_TO_POINTER (i), NULL);
+
+  return FALSE;
+}
+
+static void
+test_batching (void)
+{
+  GIOSchedulerStats before;
+
+  n_results = 0;
+  g_io_scheduler_get_stats (G_IO_SCHEDULER_POOL_METADATA, &before);
+  g_io_scheduler_push_job (send_results_job, NULL, NULL,
+                           G_PRIORITY_DEFAULT, NULL);
+  wait_for_completed (G_IO_SCHEDULER_POOL_METADATA, before.n_completed + 1);
+
+  /* Everything queued so far is delivered, in order, in one iteration */
+  g_assert_cmpint (n_results, ==, 0);
+  g_main_context_iteration (NULL, FALSE);
+  g_assert_cmpint (n_results, ==, N_RESULTS);
+  g_assert (!g_main_context_pending (NULL));
+}
+
+static gboolean
+nested_cb (gpointer user_data)
+{
+  n_nested++;
+
+  /* Later results must still arrive while we are dispatching */
+  while (n_results < N_RESULTS)
+    g_main_context_iteration (NULL, TRUE);
+
+  return FALSE;
+}
+
+static gboolean
+send_nested_job (GIOSchedulerJob *job,
+                 GCancellable    *cancellable,
+                 gpointer         user_data)
+{
+  gint i;
+
+  g_io_scheduler_job_send_to_mainloop_async (job, nested_cb, NULL, NULL);
+
+  for (i = 0; i < N_RESULTS; i++)
+    g_io_scheduler_job_send_to_mainloop_async (job, result_cb,
+                                               GINT_TO_POINTER (i), NULL);
+
+  return FALSE;
+}
+
+static gboolean
+return_value_cb (gpointer user_data)
+{
+  return GPOINTER_TO_INT (user_data);
+}
+
+static gboolean
+set_done_cb (gpointer user_data)
+{
+  gboolean *done = user_data;
+
+  *done = TRUE;
+
+  return FALSE;
+}
+
+static gboolean
+send_sync_job (GIOSchedulerJob *job,
+               GCancellable    *cancellable,
+               gpointer         user_data)
+{
+  g_assert (g_io_scheduler_job_send_to_mainloop (job, return_value_cb,
+                                                 GINT_TO_POINTER (TRUE),
+                                                 NULL));
+  g_assert (!g_io_scheduler_job_send_to_mainloop (job, return_value_cb,
+                                                  GINT_TO_POINTER (FALSE),
+                                                  NULL));
+
+  /* Setting the flag from here would not wake up the main loop */
+  g_io_scheduler_job_send_to_mainloop_async (job, set_done_cb, user_data, NULL);
+
+  return FALSE;
+}
+
+static void
+test_nested (void)
+{
+  gboolean done = FALSE;
+
+  n_results = 0;
+  n_nested = 0;
+  g_io_scheduler_push_job (send_nested_job, NULL, NULL,
+                           G_PRIORITY_DEFAULT, NULL);
+  while (n_nested == 0 || n_results < N_RESULTS)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpint (n_nested, ==, 1);
+
+  g_io_scheduler_push_job (send_sync_job, &done, NULL,
+                           G_PRIORITY_DEFAULT, NULL);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_type_init ();
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/io-scheduler/pools", test_pools);
+  g_test_add_func ("/io-scheduler/cancel", test_cancel);
+  g_test_add_func ("/io-scheduler/batching", test_batching);
+  g_test_add_func ("/io-scheduler/nested", test_nested);
+
+  return g_test_run ();
+}
@@ -149,6 +149,176 @@ test_properties (void)
   g_object_unref (mo);
 }
 
+static void
+test_writev (void)
+{
+  GOutputStream *mo;
+  GOutputVector vectors[3];
+  gsize bytes_written;
+  gssize res;
+  GError *error = NULL;
+
+  /* Memory streams use the generic one-buffer-at-a-time fallback */
+  mo = g_memory_output_stream_new (g_malloc (4), 4, g_realloc, g_free);
+
+  vectors[0].buffer = "Hello";
+  vectors[0].size = 5;
+  vectors[1].buffer = ", ";
+  vectors[1].size = 2;
+  vectors[2].buffer = "world";
+  vectors[2].size = 6;
+
+  res = g_output_stream_writev (mo, vectors, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 13);
+
+  g_output_stream_writev_all (mo, vectors, 3, &bytes_written, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (bytes_written, ==, 13);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 26);
+  g_assert_cmpstr (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)), ==, "Hello, world");
+  g_assert_cmpstr ((char *) g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)) + 13, ==, "Hello, world");
+
+  g_object_unref (mo);
+}
+
+static void
+test_chunked (void)
+{
+  GOutputStream *mo;
+  GPtrArray *chunks;
+  GBytes *bytes;
+  gchar buf[10];
+  gsize size;
+  gint i;
+  GError *error = NULL;
+
+  mo = g_memory_output_stream_new_chunked (16);
+  g_assert (g_seekable_can_truncate (G_SEEKABLE (mo)));
+
+  for (i = 0; i < 10; i++)
+    {
+      memset (buf, 'a' + i, sizeof buf);
+      g_output_stream_write_all (mo, buf, sizeof buf, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 100);
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 112);
+
+  /* Overwrite across a segment boundary */
+  g_seekable_seek (G_SEEKABLE (mo), 12, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (mo, "XXXXXXXX", 8, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_seekable_truncate (G_SEEKABLE (mo), 40, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 40);
+
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  chunks = g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpuint (chunks->len, ==, 3);
+  g_assert_cmpuint (g_bytes_get_size (chunks->pdata[0]), ==, 16);
+  g_assert_cmpuint (g_bytes_get_size (chunks->pdata[1]), ==, 16);
+  g_assert_cmpuint (g_bytes_get_size (chunks->pdata[2]), ==, 8);
+  g_assert (memcmp (g_bytes_get_data (chunks->pdata[0], NULL), "aaaaaaaaaabbXXXX", 16) == 0);
+  g_assert (memcmp (g_bytes_get_data (chunks->pdata[1], NULL), "XXXXccccccccccdd", 16) == 0);
+  g_assert (memcmp (g_bytes_get_data (chunks->pdata[2], NULL), "dddddddd", 8) == 0);
+  g_ptr_array_unref (chunks);
+  g_object_unref (mo);
+
+  /* Merged into a single GBytes */
+  mo = g_memory_output_stream_new_chunked (4);
+  g_output_stream_write_all (mo, "Hello, world", 12, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert (memcmp (g_bytes_get_data (bytes, &size), "Hello, world", 12) == 0);
+  g_assert_cmpuint (size, ==, 12);
+  g_bytes_unref (bytes);
+  g_object_unref (mo);
+}
+
+static void
+test_chunked_truncate_after_steal (void)
+{
+  GOutputStream *mo;
+  GPtrArray *chunks;
+  GBytes *bytes;
+  gchar buf[100];
+  GError *error = NULL;
+
+  memset (buf, 'x', sizeof buf);
+
+  mo = g_memory_output_stream_new_chunked (32);
+  g_output_stream_write_all (mo, buf, sizeof buf, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  chunks = g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpuint (chunks->len, ==, 4);
+
+  /* The stream no longer describes the stolen memory */
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (mo)), ==, 0);
+
+  g_seekable_truncate (G_SEEKABLE (mo), 10, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 32);
+
+  g_assert (memcmp (g_bytes_get_data (chunks->pdata[0], NULL), buf, 32) == 0);
+  g_ptr_array_unref (chunks);
+  g_object_unref (mo);
+
+  /* Same after stealing the data in one piece */
+  mo = g_memory_output_stream_new_chunked (32);
+  g_output_stream_write_all (mo, buf, sizeof buf, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, sizeof buf);
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+
+  g_seekable_truncate (G_SEEKABLE (mo), 10, NULL, &error);
+  g_assert_no_error (error);
+
+  g_assert (memcmp (g_bytes_get_data (bytes, NULL), buf, sizeof buf) == 0);
+  g_bytes_unref (bytes);
+  g_object_unref (mo);
+}
+
+static void
+test_steal_as_bytes (void)
+{
+  GOutputStream *mo;
+  GBytes *bytes;
+  gsize size;
+  GError *error = NULL;
+
+  mo = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+  g_output_stream_write_all (mo, "Hello, world", 12, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert (memcmp (g_bytes_get_data (bytes, &size), "Hello, world", 12) == 0);
+  g_assert_cmpuint (size, ==, 12);
+  g_assert (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)) == NULL);
+
+  g_object_unref (mo);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -161,6 +331,10 @@ main (int   argc,
   g_test_add_func ("/memory-output-stream/seek", test_seek);
   g_test_add_func ("/memory-output-stream/get-data-size", test_data_size);
   g_test_add_func ("/memory-output-stream/properties", test_properties);
+  g_test_add_func ("/memory-output-stream/writev", test_writev);
+  g_test_add_func ("/memory-output-stream/chunked", test_chunked);
+  g_test_add_func ("/memory-output-stream/chunked-truncate-after-steal", test_chunked_truncate_after_steal);
+  g_test_add_func ("/memory-output-stream/steal-as-bytes", test_steal_as_bytes);
 
   return g_test_run();
 }
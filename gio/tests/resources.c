@@ -181,6 +181,127 @@ test_resource_data (void)
   g_resource_unref (resource);
 }
 
+static void
+test_resource_lz4 (void)
+{
+  GResource *resource;
+  GError *error = NULL;
+  gboolean found, success;
+  gsize size;
+  guint32 flags;
+  GBytes *data;
+  GInputStream *in;
+  gchar *contents;
+  gchar buffer[4096];
+
+  resource = g_resource_load ("test.gresource", &error);
+  g_assert (resource != NULL);
+  g_assert_no_error (error);
+
+  found = g_resource_get_info (resource,
+			       "/lz4/test1.txt",
+			       G_RESOURCE_LOOKUP_FLAGS_NONE,
+			       &size, &flags, &error);
+  g_assert (found);
+  g_assert_no_error (error);
+  g_assert_cmpint (size, ==, 6);
+  g_assert_cmpuint (flags, ==, G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_LZ4);
+
+  data = g_resource_lookup_data (resource,
+				 "/lz4/test1.txt",
+				 G_RESOURCE_LOOKUP_FLAGS_NONE,
+				 &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test1\n");
+  g_bytes_unref (data);
+
+  /* long enough to contain matches */
+  success = g_file_get_contents (SRCDIR "/test.gresource.xml", &contents, &size, NULL);
+  g_assert (success);
+  g_assert_cmpint (size, <, sizeof (buffer));
+
+  data = g_resource_lookup_data (resource,
+				 "/lz4/test.gresource.xml",
+				 G_RESOURCE_LOOKUP_FLAGS_NONE,
+				 &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_bytes_get_size (data), ==, size);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, contents);
+  g_bytes_unref (data);
+
+  in = g_resource_open_stream (resource,
+			       "/lz4/test.gresource.xml",
+			       G_RESOURCE_LOOKUP_FLAGS_NONE,
+			       &error);
+  g_assert (in != NULL);
+  g_assert_no_error (error);
+
+  success = g_input_stream_read_all (in, buffer, sizeof (buffer) - 1,
+				     &size,
+				     NULL, &error);
+  g_assert (success);
+  g_assert_no_error (error);
+  buffer[size] = 0;
+  g_assert_cmpstr (buffer, ==, contents);
+  g_clear_object (&in);
+
+  g_free (contents);
+  g_resource_unref (resource);
+}
+
+static void
+test_resource_cache (void)
+{
+  GResource *resource;
+  GError *error = NULL;
+  GBytes *data, *data2;
+
+  resource = g_resource_load ("test.gresource", &error);
+  g_assert (resource != NULL);
+  g_assert_no_error (error);
+
+  /* without a cache, every lookup decompresses */
+  data = g_resource_lookup_data (resource, "/test1.txt",
+				 G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  data2 = g_resource_lookup_data (resource, "/test1.txt",
+				  G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (data != data2);
+  g_bytes_unref (data);
+  g_bytes_unref (data2);
+
+  g_resource_set_cache_size (resource, 1024);
+
+  data = g_resource_lookup_data (resource, "/test1.txt",
+				 G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  data2 = g_resource_lookup_data (resource, "/test1.txt",
+				  G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (data == data2);
+  g_assert_cmpstr (g_bytes_get_data (data2, NULL), ==, "test1\n");
+  g_bytes_unref (data2);
+
+  /* only room for one of the two files: the older one is dropped */
+  g_resource_set_cache_size (resource, 10);
+
+  data2 = g_resource_lookup_data (resource, "/lz4/test1.txt",
+				  G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_bytes_unref (data2);
+
+  data2 = g_resource_lookup_data (resource, "/test1.txt",
+				  G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (data != data2);
+  g_bytes_unref (data);
+  g_bytes_unref (data2);
+
+  g_resource_set_cache_size (resource, 0);
+  g_resource_unref (resource);
+}
+
 static void
 test_resource_registred (void)
 {
@@ -473,6 +594,8 @@ main (int   argc,
   g_test_add_func ("/resource/file", test_resource_file);
   g_test_add_func ("/resource/data", test_resource_data);
   g_test_add_func ("/resource/registred", test_resource_registred);
+  g_test_add_func ("/resource/lz4", test_resource_lz4);
+  g_test_add_func ("/resource/cache", test_resource_cache);
   g_test_add_func ("/resource/manual", test_resource_manual);
 #ifdef G_HAS_CONSTRUCTORS
   g_test_add_func ("/resource/automatic", test_resource_automatic);
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <gio/gunixconnection.h>
+#include <gio/gunixfdmessage.h>
 #endif
 
 #include "gnetworkingprivate.h"
@@ -418,6 +419,203 @@ test_ipv4_sync (void)
   test_ip_sync (G_SOCKET_FAMILY_IPV4);
 }
 
+static GSocket *
+create_udp_socket (void)
+{
+  GSocket *sock;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GError *error = NULL;
+
+  sock = g_socket_new (G_SOCKET_FAMILY_IPV4,
+                       G_SOCKET_TYPE_DATAGRAM,
+                       G_SOCKET_PROTOCOL_DEFAULT,
+                       &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+
+  g_socket_bind (sock, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+
+  return sock;
+}
+
+static void
+test_datagram_messages (void)
+{
+  GSocket *server, *client;
+  GSocketAddress *server_addr, *client_addr;
+  GSocketAddress *from[4] = { NULL, };
+  GOutputVector out_vectors[3][2];
+  GOutputMessage out_messages[3];
+  GInputVector in_vectors[4];
+  GInputMessage in_messages[4];
+  gchar buf[4][64];
+  GError *error = NULL;
+  gint i, n;
+
+  server = create_udp_socket ();
+  client = create_udp_socket ();
+  server_addr = g_socket_get_local_address (server, &error);
+  g_assert_no_error (error);
+  client_addr = g_socket_get_local_address (client, &error);
+  g_assert_no_error (error);
+
+  g_socket_set_blocking (server, TRUE);
+  g_socket_set_timeout (server, 1);
+
+  for (i = 0; i < 3; i++)
+    {
+      out_vectors[i][0].buffer = "datagram ";
+      out_vectors[i][0].size = 9;
+      out_vectors[i][1].buffer = "012" + i;
+      out_vectors[i][1].size = 1;
+
+      out_messages[i].address = server_addr;
+      out_messages[i].vectors = out_vectors[i];
+      out_messages[i].num_vectors = 2;
+      out_messages[i].bytes_sent = 0;
+      out_messages[i].control_messages = NULL;
+      out_messages[i].num_control_messages = 0;
+    }
+
+  n = g_socket_send_messages (client, out_messages, 3, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 3);
+  for (i = 0; i < 3; i++)
+    g_assert_cmpuint (out_messages[i].bytes_sent, ==, 10);
+
+  for (i = 0; i < 4; i++)
+    {
+      in_vectors[i].buffer = buf[i];
+      in_vectors[i].size = sizeof buf[i];
+
+      in_messages[i].address = &from[i];
+      in_messages[i].vectors = &in_vectors[i];
+      in_messages[i].num_vectors = 1;
+      in_messages[i].bytes_received = 0;
+      in_messages[i].flags = 0;
+      in_messages[i].control_messages = NULL;
+      in_messages[i].num_control_messages = NULL;
+    }
+
+  /* Loopback delivery is synchronous, so all three are queued */
+  n = g_socket_receive_messages (server, in_messages, 4, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 3);
+  for (i = 0; i < 3; i++)
+    {
+      g_assert_cmpuint (in_messages[i].bytes_received, ==, 10);
+      g_assert (strncmp (buf[i], "datagram ", 9) == 0);
+      g_assert_cmpint (buf[i][9], ==, '0' + i);
+      g_assert (G_IS_INET_SOCKET_ADDRESS (from[i]));
+      g_assert_cmpint (g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (from[i])), ==,
+                       g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (client_addr)));
+      g_object_unref (from[i]);
+    }
+
+  g_socket_set_blocking (server, FALSE);
+  n = g_socket_receive_messages (server, in_messages, 4, 0, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+  g_assert_cmpint (n, ==, -1);
+  g_clear_error (&error);
+
+  n = g_socket_send_messages (client, out_messages, 0, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 0);
+
+  g_object_unref (server_addr);
+  g_object_unref (client_addr);
+  g_object_unref (server);
+  g_object_unref (client);
+}
+
+#define PERF_PACKETS 200000
+#define PERF_BATCH   64
+
+static void
+test_datagram_messages_perf (void)
+{
+  GSocket *server, *client;
+  GSocketAddress *server_addr;
+  GOutputVector out_vector;
+  GOutputMessage out_messages[PERF_BATCH];
+  GInputVector in_vectors[PERF_BATCH];
+  GInputMessage in_messages[PERF_BATCH];
+  gchar payload[64] = { 0, };
+  gchar buf[PERF_BATCH][64];
+  GError *error = NULL;
+  GTimer *timer;
+  gdouble single, batched;
+  gint i, n, done;
+
+  if (!g_test_perf ())
+    return;
+
+  server = create_udp_socket ();
+  client = create_udp_socket ();
+  server_addr = g_socket_get_local_address (server, &error);
+  g_assert_no_error (error);
+
+  out_vector.buffer = payload;
+  out_vector.size = sizeof payload;
+  for (i = 0; i < PERF_BATCH; i++)
+    {
+      out_messages[i].address = server_addr;
+      out_messages[i].vectors = &out_vector;
+      out_messages[i].num_vectors = 1;
+      out_messages[i].bytes_sent = 0;
+      out_messages[i].control_messages = NULL;
+      out_messages[i].num_control_messages = 0;
+
+      in_vectors[i].buffer = buf[i];
+      in_vectors[i].size = sizeof buf[i];
+      in_messages[i].address = NULL;
+      in_messages[i].vectors = &in_vectors[i];
+      in_messages[i].num_vectors = 1;
+      in_messages[i].control_messages = NULL;
+      in_messages[i].num_control_messages = NULL;
+    }
+
+  /* One datagram per call */
+  timer = g_timer_new ();
+  for (done = 0; done < PERF_PACKETS; done += PERF_BATCH)
+    {
+      for (i = 0; i < PERF_BATCH; i++)
+        g_socket_send_message (client, server_addr, &out_vector, 1,
+                               NULL, 0, 0, NULL, &error);
+      for (i = 0; i < PERF_BATCH; i++)
+        g_socket_receive_message (server, NULL, &in_vectors[i], 1,
+                                  NULL, NULL, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+  single = PERF_PACKETS / g_timer_elapsed (timer, NULL);
+
+  /* PERF_BATCH datagrams per call */
+  g_timer_start (timer);
+  for (done = 0; done < PERF_PACKETS; done += n)
+    {
+      n = g_socket_send_messages (client, out_messages, PERF_BATCH, 0, NULL, &error);
+      g_assert_no_error (error);
+      n = g_socket_receive_messages (server, in_messages, n, 0, NULL, &error);
+      g_assert_no_error (error);
+    }
+  batched = PERF_PACKETS / g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  g_test_message ("send_message/receive_message: %.0f packets/s", single);
+  g_test_maximized_result (batched, "send_messages/receive_messages: %.0f packets/s (%.2fx)",
+                           batched, batched / single);
+
+  g_object_unref (server_addr);
+  g_object_unref (server);
+  g_object_unref (client);
+}
+
 static void
 test_ipv6_sync (void)
 {
@@ -730,6 +928,139 @@ create_connection_for_fd (int fd)
 
 #define TEST_DATA "failure to say failure to say 'i love gnome-panel!'."
 
+static void
+test_unix_connection_writev (void)
+{
+  GSocketConnection *connection;
+  GOutputStream *out;
+  GOutputVector vectors[2];
+  GError *err = NULL;
+  char buffer[1024];
+  gint sv[2], status, len;
+  gssize res;
+
+  status = socketpair (PF_UNIX, SOCK_STREAM, 0, sv);
+  g_assert_cmpint (status, ==, 0);
+
+  connection = create_connection_for_fd (sv[0]);
+  out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  vectors[0].buffer = TEST_DATA;
+  vectors[0].size = 10;
+  vectors[1].buffer = TEST_DATA + 10;
+  vectors[1].size = sizeof (TEST_DATA) - 10;
+
+  res = g_output_stream_writev (out, vectors, 2, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (res, ==, sizeof (TEST_DATA));
+
+  res = g_pollable_output_stream_writev_nonblocking (G_POLLABLE_OUTPUT_STREAM (out),
+						     vectors, 2, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (res, ==, sizeof (TEST_DATA));
+
+  do
+    len = read (sv[1], buffer, sizeof buffer);
+  while (len == -1 && errno == EINTR);
+  g_assert_cmpint (len, ==, 2 * sizeof (TEST_DATA));
+  g_assert_cmpstr (buffer, ==, TEST_DATA);
+  g_assert_cmpstr (buffer + sizeof (TEST_DATA), ==, TEST_DATA);
+
+  g_object_unref (connection);
+  close (sv[1]);
+}
+
+#define STREAM_MESSAGE_SIZE (1024 * 1024)
+
+static gpointer
+read_stream_messages (gpointer user_data)
+{
+  gint fd = GPOINTER_TO_INT (user_data);
+  gchar *buffer;
+  gsize len = 0;
+  gssize res;
+
+  buffer = g_malloc (2 * STREAM_MESSAGE_SIZE);
+
+  while (len < 2 * STREAM_MESSAGE_SIZE)
+    {
+      res = read (fd, buffer + len, 2 * STREAM_MESSAGE_SIZE - len);
+      if (res == -1 && errno == EINTR)
+        continue;
+      g_assert_cmpint (res, >, 0);
+      len += res;
+    }
+
+  return buffer;
+}
+
+static void
+test_unix_stream_messages (void)
+{
+  GSocket *sender;
+  GOutputMessage messages[2];
+  GOutputVector vectors[2][2];
+  GError *err = NULL;
+  GThread *thread;
+  gchar *data[2], *buffer;
+  gint sv[2], status, i, n;
+
+  status = socketpair (PF_UNIX, SOCK_STREAM, 0, sv);
+  g_assert_cmpint (status, ==, 0);
+
+  sender = g_socket_new_from_fd (sv[0], &err);
+  g_assert_no_error (err);
+
+  /* Messages larger than the socket buffer are only taken in parts */
+  for (i = 0; i < 2; i++)
+    {
+      data[i] = g_malloc (STREAM_MESSAGE_SIZE);
+      memset (data[i], 'a' + i, STREAM_MESSAGE_SIZE);
+
+      vectors[i][0].buffer = data[i];
+      vectors[i][0].size = 1000;
+      vectors[i][1].buffer = data[i] + 1000;
+      vectors[i][1].size = STREAM_MESSAGE_SIZE - 1000;
+
+      messages[i].address = NULL;
+      messages[i].vectors = vectors[i];
+      messages[i].num_vectors = 2;
+      messages[i].bytes_sent = 0;
+      messages[i].control_messages = NULL;
+      messages[i].num_control_messages = 0;
+    }
+
+  /* In blocking mode, each message is sent completely before the next */
+  thread = g_thread_new ("reader", read_stream_messages, GINT_TO_POINTER (sv[1]));
+
+  n = g_socket_send_messages (sender, messages, 2, 0, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (n, ==, 2);
+  g_assert_cmpuint (messages[0].bytes_sent, ==, STREAM_MESSAGE_SIZE);
+  g_assert_cmpuint (messages[1].bytes_sent, ==, STREAM_MESSAGE_SIZE);
+
+  buffer = g_thread_join (thread);
+  g_assert (memcmp (buffer, data[0], STREAM_MESSAGE_SIZE) == 0);
+  g_assert (memcmp (buffer + STREAM_MESSAGE_SIZE, data[1], STREAM_MESSAGE_SIZE) == 0);
+  g_free (buffer);
+
+  /* In non-blocking mode, sending stops after a partly sent message */
+  g_socket_set_blocking (sender, FALSE);
+  messages[0].bytes_sent = messages[1].bytes_sent = 0;
+
+  n = g_socket_send_messages (sender, messages, 2, 0, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (n, ==, 1);
+  g_assert_cmpuint (messages[0].bytes_sent, >, 0);
+  g_assert_cmpuint (messages[0].bytes_sent, <, STREAM_MESSAGE_SIZE);
+  g_assert_cmpuint (messages[1].bytes_sent, ==, 0);
+
+  g_object_unref (sender);
+  close (sv[1]);
+  g_free (data[0]);
+  g_free (data[1]);
+}
+
 static void
 test_unix_connection_ancillary_data (void)
 {
@@ -811,6 +1142,105 @@ test_unix_connection_ancillary_data (void)
    * g_unix_connection_receive_credentials().
    */
 }
+
+static void
+test_unix_datagram_messages_control (void)
+{
+  GSocket *sender, *receiver;
+  GSocketControlMessage *fd_message;
+  GSocketControlMessage **control[2] = { NULL, NULL };
+  GOutputVector out_vector;
+  GOutputMessage out_messages[2];
+  GInputVector in_vectors[2];
+  GInputMessage in_messages[2];
+  guint num_control[2];
+  gchar buf[2][64];
+  GError *err = NULL;
+  gint sv[2], pv[2], status, n, fd, len;
+  gint *fds;
+  gint i;
+
+  status = socketpair (PF_UNIX, SOCK_DGRAM, 0, sv);
+  g_assert_cmpint (status, ==, 0);
+  status = pipe (pv);
+  g_assert_cmpint (status, ==, 0);
+
+  sender = g_socket_new_from_fd (sv[0], &err);
+  g_assert_no_error (err);
+  receiver = g_socket_new_from_fd (sv[1], &err);
+  g_assert_no_error (err);
+
+  /* The second message carries the write end of the pipe */
+  fd_message = g_unix_fd_message_new ();
+  g_unix_fd_message_append_fd (G_UNIX_FD_MESSAGE (fd_message), pv[1], &err);
+  g_assert_no_error (err);
+  close (pv[1]);
+
+  out_vector.buffer = TEST_DATA;
+  out_vector.size = sizeof (TEST_DATA);
+  for (i = 0; i < 2; i++)
+    {
+      out_messages[i].address = NULL;
+      out_messages[i].vectors = &out_vector;
+      out_messages[i].num_vectors = 1;
+      out_messages[i].bytes_sent = 0;
+      out_messages[i].control_messages = i == 1 ? &fd_message : NULL;
+      out_messages[i].num_control_messages = i == 1 ? 1 : 0;
+
+      in_vectors[i].buffer = buf[i];
+      in_vectors[i].size = sizeof buf[i];
+      in_messages[i].address = NULL;
+      in_messages[i].vectors = &in_vectors[i];
+      in_messages[i].num_vectors = 1;
+      in_messages[i].control_messages = &control[i];
+      in_messages[i].num_control_messages = &num_control[i];
+    }
+
+  n = g_socket_send_messages (sender, out_messages, 2, 0, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (n, ==, 2);
+  g_object_unref (fd_message);
+
+  n = g_socket_receive_messages (receiver, in_messages, 2, 0, NULL, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (n, ==, 2);
+
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpuint (in_messages[i].bytes_received, ==, sizeof (TEST_DATA));
+      g_assert_cmpstr (buf[i], ==, TEST_DATA);
+    }
+
+  g_assert_cmpuint (num_control[0], ==, 0);
+  g_assert (control[0] == NULL);
+  g_assert_cmpuint (num_control[1], ==, 1);
+  g_assert (G_IS_UNIX_FD_MESSAGE (control[1][0]));
+  g_assert (control[1][1] == NULL);
+
+  fds = g_unix_fd_message_steal_fds (G_UNIX_FD_MESSAGE (control[1][0]), &n);
+  g_assert_cmpint (n, ==, 1);
+  fd = fds[0];
+  g_free (fds);
+  g_object_unref (control[1][0]);
+  g_free (control[1]);
+
+  do
+    len = write (fd, TEST_DATA, sizeof (TEST_DATA));
+  while (len == -1 && errno == EINTR);
+  g_assert_cmpint (len, ==, sizeof (TEST_DATA));
+  close (fd);
+
+  memset (buf[0], 0, sizeof buf[0]);
+  do
+    len = read (pv[0], buf[0], sizeof buf[0]);
+  while (len == -1 && errno == EINTR);
+  g_assert_cmpint (len, ==, sizeof (TEST_DATA));
+  g_assert_cmpstr (buf[0], ==, TEST_DATA);
+  close (pv[0]);
+
+  g_object_unref (sender);
+  g_object_unref (receiver);
+}
 #endif /* G_OS_UNIX */
 
 int
@@ -830,10 +1260,15 @@ main (int   argc,
   g_test_add_func ("/socket/close_graceful", test_close_graceful);
   g_test_add_func ("/socket/timed_wait", test_timed_wait);
   g_test_add_func ("/socket/address", test_sockaddr);
+  g_test_add_func ("/socket/datagram-messages", test_datagram_messages);
+  g_test_add_func ("/socket/datagram-messages-perf", test_datagram_messages_perf);
 #ifdef G_OS_UNIX
   g_test_add_func ("/socket/unix-from-fd", test_unix_from_fd);
   g_test_add_func ("/socket/unix-connection", test_unix_connection);
   g_test_add_func ("/socket/unix-connection-ancillary-data", test_unix_connection_ancillary_data);
+  g_test_add_func ("/socket/unix-connection-writev", test_unix_connection_writev);
+  g_test_add_func ("/socket/unix-stream-messages", test_unix_stream_messages);
+  g_test_add_func ("/socket/unix-datagram-messages-control", test_unix_datagram_messages_control);
 #endif
 
   return g_test_run();
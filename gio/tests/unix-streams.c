@@ -257,6 +257,272 @@ test_pipe_io (gconstpointer nonblocking)
   g_object_unref (out);
 }
 
+static void
+vectored_io_done (GObject      *source,
+		  GAsyncResult *res,
+		  gpointer      user_data)
+{
+  GAsyncResult **result = user_data;
+
+  *result = g_object_ref (res);
+}
+
+static void
+test_vectored_io (void)
+{
+  GInputStream *in;
+  GOutputStream *out;
+  GOutputVector out_vectors[3];
+  GInputVector in_vectors[2];
+  GOutputVector *many;
+  GAsyncResult *read_result, *write_result;
+  char buf1[3], buf2[16], *data;
+  gsize n_written, n_read;
+  int fd[2], i;
+  gssize res;
+  GError *error = NULL;
+
+  g_assert (pipe (fd) == 0);
+  g_unix_set_fd_nonblocking (fd[0], TRUE, &error);
+  g_assert_no_error (error);
+
+  in = g_unix_input_stream_new (fd[0], TRUE);
+  out = g_unix_output_stream_new (fd[1], TRUE);
+
+  out_vectors[0].buffer = "abc";
+  out_vectors[0].size = 3;
+  out_vectors[1].buffer = NULL;
+  out_vectors[1].size = 0;
+  out_vectors[2].buffer = "defgh";
+  out_vectors[2].size = 5;
+  in_vectors[0].buffer = buf1;
+  in_vectors[0].size = sizeof (buf1);
+  in_vectors[1].buffer = buf2;
+  in_vectors[1].size = sizeof (buf2);
+
+  /* Synchronous */
+  res = g_output_stream_writev (out, out_vectors, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+
+  res = g_input_stream_readv (in, in_vectors, 2, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+  g_assert (memcmp (buf1, "abc", 3) == 0);
+  g_assert (memcmp (buf2, "defgh", 5) == 0);
+
+  /* Non-blocking */
+  res = g_pollable_input_stream_readv_nonblocking (G_POLLABLE_INPUT_STREAM (in),
+						   in_vectors, 2, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+  g_assert_cmpint (res, ==, -1);
+  g_clear_error (&error);
+
+  res = g_pollable_output_stream_writev_nonblocking (G_POLLABLE_OUTPUT_STREAM (out),
+						     out_vectors, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+
+  res = g_pollable_input_stream_readv_nonblocking (G_POLLABLE_INPUT_STREAM (in),
+						   in_vectors, 2, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+  g_assert (memcmp (buf2, "defgh", 5) == 0);
+
+  /* Asynchronous; the read has to wait for the write */
+  memset (buf1, 0, sizeof (buf1));
+  memset (buf2, 0, sizeof (buf2));
+  read_result = write_result = NULL;
+  g_input_stream_readv_async (in, in_vectors, 2, G_PRIORITY_DEFAULT, NULL,
+			      vectored_io_done, &read_result);
+  g_main_context_iteration (NULL, FALSE);
+  g_assert (read_result == NULL);
+
+  g_output_stream_writev_async (out, out_vectors, 3, G_PRIORITY_DEFAULT, NULL,
+				vectored_io_done, &write_result);
+  while (read_result == NULL || write_result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  res = g_output_stream_writev_finish (out, write_result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+  g_object_unref (write_result);
+
+  res = g_input_stream_readv_finish (in, read_result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, 8);
+  g_assert (memcmp (buf1, "abc", 3) == 0);
+  g_assert (memcmp (buf2, "defgh", 5) == 0);
+  g_object_unref (read_result);
+
+  /* More vectors than the kernel takes in one call */
+  many = g_new (GOutputVector, 5000);
+  for (i = 0; i < 5000; i++)
+    {
+      many[i].buffer = DATA + i % 26;
+      many[i].size = 1;
+    }
+  g_output_stream_writev_all (out, many, 5000, &n_written, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_written, ==, 5000);
+
+  data = g_malloc (5000);
+  g_input_stream_read_all (in, data, 5000, &n_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_read, ==, 5000);
+  for (i = 0; i < 5000; i++)
+    g_assert_cmpint (data[i], ==, DATA[i % 26]);
+
+  g_free (data);
+  g_free (many);
+  g_object_unref (in);
+  g_object_unref (out);
+}
+
+#define SPLICE_SIZE (256 * 1024)
+
+static gpointer
+splice_reader_thread (gpointer user_data)
+{
+  int fd = GPOINTER_TO_INT (user_data);
+  GString *data;
+  char buf[4096];
+  gssize n;
+
+  data = g_string_new (NULL);
+  do
+    {
+      n = read (fd, buf, sizeof (buf));
+      g_assert_cmpint (n, >=, 0);
+      g_string_append_len (data, buf, n);
+    }
+  while (n > 0);
+  close (fd);
+
+  return data;
+}
+
+static gpointer
+splice_writer_thread (gpointer user_data)
+{
+  int fd = GPOINTER_TO_INT (user_data);
+  gssize n;
+  gsize i;
+
+  for (i = 0; i < SPLICE_SIZE; i += n)
+    {
+      n = write (fd, DATA, MIN (strlen (DATA), SPLICE_SIZE - i));
+      g_assert_cmpint (n, >, 0);
+    }
+  close (fd);
+
+  return NULL;
+}
+
+static void
+check_splice_data (const char *data,
+		   gsize       len)
+{
+  gsize i;
+
+  g_assert_cmpuint (len, ==, SPLICE_SIZE);
+  for (i = 0; i < len; i++)
+    g_assert_cmpint (data[i], ==, DATA[i % strlen (DATA)]);
+}
+
+static void
+test_splice (void)
+{
+  GFile *file;
+  GFileIOStream *iostream;
+  GInputStream *in;
+  GOutputStream *out;
+  GThread *thread;
+  GString *received;
+  GAsyncResult *result;
+  char *contents;
+  gsize len;
+  gssize res;
+  int fd[2];
+  GError *error = NULL;
+
+  file = g_file_new_tmp ("unix-streams-splice-XXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+
+  g_assert (pipe (fd) == 0);
+  thread = g_thread_new ("writer", splice_writer_thread, GINT_TO_POINTER (fd[1]));
+  in = g_unix_input_stream_new (fd[0], TRUE);
+  out = G_OUTPUT_STREAM (g_file_replace (file, NULL, FALSE, 0, NULL, &error));
+  g_assert_no_error (error);
+
+  /* Pipe to file; the source isn't a regular file, so this uses splice() */
+  res = g_output_stream_splice (out, in,
+				G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+				G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, SPLICE_SIZE);
+  g_thread_join (thread);
+  g_object_unref (in);
+  g_object_unref (out);
+
+  g_file_load_contents (file, NULL, &contents, &len, NULL, &error);
+  g_assert_no_error (error);
+  check_splice_data (contents, len);
+  g_free (contents);
+
+  /* File to pipe; this can use sendfile() */
+  g_assert (pipe (fd) == 0);
+  thread = g_thread_new ("reader", splice_reader_thread, GINT_TO_POINTER (fd[0]));
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+  out = g_unix_output_stream_new (fd[1], TRUE);
+
+  res = g_output_stream_splice (out, in,
+				G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+				G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, SPLICE_SIZE);
+  received = g_thread_join (thread);
+  check_splice_data (received->str, received->len);
+  g_string_free (received, TRUE);
+  g_object_unref (in);
+  g_object_unref (out);
+
+  /* The same, asynchronously, starting part way into the file */
+  g_assert (pipe (fd) == 0);
+  thread = g_thread_new ("reader", splice_reader_thread, GINT_TO_POINTER (fd[0]));
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+  g_input_stream_skip (in, strlen (DATA), NULL, &error);
+  g_assert_no_error (error);
+  out = g_unix_output_stream_new (fd[1], TRUE);
+
+  result = NULL;
+  g_output_stream_splice_async (out, in,
+				G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+				G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				G_PRIORITY_DEFAULT, NULL,
+				vectored_io_done, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  res = g_output_stream_splice_finish (out, result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, SPLICE_SIZE - strlen (DATA));
+  g_object_unref (result);
+  received = g_thread_join (thread);
+  g_assert_cmpuint (received->len, ==, SPLICE_SIZE - strlen (DATA));
+  g_assert (memcmp (received->str, DATA, strlen (DATA)) == 0);
+  g_string_free (received, TRUE);
+  g_object_unref (in);
+  g_object_unref (out);
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -270,6 +536,8 @@ main (int   argc,
   g_test_add_data_func ("/unix-streams/nonblocking-io-test",
 			GINT_TO_POINTER (TRUE),
 			test_pipe_io);
+  g_test_add_func ("/unix-streams/vectored-io", test_vectored_io);
+  g_test_add_func ("/unix-streams/splice", test_splice);
 
   return g_test_run();
 }
@@ -53,18 +53,25 @@
 
 #include "gconvert.h"
 #include "gdataset.h"
+#include "gdir.h"
 #include "gerror.h"
 #include "gfileutils.h"
 #include "ghash.h"
 #include "glibintl.h"
 #include "glist.h"
+#include "gmappedfile.h"
 #include "gslist.h"
 #include "gmem.h"
 #include "gmessages.h"
 #include "gstdio.h"
 #include "gstring.h"
 #include "gstrfuncs.h"
+#include "gthread.h"
 #include "gutils.h"
+#include "gvariant.h"
+
+#include "gvdb-builder.h"
+#include "gvdb-reader.h"
 
 
 /**
@@ -188,6 +195,22 @@
  *     (possibly modified) contents of the key file back to a file;
  *     otherwise only the translations for the current language will be
  *     written back.
+ * @G_KEY_FILE_LOAD_LAZILY: When loading a key file from disk, map it
+ *     into memory and only check its syntax, instead of building all
+ *     groups up front. The keys of each group, except the start group,
+ *     are then parsed from the mapped file the first time the group is
+ *     accessed. This makes loading large files of which only a few
+ *     groups are read much cheaper. The flag has no effect on
+ *     g_key_file_load_from_data(). Since: 2.34
+ * @G_KEY_FILE_USE_CACHE: When loading a key file from disk, take its
+ *     groups and keys from the cache that g_key_file_compile_cache()
+ *     wrote for the directory containing the file, instead of parsing
+ *     the file. The cache is only used if the modification and
+ *     change times (with sub-second precision where available), size
+ *     and inode of the file still match the ones recorded in it, so a
+ *     stale cache does not change the result of loading. Comments are not
+ *     cached, so this flag has no effect together with
+ *     %G_KEY_FILE_KEEP_COMMENTS. Since: 2.34
  *
  * Flags which influence the parsing.
  */
@@ -438,6 +461,9 @@ struct _GKeyFile
 
   GString *parse_buffer; /* Holds up to one line of not-yet-parsed data */
 
+  GMappedFile *mapped_file; /* Backs the data of lazily loaded groups */
+  guint n_pending_groups;
+
   gchar list_separator;
 
   GKeyFileFlags flags;
@@ -462,8 +488,20 @@ struct _GKeyFileGroup
    * increased lookup performance
    */
   GHashTable *lookup_map;
+
+  /* The not yet parsed lines of the group in key_file->mapped_file,
+   * as GKeyFilePendingLines ranges, one per occurrence of the group
+   * header; see G_KEY_FILE_LOAD_LAZILY
+   */
+  GArray *pending_lines;
 };
 
+typedef struct
+{
+  const gchar *data;
+  gsize length;
+} GKeyFilePendingLines;
+
 struct _GKeyFileKeyValuePair
 {
   gchar *key;  /* NULL for comments */
@@ -475,6 +513,7 @@ static gint                  find_file_in_data_dirs            (const gchar
 								gchar                 **output_file,
 								GError                **error);
 static gboolean              g_key_file_load_from_fd           (GKeyFile               *key_file,
+								const gchar            *file,
 								gint                    fd,
 								GKeyFileFlags           flags,
 								GError                **error);
@@ -554,6 +593,18 @@ static void                  g_key_file_parse_data             (GKeyFile
 								GError                **error);
 static void                  g_key_file_flush_parse_buffer     (GKeyFile               *key_file,
 								GError                **error);
+static gboolean              g_key_file_parse_lines            (GKeyFile               *key_file,
+								const gchar            *data,
+								gsize                   length,
+								gboolean                lazily,
+								GError                **error);
+static gboolean              g_key_file_locale_is_interesting  (GKeyFile               *key_file,
+                                                                const gchar            *locale);
+static gboolean              g_key_file_load_from_cache        (GKeyFile               *key_file,
+                                                                const gchar            *file,
+                                                                const GStatBuf         *stat_buf);
+static void                  g_key_file_load_pending_group     (GKeyFile               *key_file,
+								GKeyFileGroup          *group);
 
 
 GQuark
@@ -570,6 +621,8 @@ g_key_file_init (GKeyFile *key_file)
   key_file->group_hash = g_hash_table_new (g_str_hash, g_str_equal);
   key_file->start_group = NULL;
   key_file->parse_buffer = g_string_sized_new (128);
+  key_file->mapped_file = NULL;
+  key_file->n_pending_groups = 0;
   key_file->list_separator = ';';
   key_file->flags = 0;
   key_file->locales = g_strdupv ((gchar **)g_get_language_names ());
@@ -606,6 +659,12 @@ g_key_file_clear (GKeyFile *key_file)
       key_file->group_hash = NULL;
     }
 
+  if (key_file->mapped_file != NULL)
+    {
+      g_mapped_file_unref (key_file->mapped_file);
+      key_file->mapped_file = NULL;
+    }
+
   g_warn_if_fail (key_file->groups == NULL);
 }
 
@@ -735,8 +794,279 @@ find_file_in_data_dirs (const gchar   *file,
   return fd;
 }
 
+/* The file in which g_key_file_compile_cache() stores the parsed key
+ * files of a directory.  It is a gvdb table mapping the basename of
+ * each key file to a KEY_FILE_CACHE_ENTRY_TYPE value: the stamp of
+ * the key file when it was compiled, followed by its groups and their
+ * (key, raw value) pairs in file order.
+ */
+#define KEY_FILE_CACHE_NAME       "keyfile.cache"
+#define KEY_FILE_STAMP_TYPE       "(xuxutt)"
+#define KEY_FILE_CACHE_ENTRY_TYPE "(" KEY_FILE_STAMP_TYPE "a(sa(ss)))"
+
+/* What stat() tells about a file that is compared to decide whether
+ * it changed.  Whole seconds of mtime are not enough, since a file
+ * can be rewritten with the same size within one second, and the
+ * mtime can be set back with utime(); replacing the file changes its
+ * inode, and any of these changes its ctime.
+ */
+typedef struct
+{
+  gint64 mtime;
+  guint32 mtime_nsec;
+  gint64 ctime;
+  guint32 ctime_nsec;
+  guint64 size;
+  guint64 inode;
+} KeyFileStamp;
+
+static void
+key_file_stamp_init (KeyFileStamp   *stamp,
+                     const GStatBuf *stat_buf)
+{
+  stamp->mtime = stat_buf->st_mtime;
+  stamp->ctime = stat_buf->st_ctime;
+#if defined (HAVE_STRUCT_STAT_ST_MTIMENSEC)
+  stamp->mtime_nsec = stat_buf->st_mtimensec;
+#elif defined (HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+  stamp->mtime_nsec = stat_buf->st_mtim.tv_nsec;
+#else
+  stamp->mtime_nsec = 0;
+#endif
+#if defined (HAVE_STRUCT_STAT_ST_CTIMENSEC)
+  stamp->ctime_nsec = stat_buf->st_ctimensec;
+#elif defined (HAVE_STRUCT_STAT_ST_CTIM_TV_NSEC)
+  stamp->ctime_nsec = stat_buf->st_ctim.tv_nsec;
+#else
+  stamp->ctime_nsec = 0;
+#endif
+  stamp->size = stat_buf->st_size;
+  stamp->inode = stat_buf->st_ino;
+}
+
+static gboolean
+key_file_stamp_equal (const KeyFileStamp *a,
+                      const KeyFileStamp *b)
+{
+  return a->mtime == b->mtime &&
+         a->mtime_nsec == b->mtime_nsec &&
+         a->ctime == b->ctime &&
+         a->ctime_nsec == b->ctime_nsec &&
+         a->size == b->size &&
+         a->inode == b->inode;
+}
+
+typedef struct
+{
+  GvdbTable *table; /* NULL if the cache file could not be opened */
+  KeyFileStamp stamp;
+} KeyFileCache;
+
+/* Maps directory names to the KeyFileCache of their cache file, so
+ * that it is only mapped once per process for all the key files in
+ * the directory.
+ */
+G_LOCK_DEFINE_STATIC (key_file_caches);
+static GHashTable *key_file_caches = NULL;
+
+static void
+key_file_cache_free (gpointer data)
+{
+  KeyFileCache *cache = data;
+
+  if (cache->table != NULL)
+    gvdb_table_unref (cache->table);
+
+  g_slice_free (KeyFileCache, cache);
+}
+
+/* Returns a reference to the cache table of @directory, or %NULL if
+ * there is no (valid) one.  A cache file that was replaced since it
+ * was opened last is reopened.
+ */
+static GvdbTable *
+key_file_cache_lookup (const gchar *directory)
+{
+  KeyFileCache *cache;
+  GvdbTable *table;
+  KeyFileStamp stamp;
+  GStatBuf stat_buf;
+  gchar *filename;
+  gboolean exists;
+
+  filename = g_build_filename (directory, KEY_FILE_CACHE_NAME, NULL);
+  exists = g_stat (filename, &stat_buf) == 0;
+  if (exists)
+    key_file_stamp_init (&stamp, &stat_buf);
+
+  G_LOCK (key_file_caches);
+
+  if (key_file_caches == NULL)
+    key_file_caches = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, key_file_cache_free);
+
+  cache = g_hash_table_lookup (key_file_caches, directory);
+
+  if (cache != NULL &&
+      (!exists || !key_file_stamp_equal (&cache->stamp, &stamp)))
+    {
+      g_hash_table_remove (key_file_caches, directory);
+      cache = NULL;
+    }
+
+  if (cache == NULL && exists)
+    {
+      cache = g_slice_new (KeyFileCache);
+      cache->table = gvdb_table_new (filename, FALSE, NULL);
+      cache->stamp = stamp;
+      g_hash_table_insert (key_file_caches, g_strdup (directory), cache);
+    }
+
+  table = NULL;
+  if (cache != NULL && cache->table != NULL)
+    table = gvdb_table_ref (cache->table);
+
+  G_UNLOCK (key_file_caches);
+
+  g_free (filename);
+
+  return table;
+}
+
+/* Fills the freshly initialized @key_file with the cached contents
+ * of @file.  Returns %FALSE, leaving @key_file empty, if there is no
+ * cache entry for @file or if it does not describe the file as it
+ * is on disk now (see @stat_buf).
+ */
+static gboolean
+g_key_file_load_from_cache (GKeyFile       *key_file,
+                            const gchar    *file,
+                            const GStatBuf *stat_buf)
+{
+  GvdbTable *table;
+  GVariant *entry;
+  GVariantIter *groups, *pairs;
+  const gchar *group_name, *key, *value;
+  gchar *directory, *basename;
+  KeyFileStamp stamp, cached_stamp;
+  gboolean valid;
+
+  directory = g_path_get_dirname (file);
+  table = key_file_cache_lookup (directory);
+  g_free (directory);
+
+  if (table == NULL)
+    return FALSE;
+
+  basename = g_path_get_basename (file);
+  entry = gvdb_table_get_value (table, basename);
+  gvdb_table_unref (table);
+  g_free (basename);
+
+  if (entry == NULL)
+    return FALSE;
+
+  if (!g_variant_is_of_type (entry, G_VARIANT_TYPE (KEY_FILE_CACHE_ENTRY_TYPE)))
+    {
+      g_variant_unref (entry);
+      return FALSE;
+    }
+
+  g_variant_get (entry, KEY_FILE_CACHE_ENTRY_TYPE,
+                 &cached_stamp.mtime, &cached_stamp.mtime_nsec,
+                 &cached_stamp.ctime, &cached_stamp.ctime_nsec,
+                 &cached_stamp.size, &cached_stamp.inode, &groups);
+
+  key_file_stamp_init (&stamp, stat_buf);
+  valid = key_file_stamp_equal (&stamp, &cached_stamp);
+
+  while (valid && g_variant_iter_next (groups, "(&sa(ss))", &group_name, &pairs))
+    {
+      /* The cache file is not trusted any more than the key files */
+      valid = g_key_file_is_group_name (group_name);
+      if (valid)
+        g_key_file_add_group (key_file, group_name);
+
+      while (valid && g_variant_iter_next (pairs, "(&s&s)", &key, &value))
+        {
+          gchar *locale;
+
+          valid = g_key_file_is_key_name (key);
+          if (!valid)
+            break;
+
+          locale = key_get_locale (key);
+
+          if (locale == NULL || g_key_file_locale_is_interesting (key_file, locale))
+            g_key_file_add_key (key_file, key_file->current_group, key, value);
+
+          g_free (locale);
+        }
+
+      g_variant_iter_free (pairs);
+    }
+
+  g_variant_iter_free (groups);
+  g_variant_unref (entry);
+
+  if (!valid)
+    {
+      GKeyFileFlags flags;
+      gchar list_separator;
+
+      flags = key_file->flags;
+      list_separator = key_file->list_separator;
+      g_key_file_clear (key_file);
+      g_key_file_init (key_file);
+      key_file->list_separator = list_separator;
+      key_file->flags = flags;
+    }
+
+  return valid;
+}
+
+/* Maps the file and parses the start of it up to and including the
+ * start group; the other groups are only checked for syntax errors
+ * and remember where their lines are, see g_key_file_load_pending_group().
+ */
+static gboolean
+g_key_file_load_from_mapped_fd (GKeyFile  *key_file,
+                                gint       fd,
+                                GError   **error)
+{
+  GMappedFile *mapped_file;
+  const gchar *contents;
+  gsize length;
+  gboolean retval;
+
+  mapped_file = g_mapped_file_new_from_fd (fd, FALSE, error);
+  if (mapped_file == NULL)
+    return FALSE;
+
+  contents = g_mapped_file_get_contents (mapped_file);
+  length = g_mapped_file_get_length (mapped_file);
+
+  /* key_file->mapped_file goes away once no group is pending, which
+   * must not happen while we are still scanning the contents */
+  key_file->mapped_file = g_mapped_file_ref (mapped_file);
+
+  retval = g_key_file_parse_lines (key_file, contents, length, TRUE, error);
+
+  if (retval && key_file->n_pending_groups == 0 &&
+      key_file->mapped_file != NULL)
+    {
+      g_mapped_file_unref (key_file->mapped_file);
+      key_file->mapped_file = NULL;
+    }
+
+  g_mapped_file_unref (mapped_file);
+
+  return retval;
+}
+
 static gboolean
 g_key_file_load_from_fd (GKeyFile       *key_file,
+			 const gchar    *file,
 			 gint            fd,
 			 GKeyFileFlags   flags,
 			 GError        **error)
@@ -769,6 +1099,13 @@ g_key_file_load_from_fd (GKeyFile       *key_file,
   key_file->list_separator = list_separator;
   key_file->flags = flags;
 
+  if ((flags & G_KEY_FILE_USE_CACHE) && !(flags & G_KEY_FILE_KEEP_COMMENTS) &&
+      file != NULL && g_key_file_load_from_cache (key_file, file, &stat_buf))
+    return TRUE;
+
+  if (flags & G_KEY_FILE_LOAD_LAZILY)
+    return g_key_file_load_from_mapped_fd (key_file, fd, error);
+
   do
     {
       bytes_read = read (fd, read_buf, 4096);
@@ -847,7 +1184,7 @@ g_key_file_load_from_file (GKeyFile       *key_file,
       return FALSE;
     }
 
-  g_key_file_load_from_fd (key_file, fd, flags, &key_file_error);
+  g_key_file_load_from_fd (key_file, file, fd, flags, &key_file_error);
   close (fd);
 
   if (key_file_error)
@@ -970,7 +1307,7 @@ g_key_file_load_from_dirs (GKeyFile       *key_file,
  	  break;
         }
 
-      found_file = g_key_file_load_from_fd (key_file, fd, flags,
+      found_file = g_key_file_load_from_fd (key_file, output_path, fd, flags,
 	                                    &key_file_error);
       close (fd);
 
@@ -1047,6 +1384,134 @@ g_key_file_load_from_data_dirs (GKeyFile       *key_file,
   return found_file;
 }
 
+/* Serializes @key_file, which was loaded from a file described by
+ * @stat_buf, into a value for the directory cache.
+ */
+static GVariant *
+g_key_file_to_cache_entry (GKeyFile *key_file,
+                           GStatBuf *stat_buf)
+{
+  GVariantBuilder builder;
+  GList *group_node, *key_node;
+  KeyFileStamp stamp;
+
+  key_file_stamp_init (&stamp, stat_buf);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa(ss))"));
+
+  for (group_node = g_list_last (key_file->groups);
+       group_node != NULL;
+       group_node = group_node->prev)
+    {
+      GKeyFileGroup *group = group_node->data;
+
+      if (group->name == NULL)
+        continue;
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("(sa(ss))"));
+      g_variant_builder_add (&builder, "s", group->name);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(ss)"));
+
+      for (key_node = g_list_last (group->key_value_pairs);
+           key_node != NULL;
+           key_node = key_node->prev)
+        {
+          GKeyFileKeyValuePair *pair = key_node->data;
+
+          if (pair->key != NULL)
+            g_variant_builder_add (&builder, "(ss)", pair->key, pair->value);
+        }
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  return g_variant_new (KEY_FILE_CACHE_ENTRY_TYPE,
+                        stamp.mtime, stamp.mtime_nsec,
+                        stamp.ctime, stamp.ctime_nsec,
+                        stamp.size, stamp.inode,
+                        &builder);
+}
+
+/**
+ * g_key_file_compile_cache:
+ * @directory: (type filename): the directory containing the key files
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses all key files in @directory and stores their contents in a
+ * binary cache file in the same directory, which is used to load the
+ * key files without parsing them when %G_KEY_FILE_USE_CACHE is
+ * passed to g_key_file_load_from_file(), g_key_file_load_from_dirs()
+ * or g_key_file_load_from_data_dirs().
+ *
+ * The cache file is memory-mapped by the loading processes, so looking
+ * up a key file in it takes constant time regardless of the number of
+ * files in the directory. Files that are modified, added or removed
+ * after the cache was compiled are detected when loading and read
+ * from disk as usual, but the cache should be recompiled whenever the
+ * contents of @directory change, to keep benefiting from it. The
+ * <command>glib-compile-keyfiles</command> utility calls this function.
+ *
+ * Files in @directory that can not be parsed as key files are left
+ * out of the cache.
+ *
+ * Return value: %TRUE if the cache was written, %FALSE otherwise
+ *
+ * Since: 2.34
+ */
+gboolean
+g_key_file_compile_cache (const gchar  *directory,
+                          GError      **error)
+{
+  GHashTable *table;
+  const gchar *name;
+  gchar *filename;
+  gboolean success;
+  GDir *dir;
+
+  g_return_val_if_fail (directory != NULL, FALSE);
+
+  dir = g_dir_open (directory, 0, error);
+  if (dir == NULL)
+    return FALSE;
+
+  table = gvdb_hash_table_new (NULL, NULL);
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      GKeyFile *key_file;
+      GStatBuf stat_buf;
+
+      if (strcmp (name, KEY_FILE_CACHE_NAME) == 0)
+        continue;
+
+      filename = g_build_filename (directory, name, NULL);
+      key_file = g_key_file_new ();
+
+      /* Stat before loading, so that a file modified in between looks
+       * stale and is not used from the cache.
+       */
+      if (g_stat (filename, &stat_buf) == 0 && S_ISREG (stat_buf.st_mode) &&
+          g_key_file_load_from_file (key_file, filename,
+                                     G_KEY_FILE_KEEP_TRANSLATIONS, NULL))
+        gvdb_item_set_value (gvdb_hash_table_insert (table, name),
+                             g_key_file_to_cache_entry (key_file, &stat_buf));
+
+      g_key_file_unref (key_file);
+      g_free (filename);
+    }
+
+  g_dir_close (dir);
+
+  filename = g_build_filename (directory, KEY_FILE_CACHE_NAME, NULL);
+  success = gvdb_table_write_contents (table, filename, FALSE, error);
+  g_free (filename);
+
+  g_hash_table_unref (table);
+
+  return success;
+}
+
 /**
  * g_key_file_ref: (skip)
  * @key_file: a #GKeyFile
@@ -1430,6 +1895,208 @@ g_key_file_flush_parse_buffer (GKeyFile  *key_file,
     }
 }
 
+/* Checks the syntax of a line of a lazily loaded group in the same
+ * way g_key_file_parse_line() would, without building anything.
+ * @line is modified temporarily.
+ */
+static void
+g_key_file_check_line (GKeyFile  *key_file,
+                       gchar     *line,
+                       GError   **error)
+{
+  gchar *line_start, *key_end;
+  gchar c;
+
+  line_start = line;
+  while (g_ascii_isspace (*line_start))
+    line_start++;
+
+  if (g_key_file_line_is_comment (line_start))
+    return;
+
+  if (!g_key_file_line_is_key_value_pair (line_start))
+    {
+      gchar *line_utf8 = _g_utf8_make_valid (line);
+      g_set_error (error, G_KEY_FILE_ERROR,
+                   G_KEY_FILE_ERROR_PARSE,
+                   _("Key file contains line '%s' which is not "
+                     "a key-value pair, group, or comment"),
+                   line_utf8);
+      g_free (line_utf8);
+      return;
+    }
+
+  key_end = strchr (line_start, '=');
+  while (key_end > line_start && g_ascii_isspace (key_end[-1]))
+    key_end--;
+
+  c = *key_end;
+  *key_end = '\0';
+
+  if (!g_key_file_is_key_name (line_start))
+    g_set_error (error, G_KEY_FILE_ERROR,
+                 G_KEY_FILE_ERROR_PARSE,
+                 _("Invalid key name: %s"), line_start);
+
+  *key_end = c;
+}
+
+/* Parses @data line by line, like g_key_file_parse_data() followed by
+ * g_key_file_flush_parse_buffer() do, but without using the parse
+ * buffer so it can be called while a line is being parsed.
+ *
+ * If @lazily is %TRUE, the lines of groups first seen after the start
+ * group are not parsed but only checked, and the groups are marked as
+ * pending on the parts of @data holding them; a group whose header
+ * appears several times gets one range per occurrence. @data must
+ * then be owned by key_file->mapped_file.
+ */
+static gboolean
+g_key_file_parse_lines (GKeyFile     *key_file,
+                        const gchar  *data,
+                        gsize         length,
+                        gboolean      lazily,
+                        GError      **error)
+{
+  GKeyFileGroup *pending_group;
+  GKeyFilePendingLines pending;
+  GError *parse_error;
+  const gchar *p, *end;
+  GString *line;
+
+  parse_error = NULL;
+  pending_group = NULL;
+  line = g_string_sized_new (128);
+
+  p = data;
+  end = data + length;
+  while (p < end && parse_error == NULL)
+    {
+      const gchar *end_of_line, *next_line;
+      gchar *line_start;
+
+      end_of_line = memchr (p, '\n', end - p);
+      if (end_of_line != NULL)
+        next_line = end_of_line + 1;
+      else
+        next_line = end_of_line = end;
+
+      g_string_truncate (line, 0);
+      g_string_append_len (line, p, end_of_line - p);
+
+      if (end_of_line != end && line->len > 0 && line->str[line->len - 1] == '\r')
+        g_string_truncate (line, line->len - 1);
+
+      line_start = line->str;
+      while (g_ascii_isspace (*line_start))
+        line_start++;
+
+      if (line->len == 0)
+        {
+          if (pending_group == NULL)
+            g_key_file_parse_comment (key_file, "", 1, &parse_error);
+        }
+      else if (lazily && g_key_file_line_is_group (line_start))
+        {
+          guint n_groups;
+
+          if (pending_group != NULL)
+            {
+              pending.length = p - pending.data;
+              g_array_append_val (pending_group->pending_lines, pending);
+              pending_group = NULL;
+            }
+
+          /* Groups seen for the first time get their lines indexed
+           * instead of parsed, except for the start group which is
+           * always needed and where the encoding is checked. Further
+           * occurrences of a pending group add to its lines; those of
+           * a group that is not pending are parsed right away.
+           */
+          n_groups = g_hash_table_size (key_file->group_hash);
+          g_key_file_parse_line (key_file, line->str, line->len, &parse_error);
+
+          if (parse_error == NULL &&
+              g_hash_table_size (key_file->group_hash) > n_groups &&
+              key_file->current_group != key_file->start_group)
+            {
+              key_file->current_group->pending_lines =
+                g_array_new (FALSE, FALSE, sizeof (GKeyFilePendingLines));
+              key_file->n_pending_groups++;
+            }
+
+          if (parse_error == NULL &&
+              key_file->current_group->pending_lines != NULL)
+            {
+              pending_group = key_file->current_group;
+              pending.data = next_line;
+            }
+        }
+      else if (pending_group != NULL)
+        g_key_file_check_line (key_file, line->str, &parse_error);
+      else
+        g_key_file_parse_line (key_file, line->str, line->len, &parse_error);
+
+      p = next_line;
+    }
+
+  if (pending_group != NULL)
+    {
+      pending.length = end - pending.data;
+      g_array_append_val (pending_group->pending_lines, pending);
+    }
+
+  g_string_free (line, TRUE);
+
+  if (parse_error)
+    {
+      g_propagate_error (error, parse_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Parses the lines of a group that was loaded with
+ * G_KEY_FILE_LOAD_LAZILY, if that wasn't done yet.
+ */
+static void
+g_key_file_load_pending_group (GKeyFile      *key_file,
+                               GKeyFileGroup *group)
+{
+  GKeyFileGroup *current_group;
+  GArray *pending_lines;
+  guint i;
+
+  if (G_LIKELY (group->pending_lines == NULL))
+    return;
+
+  pending_lines = group->pending_lines;
+  group->pending_lines = NULL;
+
+  /* The lines were checked when loading, so this can't fail */
+  current_group = key_file->current_group;
+  key_file->current_group = group;
+  for (i = 0; i < pending_lines->len; i++)
+    {
+      GKeyFilePendingLines *lines;
+
+      lines = &g_array_index (pending_lines, GKeyFilePendingLines, i);
+      if (!g_key_file_parse_lines (key_file, lines->data, lines->length,
+                                   FALSE, NULL))
+        g_warn_if_reached ();
+    }
+  key_file->current_group = current_group;
+  g_array_free (pending_lines, TRUE);
+
+  key_file->n_pending_groups--;
+  if (key_file->n_pending_groups == 0)
+    {
+      g_mapped_file_unref (key_file->mapped_file);
+      key_file->mapped_file = NULL;
+    }
+}
+
 /**
  * g_key_file_to_data:
  * @key_file: a #GKeyFile
@@ -1467,6 +2134,7 @@ g_key_file_to_data (GKeyFile  *key_file,
       GKeyFileGroup *group;
 
       group = (GKeyFileGroup *) group_node->data;
+      g_key_file_load_pending_group (key_file, group);
 
       /* separate groups by at least an empty line */
       if (!has_blank_line)
@@ -3349,6 +4017,8 @@ get_group_comment (GKeyFile       *key_file,
 
   string = NULL;
 
+  g_key_file_load_pending_group (key_file, group);
+
   tmp = group->key_value_pairs;
   while (tmp)
     {
@@ -3519,7 +4189,8 @@ g_key_file_has_group (GKeyFile    *key_file,
   g_return_val_if_fail (key_file != NULL, FALSE);
   g_return_val_if_fail (group_name != NULL, FALSE);
 
-  return g_key_file_lookup_group (key_file, group_name) != NULL;
+  /* No need to load a pending group just to know it exists */
+  return g_hash_table_lookup (key_file->group_hash, group_name) != NULL;
 }
 
 /* This code remains from a historical attempt to add a new public API
@@ -3610,7 +4281,9 @@ g_key_file_add_group (GKeyFile    *key_file,
   g_return_if_fail (key_file != NULL);
   g_return_if_fail (g_key_file_is_group_name (group_name));
 
-  group = g_key_file_lookup_group (key_file, group_name);
+  /* This is called by the parser, so it must not load pending groups
+   * while the lines they point to are being scanned */
+  group = (GKeyFileGroup *)g_hash_table_lookup (key_file->group_hash, group_name);
   if (group != NULL)
     {
       key_file->current_group = group;
@@ -3717,6 +4390,13 @@ g_key_file_remove_group_node (GKeyFile *key_file,
 
   key_file->groups = g_list_remove_link (key_file->groups, group_node);
 
+  if (group->pending_lines != NULL)
+    {
+      g_array_free (group->pending_lines, TRUE);
+      group->pending_lines = NULL;
+      key_file->n_pending_groups--;
+    }
+
   tmp = group->key_value_pairs;
   while (tmp != NULL)
     {
@@ -3888,7 +4568,13 @@ static GKeyFileGroup *
 g_key_file_lookup_group (GKeyFile    *key_file,
 			 const gchar *group_name)
 {
-  return (GKeyFileGroup *)g_hash_table_lookup (key_file->group_hash, group_name);
+  GKeyFileGroup *group;
+
+  group = (GKeyFileGroup *)g_hash_table_lookup (key_file->group_hash, group_name);
+  if (group != NULL)
+    g_key_file_load_pending_group (key_file, group);
+
+  return group;
 }
 
 static GList *
@@ -51,7 +51,9 @@ typedef enum
 {
   G_KEY_FILE_NONE              = 0,
   G_KEY_FILE_KEEP_COMMENTS     = 1 << 0,
-  G_KEY_FILE_KEEP_TRANSLATIONS = 1 << 1
+  G_KEY_FILE_KEEP_TRANSLATIONS = 1 << 1,
+  G_KEY_FILE_LOAD_LAZILY       = 1 << 2,
+  G_KEY_FILE_USE_CACHE         = 1 << 3
 } GKeyFileFlags;
 
 GKeyFile *g_key_file_new                    (void);
@@ -80,6 +82,9 @@ gboolean g_key_file_load_from_data_dirs     (GKeyFile             *key_file,
 					     gchar               **full_path,
 					     GKeyFileFlags         flags,
 					     GError              **error);
+GLIB_AVAILABLE_IN_2_34
+gboolean  g_key_file_compile_cache          (const gchar          *directory,
+					     GError              **error);
 gchar    *g_key_file_to_data                (GKeyFile             *key_file,
 					     gsize                *length,
 					     GError              **error) G_GNUC_MALLOC;
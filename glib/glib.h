@@ -72,6 +72,7 @@
 #include <glib/gqueue.h>
 #include <glib/grand.h>
 #include <glib/gregex.h>
+#include <glib/grope.h>
 #include <glib/gscanner.h>
 #include <glib/gsequence.h>
 #include <glib/gshell.h>
@@ -506,6 +506,19 @@ text_validate (GMarkupParseContext  *context,
     return TRUE;
 }
 
+/* TRUE if @len bytes of text at @p are valid UTF-8 and would come out
+ * of unescape_gstring_inplace() unchanged, i.e. contain no entities and
+ * no carriage returns.
+ */
+static gboolean
+text_is_verbatim (const gchar *p,
+                  gsize        len)
+{
+  return memchr (p, '&', len) == NULL &&
+         memchr (p, '\r', len) == NULL &&
+         g_utf8_validate (p, len, NULL);
+}
+
 static gchar*
 char_str (gunichar c,
           gchar   *buf)
@@ -762,6 +775,53 @@ advance_char (GMarkupParseContext *context)
   return TRUE;
 }
 
+/* Moves context->iter forward to @target, keeping the line and
+ * character counts in sync as if advance_char() had been called for
+ * every byte in between, but looking for newlines with memchr().
+ */
+static inline void
+advance_to (GMarkupParseContext *context,
+            const gchar         *target)
+{
+  const gchar *p, *last, *nl, *last_nl;
+
+  if (target == context->iter)
+    return;
+
+  /* advance_char() never looks at the byte at current_text_end */
+  p = context->iter + 1;
+  last = target;
+  if (target == context->current_text_end)
+    last--;
+
+  last_nl = NULL;
+  while (p <= last && (nl = memchr (p, '\n', last - p + 1)) != NULL)
+    {
+      context->line_number++;
+      last_nl = nl;
+      p = nl + 1;
+    }
+
+  if (last_nl != NULL)
+    context->char_number = 1 + (target - last_nl);
+  else
+    context->char_number += target - context->iter;
+
+  context->iter = target;
+}
+
+/* Like advance_to(), but moves to the first occurrence of @c at or
+ * after context->iter, or to the end of the current text. */
+static inline void
+advance_to_char (GMarkupParseContext *context,
+                 gchar                c)
+{
+  const gchar *found;
+
+  found = memchr (context->iter, c, context->current_text_end - context->iter);
+  advance_to (context, found ? found : context->current_text_end);
+}
+
 static inline gboolean
 xml_isspace (char c)
 {
@@ -1375,12 +1435,7 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
                 delim = '"';
               }
 
-            do
-              {
-                if (*context->iter == delim)
-                  break;
-              }
-            while (advance_char (context));
+            advance_to_char (context, delim);
           }
           if (context->iter == context->current_text_end)
             {
@@ -1418,12 +1473,38 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
 
         case STATE_INSIDE_TEXT:
           /* Possible next states: AFTER_OPEN_ANGLE */
-          do
+          advance_to_char (context, '<');
+
+          /* If the whole text is in the current chunk and doesn't need
+           * any unescaping, hand it out without copying it.
+           */
+          if ((context->flags & G_MARKUP_ZERO_COPY_TEXT) &&
+              context->iter != context->current_text_end &&
+              (context->partial_chunk == NULL || context->partial_chunk->len == 0) &&
+              text_is_verbatim (context->start, context->iter - context->start))
             {
-              if (*context->iter == '<')
-                break;
+              GError *tmp_error = NULL;
+
+              if (context->parser->text)
+                (*context->parser->text) (context,
+                                          context->start,
+                                          context->iter - context->start,
+                                          context->user_data,
+                                          &tmp_error);
+
+              if (tmp_error == NULL)
+                {
+                  /* advance past open angle and set state. */
+                  advance_char (context);
+                  context->state = STATE_AFTER_OPEN_ANGLE;
+                  /* could begin a passthrough */
+                  context->start = context->iter;
+                }
+              else
+                propagate_error (context, error, tmp_error);
+
+              break;
             }
-          while (advance_char (context));
 
           /* The text hasn't necessarily ended. Merge with
            * partial chunk, leave state unchanged.
@@ -86,6 +86,13 @@ GQuark g_markup_error_quark (void);
  *     caller know the location of the error. When this flag is set the
  *     location information is also prefixed to errors generated by the
  *     #GMarkupParser implementation functions
+ * @G_MARKUP_ZERO_COPY_TEXT: When this flag is set, text that is
+ *     contained entirely in the buffer passed to
+ *     g_markup_parse_context_parse() and that needs no unescaping is
+ *     passed to the @text function as a pointer into that buffer,
+ *     instead of being copied first. Such text is not nul-terminated,
+ *     so the @text function must only use the first @text_len bytes.
+ *     Since: 2.34
  *
  * Flags that affect the behaviour of the parser.
  */
@@ -93,7 +100,8 @@ typedef enum
 {
   G_MARKUP_DO_NOT_USE_THIS_UNSUPPORTED_FLAG = 1 << 0,
   G_MARKUP_TREAT_CDATA_AS_TEXT              = 1 << 1,
-  G_MARKUP_PREFIX_ERROR_POSITION            = 1 << 2
+  G_MARKUP_PREFIX_ERROR_POSITION            = 1 << 2,
+  G_MARKUP_ZERO_COPY_TEXT                   = 1 << 3
 } GMarkupParseFlags;
 
 /**
@@ -32,7 +32,10 @@
 #include "gtypes.h"
 #include "gregex.h"
 #include "glibintl.h"
+#include "ghash.h"
 #include "glist.h"
+#include "gqueue.h"
+#include "gslice.h"
 #include "gmessages.h"
 #include "gstrfuncs.h"
 #include "gatomic.h"
@@ -93,6 +96,12 @@
  * state between creation and destruction, on the other hand #GMatchInfo
  * is not threadsafe.
  *
+ * Since #GRegex structures are immutable, compiled patterns can be
+ * shared. g_regex_new_cached() keeps a small, process-wide cache of
+ * recently compiled patterns, which is also used by the
+ * <function>g_regex_*_simple()</function> functions, so calling those
+ * repeatedly with the same pattern does not recompile it every time.
+ *
  * The regular expressions low-level functionalities are obtained through
  * the excellent <ulink url="http://www.pcre.org/">PCRE</ulink> library
  * written by Philip Hazel.
@@ -1318,6 +1327,196 @@ g_regex_new (const gchar         *pattern,
   return regex;
 }
 
+/* Compiled regex cache */
+
+#define REGEX_CACHE_SIZE   (64)
+
+typedef struct
+{
+  gchar *key;                   /* flags and pattern, see regex_cache_key() */
+  GRegex *regex;                /* a reference owned by the cache */
+  GList link;                   /* link in regex_cache_lru */
+} RegexCacheEntry;
+
+static GHashTable *regex_cache;
+static GQueue regex_cache_lru = G_QUEUE_INIT;  /* most recently used first */
+static guint regex_cache_hits;
+static guint regex_cache_misses;
+G_LOCK_DEFINE_STATIC (regex_cache);
+
+/* The options passed by the caller are mangled by g_regex_new() so they
+ * are part of the key, together with the pattern itself. */
+static gchar *
+regex_cache_key (const gchar        *pattern,
+                 GRegexCompileFlags  compile_options,
+                 GRegexMatchFlags    match_options)
+{
+  return g_strdup_printf ("%x:%x:%s", compile_options, match_options, pattern);
+}
+
+/* caller *must* hold the regex_cache lock */
+static void
+regex_cache_entry_free (RegexCacheEntry *entry)
+{
+  g_queue_unlink (&regex_cache_lru, &entry->link);
+  g_hash_table_remove (regex_cache, entry->key);
+  g_regex_unref (entry->regex);
+  g_free (entry->key);
+  g_slice_free (RegexCacheEntry, entry);
+}
+
+/**
+ * g_regex_new_cached:
+ * @pattern: the regular expression
+ * @compile_options: compile options for the regular expression, or 0
+ * @match_options: match options for the regular expression, or 0
+ * @error: return location for a #GError
+ *
+ * Like g_regex_new(), but looks up @pattern in a process-wide cache of
+ * recently compiled regular expressions first. If a #GRegex was already
+ * compiled with the same pattern and options, a new reference to it is
+ * returned; otherwise the pattern is compiled and added to the cache,
+ * evicting the least recently used entry if the cache is full.
+ *
+ * Patterns that fail to compile are not cached.
+ *
+ * This function is thread-safe. Since #GRegex structures are not
+ * modified after creation, the returned regex can be freely used from
+ * any thread.
+ *
+ * Returns: a #GRegex structure. Call g_regex_unref() when you
+ *   are done with it
+ *
+ * Since: 2.34
+ */
+GRegex *
+g_regex_new_cached (const gchar         *pattern,
+                    GRegexCompileFlags   compile_options,
+                    GRegexMatchFlags     match_options,
+                    GError             **error)
+{
+  RegexCacheEntry *entry;
+  GRegex *regex;
+  gchar *key;
+
+  g_return_val_if_fail (pattern != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+  g_return_val_if_fail ((compile_options & ~G_REGEX_COMPILE_MASK) == 0, NULL);
+  g_return_val_if_fail ((match_options & ~G_REGEX_MATCH_MASK) == 0, NULL);
+
+  key = regex_cache_key (pattern, compile_options, match_options);
+
+  G_LOCK (regex_cache);
+
+  if (regex_cache == NULL)
+    regex_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+  entry = g_hash_table_lookup (regex_cache, key);
+  if (entry != NULL)
+    {
+      regex_cache_hits++;
+
+      /* move to the front of the LRU list */
+      g_queue_unlink (&regex_cache_lru, &entry->link);
+      g_queue_push_head_link (&regex_cache_lru, &entry->link);
+
+      regex = g_regex_ref (entry->regex);
+
+      G_UNLOCK (regex_cache);
+      g_free (key);
+
+      return regex;
+    }
+
+  regex_cache_misses++;
+
+  G_UNLOCK (regex_cache);
+
+  /* Compile without holding the lock; if another thread raced us to
+   * insert the same pattern, the newer regex simply replaces it. */
+  regex = g_regex_new (pattern, compile_options, match_options, error);
+  if (regex == NULL)
+    {
+      g_free (key);
+      return NULL;
+    }
+
+  G_LOCK (regex_cache);
+
+  entry = g_hash_table_lookup (regex_cache, key);
+  if (entry != NULL)
+    regex_cache_entry_free (entry);
+
+  while (regex_cache_lru.length >= REGEX_CACHE_SIZE)
+    regex_cache_entry_free (regex_cache_lru.tail->data);
+
+  entry = g_slice_new (RegexCacheEntry);
+  entry->key = key;
+  entry->regex = g_regex_ref (regex);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  g_queue_push_head_link (&regex_cache_lru, &entry->link);
+  g_hash_table_insert (regex_cache, entry->key, entry);
+
+  G_UNLOCK (regex_cache);
+
+  return regex;
+}
+
+/**
+ * g_regex_cache_get_stats:
+ * @n_hits: (out) (allow-none): return location for the number of cache
+ *     hits, or %NULL
+ * @n_misses: (out) (allow-none): return location for the number of cache
+ *     misses, or %NULL
+ *
+ * Retrieves the number of lookups in the cache used by
+ * g_regex_new_cached() and the <function>g_regex_*_simple()</function>
+ * functions that found an already compiled pattern (@n_hits) and
+ * that had to compile the pattern (@n_misses), since the program
+ * started or since the last call to g_regex_cache_clear().
+ *
+ * Since: 2.34
+ */
+void
+g_regex_cache_get_stats (guint *n_hits,
+                         guint *n_misses)
+{
+  G_LOCK (regex_cache);
+
+  if (n_hits)
+    *n_hits = regex_cache_hits;
+  if (n_misses)
+    *n_misses = regex_cache_misses;
+
+  G_UNLOCK (regex_cache);
+}
+
+/**
+ * g_regex_cache_clear:
+ *
+ * Drops all the regular expressions held by the cache used by
+ * g_regex_new_cached(), and resets its hit and miss counters.
+ *
+ * References returned by g_regex_new_cached() before this call
+ * stay valid.
+ *
+ * Since: 2.34
+ */
+void
+g_regex_cache_clear (void)
+{
+  G_LOCK (regex_cache);
+
+  while (regex_cache_lru.head != NULL)
+    regex_cache_entry_free (regex_cache_lru.head->data);
+
+  regex_cache_hits = 0;
+  regex_cache_misses = 0;
+
+  G_UNLOCK (regex_cache);
+}
+
 /**
  * g_regex_get_pattern:
  * @regex: a #GRegex structure
@@ -1431,9 +1630,11 @@ g_regex_get_match_flags (const GRegex *regex)
  * lines of code when you need just to do a match without extracting
  * substrings, capture counts, and so on.
  *
- * If this function is to be called on the same @pattern more than
- * once, it's more efficient to compile the pattern once with
- * g_regex_new() and then use g_regex_match().
+ * The compiled pattern is kept in the cache used by g_regex_new_cached(),
+ * so calling this function repeatedly with the same @pattern does not
+ * recompile it each time. Still, in performance critical code it's more
+ * efficient to compile the pattern once with g_regex_new() and then use
+ * g_regex_match().
  *
  * Returns: %TRUE if the string matched, %FALSE otherwise
  *
@@ -1448,7 +1649,7 @@ g_regex_match_simple (const gchar        *pattern,
   GRegex *regex;
   gboolean result;
 
-  regex = g_regex_new (pattern, compile_options, 0, NULL);
+  regex = g_regex_new_cached (pattern, compile_options, 0, NULL);
   if (!regex)
     return FALSE;
   result = g_regex_match_full (regex, string, -1, 0, match_options, NULL, NULL);
@@ -1812,9 +2013,8 @@ g_regex_get_string_number (const GRegex *regex,
  * some lines of code when you need just to do a split without
  * extracting substrings, capture counts, and so on.
  *
- * If this function is to be called on the same @pattern more than
- * once, it's more efficient to compile the pattern once with
- * g_regex_new() and then use g_regex_split().
+ * Like g_regex_match_simple(), this function caches the compiled
+ * @pattern, see g_regex_new_cached().
  *
  * As a special case, the result of splitting the empty string ""
  * is an empty vector, not a vector containing a single string.
@@ -1842,7 +2042,7 @@ g_regex_split_simple (const gchar        *pattern,
   GRegex *regex;
   gchar **result;
 
-  regex = g_regex_new (pattern, compile_options, 0, NULL);
+  regex = g_regex_new_cached (pattern, compile_options, 0, NULL);
   if (!regex)
     return NULL;
 
@@ -357,6 +357,16 @@ GRegex		 *g_regex_new			(const gchar         *pattern,
 						 GError             **error);
 GRegex           *g_regex_ref			(GRegex              *regex);
 void		  g_regex_unref			(GRegex              *regex);
+GLIB_AVAILABLE_IN_2_34
+GRegex		 *g_regex_new_cached		(const gchar         *pattern,
+						 GRegexCompileFlags   compile_options,
+						 GRegexMatchFlags     match_options,
+						 GError             **error);
+GLIB_AVAILABLE_IN_2_34
+void		  g_regex_cache_get_stats	(guint               *n_hits,
+						 guint               *n_misses);
+GLIB_AVAILABLE_IN_2_34
+void		  g_regex_cache_clear		(void);
 const gchar	 *g_regex_get_pattern		(const GRegex        *regex);
 gint		  g_regex_get_max_backref	(const GRegex        *regex);
 gint		  g_regex_get_capture_count	(const GRegex        *regex);
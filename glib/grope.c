@@ -0,0 +1,744 @@
+/* GLIB - Library of useful routines for C programming
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * MT safe
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "grope.h"
+
+#include "garray.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gprintf.h"
+#include "gslice.h"
+
+
+/**
+ * SECTION:ropes
+ * @title: Ropes
+ * @short_description: text buffers for large incremental edits
+ * @see_also: #GString
+ *
+ * A #GRope is a text buffer with an interface similar to the one of
+ * #GString, for building large strings piece by piece.
+ *
+ * Where a #GString keeps its contents in one contiguous block of
+ * memory, a #GRope stores them in a list of chunks of limited size.
+ * Appending to it never copies the data that is already in the rope,
+ * and inserting into or erasing from the middle of it only moves the
+ * bytes of the chunks around the position, instead of all the bytes
+ * after it as with g_string_insert_len() or g_string_erase(). Finding
+ * the chunk that holds a position other than the end still walks the
+ * list of chunks, so edits in the middle get slower as the rope grows,
+ * by one step for every 64 kilobytes of text.
+ *
+ * The contents of a #GRope are only made contiguous when they are
+ * needed as a single string, by g_rope_flatten() or g_rope_free().
+ * Flattening copies the whole rope into a separate string once; after
+ * that, the string is returned again without copying until the rope
+ * is modified. The chunks are kept as they are, so flattening does
+ * not make later edits more expensive.
+ *
+ * Ropes are useful when assembling strings of many megabytes, like
+ * logs or documents produced from templates. For small strings, or
+ * strings that are mostly read rather than edited, #GString is more
+ * efficient.
+ */
+
+/**
+ * GRope:
+ *
+ * An opaque data structure representing a rope.
+ * It should only be accessed by using the following functions.
+ *
+ * Since: 2.34
+ */
+
+/* Chunks are filled up to this size by appends and inserts */
+#define ROPE_CHUNK_SIZE 65536
+
+#define MY_MAXSIZE ((gsize)-1)
+
+typedef struct
+{
+  gchar *data;
+  gsize len;
+  gsize alloc;
+} RopeChunk;
+
+struct _GRope
+{
+  GArray *chunks;  /* of RopeChunk, never containing empty ones */
+  gsize len;
+  gchar *flat;     /* cached result of g_rope_flatten(), or NULL */
+};
+
+static inline gsize
+nearest_power (gsize base,
+               gsize num)
+{
+  if (num > MY_MAXSIZE / 2)
+    {
+      return MY_MAXSIZE;
+    }
+  else
+    {
+      gsize n = base;
+
+      while (n < num)
+        n <<= 1;
+
+      return n;
+    }
+}
+
+#define rope_chunk(rope, i) (&g_array_index ((rope)->chunks, RopeChunk, (i)))
+
+/* Drops the flattened copy of @rope, before its contents change */
+static void
+rope_changed (GRope *rope)
+{
+  g_free (rope->flat);
+  rope->flat = NULL;
+}
+
+/* Copies the contents of @rope into a new nul-terminated string */
+static gchar *
+rope_copy_flat (GRope *rope)
+{
+  gchar *flat;
+  gsize len;
+  guint i;
+
+  flat = g_malloc (rope->len + 1);
+  len = 0;
+
+  for (i = 0; i < rope->chunks->len; i++)
+    {
+      RopeChunk *chunk = rope_chunk (rope, i);
+
+      memcpy (flat + len, chunk->data, chunk->len);
+      len += chunk->len;
+    }
+
+  flat[len] = '\0';
+
+  return flat;
+}
+
+/* Inserts an empty chunk at @index that can hold @size bytes */
+static RopeChunk *
+rope_insert_chunk (GRope *rope,
+                   guint  index,
+                   gsize  size)
+{
+  RopeChunk chunk;
+
+  chunk.alloc = size;
+  chunk.data = g_malloc (chunk.alloc);
+  chunk.len = 0;
+
+  g_array_insert_val (rope->chunks, index, chunk);
+
+  return rope_chunk (rope, index);
+}
+
+static void
+rope_remove_chunk (GRope *rope,
+                   guint  index)
+{
+  g_free (rope_chunk (rope, index)->data);
+  g_array_remove_index (rope->chunks, index);
+}
+
+/* Finds the chunk containing the byte at @pos.  A position at the
+ * boundary of two chunks is reported at the end of the first one, so
+ * that inserts there can use the free space of that chunk; @pos ==
+ * rope->len is reported at the end of the last chunk.  Returns FALSE
+ * if the rope is empty.
+ */
+static gboolean
+rope_find (GRope *rope,
+           gsize  pos,
+           guint *index,
+           gsize *offset)
+{
+  guint i;
+
+  /* Appends are the common case */
+  if (pos == rope->len && rope->chunks->len > 0)
+    {
+      *index = rope->chunks->len - 1;
+      *offset = rope_chunk (rope, *index)->len;
+      return TRUE;
+    }
+
+  for (i = 0; i < rope->chunks->len; i++)
+    {
+      RopeChunk *chunk = rope_chunk (rope, i);
+
+      if (pos <= chunk->len)
+        {
+          *index = i;
+          *offset = pos;
+          return TRUE;
+        }
+
+      pos -= chunk->len;
+    }
+
+  return FALSE;
+}
+
+/* Copies as much of @val as fits into the free space of @chunk at
+ * @offset, moving the bytes after @offset up.  Returns the number of
+ * bytes copied.
+ */
+static gsize
+rope_chunk_fill (RopeChunk   *chunk,
+                 gsize        offset,
+                 const gchar *val,
+                 gsize        len)
+{
+  gsize n;
+
+  n = MIN (len, chunk->alloc - chunk->len);
+
+  if (offset < chunk->len)
+    memmove (chunk->data + offset + n, chunk->data + offset, chunk->len - offset);
+  memcpy (chunk->data + offset, val, n);
+  chunk->len += n;
+
+  return n;
+}
+
+/**
+ * g_rope_new:
+ * @init: (allow-none): the initial text to copy into the rope, or %NULL
+ *
+ * Creates a new #GRope.
+ *
+ * Returns: the new #GRope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_new (const gchar *init)
+{
+  GRope *rope;
+
+  rope = g_slice_new (GRope);
+  rope->chunks = g_array_new (FALSE, FALSE, sizeof (RopeChunk));
+  rope->len = 0;
+  rope->flat = NULL;
+
+  if (init != NULL)
+    g_rope_append (rope, init);
+
+  return rope;
+}
+
+/**
+ * g_rope_free:
+ * @rope: a #GRope
+ * @free_segment: if %TRUE, the contents of the rope are freed as well
+ *
+ * Frees @rope. If @free_segment is %FALSE, the contents of @rope are
+ * flattened into a single string, which is returned.
+ *
+ * Returns: the contents of @rope as a newly allocated string that
+ *     should be freed with g_free(), or %NULL if @free_segment is %TRUE
+ *
+ * Since: 2.34
+ */
+gchar *
+g_rope_free (GRope    *rope,
+             gboolean  free_segment)
+{
+  gchar *segment;
+  guint i;
+
+  g_return_val_if_fail (rope != NULL, NULL);
+
+  segment = NULL;
+
+  if (!free_segment)
+    {
+      if (rope->flat != NULL)
+        {
+          segment = rope->flat;
+          rope->flat = NULL;
+        }
+      else if (rope->chunks->len == 1)
+        {
+          RopeChunk *chunk = rope_chunk (rope, 0);
+
+          /* Hand out the only chunk instead of copying it */
+          segment = g_realloc (chunk->data, chunk->len + 1);
+          segment[chunk->len] = '\0';
+          g_array_set_size (rope->chunks, 0);
+        }
+      else
+        segment = rope_copy_flat (rope);
+    }
+
+  for (i = 0; i < rope->chunks->len; i++)
+    g_free (rope_chunk (rope, i)->data);
+
+  g_free (rope->flat);
+
+  g_array_free (rope->chunks, TRUE);
+  g_slice_free (GRope, rope);
+
+  return segment;
+}
+
+/**
+ * g_rope_get_length:
+ * @rope: a #GRope
+ *
+ * Gets the number of bytes in @rope.
+ *
+ * Returns: the length of @rope
+ *
+ * Since: 2.34
+ */
+gsize
+g_rope_get_length (GRope *rope)
+{
+  g_return_val_if_fail (rope != NULL, 0);
+
+  return rope->len;
+}
+
+/**
+ * g_rope_flatten:
+ * @rope: a #GRope
+ *
+ * Makes the contents of @rope contiguous and returns them as a
+ * nul-terminated string.
+ *
+ * This copies the contents of @rope unless it has been flattened
+ * before and was not modified since. The chunks of @rope are left
+ * untouched, so the copy takes as much memory again as the rope
+ * itself. The returned string is owned by @rope and only valid until
+ * @rope is modified or freed.
+ *
+ * Returns: the contents of @rope
+ *
+ * Since: 2.34
+ */
+const gchar *
+g_rope_flatten (GRope *rope)
+{
+  g_return_val_if_fail (rope != NULL, NULL);
+
+  if (rope->flat == NULL)
+    rope->flat = rope_copy_flat (rope);
+
+  return rope->flat;
+}
+
+/**
+ * g_rope_truncate:
+ * @rope: a #GRope
+ * @len: the new size of @rope
+ *
+ * Cuts off the end of @rope, leaving the first @len bytes.
+ * If @len is not smaller than the length of @rope, nothing happens.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_truncate (GRope *rope,
+                 gsize  len)
+{
+  g_return_val_if_fail (rope != NULL, NULL);
+
+  if (len < rope->len)
+    g_rope_erase (rope, len, -1);
+
+  return rope;
+}
+
+/**
+ * g_rope_insert_len:
+ * @rope: a #GRope
+ * @pos: position in @rope where insertion should
+ *       happen, or -1 for at the end
+ * @val: bytes to insert
+ * @len: number of bytes of @val to insert, or -1 if @val is
+ *       nul-terminated
+ *
+ * Inserts @len bytes of @val into @rope at @pos.
+ *
+ * Unlike g_string_insert_len(), this only moves the bytes following
+ * @pos within one chunk of the rope, at most 64 kilobytes, rather
+ * than all of them. Inserting anywhere but at the end still looks
+ * up the chunk by walking the list of chunks, and splitting a chunk
+ * shifts the entries of that list, so the cost grows with the number
+ * of chunks in @rope, about one for every 64 kilobytes of its length.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_insert_len (GRope       *rope,
+                   gssize       pos,
+                   const gchar *val,
+                   gssize       len)
+{
+  RopeChunk *chunk;
+  guint index;
+  gsize offset;
+  gsize n;
+
+  g_return_val_if_fail (rope != NULL, NULL);
+  g_return_val_if_fail (len == 0 || val != NULL, rope);
+
+  if (len == 0)
+    return rope;
+
+  if (len < 0)
+    len = strlen (val);
+
+  if (pos < 0)
+    pos = rope->len;
+  else
+    g_return_val_if_fail (pos <= rope->len, rope);
+
+  rope_changed (rope);
+
+  if (!rope_find (rope, pos, &index, &offset))
+    {
+      index = 0;
+      offset = 0;
+      rope_insert_chunk (rope, 0, nearest_power (64, MIN (len, ROPE_CHUNK_SIZE)));
+    }
+
+  rope->len += len;
+
+  /* Grow a small chunk first, as long as it stays below the limit */
+  chunk = rope_chunk (rope, index);
+  if (chunk->alloc < ROPE_CHUNK_SIZE && chunk->len + len > chunk->alloc)
+    {
+      chunk->alloc = nearest_power (chunk->alloc, MIN (chunk->len + len, ROPE_CHUNK_SIZE));
+      chunk->data = g_realloc (chunk->data, chunk->alloc);
+    }
+
+  n = rope_chunk_fill (chunk, offset, val, len);
+  if (n == len)
+    return rope;
+
+  val += n;
+  len -= n;
+  offset += n;
+
+  /* The chunk is full; move what follows the insertion point into a
+   * chunk of its own, and put the rest of @val in between.
+   */
+  if (offset < chunk->len)
+    {
+      RopeChunk *tail;
+      gsize tail_len;
+
+      tail_len = chunk->len - offset;
+      tail = rope_insert_chunk (rope, index + 1, ROPE_CHUNK_SIZE);
+      chunk = rope_chunk (rope, index);
+      memcpy (tail->data, chunk->data + offset, tail_len);
+      tail->len = tail_len;
+      chunk->len = offset;
+
+      n = rope_chunk_fill (chunk, offset, val, len);
+      val += n;
+      len -= n;
+    }
+
+  while (len > 0)
+    {
+      /* Prefer the free space of the chunk that follows */
+      if (index + 1 < rope->chunks->len)
+        {
+          chunk = rope_chunk (rope, index + 1);
+
+          if (chunk->alloc - chunk->len >= len)
+            {
+              rope_chunk_fill (chunk, 0, val, len);
+              break;
+            }
+        }
+
+      chunk = rope_insert_chunk (rope, ++index, ROPE_CHUNK_SIZE);
+      n = rope_chunk_fill (chunk, 0, val, len);
+      val += n;
+      len -= n;
+    }
+
+  return rope;
+}
+
+/**
+ * g_rope_insert:
+ * @rope: a #GRope
+ * @pos: the position to insert the copy of the string, or -1 for
+ *       at the end
+ * @val: the string to insert
+ *
+ * Inserts a copy of a string into a #GRope at @pos.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_insert (GRope       *rope,
+               gssize       pos,
+               const gchar *val)
+{
+  return g_rope_insert_len (rope, pos, val, -1);
+}
+
+/**
+ * g_rope_append:
+ * @rope: a #GRope
+ * @val: the string to append onto the end of @rope
+ *
+ * Adds a string onto the end of a #GRope.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_append (GRope       *rope,
+               const gchar *val)
+{
+  return g_rope_insert_len (rope, -1, val, -1);
+}
+
+/**
+ * g_rope_append_len:
+ * @rope: a #GRope
+ * @val: bytes to append
+ * @len: number of bytes of @val to use, or -1 if @val is nul-terminated
+ *
+ * Appends @len bytes of @val to @rope. Because @len is provided, @val
+ * may contain embedded nuls and need not be nul-terminated.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_append_len (GRope       *rope,
+                   const gchar *val,
+                   gssize       len)
+{
+  return g_rope_insert_len (rope, -1, val, len);
+}
+
+/**
+ * g_rope_append_c:
+ * @rope: a #GRope
+ * @c: the byte to append onto the end of @rope
+ *
+ * Adds a byte onto the end of a #GRope.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_append_c (GRope *rope,
+                 gchar  c)
+{
+  return g_rope_insert_len (rope, -1, &c, 1);
+}
+
+/**
+ * g_rope_append_vprintf:
+ * @rope: a #GRope
+ * @format: the string format. See the printf() documentation
+ * @args: the list of arguments to insert in the output
+ *
+ * Appends a formatted string onto the end of a #GRope.
+ * This function is similar to g_rope_append_printf()
+ * except that the arguments to the format string are passed
+ * as a va_list.
+ *
+ * Since: 2.34
+ */
+void
+g_rope_append_vprintf (GRope       *rope,
+                       const gchar *format,
+                       va_list      args)
+{
+  gchar *buf;
+  gint len;
+
+  g_return_if_fail (rope != NULL);
+  g_return_if_fail (format != NULL);
+
+  len = g_vasprintf (&buf, format, args);
+
+  if (len >= 0)
+    {
+      g_rope_insert_len (rope, -1, buf, len);
+      g_free (buf);
+    }
+}
+
+/**
+ * g_rope_append_printf:
+ * @rope: a #GRope
+ * @format: the string format. See the printf() documentation
+ * @...: the parameters to insert into the format string
+ *
+ * Appends a formatted string onto the end of a #GRope.
+ * This function is similar to g_string_append_printf().
+ *
+ * Since: 2.34
+ */
+void
+g_rope_append_printf (GRope       *rope,
+                      const gchar *format,
+                      ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  g_rope_append_vprintf (rope, format, args);
+  va_end (args);
+}
+
+/**
+ * g_rope_prepend:
+ * @rope: a #GRope
+ * @val: the string to prepend on the start of @rope
+ *
+ * Adds a string on to the start of a #GRope.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_prepend (GRope       *rope,
+                const gchar *val)
+{
+  return g_rope_insert_len (rope, 0, val, -1);
+}
+
+/**
+ * g_rope_prepend_len:
+ * @rope: a #GRope
+ * @val: bytes to prepend
+ * @len: number of bytes in @val to prepend, or -1 if @val is
+ *       nul-terminated
+ *
+ * Prepends @len bytes of @val to @rope.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_prepend_len (GRope       *rope,
+                    const gchar *val,
+                    gssize       len)
+{
+  return g_rope_insert_len (rope, 0, val, len);
+}
+
+/**
+ * g_rope_erase:
+ * @rope: a #GRope
+ * @pos: the position of the content to remove
+ * @len: the number of bytes to remove, or -1 to remove all
+ *       following bytes
+ *
+ * Removes @len bytes from a #GRope, starting at position @pos.
+ *
+ * Unlike g_string_erase(), this only moves bytes within the chunks of
+ * the rope at the start and the end of the removed range. Finding the
+ * start of the range and removing the chunks in between takes time
+ * proportional to the number of chunks in @rope.
+ *
+ * Returns: @rope
+ *
+ * Since: 2.34
+ */
+GRope *
+g_rope_erase (GRope  *rope,
+              gssize  pos,
+              gssize  len)
+{
+  guint index;
+  gsize offset;
+
+  g_return_val_if_fail (rope != NULL, NULL);
+  g_return_val_if_fail (pos >= 0, rope);
+  g_return_val_if_fail (pos <= rope->len, rope);
+
+  if (len < 0)
+    len = rope->len - pos;
+  else
+    g_return_val_if_fail (pos + len <= rope->len, rope);
+
+  if (len == 0)
+    return rope;
+
+  rope_changed (rope);
+
+  rope_find (rope, pos, &index, &offset);
+  rope->len -= len;
+
+  while (len > 0)
+    {
+      RopeChunk *chunk = rope_chunk (rope, index);
+      gsize n;
+
+      n = MIN (len, chunk->len - offset);
+
+      if (n == chunk->len)
+        {
+          rope_remove_chunk (rope, index);
+        }
+      else
+        {
+          memmove (chunk->data + offset, chunk->data + offset + n,
+                   chunk->len - offset - n);
+          chunk->len -= n;
+          index++;
+        }
+
+      len -= n;
+      offset = 0;
+    }
+
+  return rope;
+}
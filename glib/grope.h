@@ -0,0 +1,88 @@
+/* GLIB - Library of useful routines for C programming
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#ifndef __G_ROPE_H__
+#define __G_ROPE_H__
+
+#include <stdarg.h>
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GRope GRope;
+
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_new                 (const gchar     *init);
+GLIB_AVAILABLE_IN_2_34
+gchar *      g_rope_free                (GRope           *rope,
+                                         gboolean         free_segment);
+GLIB_AVAILABLE_IN_2_34
+gsize        g_rope_get_length          (GRope           *rope);
+GLIB_AVAILABLE_IN_2_34
+const gchar *g_rope_flatten             (GRope           *rope);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_truncate            (GRope           *rope,
+                                         gsize            len);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_insert_len          (GRope           *rope,
+                                         gssize           pos,
+                                         const gchar     *val,
+                                         gssize           len);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_insert              (GRope           *rope,
+                                         gssize           pos,
+                                         const gchar     *val);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_append              (GRope           *rope,
+                                         const gchar     *val);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_append_len          (GRope           *rope,
+                                         const gchar     *val,
+                                         gssize           len);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_append_c            (GRope           *rope,
+                                         gchar            c);
+GLIB_AVAILABLE_IN_2_34
+void         g_rope_append_printf       (GRope           *rope,
+                                         const gchar     *format,
+                                         ...) G_GNUC_PRINTF (2, 3);
+GLIB_AVAILABLE_IN_2_34
+void         g_rope_append_vprintf      (GRope           *rope,
+                                         const gchar     *format,
+                                         va_list          args);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_prepend             (GRope           *rope,
+                                         const gchar     *val);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_prepend_len         (GRope           *rope,
+                                         const gchar     *val,
+                                         gssize           len);
+GLIB_AVAILABLE_IN_2_34
+GRope *      g_rope_erase               (GRope           *rope,
+                                         gssize           pos,
+                                         gssize           len);
+
+G_END_DECLS
+
+#endif /* __G_ROPE_H__ */
@@ -198,6 +198,11 @@ struct _GVariant
  *                   data is corrupted.  It merely means that we're not
  *                   sure that it's valid.  See g_variant_is_trusted().
  *
+ *    STATE_CHECKED: g_variant_is_normal_form() has already examined
+ *                   the instance.  If STATE_TRUSTED is not also set
+ *                   then the instance is known not to be in normal
+ *                   form, and there is no point in checking again.
+ *
  *    STATE_FLOATING: if this flag is set then the object has a floating
  *                    reference.  See g_variant_ref_sink().
  *
@@ -207,6 +212,7 @@ struct _GVariant
 #define STATE_SERIALISED 2
 #define STATE_TRUSTED    4
 #define STATE_FLOATING   8
+#define STATE_CHECKED    16
 
 /* -- private -- */
 /* < private >
@@ -485,56 +491,6 @@ g_variant_alloc (const GVariantType *type,
 }
 
 /* -- internal -- */
-/* < internal >
- * g_variant_new_from_bytes:
- * @type: a #GVariantType
- * @bytes: a #GBytes
- * @trusted: if the contents of @bytes are trusted
- *
- * Constructs a new serialised-mode #GVariant instance.  This is the
- * inner interface for creation of new serialised values that gets
- * called from various functions in gvariant.c.
- *
- * A reference is taken on @bytes.
- *
- * Returns: a new #GVariant with a floating reference
- */
-GVariant *
-g_variant_new_from_bytes (const GVariantType *type,
-                          GBytes             *bytes,
-                          gboolean            trusted)
-{
-  GVariant *value;
-  guint alignment;
-  gsize size;
-
-  value = g_variant_alloc (type, TRUE, trusted);
-
-  value->contents.serialised.bytes = g_bytes_ref (bytes);
-
-  g_variant_type_info_query (value->type_info,
-                             &alignment, &size);
-
-  if (size && g_bytes_get_size (bytes) != size)
-    {
-      /* Creating a fixed-sized GVariant with a bytes of the wrong
-       * size.
-       *
-       * We should do the equivalent of pulling a fixed-sized child out
-       * of a brozen container (ie: data is NULL size is equal to the correct
-       * fixed size).
-       */
-      value->contents.serialised.data = NULL;
-      value->size = size;
-    }
-  else
-    {
-      value->contents.serialised.data = g_bytes_get_data (bytes, &value->size);
-    }
-
-  return value;
-}
-
 /* < internal >
  * g_variant_new_from_children:
  * @type: a #GVariantType
@@ -604,8 +560,124 @@ g_variant_is_trusted (GVariant *value)
   return (value->state & STATE_TRUSTED) != 0;
 }
 
+/* < internal >
+ * g_variant_get_serialised_children:
+ * @value: a container #GVariant
+ * @index_: the index of the first child
+ * @children: an array of at least @n_children items
+ * @n_children: the number of children to fetch
+ *
+ * If @value is in serialised form, stores the serialised form of
+ * @n_children of its children (starting at @index_) in @children and
+ * returns %TRUE.  This is a lot cheaper than calling
+ * g_variant_get_child_value() repeatedly since no #GVariant instances
+ * are created and the framing offsets are decoded in bulk.
+ *
+ * The data of the children points into the data of @value and is
+ * valid for as long as @value is.  The type info of each child must be
+ * released with g_variant_type_info_unref().
+ *
+ * If @value is not in serialised form then %FALSE is returned and
+ * @children is not modified.
+ *
+ * Returns: %TRUE if @children was filled in
+ */
+gboolean
+g_variant_get_serialised_children (GVariant           *value,
+                                   gsize               index_,
+                                   GVariantSerialised *children,
+                                   gsize               n_children)
+{
+  if (~g_atomic_int_get (&value->state) & STATE_SERIALISED)
+    return FALSE;
+
+  {
+    GVariantSerialised serialised = {
+      value->type_info,
+      (gpointer) value->contents.serialised.data,
+      value->size
+    };
+
+    g_variant_serialised_get_children (serialised, index_,
+                                       children, n_children);
+  }
+
+  return TRUE;
+}
+
 /* -- public -- */
 
+/**
+ * g_variant_new_from_bytes:
+ * @type: a #GVariantType
+ * @bytes: a #GBytes
+ * @trusted: if the contents of @bytes are trusted
+ *
+ * Constructs a new serialised-mode #GVariant instance.
+ *
+ * This is the #GBytes equivalent of g_variant_new_from_data().  A
+ * reference is taken on @bytes and, as long as its data is suitably
+ * aligned for @type, the data is used in place without being copied.
+ * In particular, a large array of fixed-sized values (such as an array
+ * of doubles) can be handed over to #GVariant this way and then be
+ * accessed with g_variant_get_fixed_array() without any copy at all.
+ *
+ * If the data of @bytes is not aligned as required by @type then a
+ * properly aligned copy of it is used instead.
+ *
+ * Returns: (transfer none): a new #GVariant with a floating reference
+ *
+ * Since: 2.34
+ **/
+GVariant *
+g_variant_new_from_bytes (const GVariantType *type,
+                          GBytes             *bytes,
+                          gboolean            trusted)
+{
+  GVariant *value;
+  guint alignment;
+  gconstpointer data;
+  gsize size;
+
+  g_return_val_if_fail (g_variant_type_is_definite (type), NULL);
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  value = g_variant_alloc (type, TRUE, trusted);
+
+  g_variant_type_info_query (value->type_info,
+                             &alignment, &size);
+
+  data = g_bytes_get_data (bytes, NULL);
+
+  if G_UNLIKELY (((gsize) data) & alignment)
+    /* g_malloc() gives us memory suitably aligned for any type */
+    value->contents.serialised.bytes =
+      g_bytes_new (data, g_bytes_get_size (bytes));
+  else
+    value->contents.serialised.bytes = g_bytes_ref (bytes);
+
+  bytes = value->contents.serialised.bytes;
+
+  if (size && g_bytes_get_size (bytes) != size)
+    {
+      /* Creating a fixed-sized GVariant with a bytes of the wrong
+       * size.
+       *
+       * We should do the equivalent of pulling a fixed-sized child out
+       * of a brozen container (ie: data is NULL size is equal to the correct
+       * fixed size).
+       */
+      value->contents.serialised.data = NULL;
+      value->size = size;
+    }
+  else
+    {
+      value->contents.serialised.data = g_bytes_get_data (bytes, &value->size);
+    }
+
+  return value;
+}
+
 /**
  * g_variant_unref:
  * @value: a #GVariant
@@ -861,6 +933,53 @@ g_variant_get_data (GVariant *value)
   return value->contents.serialised.data;
 }
 
+/**
+ * g_variant_get_data_as_bytes:
+ * @value: a #GVariant
+ *
+ * Returns a pointer to the serialised form of a #GVariant instance,
+ * as a #GBytes.  The semantics of this function are exactly the same
+ * as g_variant_get_data(), except that the returned #GBytes holds a
+ * reference on the data, so it remains valid even after @value is
+ * freed.
+ *
+ * No copy is made: the returned #GBytes shares the memory of @value.
+ * This makes it the counterpart of g_variant_new_from_bytes().
+ *
+ * Returns: (transfer full): a new #GBytes representing the variant data
+ *
+ * Since: 2.34
+ **/
+GBytes *
+g_variant_get_data_as_bytes (GVariant *value)
+{
+  const gchar *bytes_data;
+  const gchar *data;
+  gsize bytes_size;
+  gsize size;
+
+  g_return_val_if_fail (value != NULL, NULL);
+
+  g_variant_lock (value);
+  g_variant_ensure_serialised (value);
+  g_variant_unlock (value);
+
+  bytes_data = g_bytes_get_data (value->contents.serialised.bytes,
+                                 &bytes_size);
+  data = value->contents.serialised.data;
+  size = value->size;
+
+  if (data == NULL)
+    /* a fixed-sized child of a corrupted container: all zeros */
+    return g_bytes_new_take (g_malloc0 (size), size);
+
+  if (data == bytes_data && size == bytes_size)
+    return g_bytes_ref (value->contents.serialised.bytes);
+
+  return g_bytes_new_from_bytes (value->contents.serialised.bytes,
+                                 data - bytes_data, size);
+}
+
 /**
  * g_variant_n_children:
  * @value: a container #GVariant
@@ -886,22 +1005,33 @@ g_variant_n_children (GVariant *value)
 {
   gsize n_children;
 
-  g_variant_lock (value);
-
-  if (value->state & STATE_SERIALISED)
+  /* once serialised, a value stays that way and its serialised data
+   * never changes, so there is no need to take the lock.
+   */
+  if (~g_atomic_int_get (&value->state) & STATE_SERIALISED)
     {
-      GVariantSerialised serialised = {
-        value->type_info,
-        (gpointer) value->contents.serialised.data,
-        value->size
-      };
+      g_variant_lock (value);
 
-      n_children = g_variant_serialised_n_children (serialised);
+      if (~value->state & STATE_SERIALISED)
+        {
+          n_children = value->contents.tree.n_children;
+          g_variant_unlock (value);
+
+          return n_children;
+        }
+
+      g_variant_unlock (value);
     }
-  else
-    n_children = value->contents.tree.n_children;
 
-  g_variant_unlock (value);
+  {
+    GVariantSerialised serialised = {
+      value->type_info,
+      (gpointer) value->contents.serialised.data,
+      value->size
+    };
+
+    n_children = g_variant_serialised_n_children (serialised);
+  }
 
   return n_children;
 }
@@ -1034,6 +1164,13 @@ g_variant_store (GVariant *value,
  * being trusted.  If the value was already marked as being trusted then
  * this function will immediately return %TRUE.
  *
+ * The check covers the entire value in a single pass, and its result
+ * is remembered.  Children extracted from a value that was found to be
+ * in normal form are trusted as well, so calling this function once on
+ * data received from an untrusted source avoids the validation that
+ * accessors like g_variant_get_string() would otherwise repeat for
+ * each access.
+ *
  * Returns: %TRUE if @value is in normal form
  *
  * Since: 2.24
@@ -1041,11 +1178,30 @@ g_variant_store (GVariant *value,
 gboolean
 g_variant_is_normal_form (GVariant *value)
 {
-  if (value->state & STATE_TRUSTED)
+  gboolean normal;
+  gint state;
+
+  /* Test both bits on one read of the state: another thread may finish
+   * the check in between, setting STATE_TRUSTED and STATE_CHECKED.
+   */
+  state = g_atomic_int_get (&value->state);
+
+  if (state & STATE_TRUSTED)
     return TRUE;
 
+  if (state & STATE_CHECKED)
+    return FALSE;
+
   g_variant_lock (value);
 
+  if (value->state & STATE_CHECKED)
+    {
+      normal = (value->state & STATE_TRUSTED) != 0;
+      g_variant_unlock (value);
+
+      return normal;
+    }
+
   if (value->state & STATE_SERIALISED)
     {
       GVariantSerialised serialised = {
@@ -1054,22 +1210,20 @@ g_variant_is_normal_form (GVariant *value)
         value->size
       };
 
-      if (g_variant_serialised_is_normal (serialised))
-        value->state |= STATE_TRUSTED;
+      normal = g_variant_serialised_is_normal (serialised);
     }
   else
     {
-      gboolean normal = TRUE;
       gsize i;
 
+      normal = TRUE;
       for (i = 0; i < value->contents.tree.n_children; i++)
         normal &= g_variant_is_normal_form (value->contents.tree.children[i]);
-
-      if (normal)
-        value->state |= STATE_TRUSTED;
     }
 
+  /* Set both bits at once, for readers that do not take the lock */
+  g_atomic_int_or (&value->state, STATE_CHECKED | (normal ? STATE_TRUSTED : 0));
   g_variant_unlock (value);
 
-  return (value->state & STATE_TRUSTED) != 0;
+  return normal;
 }
@@ -22,14 +22,11 @@
 #define __G_VARIANT_CORE_H__
 
 #include <glib/gvarianttypeinfo.h>
+#include <glib/gvariant-serialiser.h>
 #include <glib/gvariant.h>
 #include <glib/gbytes.h>
 
 /* gvariant-core.c */
-G_GNUC_INTERNAL
-GVariant *              g_variant_new_from_bytes                        (const GVariantType *type,
-                                                                         GBytes             *bytes,
-                                                                         gboolean            trusted);
 
 G_GNUC_INTERNAL
 GVariant *              g_variant_new_from_children                     (const GVariantType  *type,
@@ -43,4 +40,10 @@ gboolean                g_variant_is_trusted                            (GVarian
 G_GNUC_INTERNAL
 GVariantTypeInfo *      g_variant_get_type_info                         (GVariant            *value);
 
+G_GNUC_INTERNAL
+gboolean                g_variant_get_serialised_children               (GVariant            *value,
+                                                                         gsize                index_,
+                                                                         GVariantSerialised  *children,
+                                                                         gsize                n_children);
+
 #endif /* __G_VARIANT_CORE_H__ */
@@ -25,6 +25,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include "garray.h"
 #include "gerror.h"
 #include "gquark.h"
 #include "gstring.h"
@@ -135,6 +136,9 @@ typedef struct
   const gchar *end;
 
   const gchar *this;
+
+  /* position of 'start' in the complete input */
+  gint offset;
 } TokenStream;
 
 
@@ -149,10 +153,10 @@ token_stream_set_error (TokenStream  *stream,
   SourceRef ref;
   va_list ap;
 
-  ref.start = stream->this - stream->start;
+  ref.start = stream->this - stream->start + stream->offset;
 
   if (this_token)
-    ref.end = stream->stream - stream->start;
+    ref.end = stream->stream - stream->start + stream->offset;
   else
     ref.end = ref.start;
 
@@ -371,14 +375,14 @@ token_stream_start_ref (TokenStream *stream,
                         SourceRef   *ref)
 {
   token_stream_prepare (stream);
-  ref->start = stream->this - stream->start;
+  ref->start = stream->this - stream->start + stream->offset;
 }
 
 static void
 token_stream_end_ref (TokenStream *stream,
                       SourceRef   *ref)
 {
-  ref->end = stream->stream - stream->start;
+  ref->end = stream->stream - stream->start + stream->offset;
 }
 
 static void
@@ -2402,6 +2406,869 @@ g_variant_parse (const GVariantType  *type,
   return result;
 }
 
+typedef enum
+{
+  FRAME_MAYBE,
+  FRAME_ARRAY,
+  FRAME_TUPLE,
+  FRAME_DICT_ENTRY,
+  FRAME_DICTIONARY
+} FrameKind;
+
+typedef struct
+{
+  FrameKind kind;
+  const GVariantType *type;
+
+  /* for tuples, the type of the next member to be parsed */
+  const GVariantType *member;
+
+  /* TRUE for the entries of a dictionary written as {k: v, ...}, which
+   * are closed as soon as their value is complete.  for tuples, TRUE
+   * once the (mandatory) comma after the first member has been seen.
+   */
+  gboolean flag;
+
+  GVariantBuilder builder;
+  gsize n_children;
+  gint start;
+} Frame;
+
+typedef enum
+{
+  STATE_VALUE,
+  STATE_VALUE_OR_CLOSE,
+  STATE_SEPARATOR,
+  STATE_VARIANT,
+  STATE_DONE,
+  STATE_INVALID
+} ParseState;
+
+/**
+ * GVariantParseContext:
+ *
+ * An opaque structure representing an incremental parse of a single
+ * text format #GVariant.  See g_variant_parse_context_new().
+ *
+ * Since: 2.34
+ **/
+struct _GVariantParseContext
+{
+  GVariantType *type;
+  ParseState state;
+
+  /* the type of the value expected in STATE_VALUE */
+  const GVariantType *value_type;
+
+  /* a frame (with its own builder) for each open container.  if the
+   * root is not a container, the stack stays empty and the value goes
+   * straight to 'result'.
+   */
+  GArray *frames;
+  GVariant *result;
+
+  /* input that has not been fully consumed yet.  'offset' is the
+   * position of the start of the buffer in the complete input and
+   * 'position' is the point up to which the buffer has been tokenised.
+   */
+  GString *buffer;
+  gsize position;
+  gint offset;
+
+  /* the contents of a variant are not streamed: their type is only
+   * known once they have been seen entirely.  the text is kept in the
+   * buffer from 'variant_start' (the '<') until the matching '>'.
+   */
+  gsize variant_start;
+  gint variant_depth;
+};
+
+static Frame *
+parse_context_top (GVariantParseContext *context)
+{
+  g_assert (context->frames->len > 0);
+
+  return &g_array_index (context->frames, Frame, context->frames->len - 1);
+}
+
+static void
+parse_context_open (GVariantParseContext *context,
+                    TokenStream          *stream,
+                    FrameKind             kind,
+                    const GVariantType   *type,
+                    gboolean              flag)
+{
+  Frame frame = { 0, };
+
+  frame.kind = kind;
+  frame.type = type;
+  frame.flag = flag;
+  frame.start = stream->this - stream->start + stream->offset;
+  g_variant_builder_init (&frame.builder, type);
+
+  if (kind == FRAME_TUPLE)
+    frame.member = g_variant_type_first (type);
+
+  g_array_append_val (context->frames, frame);
+}
+
+static GVariant *
+parse_context_pop (GVariantParseContext *context)
+{
+  GVariant *value;
+  Frame *frame;
+
+  frame = parse_context_top (context);
+  value = g_variant_builder_end (&frame->builder);
+  g_array_set_size (context->frames, context->frames->len - 1);
+
+  /* serialise the elements of arrays and dictionaries right away.  for
+   * the small containers that large arrays are typically made of, the
+   * tree of children is many times bigger than the serialised data.
+   */
+  if (context->frames->len > 0)
+    {
+      frame = parse_context_top (context);
+
+      if (frame->kind == FRAME_ARRAY || frame->kind == FRAME_DICTIONARY)
+        g_variant_get_data (value);
+    }
+
+  return value;
+}
+
+/* adds a complete value to the current container (or, if there is no
+ * container, makes it the result).  maybes and dictionary entries
+ * written with ':' have no closing token, so they are closed here as
+ * soon as they are complete.
+ */
+static void
+parse_context_add_value (GVariantParseContext *context,
+                         GVariant             *value)
+{
+  while (context->frames->len > 0)
+    {
+      Frame *frame = parse_context_top (context);
+
+      g_variant_builder_add_value (&frame->builder, value);
+      frame->n_children++;
+
+      if (frame->kind != FRAME_MAYBE &&
+          !(frame->kind == FRAME_DICT_ENTRY && frame->flag &&
+            frame->n_children == 2))
+        {
+          context->state = STATE_SEPARATOR;
+          return;
+        }
+
+      value = parse_context_pop (context);
+    }
+
+  context->result = g_variant_ref_sink (value);
+  context->state = STATE_DONE;
+}
+
+static void
+parse_context_close (GVariantParseContext *context)
+{
+  parse_context_add_value (context, parse_context_pop (context));
+}
+
+static gboolean
+parse_context_type_error (TokenStream         *stream,
+                          gint                 start,
+                          const GVariantType  *type,
+                          GError             **error)
+{
+  SourceRef ref;
+  gchar *typestr;
+
+  ref.start = start;
+  ref.end = stream->stream - stream->start + stream->offset;
+
+  typestr = g_variant_type_dup_string (type);
+  parser_set_error (error, &ref, NULL,
+                    G_VARIANT_PARSE_ERROR_TYPE_ERROR,
+                    "can not parse as value of type `%s'",
+                    typestr);
+  g_free (typestr);
+
+  return FALSE;
+}
+
+static gboolean
+parse_context_is_type_keyword (TokenStream *stream)
+{
+  static const gchar * const keywords[] = {
+    "boolean", "byte", "int16", "uint16", "int32", "handle", "uint32",
+    "int64", "uint64", "double", "string", "objectpath", "signature"
+  };
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (keywords); i++)
+    if (token_stream_peek_string (stream, keywords[i]))
+      return TRUE;
+
+  return FALSE;
+}
+
+/* parses the leaf value consisting of the current token alone */
+static gboolean
+parse_context_leaf (GVariantParseContext  *context,
+                    TokenStream           *stream,
+                    GError               **error)
+{
+  TokenStream leaf = { 0, };
+  GVariant *value;
+  AST *ast;
+
+  leaf.start = stream->start;
+  leaf.stream = stream->this;
+  leaf.end = stream->stream;
+  leaf.offset = stream->offset;
+
+  if ((ast = parse (&leaf, NULL, error)) == NULL)
+    return FALSE;
+
+  value = ast_get_value (ast, context->value_type, error);
+  ast_free (ast);
+
+  if (value == NULL)
+    return FALSE;
+
+  parse_context_add_value (context, value);
+
+  return TRUE;
+}
+
+static gboolean
+parse_context_variant (GVariantParseContext  *context,
+                       TokenStream           *stream,
+                       GError               **error)
+{
+  TokenStream inner = { 0, };
+  GVariant *value;
+  AST *ast;
+
+  /* everything between the '<' and the current token (the '>') */
+  inner.start = stream->start;
+  inner.stream = stream->start + context->variant_start + 1;
+  inner.end = stream->this;
+  inner.offset = stream->offset;
+
+  if ((ast = parse (&inner, NULL, error)) == NULL)
+    return FALSE;
+
+  if (token_stream_prepare (&inner))
+    {
+      token_stream_set_error (&inner, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                              "expected `>' to follow variant value");
+      ast_free (ast);
+      return FALSE;
+    }
+
+  value = ast_resolve (ast, error);
+  ast_free (ast);
+
+  if (value == NULL)
+    return FALSE;
+
+  parse_context_add_value (context, g_variant_new_variant (value));
+
+  return TRUE;
+}
+
+static gboolean
+parse_context_value (GVariantParseContext  *context,
+                     TokenStream           *stream,
+                     GError               **error)
+{
+  const GVariantType *type = context->value_type;
+  gint start;
+
+  start = stream->this - stream->start + stream->offset;
+
+  /* type annotations are checked for validity but otherwise ignored,
+   * just like g_variant_parse() does when given a type.
+   */
+  if (token_stream_peek (stream, '@'))
+    {
+      gchar *token;
+
+      token = token_stream_get (stream);
+
+      if (!g_variant_type_string_is_valid (token + 1))
+        {
+          token_stream_set_error (stream, error, TRUE,
+                                  G_VARIANT_PARSE_ERROR_INVALID_TYPE_STRING,
+                                  "invalid type declaration");
+          g_free (token);
+          return FALSE;
+        }
+
+      if (!g_variant_type_is_definite (G_VARIANT_TYPE (token + 1)))
+        {
+          token_stream_set_error (stream, error, TRUE,
+                                  G_VARIANT_PARSE_ERROR_DEFINITE_TYPE_EXPECTED,
+                                  "type declarations must be definite");
+          g_free (token);
+          return FALSE;
+        }
+
+      g_free (token);
+      return TRUE;
+    }
+
+  if (parse_context_is_type_keyword (stream))
+    return TRUE;
+
+  /* a value for a maybe type is either 'nothing', 'just' followed by
+   * the value, or the value itself.
+   */
+  while (g_variant_type_is_maybe (type))
+    {
+      if (token_stream_peek_string (stream, "nothing"))
+        {
+          type = g_variant_type_element (type);
+          parse_context_add_value (context, g_variant_new_maybe (type, NULL));
+          return TRUE;
+        }
+
+      parse_context_open (context, stream, FRAME_MAYBE, type, FALSE);
+      type = context->value_type = g_variant_type_element (type);
+
+      if (token_stream_peek_string (stream, "just"))
+        return TRUE;
+    }
+
+  if (token_stream_peek (stream, '['))
+    {
+      if (!g_variant_type_is_array (type))
+        return parse_context_type_error (stream, start, type, error);
+
+      parse_context_open (context, stream, FRAME_ARRAY, type, FALSE);
+      context->value_type = g_variant_type_element (type);
+      context->state = STATE_VALUE_OR_CLOSE;
+    }
+
+  else if (token_stream_peek (stream, '('))
+    {
+      Frame *frame;
+
+      if (!g_variant_type_is_tuple (type))
+        return parse_context_type_error (stream, start, type, error);
+
+      parse_context_open (context, stream, FRAME_TUPLE, type, FALSE);
+      frame = parse_context_top (context);
+
+      if (frame->member != NULL)
+        {
+          context->value_type = frame->member;
+          frame->member = g_variant_type_next (frame->member);
+          context->state = STATE_VALUE;
+        }
+      else
+        context->state = STATE_VALUE_OR_CLOSE;
+    }
+
+  else if (token_stream_peek (stream, '{'))
+    {
+      if (g_variant_type_is_dict_entry (type))
+        {
+          parse_context_open (context, stream, FRAME_DICT_ENTRY, type, FALSE);
+          context->value_type = g_variant_type_key (type);
+          context->state = STATE_VALUE;
+        }
+      else if (g_variant_type_is_subtype_of (type, G_VARIANT_TYPE_DICTIONARY))
+        {
+          parse_context_open (context, stream, FRAME_DICTIONARY, type, FALSE);
+          context->state = STATE_VALUE_OR_CLOSE;
+        }
+      else
+        return parse_context_type_error (stream, start, type, error);
+    }
+
+  else if (token_stream_peek (stream, '<'))
+    {
+      if (!g_variant_type_equal (type, G_VARIANT_TYPE_VARIANT))
+        return parse_context_type_error (stream, start, type, error);
+
+      context->variant_start = stream->this - stream->start;
+      context->variant_depth = 1;
+      context->state = STATE_VARIANT;
+    }
+
+  else if (token_stream_peek_string (stream, "just") ||
+           token_stream_peek_string (stream, "nothing"))
+    return parse_context_type_error (stream, start, type, error);
+
+  else
+    return parse_context_leaf (context, stream, error);
+
+  return TRUE;
+}
+
+static gboolean
+parse_context_separator (GVariantParseContext  *context,
+                         TokenStream           *stream,
+                         GError               **error)
+{
+  Frame *frame = parse_context_top (context);
+
+  switch (frame->kind)
+    {
+    case FRAME_ARRAY:
+      if (token_stream_peek (stream, ','))
+        {
+          context->value_type = g_variant_type_element (frame->type);
+          context->state = STATE_VALUE;
+          return TRUE;
+        }
+
+      if (token_stream_peek (stream, ']'))
+        {
+          parse_context_close (context);
+          return TRUE;
+        }
+
+      token_stream_set_error (stream, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                              "expected `,' or `]' to follow array element");
+      return FALSE;
+
+    case FRAME_TUPLE:
+      if (!frame->flag)
+        {
+          if (!token_stream_peek (stream, ','))
+            {
+              token_stream_set_error (stream, error, FALSE,
+                                      G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                                      "expected `,' after first tuple element");
+              return FALSE;
+            }
+
+          frame->flag = TRUE;
+          context->state = STATE_VALUE_OR_CLOSE;
+          return TRUE;
+        }
+
+      if (token_stream_peek (stream, ','))
+        {
+          if (frame->member == NULL)
+            return parse_context_type_error (stream, frame->start,
+                                             frame->type, error);
+
+          context->value_type = frame->member;
+          frame->member = g_variant_type_next (frame->member);
+          context->state = STATE_VALUE;
+          return TRUE;
+        }
+
+      if (token_stream_peek (stream, ')'))
+        {
+          if (frame->member != NULL)
+            return parse_context_type_error (stream, frame->start,
+                                             frame->type, error);
+
+          parse_context_close (context);
+          return TRUE;
+        }
+
+      token_stream_set_error (stream, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                              "expected `,' or `)' to follow tuple element");
+      return FALSE;
+
+    case FRAME_DICT_ENTRY:
+      if (frame->n_children == 1)
+        {
+          if (!token_stream_peek (stream, frame->flag ? ':' : ','))
+            {
+              token_stream_set_error (stream, error, FALSE,
+                                      G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                                      "expected `%c' to follow dictionary "
+                                      "entry key", frame->flag ? ':' : ',');
+              return FALSE;
+            }
+
+          context->value_type = g_variant_type_value (frame->type);
+          context->state = STATE_VALUE;
+          return TRUE;
+        }
+
+      if (!token_stream_peek (stream, '}'))
+        {
+          token_stream_set_error (stream, error, FALSE,
+                                  G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                                  "expected `}' at end of dictionary entry");
+          return FALSE;
+        }
+
+      parse_context_close (context);
+      return TRUE;
+
+    case FRAME_DICTIONARY:
+      if (token_stream_peek (stream, ','))
+        {
+          const GVariantType *entry;
+
+          entry = g_variant_type_element (frame->type);
+          parse_context_open (context, stream, FRAME_DICT_ENTRY, entry, TRUE);
+          context->value_type = g_variant_type_key (entry);
+          context->state = STATE_VALUE;
+          return TRUE;
+        }
+
+      if (token_stream_peek (stream, '}'))
+        {
+          parse_context_close (context);
+          return TRUE;
+        }
+
+      token_stream_set_error (stream, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                              "expected `,' or `}' to follow dictionary entry");
+      return FALSE;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* right after an opening bracket, or after the first comma of a tuple:
+ * either the container is closed or a value follows.
+ */
+static gboolean
+parse_context_value_or_close (GVariantParseContext  *context,
+                              TokenStream           *stream,
+                              GError               **error)
+{
+  Frame *frame = parse_context_top (context);
+
+  switch (frame->kind)
+    {
+    case FRAME_ARRAY:
+      if (token_stream_peek (stream, ']'))
+        {
+          parse_context_close (context);
+          return TRUE;
+        }
+      break;
+
+    case FRAME_TUPLE:
+      if (token_stream_peek (stream, ')'))
+        {
+          if (frame->member != NULL)
+            return parse_context_type_error (stream, frame->start,
+                                             frame->type, error);
+
+          parse_context_close (context);
+          return TRUE;
+        }
+
+      if (frame->member == NULL)
+        return parse_context_type_error (stream, frame->start,
+                                         frame->type, error);
+
+      context->value_type = frame->member;
+      frame->member = g_variant_type_next (frame->member);
+      break;
+
+    case FRAME_DICTIONARY:
+      if (token_stream_peek (stream, '}'))
+        {
+          parse_context_close (context);
+          return TRUE;
+        }
+      else
+        {
+          const GVariantType *entry;
+
+          entry = g_variant_type_element (frame->type);
+          parse_context_open (context, stream, FRAME_DICT_ENTRY, entry, TRUE);
+          context->value_type = g_variant_type_key (entry);
+        }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  context->state = STATE_VALUE;
+
+  return parse_context_value (context, stream, error);
+}
+
+static gboolean
+parse_context_token (GVariantParseContext  *context,
+                     TokenStream           *stream,
+                     GError               **error)
+{
+  switch (context->state)
+    {
+    case STATE_VALUE:
+      return parse_context_value (context, stream, error);
+
+    case STATE_VALUE_OR_CLOSE:
+      return parse_context_value_or_close (context, stream, error);
+
+    case STATE_SEPARATOR:
+      return parse_context_separator (context, stream, error);
+
+    case STATE_VARIANT:
+      if (token_stream_peek (stream, '<'))
+        context->variant_depth++;
+
+      else if (token_stream_peek (stream, '>') && --context->variant_depth == 0)
+        return parse_context_variant (context, stream, error);
+
+      return TRUE;
+
+    case STATE_DONE:
+      token_stream_set_error (stream, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_INPUT_NOT_AT_END,
+                              "expected end of input");
+      return FALSE;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* tokenises as much of the buffer as possible and feeds the tokens to
+ * the state machine.  unless @at_end, a token that runs up to the end
+ * of the buffer may still continue in the next chunk and is left for
+ * later.
+ */
+static gboolean
+parse_context_run (GVariantParseContext  *context,
+                   gboolean               at_end,
+                   GError               **error)
+{
+  TokenStream stream = { 0, };
+  gsize keep;
+
+  stream.start = context->buffer->str;
+  stream.stream = context->buffer->str + context->position;
+  stream.end = context->buffer->str + context->buffer->len;
+  stream.offset = context->offset;
+
+  while (token_stream_prepare (&stream))
+    {
+      if (!at_end && stream.stream == stream.end)
+        {
+          stream.stream = stream.this;
+          break;
+        }
+
+      if (!parse_context_token (context, &stream, error))
+        {
+          context->state = STATE_INVALID;
+          return FALSE;
+        }
+
+      token_stream_next (&stream);
+    }
+
+  if (stream.stream != stream.end && *stream.stream == '\0')
+    {
+      token_stream_set_error (&stream, error, FALSE,
+                              G_VARIANT_PARSE_ERROR_INVALID_CHARACTER,
+                              "invalid character");
+      context->state = STATE_INVALID;
+      return FALSE;
+    }
+
+  context->position = stream.stream - stream.start;
+
+  /* drop the text that is not needed anymore */
+  if (context->state == STATE_VARIANT)
+    keep = context->variant_start;
+  else
+    keep = context->position;
+
+  if (keep > 0)
+    {
+      g_string_erase (context->buffer, 0, keep);
+      context->offset += keep;
+      context->position -= keep;
+
+      if (context->state == STATE_VARIANT)
+        context->variant_start -= keep;
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_variant_parse_context_new:
+ * @type: a definite #GVariantType
+ *
+ * Creates a new #GVariantParseContext for incrementally parsing a
+ * single value of type @type from its text representation (in the same
+ * format that is accepted by g_variant_parse()).
+ *
+ * The text is given to the context in chunks of arbitrary size with
+ * g_variant_parse_context_parse() and the value is retrieved with
+ * g_variant_parse_context_end_parse().
+ *
+ * Unlike g_variant_parse(), the context never needs the entire text in
+ * memory and it does not build a syntax tree for it: since the type is
+ * known in advance, each element is converted as soon as it has been
+ * read and added to the value under construction.  Only the contents
+ * of variants (whose type is not known until they have been read
+ * completely) are buffered and parsed as a whole.
+ *
+ * Returns: a new #GVariantParseContext
+ *
+ * Since: 2.34
+ **/
+GVariantParseContext *
+g_variant_parse_context_new (const GVariantType *type)
+{
+  GVariantParseContext *context;
+
+  g_return_val_if_fail (type != NULL, NULL);
+  g_return_val_if_fail (g_variant_type_is_definite (type), NULL);
+
+  context = g_slice_new0 (GVariantParseContext);
+  context->type = g_variant_type_copy (type);
+  context->value_type = context->type;
+  context->state = STATE_VALUE;
+  context->frames = g_array_new (FALSE, FALSE, sizeof (Frame));
+  context->buffer = g_string_new (NULL);
+
+  return context;
+}
+
+/**
+ * g_variant_parse_context_parse:
+ * @context: a #GVariantParseContext
+ * @text: a chunk of text to parse
+ * @text_len: the length of @text in bytes, or -1 if it is nul-terminated
+ * @error: (allow-none): a pointer to a %NULL #GError pointer, or %NULL
+ *
+ * Feeds some text to @context.
+ *
+ * The chunks may be split at any position, including the middle of a
+ * token or of a multi-byte character.
+ *
+ * If an error is detected, %FALSE is returned and @error is set.  The
+ * positions in the error message refer to the complete input, not to
+ * @text.  After an error, the context can only be freed.
+ *
+ * Returns: %FALSE if an error occurred, %TRUE on success
+ *
+ * Since: 2.34
+ **/
+gboolean
+g_variant_parse_context_parse (GVariantParseContext  *context,
+                               const gchar           *text,
+                               gssize                 text_len,
+                               GError               **error)
+{
+  g_return_val_if_fail (context != NULL, FALSE);
+  g_return_val_if_fail (text != NULL || text_len == 0, FALSE);
+  g_return_val_if_fail (context->state != STATE_INVALID, FALSE);
+
+  if (text_len < 0)
+    text_len = strlen (text);
+
+  g_string_append_len (context->buffer, text, text_len);
+
+  return parse_context_run (context, FALSE, error);
+}
+
+/**
+ * g_variant_parse_context_end_parse:
+ * @context: a #GVariantParseContext
+ * @error: (allow-none): a pointer to a %NULL #GError pointer, or %NULL
+ *
+ * Signals to @context that all of the text has been given to it, and
+ * returns the parsed value.
+ *
+ * In case of any error (including the text ending before the value is
+ * complete), %NULL is returned and @error is set.
+ *
+ * This function may only be called once; after it, the context can
+ * only be freed.
+ *
+ * Returns: (transfer full): a reference to a #GVariant, or %NULL
+ *
+ * Since: 2.34
+ **/
+GVariant *
+g_variant_parse_context_end_parse (GVariantParseContext  *context,
+                                   GError               **error)
+{
+  GVariant *result;
+
+  g_return_val_if_fail (context != NULL, NULL);
+  g_return_val_if_fail (context->state != STATE_INVALID, NULL);
+
+  if (!parse_context_run (context, TRUE, error))
+    return NULL;
+
+  if (context->state != STATE_DONE)
+    {
+      SourceRef ref;
+
+      ref.start = ref.end = context->offset + context->buffer->len;
+
+      if (context->state == STATE_VALUE)
+        parser_set_error (error, &ref, NULL,
+                          G_VARIANT_PARSE_ERROR_VALUE_EXPECTED,
+                          "expected value");
+      else
+        parser_set_error (error, &ref, NULL,
+                          G_VARIANT_PARSE_ERROR_UNEXPECTED_TOKEN,
+                          "unexpected end of input");
+
+      context->state = STATE_INVALID;
+
+      return NULL;
+    }
+
+  result = context->result;
+  context->result = NULL;
+  context->state = STATE_INVALID;
+
+  return result;
+}
+
+/**
+ * g_variant_parse_context_free:
+ * @context: a #GVariantParseContext
+ *
+ * Frees @context, along with any partially parsed value.
+ *
+ * Since: 2.34
+ **/
+void
+g_variant_parse_context_free (GVariantParseContext *context)
+{
+  guint i;
+
+  g_return_if_fail (context != NULL);
+
+  for (i = 0; i < context->frames->len; i++)
+    {
+      Frame *frame = &g_array_index (context->frames, Frame, i);
+
+      g_variant_builder_clear (&frame->builder);
+    }
+
+  g_array_free (context->frames, TRUE);
+  g_string_free (context->buffer, TRUE);
+
+  if (context->result)
+    g_variant_unref (context->result);
+
+  g_variant_type_free (context->type);
+  g_slice_free (GVariantParseContext, context);
+}
+
 /**
  * g_variant_new_parsed_va:
  * @format: a text format #GVariant
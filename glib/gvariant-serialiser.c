@@ -495,6 +495,28 @@ gvs_fixed_sized_array_is_normal (GVariantSerialised value)
   if (value.size % child.size != 0)
     return FALSE;
 
+  /* every bit pattern is a valid number and booleans only need to be
+   * 0 or 1, so arrays of those are checked without looking at the
+   * elements one by one.
+   */
+  switch (g_variant_type_info_get_type_char (child.type_info))
+    {
+    case 'b':
+      {
+        guchar bits = 0;
+        gsize i;
+
+        for (i = 0; i < value.size; i++)
+          bits |= value.data[i];
+
+        return bits < 2;
+      }
+
+    case 'y': case 'n': case 'q': case 'i': case 'u':
+    case 'x': case 't': case 'h': case 'd':
+      return TRUE;
+    }
+
   for (child.data = value.data;
        child.data < value.data + value.size;
        child.data += child.size)
@@ -562,12 +584,95 @@ gvs_read_unaligned_le (guchar *bytes,
     gsize integer;
   } tmpvalue;
 
+  /* Offsets are only ever 1, 2, 4 or 8 bytes.  Give the compiler a
+   * constant size for those so that it can emit a single load.
+   */
+  switch (size)
+    {
+    case 1:
+      return bytes[0];
+
+    case 2:
+      {
+        guint16 value;
+
+        memcpy (&value, bytes, sizeof value);
+        return GUINT16_FROM_LE (value);
+      }
+
+    case 4:
+      {
+        guint32 value;
+
+        memcpy (&value, bytes, sizeof value);
+        return GUINT32_FROM_LE (value);
+      }
+
+#if GLIB_SIZEOF_SIZE_T == 8
+    case 8:
+      {
+        guint64 value;
+
+        memcpy (&value, bytes, sizeof value);
+        return GUINT64_FROM_LE (value);
+      }
+#endif
+    }
+
   tmpvalue.integer = 0;
   memcpy (&tmpvalue.bytes, bytes, size);
 
   return GSIZE_FROM_LE (tmpvalue.integer);
 }
 
+/* Decodes @n consecutive offsets starting at @table into the .size
+ * fields of @out.  Having a separate loop for each offset size keeps
+ * the per-element work down to a load and (on big endian machines) a
+ * byteswap.
+ */
+static void
+gvs_read_offsets_le (guchar             *table,
+                     guint               offset_size,
+                     GVariantSerialised *out,
+                     gsize               n)
+{
+  gsize i;
+
+  switch (offset_size)
+    {
+    case 1:
+      for (i = 0; i < n; i++)
+        out[i].size = table[i];
+      break;
+
+    case 2:
+      for (i = 0; i < n; i++)
+        {
+          guint16 value;
+
+          memcpy (&value, table + 2 * i, sizeof value);
+          out[i].size = GUINT16_FROM_LE (value);
+        }
+      break;
+
+    case 4:
+      for (i = 0; i < n; i++)
+        {
+          guint32 value;
+
+          memcpy (&value, table + 4 * i, sizeof value);
+          out[i].size = GUINT32_FROM_LE (value);
+        }
+      break;
+
+    default:
+      for (i = 0; i < n; i++)
+        out[i].size = gvs_read_unaligned_le (table + offset_size * i,
+                                             offset_size);
+      break;
+    }
+}
+
 static inline void
 gvs_write_unaligned_le (guchar *bytes,
                         gsize   value,
@@ -688,6 +793,67 @@ gvs_variable_sized_array_get_child (GVariantSerialised value,
   return child;
 }
 
+static void
+gvs_variable_sized_array_get_children (GVariantSerialised  value,
+                                       gsize               index_,
+                                       GVariantSerialised *children,
+                                       gsize               n_children)
+{
+  GVariantTypeInfo *element;
+  guchar *offsets_array;
+  gsize offset_size;
+  guint alignment;
+  gsize last_end;
+  gsize start;
+  gsize i;
+
+  element = g_variant_type_info_element (value.type_info);
+  g_variant_type_info_query (element, &alignment, NULL);
+
+  offset_size = gvs_get_offset_size (value.size);
+  last_end = gvs_read_unaligned_le (value.data + value.size -
+                                    offset_size, offset_size);
+  offsets_array = value.data + last_end;
+
+  if (index_ > 0)
+    start = gvs_read_unaligned_le (offsets_array +
+                                   offset_size * (index_ - 1),
+                                   offset_size);
+  else
+    start = 0;
+
+  /* first pass: decode the end offsets of all requested children in
+   * one go, temporarily storing them in the .size fields.
+   */
+  gvs_read_offsets_le (offsets_array + offset_size * index_,
+                       offset_size, children, n_children);
+
+  /* second pass: turn (start, end) pairs into children, with the same
+   * rules as gvs_variable_sized_array_get_child()
+   */
+  for (i = 0; i < n_children; i++)
+    {
+      gsize end = children[i].size;
+
+      start += (-start) & alignment;
+
+      children[i].type_info = g_variant_type_info_ref (element);
+
+      if (start < end && end <= value.size)
+        {
+          children[i].data = value.data + start;
+          children[i].size = end - start;
+        }
+      else
+        {
+          children[i].data = NULL;
+          children[i].size = 0;
+        }
+
+      start = end;
+    }
+}
+
 static gsize
 gvs_variable_sized_array_needed_size (GVariantTypeInfo         *type_info,
                                       GVariantSerialisedFiller  gvs_filler,
@@ -1367,6 +1533,68 @@ g_variant_serialised_get_child (GVariantSerialised serialised,
            index_, g_variant_serialised_n_children (serialised));
 }
 
+/* < private >
+ * g_variant_serialised_get_children:
+ * @serialised: a #GVariantSerialised
+ * @index_: the index of the first child to fetch
+ * @children: an array of at least @n_children items
+ * @n_children: the number of children to fetch
+ *
+ * Extracts @n_children consecutive children from serialised data
+ * representing a container value, starting at @index_.  The result is
+ * the same as calling g_variant_serialised_get_child() for each index
+ * in turn (and each child holds a reference on its type info in the
+ * same way) but the framing offsets of variable-sized arrays are
+ * decoded in bulk, which is considerably faster for large arrays.
+ *
+ * It is an error to call this function with a range that is not
+ * entirely within the bounds of the container.
+ */
+void
+g_variant_serialised_get_children (GVariantSerialised  serialised,
+                                   gsize               index_,
+                                   GVariantSerialised *children,
+                                   gsize               n_children)
+{
+  gsize n;
+  gsize i;
+
+  g_variant_serialised_check (serialised);
+
+  n = g_variant_serialised_n_children (serialised);
+
+  if G_UNLIKELY (index_ > n || n_children > n - index_)
+    g_error ("Attempt to access items %"G_GSIZE_FORMAT" to %"G_GSIZE_FORMAT
+             " in a container with only %"G_GSIZE_FORMAT" items",
+             index_, index_ + n_children, n);
+
+  if (n_children == 0)
+    return;
+
+  if (g_variant_type_info_get_type_char (serialised.type_info) ==
+      G_VARIANT_TYPE_INFO_CHAR_ARRAY)
+    {
+      gsize fixed_size;
+
+      g_variant_type_info_query_element (serialised.type_info,
+                                         NULL, &fixed_size);
+
+      if (!fixed_size)
+        {
+          gvs_variable_sized_array_get_children (serialised, index_,
+                                                 children, n_children);
+
+          for (i = 0; i < n_children; i++)
+            g_variant_serialised_check (children[i]);
+
+          return;
+        }
+    }
+
+  for (i = 0; i < n_children; i++)
+    children[i] = g_variant_serialised_get_child (serialised, index_ + i);
+}
+
 /* < private >
  * g_variant_serialiser_serialise:
  * @serialised: a #GVariantSerialised, properly set up
@@ -1438,6 +1666,51 @@ g_variant_serialiser_needed_size (GVariantTypeInfo         *type_info,
 
 /* Byteswapping {{{2 */
 
+/* Byteswaps @n consecutive numbers of @size bytes each, in place.
+ * @data must be suitably aligned.  The loops are trivial enough for the
+ * compiler to vectorise.
+ */
+static void
+gvs_byteswap_numbers (guchar *data,
+                      gsize   n,
+                      gsize   size)
+{
+  gsize i;
+
+  switch (size)
+    {
+    case 2:
+      {
+        guint16 *ptr = (guint16 *) data;
+
+        for (i = 0; i < n; i++)
+          ptr[i] = GUINT16_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    case 4:
+      {
+        guint32 *ptr = (guint32 *) data;
+
+        for (i = 0; i < n; i++)
+          ptr[i] = GUINT32_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    case 8:
+      {
+        guint64 *ptr = (guint64 *) data;
+
+        for (i = 0; i < n; i++)
+          ptr[i] = GUINT64_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 /* < private >
  * g_variant_serialised_byteswap:
  * @value: a #GVariantSerialised
@@ -1511,6 +1784,30 @@ g_variant_serialised_byteswap (GVariantSerialised serialised)
     {
       gsize children, i;
 
+      /* arrays of numbers are common (and can be large): swap them in
+       * one go instead of visiting each element separately.
+       */
+      if (g_variant_type_info_get_type_char (serialised.type_info) ==
+          G_VARIANT_TYPE_INFO_CHAR_ARRAY)
+        {
+          guint element_alignment;
+          gsize element_size;
+
+          g_variant_type_info_query_element (serialised.type_info,
+                                             &element_alignment,
+                                             &element_size);
+
+          if (element_size && element_alignment + 1 == element_size)
+            {
+              /* same rule as gvs_fixed_sized_array_n_children() */
+              if (serialised.size % element_size == 0)
+                gvs_byteswap_numbers (serialised.data,
+                                      serialised.size / element_size,
+                                      element_size);
+              return;
+            }
+        }
+
       children = g_variant_serialised_n_children (serialised);
       for (i = 0; i < children; i++)
         {
@@ -1593,11 +1890,33 @@ gboolean
 g_variant_serialiser_is_string (gconstpointer data,
                                 gsize         size)
 {
+  const gsize ones = (gsize) -1 / 0xff;
+  const gchar *string = data;
   const gchar *end;
+  gsize i = 0;
+
+  if (size == 0 || string[size - 1] != '\0')
+    return FALSE;
+
+  /* skip over plain ASCII a word at a time: subtracting one from each
+   * byte only sets a high bit if the byte was zero or already had the
+   * high bit set.  the rest is left to g_utf8_validate().
+   */
+  while (size - 1 - i >= sizeof (gsize))
+    {
+      gsize word;
+
+      memcpy (&word, string + i, sizeof word);
+
+      if (((word - ones) | word) & (ones << 7))
+        break;
+
+      i += sizeof word;
+    }
 
-  g_utf8_validate (data, size, &end);
+  g_utf8_validate (string + i, size - i, &end);
 
-  return data == end - (size - 1);
+  return end == string + size - 1;
 }
 
 /* < private >
@@ -36,6 +36,10 @@ typedef struct
 gsize                           g_variant_serialised_n_children         (GVariantSerialised        container);
 GVariantSerialised              g_variant_serialised_get_child          (GVariantSerialised        container,
                                                                          gsize                     index);
+void                            g_variant_serialised_get_children       (GVariantSerialised        container,
+                                                                         gsize                     index,
+                                                                         GVariantSerialised       *children,
+                                                                         gsize                     n_children);
 
 /* serialisation */
 typedef void                  (*GVariantSerialisedFiller)               (GVariantSerialised       *serialised,
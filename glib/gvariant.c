@@ -1181,6 +1181,87 @@ g_variant_get_fixed_array (GVariant *value,
   return NULL;
 }
 
+/**
+ * g_variant_copy_fixed_array:
+ * @value: a #GVariant array with fixed-sized elements
+ * @first: the index of the first element to copy
+ * @elements: (out caller-allocates) (array length=n_elements): the
+ *            location to copy the elements to
+ * @n_elements: the maximum number of elements to copy
+ * @element_size: the size of each element
+ * @byteswap: %TRUE to byteswap the elements while copying
+ *
+ * Copies up to @n_elements elements of @value, starting with the
+ * element at index @first, into @elements.
+ *
+ * This is the copying counterpart of g_variant_get_fixed_array() and
+ * the same rules apply to @value and @element_size.  @elements must be
+ * suitably aligned for the element type, which any C array of the
+ * corresponding type will be.
+ *
+ * If @byteswap is %TRUE then all multi-byte numeric data in the copied
+ * elements is byteswapped, exactly as g_variant_byteswap() would do.
+ * This allows data that was stored in non-native byte order to be read
+ * in manageable chunks, without creating a byteswapped copy of all of
+ * @value first.
+ *
+ * Returns: the number of elements copied, which is less than
+ *          @n_elements only if the end of the array is reached
+ *
+ * Since: 2.34
+ **/
+gsize
+g_variant_copy_fixed_array (GVariant *value,
+                            gsize     first,
+                            gpointer  elements,
+                            gsize     n_elements,
+                            gsize     element_size,
+                            gboolean  byteswap)
+{
+  GVariantTypeInfo *array_info;
+  gsize array_element_size;
+  const guchar *data;
+  gsize n_available;
+  gsize size;
+
+  TYPE_CHECK (value, G_VARIANT_TYPE_ARRAY, 0);
+
+  g_return_val_if_fail (elements != NULL || n_elements == 0, 0);
+  g_return_val_if_fail (element_size > 0, 0);
+
+  array_info = g_variant_get_type_info (value);
+  g_variant_type_info_query_element (array_info, NULL, &array_element_size);
+
+  g_return_val_if_fail (array_element_size == element_size, 0);
+
+  data = g_variant_get_data (value);
+  size = g_variant_get_size (value);
+
+  if (size % element_size)
+    n_available = 0;
+  else
+    n_available = size / element_size;
+
+  if (first >= n_available)
+    return 0;
+
+  n_elements = MIN (n_elements, n_available - first);
+  memcpy (elements, data + first * element_size, n_elements * element_size);
+
+  if (byteswap)
+    {
+      GVariantSerialised serialised;
+
+      serialised.type_info = array_info;
+      serialised.data = elements;
+      serialised.size = n_elements * element_size;
+
+      g_variant_serialised_byteswap (serialised);
+    }
+
+  return n_elements;
+}
+
 /**
  * g_variant_new_fixed_array:
  * @element_type: the #GVariantType of each element
@@ -1401,30 +1482,24 @@ g_variant_get_string (GVariant *value,
   data = g_variant_get_data (value);
   size = g_variant_get_size (value);
 
-  if (!g_variant_is_trusted (value))
+  /* for untrusted values, this checks the string once and remembers
+   * the result.
+   */
+  if (!g_variant_is_normal_form (value))
     {
       switch (g_variant_classify (value))
         {
         case G_VARIANT_CLASS_STRING:
-          if (g_variant_serialiser_is_string (data, size))
-            break;
-
           data = "";
           size = 1;
           break;
 
         case G_VARIANT_CLASS_OBJECT_PATH:
-          if (g_variant_serialiser_is_object_path (data, size))
-            break;
-
           data = "/";
           size = 2;
           break;
 
         case G_VARIANT_CLASS_SIGNATURE:
-          if (g_variant_serialiser_is_signature (data, size))
-            break;
-
           data = "";
           size = 1;
           break;
@@ -1463,6 +1538,84 @@ g_variant_dup_string (GVariant *value,
   return g_strdup (g_variant_get_string (value, length));
 }
 
+/* Fills @strv with the @n items of @value, which is an array of
+ * strings or object paths.
+ *
+ * If @value is in serialised form then the framing offsets are decoded
+ * in blocks and the strings are taken directly from the serialised
+ * data, without creating a #GVariant for each of them.  Otherwise,
+ * fall back to fetching one child at a time.
+ */
+static void
+g_variant_fill_strv (GVariant     *value,
+                     const gchar **strv,
+                     gsize         n,
+                     gboolean      dup)
+{
+  GVariantSerialised children[64];
+  gboolean object_paths;
+  gboolean trusted;
+  gsize i = 0;
+
+  object_paths = g_variant_is_of_type (value, G_VARIANT_TYPE_OBJECT_PATH_ARRAY);
+
+  /* validate the whole array in one go; that result is remembered, so
+   * the next call takes the trusted path.  only if some element is
+   * broken do the elements need to be checked one at a time.
+   */
+  trusted = g_variant_is_normal_form (value);
+
+  while (i < n)
+    {
+      gsize n_children;
+      gsize j;
+
+      n_children = MIN (n - i, G_N_ELEMENTS (children));
+
+      if (!g_variant_get_serialised_children (value, i, children, n_children))
+        break;
+
+      for (j = 0; j < n_children; j++)
+        {
+          const gchar *string = (const gchar *) children[j].data;
+
+          /* same rules as g_variant_get_string() */
+          if (!trusted)
+            {
+              if (object_paths)
+                {
+                  if (!g_variant_serialiser_is_object_path (string, children[j].size))
+                    string = "/";
+                }
+              else
+                {
+                  if (!g_variant_serialiser_is_string (string, children[j].size))
+                    string = "";
+                }
+            }
+
+          g_variant_type_info_unref (children[j].type_info);
+          strv[i + j] = dup ? g_strdup (string) : string;
+        }
+
+      i += n_children;
+    }
+
+  for (; i < n; i++)
+    {
+      GVariant *string;
+
+      string = g_variant_get_child_value (value, i);
+      if (dup)
+        strv[i] = g_variant_dup_string (string, NULL);
+      else
+        strv[i] = g_variant_get_string (string, NULL);
+      g_variant_unref (string);
+    }
+
+  strv[n] = NULL;
+}
+
 /**
  * g_variant_new_strv:
  * @strv: (array length=length) (element-type utf8): an array of strings
@@ -1523,23 +1676,13 @@ g_variant_get_strv (GVariant *value,
 {
   const gchar **strv;
   gsize n;
-  gsize i;
 
   TYPE_CHECK (value, G_VARIANT_TYPE_STRING_ARRAY, NULL);
 
   g_variant_get_data (value);
   n = g_variant_n_children (value);
   strv = g_new (const gchar *, n + 1);
-
-  for (i = 0; i < n; i++)
-    {
-      GVariant *string;
-
-      string = g_variant_get_child_value (value, i);
-      strv[i] = g_variant_get_string (string, NULL);
-      g_variant_unref (string);
-    }
-  strv[i] = NULL;
+  g_variant_fill_strv (value, strv, n, FALSE);
 
   if (length)
     *length = n;
@@ -1573,22 +1716,12 @@ g_variant_dup_strv (GVariant *value,
 {
   gchar **strv;
   gsize n;
-  gsize i;
 
   TYPE_CHECK (value, G_VARIANT_TYPE_STRING_ARRAY, NULL);
 
   n = g_variant_n_children (value);
   strv = g_new (gchar *, n + 1);
-
-  for (i = 0; i < n; i++)
-    {
-      GVariant *string;
-
-      string = g_variant_get_child_value (value, i);
-      strv[i] = g_variant_dup_string (string, NULL);
-      g_variant_unref (string);
-    }
-  strv[i] = NULL;
+  g_variant_fill_strv (value, (const gchar **) strv, n, TRUE);
 
   if (length)
     *length = n;
@@ -1659,23 +1792,13 @@ g_variant_get_objv (GVariant *value,
 {
   const gchar **strv;
   gsize n;
-  gsize i;
 
   TYPE_CHECK (value, G_VARIANT_TYPE_OBJECT_PATH_ARRAY, NULL);
 
   g_variant_get_data (value);
   n = g_variant_n_children (value);
   strv = g_new (const gchar *, n + 1);
-
-  for (i = 0; i < n; i++)
-    {
-      GVariant *string;
-
-      string = g_variant_get_child_value (value, i);
-      strv[i] = g_variant_get_string (string, NULL);
-      g_variant_unref (string);
-    }
-  strv[i] = NULL;
+  g_variant_fill_strv (value, strv, n, FALSE);
 
   if (length)
     *length = n;
@@ -1709,22 +1832,12 @@ g_variant_dup_objv (GVariant *value,
 {
   gchar **strv;
   gsize n;
-  gsize i;
 
   TYPE_CHECK (value, G_VARIANT_TYPE_OBJECT_PATH_ARRAY, NULL);
 
   n = g_variant_n_children (value);
   strv = g_new (gchar *, n + 1);
-
-  for (i = 0; i < n; i++)
-    {
-      GVariant *string;
-
-      string = g_variant_get_child_value (value, i);
-      strv[i] = g_variant_dup_string (string, NULL);
-      g_variant_unref (string);
-    }
-  strv[i] = NULL;
+  g_variant_fill_strv (value, (const gchar **) strv, n, TRUE);
 
   if (length)
     *length = n;
@@ -29,6 +29,7 @@
 
 #include <glib/gvarianttype.h>
 #include <glib/gstring.h>
+#include <glib/gbytes.h>
 
 G_BEGIN_DECLS
 
@@ -154,9 +155,18 @@ GVariant *                      g_variant_lookup_value                  (GVarian
 gconstpointer                   g_variant_get_fixed_array               (GVariant             *value,
                                                                          gsize                *n_elements,
                                                                          gsize                 element_size);
+GLIB_AVAILABLE_IN_2_34
+gsize                           g_variant_copy_fixed_array              (GVariant             *value,
+                                                                         gsize                 first,
+                                                                         gpointer              elements,
+                                                                         gsize                 n_elements,
+                                                                         gsize                 element_size,
+                                                                         gboolean              byteswap);
 
 gsize                           g_variant_get_size                      (GVariant             *value);
 gconstpointer                   g_variant_get_data                      (GVariant             *value);
+GLIB_AVAILABLE_IN_2_34
+GBytes *                        g_variant_get_data_as_bytes             (GVariant             *value);
 void                            g_variant_store                         (GVariant             *value,
                                                                          gpointer              data);
 
@@ -179,6 +189,10 @@ GVariant *                      g_variant_new_from_data                 (const G
                                                                          gboolean              trusted,
                                                                          GDestroyNotify        notify,
                                                                          gpointer              user_data);
+GLIB_AVAILABLE_IN_2_34
+GVariant *                      g_variant_new_from_bytes                (const GVariantType   *type,
+                                                                         GBytes               *bytes,
+                                                                         gboolean              trusted);
 
 typedef struct _GVariantIter GVariantIter;
 struct _GVariantIter {
@@ -270,6 +284,22 @@ GVariant *                      g_variant_parse                         (const G
                                                                          const gchar          *limit,
                                                                          const gchar         **endptr,
                                                                          GError              **error);
+
+typedef struct _GVariantParseContext GVariantParseContext;
+
+GLIB_AVAILABLE_IN_2_34
+GVariantParseContext *          g_variant_parse_context_new             (const GVariantType   *type);
+GLIB_AVAILABLE_IN_2_34
+gboolean                        g_variant_parse_context_parse           (GVariantParseContext *context,
+                                                                         const gchar          *text,
+                                                                         gssize                text_len,
+                                                                         GError              **error);
+GLIB_AVAILABLE_IN_2_34
+GVariant *                      g_variant_parse_context_end_parse       (GVariantParseContext *context,
+                                                                         GError              **error);
+GLIB_AVAILABLE_IN_2_34
+void                            g_variant_parse_context_free            (GVariantParseContext *context);
+
 GVariant *                      g_variant_new_parsed                    (const gchar          *format,
                                                                          ...);
 GVariant *                      g_variant_new_parsed_va                 (const gchar          *format,
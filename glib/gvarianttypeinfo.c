@@ -28,6 +28,9 @@
 #include <glib/gthread.h>
 #include <glib/gslice.h>
 #include <glib/ghash.h>
+#include <glib/gatomic.h>
+
+#include <string.h>
 
 /* < private >
  * GVariantTypeInfo:
@@ -49,6 +52,10 @@
  * container GVariantTypeInfo structures will exist for "(asv)" and
  * for "as" (note that "s" and "v" always exist in the static array).
  *
+ * Lookups of container types that are already known mostly go through
+ * a small lock-free cache (see below) instead of the hash table, which
+ * is protected by a lock.
+ *
  * The trickiest part of GVariantTypeInfo (and in fact, the major reason
  * for its existence) is the storage of somewhat magical constants that
  * allow for O(1) lookups of items in tuples.  This is described below.
@@ -712,6 +719,44 @@ g_variant_type_info_member_info (GVariantTypeInfo *info,
 static GRecMutex g_variant_type_info_lock;
 static GHashTable *g_variant_type_info_table;
 
+/* The cache is a small direct-mapped table of container infos that
+ * can be read without taking g_variant_type_info_lock.
+ *
+ * A slot is filled (under the lock) the first time that a type hashing
+ * to it is looked up, and is never emptied or replaced.  The cache
+ * holds a reference on each info in it, so those infos are never freed
+ * and a lock-free reader can always safely add a reference to
+ * whatever it finds in a slot.  This pins at most
+ * G_VARIANT_TYPE_INFO_CACHE_SIZE container infos (plus the infos for
+ * their component types) for the lifetime of the process.
+ */
+#define G_VARIANT_TYPE_INFO_CACHE_SIZE 128
+static ContainerInfo *g_variant_type_info_cache[G_VARIANT_TYPE_INFO_CACHE_SIZE];
+
+static guint
+g_variant_type_info_hash_string (const gchar *type_string,
+                                 gsize        length)
+{
+  guint32 h = 5381;
+  gsize i;
+
+  for (i = 0; i < length; i++)
+    h = (h << 5) + h + type_string[i];
+
+  return h;
+}
+
+static ContainerInfo **
+g_variant_type_info_cache_slot (const gchar *type_string,
+                                gsize        length)
+{
+  guint hash;
+
+  hash = g_variant_type_info_hash_string (type_string, length);
+
+  return &g_variant_type_info_cache[hash % G_VARIANT_TYPE_INFO_CACHE_SIZE];
+}
+
 /* < private >
  * g_variant_type_info_get:
  * @type: a #GVariantType
@@ -737,8 +782,27 @@ g_variant_type_info_get (const GVariantType *type)
       type_char == G_VARIANT_TYPE_INFO_CHAR_TUPLE ||
       type_char == G_VARIANT_TYPE_INFO_CHAR_DICT_ENTRY)
     {
+      ContainerInfo **slot;
+      ContainerInfo *cached;
       GVariantTypeInfo *info;
+      const gchar *type_peek;
       gchar *type_string;
+      gsize length;
+
+      type_peek = g_variant_type_peek_string (type);
+      length = g_variant_type_get_string_length (type);
+      slot = g_variant_type_info_cache_slot (type_peek, length);
+
+      /* fast path: no lock, no allocation */
+      cached = g_atomic_pointer_get (slot);
+      if (cached != NULL &&
+          strncmp (cached->type_string, type_peek, length) == 0 &&
+          cached->type_string[length] == '\0')
+        {
+          g_atomic_int_inc (&cached->ref_count);
+
+          return (GVariantTypeInfo *) cached;
+        }
 
       type_string = g_variant_type_dup_string (type);
 
@@ -773,6 +837,15 @@ g_variant_type_info_get (const GVariantType *type)
       else
         g_variant_type_info_ref (info);
 
+      /* claim the cache slot if it is still free.  The reference taken
+       * here belongs to the cache and is never dropped.
+       */
+      if (g_atomic_pointer_get (slot) == NULL)
+        {
+          g_variant_type_info_ref (info);
+          g_atomic_pointer_set (slot, info);
+        }
+
       g_rec_mutex_unlock (&g_variant_type_info_lock);
       g_variant_type_info_check (info, 0);
       g_free (type_string);
@@ -833,6 +906,25 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
   if (info->container_class)
     {
       ContainerInfo *container = (ContainerInfo *) info;
+      gint ref_count;
+
+      /* Dropping anything but the last reference needs no lock.  Only
+       * the last reference needs to be dropped under the lock, so that
+       * g_variant_type_info_get() cannot find the info in the hash
+       * table while it is being freed.
+       */
+      do
+        {
+          ref_count = g_atomic_int_get (&container->ref_count);
+
+          if (ref_count == 1)
+            break;
+        }
+      while (!g_atomic_int_compare_and_exchange (&container->ref_count,
+                                                 ref_count, ref_count - 1));
+
+      if (ref_count != 1)
+        return;
 
       g_rec_mutex_lock (&g_variant_type_info_lock);
       if (g_atomic_int_dec_and_test (&container->ref_count))
@@ -862,8 +954,75 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
     }
 }
 
+static void
+g_variant_type_info_count_ref (GHashTable       *expected,
+                               GVariantTypeInfo *info)
+{
+  if (info->container_class)
+    g_hash_table_insert (expected, info,
+                         GINT_TO_POINTER (GPOINTER_TO_INT (g_hash_table_lookup (expected, info)) + 1));
+}
+
+/* < private >
+ * g_variant_type_info_assert_no_infos:
+ *
+ * Asserts that no container type infos are in use, apart from the ones
+ * that are pinned by the cache (and the ones that those refer to).
+ * This is used by the testsuite to check for leaks.
+ */
 void
 g_variant_type_info_assert_no_infos (void)
 {
-  g_assert (g_variant_type_info_table == NULL);
+  GHashTableIter iter;
+  GHashTable *expected;
+  gpointer value;
+  gint i;
+
+  g_rec_mutex_lock (&g_variant_type_info_lock);
+
+  if (g_variant_type_info_table == NULL)
+    {
+      g_rec_mutex_unlock (&g_variant_type_info_lock);
+      return;
+    }
+
+  /* work out how many references each remaining info should have:
+   * one if it is in the cache, plus one for each remaining info that
+   * has it as an element or member type
+   */
+  expected = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < G_VARIANT_TYPE_INFO_CACHE_SIZE; i++)
+    if (g_variant_type_info_cache[i])
+      g_variant_type_info_count_ref (expected, (GVariantTypeInfo *) g_variant_type_info_cache[i]);
+
+  g_hash_table_iter_init (&iter, g_variant_type_info_table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      GVariantTypeInfo *info = value;
+
+      if (info->container_class == GV_ARRAY_INFO_CLASS)
+        g_variant_type_info_count_ref (expected, GV_ARRAY_INFO (info)->element);
+      else
+        {
+          TupleInfo *tuple_info = GV_TUPLE_INFO (info);
+          gsize j;
+
+          for (j = 0; j < tuple_info->n_members; j++)
+            g_variant_type_info_count_ref (expected, tuple_info->members[j].type_info);
+        }
+    }
+
+  g_hash_table_iter_init (&iter, g_variant_type_info_table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ContainerInfo *container = value;
+
+      g_assert_cmpint (container->ref_count, ==,
+                       GPOINTER_TO_INT (g_hash_table_lookup (expected, container)));
+    }
+
+  g_hash_table_unref (expected);
+
+  g_rec_mutex_unlock (&g_variant_type_info_lock);
 }
@@ -1039,6 +1039,73 @@ test_gvarianttypeinfo (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+#define TYPEINFO_THREADS         8
+#define TYPEINFO_TYPES           400
+
+static GVariantType *typeinfo_types[TYPEINFO_TYPES];
+
+static gpointer
+typeinfo_thread (gpointer data)
+{
+  GRand *rand;
+  gint i;
+
+  rand = g_rand_new_with_seed (GPOINTER_TO_UINT (data));
+
+  for (i = 0; i < 20000; i++)
+    {
+      GVariantTypeInfo *info;
+      GVariantType *type;
+
+      type = typeinfo_types[g_rand_int_range (rand, 0, TYPEINFO_TYPES)];
+      info = g_variant_type_info_get (type);
+      g_assert (strncmp (g_variant_type_info_get_type_string (info),
+                         g_variant_type_peek_string (type),
+                         g_variant_type_get_string_length (type)) == 0);
+      g_variant_type_info_ref (info);
+      g_variant_type_info_unref (info);
+      g_variant_type_info_unref (info);
+    }
+
+  g_rand_free (rand);
+
+  return NULL;
+}
+
+/* Look up (and drop) type infos from many threads at once.  There are
+ * more types than fit into the lock-free cache, so both the cached and
+ * the locked paths get exercised, as does dropping the last reference
+ * while other threads look the same type up again.
+ */
+static void
+test_gvarianttypeinfo_threaded (void)
+{
+  GThread *threads[TYPEINFO_THREADS];
+  gint i;
+
+  for (i = 0; i < TYPEINFO_TYPES; i++)
+    {
+      GString *type_string, *description;
+
+      type_string = g_string_new (NULL);
+      description = g_string_new (NULL);
+      typeinfo_types[i] = append_type_string (type_string, description, TRUE, 4);
+      g_string_free (type_string, TRUE);
+      g_string_free (description, TRUE);
+    }
+
+  for (i = 0; i < TYPEINFO_THREADS; i++)
+    threads[i] = g_thread_new ("typeinfo", typeinfo_thread, GINT_TO_POINTER (i));
+
+  for (i = 0; i < TYPEINFO_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  for (i = 0; i < TYPEINFO_TYPES; i++)
+    g_variant_type_free (typeinfo_types[i]);
+
+  g_variant_type_info_assert_no_infos ();
+}
+
 #define MAX_FIXED_MULTIPLIER    256
 #define MAX_INSTANCE_SIZE       1024
 #define MAX_ARRAY_CHILDREN      128
@@ -1821,6 +1888,11 @@ test_strings (void)
     { is_nval,     13, "hello world\0" },
     { is_nval,     13, "hello\0world!" },
     { is_nval,     12, "hello world!" },
+    { is_string,   27, "abcdefghijklmnopqrstuvwxyz" },
+    { is_nval,     27, "abcdefghijklm\0opqrstuvwxyz" },
+    { is_nval,     27, "abcdefghijklmnopqrstuvwxy\xff" },
+    { is_string,   29, "abcdefghijklmnopqr\xc5\x82stuvwxyz" },
+    { is_nval,     29, "abcdefghijklmnopqr\xc5stuvwxyz!" },
 
     { is_objpath,   2, "/" },
     { is_objpath,   3, "/a" },
@@ -2119,6 +2191,42 @@ tree_filler (GVariantSerialised *serialised,
     }
 }
 
+/* check that fetching all children at once (and a range in the middle)
+ * gives exactly the same result as fetching them one at a time, even
+ * for corrupted data
+ */
+static void
+check_get_children (GVariantSerialised serialised)
+{
+  GVariantSerialised *children;
+  gsize n_children;
+  gsize start;
+  gsize i;
+
+  n_children = g_variant_serialised_n_children (serialised);
+  children = g_new (GVariantSerialised, n_children + 1);
+
+  for (start = 0; start < MIN (n_children, 3); start++)
+    {
+      g_variant_serialised_get_children (serialised, start, children,
+                                         n_children - start);
+
+      for (i = start; i < n_children; i++)
+        {
+          GVariantSerialised child;
+
+          child = g_variant_serialised_get_child (serialised, i);
+          g_assert (child.type_info == children[i - start].type_info);
+          g_assert (child.data == children[i - start].data);
+          g_assert_cmpuint (child.size, ==, children[i - start].size);
+          g_variant_type_info_unref (child.type_info);
+          g_variant_type_info_unref (children[i - start].type_info);
+        }
+    }
+
+  g_free (children);
+}
+
 static gboolean
 check_tree (TreeInstance       *instance,
             GVariantSerialised  serialised)
@@ -2131,6 +2239,8 @@ check_tree (TreeInstance       *instance,
     {
       gint i;
 
+      check_get_children (serialised);
+
       if (g_variant_serialised_n_children (serialised) !=
           instance->n_children)
         return FALSE;
@@ -3896,6 +4006,154 @@ test_parse_positional (void)
     }
 }
 
+static GVariant *
+parse_in_chunks (const GVariantType  *type,
+                 const gchar         *text,
+                 gsize                chunk_size,
+                 GError             **error)
+{
+  GVariantParseContext *context;
+  GVariant *value = NULL;
+  gsize length;
+  gsize i;
+
+  context = g_variant_parse_context_new (type);
+  length = strlen (text);
+
+  for (i = 0; i < length; i += chunk_size)
+    if (!g_variant_parse_context_parse (context, text + i,
+                                        MIN (chunk_size, length - i), error))
+      goto out;
+
+  value = g_variant_parse_context_end_parse (context, error);
+
+ out:
+  g_variant_parse_context_free (context);
+
+  return value;
+}
+
+static void
+test_parse_context (void)
+{
+  const gchar *tests[] = {
+    "a{sv}",    "{'a': <1>, 'b': <<'x>'>>, 'c': <@as []>}",
+    "a{is}",    "[{1, 'one'}, {2, 'two'}]",
+    "a{is}",    "{}",
+    "{is}",     "{1, 'one'}",
+    "mmi",      "just nothing",
+    "mmi",      "nothing",
+    "mmi",      "5",
+    "mai",      "[1, int32 2, @i 3]",
+    "(i)",      "(1,)",
+    "(ibs)",    "(1, true, 'x')",
+    "()",       "()",
+    "aay",      "[b'', b\"x\\ty\", [1, 2]]",
+    "d",        "-inf",
+    "v",        "<[<1>, <(3, 'x')>]>",
+    "s",        "  'surrounding space'  ",
+    "(sv)",     "('a', <{'b': <1>}>)"
+  };
+  const gchar *failures[] = {
+    "ai",       "[1, 2,",       "6:",           "expected value",
+    "ai",       "[1, 2",        "5:",           "unexpected end",
+    "ai",       "[1 2]",        "3:",           "expected `,' or `]'",
+    "ai",       "",             "0:",           "expected value",
+    "(ii)",     "(1)",          "2:",           "expected `,' after first",
+    "(ii)",     "(1,)",         "0-4:",         "can not parse as",
+    "(i)",      "(1, 2)",       "0-5:",         "can not parse as",
+    "a{si}",    "{'a', 1}",     "4:",           "expected `:'",
+    "i",        "1 2",          "2:",           "expected end of input",
+    "i",        "true",         "0-4:",         "can not parse as",
+    "y",        "256",          "0-3:",         "out of range",
+    "s",        "'abc",         "0-4:",         "unterminated string",
+    "v",        "<1 2>",        "3:",           "expected `>'"
+  };
+  gint i;
+
+  for (i = 0; i < 100; i++)
+    {
+      TreeInstance *tree;
+      GVariant *parsed;
+      GVariant *value;
+      gchar *pt, *p;
+      gchar *res;
+      gsize chunk;
+
+      tree = tree_instance_new (NULL, 3);
+      value = tree_instance_get_gvariant (tree);
+      tree_instance_free (tree);
+
+      pt = g_variant_print (value, TRUE);
+      p = g_variant_print (value, FALSE);
+      chunk = g_test_rand_int_range (1, 20);
+
+      parsed = parse_in_chunks (g_variant_get_type (value), pt, chunk, NULL);
+      res = g_variant_print (parsed, FALSE);
+      g_assert_cmpstr (p, ==, res);
+      g_variant_unref (parsed);
+      g_free (res);
+
+      parsed = parse_in_chunks (g_variant_get_type (value), p, chunk, NULL);
+      res = g_variant_print (parsed, TRUE);
+      g_assert_cmpstr (pt, ==, res);
+      g_variant_unref (parsed);
+      g_free (res);
+
+      g_variant_unref (value);
+      g_free (pt);
+      g_free (p);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i += 2)
+    {
+      const GVariantType *type = G_VARIANT_TYPE (tests[i]);
+      GVariant *expected;
+      GVariant *value;
+      gsize chunk;
+
+      expected = g_variant_parse (type, tests[i + 1], NULL, NULL, NULL);
+      g_assert (expected != NULL);
+
+      for (chunk = 1; chunk < 8; chunk++)
+        {
+          value = parse_in_chunks (type, tests[i + 1], chunk, NULL);
+          g_assert (value != NULL);
+          g_assert (g_variant_equal (value, expected));
+          g_variant_unref (value);
+        }
+
+      g_variant_unref (expected);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (failures); i += 4)
+    {
+      const GVariantType *type = G_VARIANT_TYPE (failures[i]);
+      gsize chunk;
+
+      for (chunk = 1; chunk < 8; chunk++)
+        {
+          GError *error = NULL;
+          GVariant *value;
+
+          value = parse_in_chunks (type, failures[i + 1], chunk, &error);
+          g_assert (value == NULL);
+
+          if (!strstr (error->message, failures[i + 3]))
+            g_error ("test %d: Can't find `%s' in `%s'", i / 4,
+                     failures[i + 3], error->message);
+
+          if (!g_str_has_prefix (error->message, failures[i + 2]))
+            g_error ("test %d: Expected location `%s' in `%s'", i / 4,
+                     failures[i + 2], error->message);
+
+          g_error_free (error);
+        }
+    }
+
+  g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_floating (void)
 {
@@ -4111,6 +4369,286 @@ test_fixed_array (void)
   g_variant_unref (a);
 }
 
+static void
+test_copy_fixed_array (void)
+{
+  gdouble doubles[1000];
+  gdouble copied[64];
+  GVariant *a, *swapped;
+  const gdouble *elts;
+  gsize n_elts;
+  gsize first;
+  gsize n;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (doubles); i++)
+    doubles[i] = i * 1.5;
+
+  a = g_variant_new_fixed_array (G_VARIANT_TYPE_DOUBLE, doubles,
+                                 G_N_ELEMENTS (doubles), sizeof (gdouble));
+  g_variant_ref_sink (a);
+  swapped = g_variant_byteswap (a);
+  elts = g_variant_get_fixed_array (swapped, &n_elts, sizeof (gdouble));
+  g_assert_cmpuint (n_elts, ==, G_N_ELEMENTS (doubles));
+
+  /* copy out in chunks, with and without swapping */
+  for (first = 0; first < G_N_ELEMENTS (doubles); first += n)
+    {
+      n = g_variant_copy_fixed_array (a, first, copied, G_N_ELEMENTS (copied),
+                                      sizeof (gdouble), FALSE);
+      g_assert_cmpuint (n, ==, MIN (64, G_N_ELEMENTS (doubles) - first));
+      g_assert (memcmp (copied, doubles + first, n * sizeof (gdouble)) == 0);
+
+      n = g_variant_copy_fixed_array (swapped, first, copied,
+                                      G_N_ELEMENTS (copied),
+                                      sizeof (gdouble), TRUE);
+      g_assert_cmpuint (n, ==, MIN (64, G_N_ELEMENTS (doubles) - first));
+      g_assert (memcmp (copied, doubles + first, n * sizeof (gdouble)) == 0);
+
+      n = g_variant_copy_fixed_array (a, first, copied,
+                                      G_N_ELEMENTS (copied),
+                                      sizeof (gdouble), TRUE);
+      g_assert (memcmp (copied, elts + first, n * sizeof (gdouble)) == 0);
+    }
+
+  g_assert_cmpuint (g_variant_copy_fixed_array (a, 1000, copied, 64,
+                                                sizeof (gdouble), FALSE), ==, 0);
+  g_assert_cmpuint (g_variant_copy_fixed_array (a, 5000, copied, 64,
+                                                sizeof (gdouble), FALSE), ==, 0);
+
+  g_variant_unref (swapped);
+  g_variant_unref (a);
+
+  /* elements with padding are swapped member by member */
+  {
+    struct { guint16 a; guint32 b; } pairs[3], out[3];
+    GVariant *b;
+
+    a = g_variant_ref_sink (g_variant_new_parsed ("[(@q 1, @u 2), (3, 4), (5, 6)]"));
+    b = g_variant_byteswap (a);
+    memset (out, 0, sizeof out);
+    n = g_variant_copy_fixed_array (b, 0, out, 3, sizeof out[0], TRUE);
+    g_assert_cmpuint (n, ==, 3);
+    n = g_variant_copy_fixed_array (a, 0, pairs, 3, sizeof pairs[0], FALSE);
+    g_assert_cmpuint (n, ==, 3);
+
+    for (i = 0; i < 3; i++)
+      {
+        g_assert_cmpuint (out[i].a, ==, 2 * i + 1);
+        g_assert_cmpuint (out[i].b, ==, 2 * i + 2);
+        g_assert_cmpuint (pairs[i].a, ==, 2 * i + 1);
+        g_assert_cmpuint (pairs[i].b, ==, 2 * i + 2);
+      }
+
+    g_variant_unref (b);
+    g_variant_unref (a);
+  }
+}
+
+static void
+test_gbytes (void)
+{
+  GVariant *a, *child;
+  GBytes *bytes, *bytes2, *sub;
+  const gdouble *elts;
+  gdouble *doubles;
+  gchar *misaligned;
+  gsize n_elts;
+  gint i;
+
+  doubles = g_new (gdouble, 100);
+  for (i = 0; i < 100; i++)
+    doubles[i] = i;
+  bytes = g_bytes_new_take (doubles, 100 * sizeof (gdouble));
+
+  /* suitably aligned data is used in place... */
+  a = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("ad"),
+                                                    bytes, TRUE));
+  elts = g_variant_get_fixed_array (a, &n_elts, sizeof (gdouble));
+  g_assert (elts == (gpointer) doubles);
+  g_assert_cmpuint (n_elts, ==, 100);
+
+  /* ...and handed back out without a copy */
+  bytes2 = g_variant_get_data_as_bytes (a);
+  g_assert (bytes2 == bytes);
+  g_bytes_unref (bytes2);
+
+  /* the data of a child is a slice of the same memory */
+  child = g_variant_get_child_value (a, 10);
+  bytes2 = g_variant_get_data_as_bytes (child);
+  g_assert_cmpuint (g_bytes_get_size (bytes2), ==, sizeof (gdouble));
+  g_assert (g_bytes_get_data (bytes2, NULL) == (gpointer) (doubles + 10));
+  g_bytes_unref (bytes2);
+  g_variant_unref (child);
+  g_variant_unref (a);
+
+  /* misaligned data gets copied */
+  misaligned = g_malloc (100 * sizeof (gdouble) + 1);
+  memcpy (misaligned + 1, doubles, 100 * sizeof (gdouble));
+  sub = g_bytes_new_take (misaligned, 100 * sizeof (gdouble) + 1);
+  bytes2 = g_bytes_new_from_bytes (sub, 1, 100 * sizeof (gdouble));
+  g_bytes_unref (sub);
+
+  a = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("ad"),
+                                                    bytes2, FALSE));
+  elts = g_variant_get_fixed_array (a, &n_elts, sizeof (gdouble));
+  g_assert (elts != (gpointer) (misaligned + 1));
+  g_assert_cmpuint (((gsize) elts) % sizeof (gdouble), ==, 0);
+  g_assert_cmpuint (n_elts, ==, 100);
+  for (i = 0; i < 100; i++)
+    g_assert_cmpfloat (elts[i], ==, i);
+  g_variant_unref (a);
+  g_bytes_unref (bytes2);
+
+  /* tree-form values get serialised first */
+  a = g_variant_ref_sink (g_variant_new_parsed ("('hello', 42)"));
+  bytes2 = g_variant_get_data_as_bytes (a);
+  g_assert_cmpuint (g_bytes_get_size (bytes2), ==, g_variant_get_size (a));
+  g_assert (memcmp (g_bytes_get_data (bytes2, NULL), g_variant_get_data (a),
+                    g_variant_get_size (a)) == 0);
+  g_bytes_unref (bytes2);
+  g_variant_unref (a);
+
+  g_bytes_unref (bytes);
+}
+
+/* check the strings in an array of strings or object paths read from
+ * untrusted data, with the item at index 100 corrupted
+ */
+static void
+check_strv_corrupted (const GVariantType *type,
+                      const gchar        *format,
+                      gsize               item_size,
+                      gsize               corrupt_offset,
+                      const gchar        *replacement)
+{
+  gboolean is_strv;
+  GVariantBuilder builder;
+  GVariant *trusted;
+  GVariant *value;
+  const gchar **strv;
+  gchar **dup;
+  gchar *data;
+  gsize length;
+  gsize i;
+
+  is_strv = g_variant_type_equal (type, G_VARIANT_TYPE_STRING_ARRAY);
+
+  g_variant_builder_init (&builder, type);
+  for (i = 0; i < 200; i++)
+    {
+      gchar *str = g_strdup_printf (format, (gint) i);
+      g_assert_cmpuint (strlen (str) + 1, ==, item_size);
+      if (is_strv)
+        g_variant_builder_add (&builder, "s", str);
+      else
+        g_variant_builder_add (&builder, "o", str);
+      g_free (str);
+    }
+  trusted = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  data = g_memdup (g_variant_get_data (trusted), g_variant_get_size (trusted));
+  data[item_size * 100 + corrupt_offset] = 'x';
+  value = g_variant_new_from_data (type, data, g_variant_get_size (trusted),
+                                   FALSE, g_free, data);
+
+  if (is_strv)
+    strv = g_variant_get_strv (value, &length);
+  else
+    strv = g_variant_get_objv (value, &length);
+  g_assert_cmpuint (length, ==, 200);
+  g_assert (strv[200] == NULL);
+
+  for (i = 0; i < 200; i++)
+    {
+      GVariant *child;
+
+      child = g_variant_get_child_value (value, i);
+      g_assert_cmpstr (strv[i], ==, g_variant_get_string (child, NULL));
+      g_variant_unref (child);
+    }
+
+  g_assert_cmpstr (strv[100], ==, replacement);
+  g_assert_cmpstr (strv[99], !=, replacement);
+  g_assert_cmpstr (strv[101], !=, replacement);
+
+  if (is_strv)
+    dup = g_variant_dup_strv (value, &length);
+  else
+    dup = g_variant_dup_objv (value, &length);
+  g_assert_cmpuint (length, ==, 200);
+  for (i = 0; i < 200; i++)
+    g_assert_cmpstr (dup[i], ==, strv[i]);
+  g_assert (dup[200] == NULL);
+
+  g_strfreev (dup);
+  g_free (strv);
+  g_variant_unref (value);
+  g_variant_unref (trusted);
+}
+
+static void
+test_strv_untrusted (void)
+{
+  /* "%03d" is 4 bytes with the nul: replace the nul */
+  check_strv_corrupted (G_VARIANT_TYPE_STRING_ARRAY, "%03d", 4, 3, "");
+
+  /* "/p%03d" is 6 bytes with the nul: replace the leading slash */
+  check_strv_corrupted (G_VARIANT_TYPE_OBJECT_PATH_ARRAY, "/p%03d", 6, 0, "/");
+}
+
+static void
+test_normal_form_cached (void)
+{
+  const guchar bools[] = { 0, 1, 1, 0, 1 };
+  const guchar bad_bools[] = { 0, 1, 2, 0, 1 };
+  GVariant *value;
+  GVariant *child;
+  gint i;
+
+  value = g_variant_new_from_data (G_VARIANT_TYPE ("ab"), bools,
+                                   sizeof bools, FALSE, NULL, NULL);
+  for (i = 0; i < 2; i++)
+    g_assert (g_variant_is_normal_form (value));
+  g_variant_unref (value);
+
+  /* negative results are remembered too */
+  value = g_variant_new_from_data (G_VARIANT_TYPE ("ab"), bad_bools,
+                                   sizeof bad_bools, FALSE, NULL, NULL);
+  for (i = 0; i < 2; i++)
+    g_assert (!g_variant_is_normal_form (value));
+
+  child = g_variant_get_child_value (value, 1);
+  g_assert (g_variant_is_normal_form (child));
+  g_variant_unref (child);
+
+  child = g_variant_get_child_value (value, 2);
+  g_assert (!g_variant_is_normal_form (child));
+  g_variant_unref (child);
+  g_variant_unref (value);
+
+  /* g_variant_get_string() shares the result with
+   * g_variant_is_normal_form()
+   */
+  value = g_variant_new_from_data (G_VARIANT_TYPE_STRING, "not\xffutf8",
+                                   9, FALSE, NULL, NULL);
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpstr (g_variant_get_string (value, NULL), ==, "");
+      g_assert (!g_variant_is_normal_form (value));
+    }
+  g_variant_unref (value);
+
+  value = g_variant_new_from_data (G_VARIANT_TYPE_STRING, "valid utf8",
+                                   11, FALSE, NULL, NULL);
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpstr (g_variant_get_string (value, NULL), ==, "valid utf8");
+      g_assert (g_variant_is_normal_form (value));
+    }
+  g_variant_unref (value);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -4120,6 +4658,7 @@ main (int argc, char **argv)
 
   g_test_add_func ("/gvariant/type", test_gvarianttype);
   g_test_add_func ("/gvariant/typeinfo", test_gvarianttypeinfo);
+  g_test_add_func ("/gvariant/typeinfo/threaded", test_gvarianttypeinfo_threaded);
   g_test_add_func ("/gvariant/serialiser/maybe", test_maybes);
   g_test_add_func ("/gvariant/serialiser/array", test_arrays);
   g_test_add_func ("/gvariant/serialiser/tuple", test_tuples);
@@ -4149,12 +4688,17 @@ main (int argc, char **argv)
   g_test_add_func ("/gvariant/parser", test_parses);
   g_test_add_func ("/gvariant/parse-failures", test_parse_failures);
   g_test_add_func ("/gvariant/parse-positional", test_parse_positional);
+  g_test_add_func ("/gvariant/parse-context", test_parse_context);
   g_test_add_func ("/gvariant/floating", test_floating);
   g_test_add_func ("/gvariant/bytestring", test_bytestring);
   g_test_add_func ("/gvariant/lookup-value", test_lookup_value);
   g_test_add_func ("/gvariant/lookup", test_lookup);
   g_test_add_func ("/gvariant/compare", test_compare);
   g_test_add_func ("/gvariant/fixed-array", test_fixed_array);
+  g_test_add_func ("/gvariant/strv-untrusted", test_strv_untrusted);
+  g_test_add_func ("/gvariant/normal-form-cached", test_normal_form_cached);
+  g_test_add_func ("/gvariant/copy-fixed-array", test_copy_fixed_array);
+  g_test_add_func ("/gvariant/gbytes", test_gbytes);
 
   return g_test_run ();
 }
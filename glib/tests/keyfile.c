@@ -1,7 +1,13 @@
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <locale.h>
 #include <string.h>
 #include <stdlib.h>
+#ifdef G_OS_UNIX
+#include <utime.h>
+#else
+#include <sys/utime.h>
+#endif
 
 static GKeyFile *
 load_data (const gchar   *data,
@@ -1422,6 +1428,307 @@ test_page_boundary (void)
   g_key_file_free (file);
 }
 
+static GKeyFile *
+load_file_from_data (const gchar   *data,
+                     GKeyFileFlags  flags,
+                     GError       **error)
+{
+  GKeyFile *keyfile;
+  gchar *filename;
+
+  filename = g_build_filename (g_get_tmp_dir (), "keyfile-test-lazy.ini", NULL);
+  g_assert (g_file_set_contents (filename, data, -1, NULL));
+
+  keyfile = g_key_file_new ();
+  if (!g_key_file_load_from_file (keyfile, filename, flags, error))
+    {
+      g_key_file_free (keyfile);
+      keyfile = NULL;
+    }
+
+  g_unlink (filename);
+  g_free (filename);
+
+  return keyfile;
+}
+
+static void
+test_load_lazily (void)
+{
+  GKeyFile *eager, *lazy;
+  GError *error = NULL;
+  gchar *eager_data, *lazy_data;
+  gchar *value;
+  gchar **keys;
+  const gchar data[] =
+    "# top comment\n"
+    "\n"
+    "[first]\n"
+    "Encoding=UTF-8\n"
+    "key=1\n"
+    "\n"
+    "# about the second group\n"
+    "[second]\r\n"
+    "key = 2\r\n"
+    "name[de]=zwei\n"
+    "# trailing comment\n"
+    "[third]\n"
+    "key=3\n"
+    "[second]\n"
+    "other=22\n"
+    "[fourth]\n"
+    "  key=4";
+
+  eager = load_file_from_data (data, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &error);
+  g_assert_no_error (error);
+  lazy = load_file_from_data (data, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS | G_KEY_FILE_LOAD_LAZILY, &error);
+  g_assert_no_error (error);
+
+  /* lookups only parse the group they need */
+  value = g_key_file_get_value (lazy, "third", "key", &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, "3");
+  g_free (value);
+
+  keys = g_key_file_get_keys (lazy, "second", NULL, &error);
+  check_no_error (&error);
+  g_assert_cmpint (g_strv_length (keys), ==, 3);
+  g_assert_cmpstr (keys[0], ==, "key");
+  g_assert_cmpstr (keys[1], ==, "name[de]");
+  g_assert_cmpstr (keys[2], ==, "other");
+  g_strfreev (keys);
+
+  value = g_key_file_get_comment (lazy, "second", NULL, &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, " about the second group\n");
+  g_free (value);
+
+  g_assert (g_key_file_remove_group (lazy, "fourth", &error));
+  check_no_error (&error);
+  g_assert (g_key_file_remove_group (eager, "fourth", &error));
+  check_no_error (&error);
+
+  /* the result is the same as loading everything up front */
+  eager_data = g_key_file_to_data (eager, NULL, NULL);
+  lazy_data = g_key_file_to_data (lazy, NULL, NULL);
+  g_assert_cmpstr (lazy_data, ==, eager_data);
+  g_free (eager_data);
+  g_free (lazy_data);
+
+  g_key_file_free (eager);
+  g_key_file_free (lazy);
+
+  /* syntax errors in groups that are not parsed yet are still reported */
+  lazy = load_file_from_data ("[first]\nkey=1\n[second]\nkey=2\nnonsense\n",
+                              G_KEY_FILE_LOAD_LAZILY, &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE);
+  g_assert (lazy == NULL);
+  g_clear_error (&error);
+
+  lazy = load_file_from_data ("[first]\nkey=1\n[second]\n b[ad =2\n",
+                              G_KEY_FILE_LOAD_LAZILY, &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE);
+  g_assert (lazy == NULL);
+  g_clear_error (&error);
+
+  lazy = load_file_from_data ("[first]\nEncoding=ISO-8859-1\n[second]\nkey=2\n",
+                              G_KEY_FILE_LOAD_LAZILY, &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_UNKNOWN_ENCODING);
+  g_assert (lazy == NULL);
+  g_clear_error (&error);
+}
+
+static void
+test_load_lazily_repeated_group (void)
+{
+  GKeyFile *eager, *lazy;
+  GError *error = NULL;
+  gchar *eager_data, *lazy_data;
+  gchar *value;
+  const gchar data[] =
+    "[Start]\n"
+    "[A]\n"
+    "k=v\n"
+    "[A]\n"
+    "k2=w\n"
+    "[B]\n"
+    "x=y\n"
+    "[Start]\n"
+    "s=1\n";
+
+  eager = load_file_from_data (data, 0, &error);
+  g_assert_no_error (error);
+  lazy = load_file_from_data (data, G_KEY_FILE_LOAD_LAZILY, &error);
+  g_assert_no_error (error);
+
+  g_assert (g_key_file_has_group (lazy, "A"));
+  g_assert (g_key_file_has_group (lazy, "B"));
+
+  value = g_key_file_get_value (lazy, "A", "k2", &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, "w");
+  g_free (value);
+
+  value = g_key_file_get_value (lazy, "Start", "s", &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, "1");
+  g_free (value);
+
+  eager_data = g_key_file_to_data (eager, NULL, NULL);
+  lazy_data = g_key_file_to_data (lazy, NULL, NULL);
+  g_assert_cmpstr (lazy_data, ==, eager_data);
+  g_free (eager_data);
+  g_free (lazy_data);
+
+  g_key_file_free (eager);
+  g_key_file_free (lazy);
+}
+
+static GKeyFile *
+load_cached_file (const gchar   *dir,
+                  const gchar   *name,
+                  GKeyFileFlags  flags,
+                  GError       **error)
+{
+  GKeyFile *keyfile;
+  gchar *filename;
+
+  filename = g_build_filename (dir, name, NULL);
+
+  keyfile = g_key_file_new ();
+  if (!g_key_file_load_from_file (keyfile, filename, flags, error))
+    {
+      g_key_file_free (keyfile);
+      keyfile = NULL;
+    }
+
+  g_free (filename);
+
+  return keyfile;
+}
+
+static void
+check_cached_file (const gchar   *dir,
+                   const gchar   *name,
+                   GKeyFileFlags  flags)
+{
+  GKeyFile *parsed, *cached;
+  GError *error = NULL;
+  gchar *parsed_data, *cached_data;
+
+  parsed = load_cached_file (dir, name, flags, &error);
+  g_assert_no_error (error);
+  cached = load_cached_file (dir, name, flags | G_KEY_FILE_USE_CACHE, &error);
+  g_assert_no_error (error);
+
+  parsed_data = g_key_file_to_data (parsed, NULL, NULL);
+  cached_data = g_key_file_to_data (cached, NULL, NULL);
+  g_assert_cmpstr (cached_data, ==, parsed_data);
+  g_free (parsed_data);
+  g_free (cached_data);
+
+  g_key_file_free (parsed);
+  g_key_file_free (cached);
+}
+
+static void
+test_cache (void)
+{
+  GKeyFile *keyfile;
+  GError *error = NULL;
+  gchar *dir, *a, *b, *cache;
+  struct utimbuf times;
+  GStatBuf stat_buf;
+  gchar *value;
+
+  dir = g_dir_make_tmp ("keyfile-test-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  a = g_build_filename (dir, "a.ini", NULL);
+  b = g_build_filename (dir, "b.ini", NULL);
+  cache = g_build_filename (dir, "keyfile.cache", NULL);
+
+  g_assert (g_file_set_contents (a,
+                                 "# comment\n"
+                                 "[first]\n"
+                                 "key=1\n"
+                                 "name=one\n"
+                                 "name[de]=eins\n"
+                                 "name[fr]=un\n"
+                                 "[second]\n"
+                                 "key = 2\n"
+                                 "[first]\n"
+                                 "other=3\n"
+                                 "key=4\n",
+                                 -1, NULL));
+  g_assert (g_file_set_contents (b, "nonsense\n", -1, NULL));
+
+  g_assert (g_key_file_compile_cache (dir, &error));
+  g_assert_no_error (error);
+  g_assert (g_file_test (cache, G_FILE_TEST_IS_REGULAR));
+
+  check_cached_file (dir, "a.ini", G_KEY_FILE_NONE);
+  check_cached_file (dir, "a.ini", G_KEY_FILE_KEEP_TRANSLATIONS);
+  check_cached_file (dir, "a.ini", G_KEY_FILE_KEEP_COMMENTS);
+
+  /* invalid files are not cached, so they still fail to load */
+  keyfile = load_cached_file (dir, "b.ini", G_KEY_FILE_USE_CACHE, &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE);
+  g_assert (keyfile == NULL);
+  g_clear_error (&error);
+
+  /* a file rewritten with the same size and its old mtime restored is
+   * parsed again, since it was replaced...
+   */
+  g_assert (g_stat (a, &stat_buf) == 0);
+  g_assert (g_file_set_contents (a,
+                                 "# comment\n"
+                                 "[first]\n"
+                                 "key=5\n"
+                                 "name=one\n"
+                                 "name[de]=eins\n"
+                                 "name[fr]=un\n"
+                                 "[second]\n"
+                                 "key = 2\n"
+                                 "[first]\n"
+                                 "other=3\n"
+                                 "key=6\n",
+                                 -1, NULL));
+  times.actime = stat_buf.st_atime;
+  times.modtime = stat_buf.st_mtime;
+  g_assert (g_utime (a, &times) == 0);
+
+  keyfile = load_cached_file (dir, "a.ini", G_KEY_FILE_USE_CACHE, &error);
+  g_assert_no_error (error);
+  value = g_key_file_get_value (keyfile, "first", "key", &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, "6");
+  g_free (value);
+  g_key_file_free (keyfile);
+
+  /* ...and so is one whose mtime changed */
+  times.modtime = stat_buf.st_mtime + 10;
+  g_assert (g_utime (a, &times) == 0);
+
+  keyfile = load_cached_file (dir, "a.ini", G_KEY_FILE_USE_CACHE, &error);
+  g_assert_no_error (error);
+  value = g_key_file_get_value (keyfile, "first", "key", &error);
+  check_no_error (&error);
+  g_assert_cmpstr (value, ==, "6");
+  g_free (value);
+  g_key_file_free (keyfile);
+
+  g_unlink (a);
+  g_unlink (b);
+  g_unlink (cache);
+  g_rmdir (dir);
+
+  g_free (a);
+  g_free (b);
+  g_free (cache);
+  g_free (dir);
+}
+
 static void
 test_ref (void)
 {
@@ -1570,6 +1877,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/keyfile/load-fail", test_load_fail);
   g_test_add_func ("/keyfile/non-utf8", test_non_utf8);
   g_test_add_func ("/keyfile/page-boundary", test_page_boundary);
+  g_test_add_func ("/keyfile/load-lazily", test_load_lazily);
+  g_test_add_func ("/keyfile/load-lazily-repeated-group", test_load_lazily_repeated_group);
+  g_test_add_func ("/keyfile/cache", test_cache);
   g_test_add_func ("/keyfile/ref", test_ref);
   g_test_add_func ("/keyfile/replace-value", test_replace_value);
   g_test_add_func ("/keyfile/list-separator", test_list_separator);
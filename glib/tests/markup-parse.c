@@ -148,6 +148,33 @@ test_in_chunks (const gchar *contents,
   return 0;
 }
 
+static int
+test_zero_copy (const gchar *contents,
+                gint         length)
+{
+  GMarkupParseContext *context;
+  GString *saved;
+  gint res = 0;
+
+  saved = string;
+  string = g_string_sized_new (0);
+  depth = 0;
+
+  context = g_markup_parse_context_new (&parser, G_MARKUP_ZERO_COPY_TEXT, NULL, NULL);
+  if (!g_markup_parse_context_parse (context, contents, length, NULL) ||
+      !g_markup_parse_context_end_parse (context, NULL))
+    res = 1;
+  g_markup_parse_context_free (context);
+
+  g_assert_cmpstr (string->str, ==, saved->str);
+
+  g_string_free (string, TRUE);
+  string = saved;
+  depth = 0;
+
+  return res;
+}
+
 static int
 test_file (const gchar *filename)
 {
@@ -176,6 +203,7 @@ test_file (const gchar *filename)
   if (!g_markup_parse_context_parse (context, contents, length, NULL))
     {
       g_markup_parse_context_free (context);
+      g_assert_cmpint (test_zero_copy (contents, length), ==, 1);
       g_free (contents);
       return 1;
     }
@@ -183,12 +211,20 @@ test_file (const gchar *filename)
   if (!g_markup_parse_context_end_parse (context, NULL))
     {
       g_markup_parse_context_free (context);
+      g_assert_cmpint (test_zero_copy (contents, length), ==, 1);
       g_free (contents);
       return 1;
     }
 
   g_markup_parse_context_free (context);
 
+  /* The zero-copy text mode must report exactly the same things */
+  if (test_zero_copy (contents, length) != 0)
+    {
+      g_free (contents);
+      return 1;
+    }
+
   /* A byte at a time */
   if (test_in_chunks (contents, length, 1) != 0)
     {
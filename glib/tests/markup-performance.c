@@ -0,0 +1,145 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#define NUM_ITERATIONS 20
+
+typedef struct
+{
+  GMarkupParseFlags flags;
+  gsize chunk_size;     /* 0 for the whole document at once */
+} PerfTest;
+
+static void
+text_handler (GMarkupParseContext *context,
+              const gchar         *text,
+              gsize                text_len,
+              gpointer             user_data,
+              GError             **error)
+{
+  gsize *n_bytes = user_data;
+
+  *n_bytes += text_len;
+}
+
+static const GMarkupParser parser = {
+  NULL,
+  NULL,
+  text_handler,
+  NULL,
+  NULL
+};
+
+/* Something that looks like D-Bus introspection data followed by
+ * large blocks of documentation text, roughly 4 MB in total.
+ */
+static gchar *
+make_document (gsize *length)
+{
+  GString *doc;
+  gint i, j;
+
+  doc = g_string_new ("<node name=\"/org/gtk/Test\">\n");
+  for (i = 0; i < 2000; i++)
+    {
+      g_string_append_printf (doc, "  <interface name=\"org.gtk.Test%d\">\n", i);
+      for (j = 0; j < 4; j++)
+        g_string_append_printf (doc,
+                                "    <method name=\"Method%d\">\n"
+                                "      <arg type=\"a{sv}\" name=\"options\" direction=\"in\"/>\n"
+                                "      <arg type=\"s\" name=\"result\" direction=\"out\"/>\n"
+                                "    </method>\n", j);
+      g_string_append (doc, "    <doc>");
+      for (j = 0; j < 20; j++)
+        g_string_append (doc,
+                         "The quick brown fox jumps over the lazy dog, "
+                         "and then does it all over again.\n");
+      g_string_append (doc, "    Escaped &lt;markup&gt; &amp; more.</doc>\n");
+      g_string_append (doc, "  </interface>\n");
+    }
+  g_string_append (doc, "</node>\n");
+
+  *length = doc->len;
+
+  return g_string_free (doc, FALSE);
+}
+
+static void
+perform (gconstpointer data)
+{
+  const PerfTest *test = data;
+  GMarkupParseContext *context;
+  gchar *doc;
+  gsize length;
+  gsize n_bytes = 0;
+  gdouble time_elapsed;
+  gdouble result;
+  gint i;
+
+  if (!g_test_perf ())
+    return;
+
+  doc = make_document (&length);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < NUM_ITERATIONS; i++)
+    {
+      gsize offset, chunk_size;
+
+      context = g_markup_parse_context_new (&parser, test->flags, &n_bytes, NULL);
+      chunk_size = test->chunk_size ? test->chunk_size : length;
+
+      for (offset = 0; offset < length; offset += chunk_size)
+        g_assert (g_markup_parse_context_parse (context, doc + offset,
+                                                MIN (chunk_size, length - offset),
+                                                NULL));
+      g_assert (g_markup_parse_context_end_parse (context, NULL));
+      g_markup_parse_context_free (context);
+    }
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpuint (n_bytes, >, 0);
+
+  result = ((gdouble) length * NUM_ITERATIONS / time_elapsed) * 1.0e-6;
+  g_test_maximized_result (result, "%6.1f MB/s", result);
+
+  g_free (doc);
+}
+
+int
+main (int argc, char **argv)
+{
+  static const PerfTest copy = { 0, 0 };
+  static const PerfTest copy_chunked = { 0, 4096 };
+  static const PerfTest zero_copy = { G_MARKUP_ZERO_COPY_TEXT, 0 };
+  static const PerfTest zero_copy_chunked = { G_MARKUP_ZERO_COPY_TEXT, 4096 };
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/markup/perf/parse", &copy, perform);
+  g_test_add_data_func ("/markup/perf/parse-chunked", &copy_chunked, perform);
+  g_test_add_data_func ("/markup/perf/parse-zero-copy", &zero_copy, perform);
+  g_test_add_data_func ("/markup/perf/parse-zero-copy-chunked", &zero_copy_chunked, perform);
+
+  return g_test_run ();
+}
@@ -1383,6 +1383,72 @@ test_basic (void)
   g_regex_unref (regex);
 }
 
+static void
+test_cache (void)
+{
+  GRegex *regex1, *regex2, *regex3;
+  GError *error = NULL;
+  guint hits, misses;
+  gint i;
+
+  g_regex_cache_clear ();
+
+  regex1 = g_regex_new_cached ("[a-z]+", 0, 0, &error);
+  g_assert_no_error (error);
+  regex2 = g_regex_new_cached ("[a-z]+", 0, 0, &error);
+  g_assert_no_error (error);
+  g_assert (regex1 == regex2);
+
+  /* different options give a different regex */
+  regex3 = g_regex_new_cached ("[a-z]+", G_REGEX_CASELESS, 0, &error);
+  g_assert_no_error (error);
+  g_assert (regex3 != regex1);
+  g_assert (g_regex_match (regex3, "ABC", 0, NULL));
+  g_assert (!g_regex_match (regex1, "ABC", 0, NULL));
+
+  g_regex_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 2);
+
+  /* failures are reported and not cached */
+  g_assert (g_regex_new_cached ("(", 0, 0, &error) == NULL);
+  g_assert_error (error, G_REGEX_ERROR, G_REGEX_ERROR_UNMATCHED_PARENTHESIS);
+  g_clear_error (&error);
+  g_assert (g_regex_new_cached ("(", 0, 0, NULL) == NULL);
+  g_regex_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 4);
+
+  /* the _simple() functions go through the cache */
+  g_assert (g_regex_match_simple ("[a-z]+", "abc", 0, 0));
+  g_regex_cache_get_stats (&hits, NULL);
+  g_assert_cmpuint (hits, ==, 2);
+
+  /* flooding the cache evicts the least recently used entries, while
+   * references held by the caller stay valid */
+  for (i = 0; i < 100; i++)
+    {
+      gchar *pattern = g_strdup_printf ("x{%d}", i);
+      GRegex *regex = g_regex_new_cached (pattern, 0, 0, NULL);
+      g_regex_unref (regex);
+      g_free (pattern);
+    }
+  g_regex_unref (regex2);
+  regex2 = g_regex_new_cached ("[a-z]+", 0, 0, NULL);
+  g_assert (regex2 != regex1);
+  g_assert_cmpstr (g_regex_get_pattern (regex1), ==, "[a-z]+");
+  g_assert (g_regex_match (regex1, "abc", 0, NULL));
+
+  g_regex_cache_clear ();
+  g_regex_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  g_regex_unref (regex1);
+  g_regex_unref (regex2);
+  g_regex_unref (regex3);
+}
+
 static void
 test_compile (void)
 {
@@ -2117,6 +2183,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/regex/basic", test_basic);
   g_test_add_func ("/regex/compile", test_compile);
+  g_test_add_func ("/regex/cache", test_cache);
   g_test_add_func ("/regex/properties", test_properties);
   g_test_add_func ("/regex/class", test_class);
   g_test_add_func ("/regex/lookahead", test_lookahead);
@@ -0,0 +1,178 @@
+/* Unit tests for GRope
+ * Copyright (C) 2012 Red Hat, Inc.
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <string.h>
+#include "glib.h"
+
+static void
+test_rope_basic (void)
+{
+  GRope *rope;
+  gchar *str;
+
+  rope = g_rope_new (NULL);
+  g_assert_cmpuint (g_rope_get_length (rope), ==, 0);
+  g_assert_cmpstr (g_rope_flatten (rope), ==, "");
+  str = g_rope_free (rope, FALSE);
+  g_assert_cmpstr (str, ==, "");
+  g_free (str);
+
+  rope = g_rope_new ("lo wor");
+  g_rope_append (rope, "ld");
+  g_rope_prepend (rope, "he");
+  g_rope_append_c (rope, '!');
+  g_rope_insert (rope, 3, "l");
+  g_rope_append_printf (rope, " %d %s", 42, "times");
+  g_assert_cmpstr (g_rope_flatten (rope), ==, "hello world! 42 times");
+  g_assert_cmpuint (g_rope_get_length (rope), ==, 21);
+
+  g_rope_erase (rope, 5, 6);
+  g_assert_cmpstr (g_rope_flatten (rope), ==, "hello! 42 times");
+  g_rope_truncate (rope, 6);
+  g_assert_cmpstr (g_rope_flatten (rope), ==, "hello!");
+  g_rope_erase (rope, 0, -1);
+  g_assert_cmpuint (g_rope_get_length (rope), ==, 0);
+  g_assert_cmpstr (g_rope_flatten (rope), ==, "");
+
+  /* embedded nuls */
+  g_rope_append_len (rope, "a\0b", 3);
+  g_rope_prepend_len (rope, "\0", 1);
+  g_rope_insert_len (rope, -1, "c\0", 2);
+  g_assert_cmpuint (g_rope_get_length (rope), ==, 6);
+  g_assert (memcmp (g_rope_flatten (rope), "\0a\0bc\0", 7) == 0);
+
+  g_rope_free (rope, TRUE);
+}
+
+/* Applies random edits to a GRope and a GString in parallel */
+static void
+test_rope_random (void)
+{
+  GRope *rope;
+  GString *string;
+  gchar buf[100000];
+  gchar *str;
+  gint i;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = 'a' + i % 26;
+
+  rope = g_rope_new (NULL);
+  string = g_string_new (NULL);
+
+  for (i = 0; i < 2000; i++)
+    {
+      gsize pos, len;
+
+      pos = g_test_rand_int_range (0, string->len + 1);
+
+      switch (g_test_rand_int_range (0, 4))
+        {
+        case 0:
+          len = g_test_rand_int_range (0, 100);
+          g_rope_append_len (rope, buf + i % 26, len);
+          g_string_append_len (string, buf + i % 26, len);
+          break;
+
+        case 1:
+          /* mostly small inserts, sometimes more than a chunk */
+          if (g_test_rand_int_range (0, 20) == 0)
+            len = g_test_rand_int_range (0, sizeof buf - i % 26);
+          else
+            len = g_test_rand_int_range (0, 1000);
+          g_rope_insert_len (rope, pos, buf + i % 26, len);
+          g_string_insert_len (string, pos, buf + i % 26, len);
+          break;
+
+        case 2:
+          len = g_test_rand_int_range (0, string->len - pos + 1) / 4;
+          g_rope_erase (rope, pos, len);
+          g_string_erase (string, pos, len);
+          break;
+
+        case 3:
+          if (g_test_rand_int_range (0, 10) == 0)
+            g_assert_cmpstr (g_rope_flatten (rope), ==, string->str);
+          break;
+        }
+
+      g_assert_cmpuint (g_rope_get_length (rope), ==, string->len);
+    }
+
+  str = g_rope_free (rope, FALSE);
+  g_assert_cmpstr (str, ==, string->str);
+  g_free (str);
+  g_string_free (string, TRUE);
+}
+
+static void
+test_rope_large (void)
+{
+  GRope *rope;
+  GString *string;
+  gchar *str;
+  gint i;
+
+  rope = g_rope_new (NULL);
+  string = g_string_new (NULL);
+
+  /* a few megabytes of log lines */
+  for (i = 0; i < 100000; i++)
+    {
+      g_rope_append_printf (rope, "line %d\n", i);
+      g_string_append_printf (string, "line %d\n", i);
+    }
+
+  /* flattening keeps the chunks for the edits that follow */
+  g_assert_cmpstr (g_rope_flatten (rope), ==, string->str);
+
+  /* with edits in the middle */
+  for (i = 0; i < 1000; i++)
+    {
+      gsize pos = string->len / 2 + i * 7;
+
+      g_rope_insert (rope, pos, "#");
+      g_string_insert (string, pos, "#");
+    }
+
+  g_rope_erase (rope, 1000, 100000);
+  g_string_erase (string, 1000, 100000);
+
+  g_assert_cmpstr (g_rope_flatten (rope), ==, string->str);
+
+  str = g_rope_free (rope, FALSE);
+  g_assert_cmpstr (str, ==, string->str);
+  g_free (str);
+  g_string_free (string, TRUE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rope/basic", test_rope_basic);
+  g_test_add_func ("/rope/random", test_rope_random);
+  g_test_add_func ("/rope/large", test_rope_large);
+
+  return g_test_run();
+}